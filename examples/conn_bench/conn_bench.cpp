@@ -0,0 +1,157 @@
+///////////////////////////////////////////////////////////////////////////////
+// 建立连接压测: 多个客户端线程不停地 "连接 -> 收发一个字节 -> 断开"，测量服务器
+// 每秒能处理的连接数。客户端以 SO_LINGER(0) 关闭连接，避免本地端口耗尽于 TIME_WAIT。
+//
+// 用法: conn_bench [listener|reuse_port] [clients] [seconds]
+//   listener   - 由监听线程接受连接，再分派给各事件循环 (缺省)
+//   reuse_port - 各事件循环以 SO_REUSEPORT 直接接受连接
+
+#include "conn_bench.h"
+
+IseBusiness* createIseBusinessObject()
+{
+    return new AppBusiness();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+const int SERVER_PORT = 10030;
+const int EVENT_LOOP_COUNT = 4;
+
+//-----------------------------------------------------------------------------
+
+AppBusiness::AppBusiness() :
+    reusePort_(false),
+    clientCount_(16),
+    seconds_(5)
+{
+    // nothing
+}
+
+//-----------------------------------------------------------------------------
+
+bool AppBusiness::parseArguments(int argc, char *argv[])
+{
+    if (argc > 1)
+    {
+        string mode = argv[1];
+        if (mode == "reuse_port")
+            reusePort_ = true;
+        else if (mode != "listener")
+            return false;
+    }
+    if (argc > 2) clientCount_ = ise::max(1, strToInt(argv[2]));
+    if (argc > 3) seconds_ = ise::max(1, strToInt(argv[3]));
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+
+string AppBusiness::getAppHelp()
+{
+    return formatString("Usage: %s [listener|reuse_port] [clients] [seconds]\n",
+        extractFileName(getAppExeName()).c_str());
+}
+
+//-----------------------------------------------------------------------------
+
+void AppBusiness::afterInit()
+{
+    std::cout << formatString("conn_bench: mode=%s, clients=%d, seconds=%d",
+        reusePort_ ? "reuse_port" : "listener", clientCount_, seconds_) << std::endl;
+
+    Thread::create(boost::bind(&AppBusiness::benchThreadProc, this, _1));
+}
+
+//-----------------------------------------------------------------------------
+
+void AppBusiness::onInitFailed(Exception& e)
+{
+    std::cout << "fail to start conn_bench: " << e.makeLogStr() << std::endl;
+}
+
+//-----------------------------------------------------------------------------
+
+void AppBusiness::initIseOptions(IseOptions& options)
+{
+    options.setIsDaemon(false);
+    options.setAllowMultiInstance(true);
+    options.setServerType(ST_TCP);
+    options.setTcpServerCount(1);
+    options.setTcpServerPort(SERVER_PORT);
+    options.setTcpServerEventLoopCount(EVENT_LOOP_COUNT);
+    options.setTcpServerReusePort(reusePort_);
+}
+
+//-----------------------------------------------------------------------------
+
+void AppBusiness::onTcpConnected(const TcpConnectionPtr& connection)
+{
+    connection->recv(BYTE_PACKET_SPLITTER);
+}
+
+//-----------------------------------------------------------------------------
+
+void AppBusiness::onTcpRecvComplete(const TcpConnectionPtr& connection, void *packetBuffer,
+    int packetSize, const Context& context)
+{
+    connection->send(packetBuffer, packetSize);
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 压测主线程
+//-----------------------------------------------------------------------------
+void AppBusiness::benchThreadProc(Thread& thread)
+{
+    UINT64 startTicks = getCurTicks();
+    for (int i = 0; i < clientCount_; ++i)
+        Thread::create(boost::bind(&AppBusiness::clientThreadProc, this, _1));
+
+    sleepSeconds(seconds_);
+    stopped_.set(1);
+    while (finishedClients_.get() < clientCount_)
+        sleepSeconds(0.01);
+    UINT64 elapsedMSecs = ise::max<UINT64>(1, getTickDiff(startTicks, getCurTicks()));
+
+    std::cout << formatString("%s connections in %dms, %.0f conn/s, failed: %s",
+        addThousandSep(completedCount_.get()).c_str(), (int)elapsedMSecs,
+        completedCount_.get() * 1000.0 / elapsedMSecs,
+        addThousandSep(failedCount_.get()).c_str()) << std::endl;
+
+    iseApp().setTerminated(true);
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 客户端线程: 不停地建立连接、收发一个字节、断开
+//-----------------------------------------------------------------------------
+void AppBusiness::clientThreadProc(Thread& thread)
+{
+    while (!stopped_.get())
+    {
+        try
+        {
+            BaseTcpClient client;
+            client.connect("127.0.0.1", SERVER_PORT);
+
+            TcpSocket& socket = client.getConnection().getSocket();
+            socket.setBlockMode(true);
+
+            struct linger lingerValue = { 1, 0 };
+            ::setsockopt(socket.getHandle(), SOL_SOCKET, SO_LINGER,
+                (char*)&lingerValue, sizeof(lingerValue));
+
+            char data = 'x';
+            if (::send(socket.getHandle(), &data, 1, 0) == 1 &&
+                ::recv(socket.getHandle(), &data, 1, 0) == 1)
+                completedCount_.increment();
+            else
+                failedCount_.increment();
+        }
+        catch (Exception&)
+        {
+            failedCount_.increment();
+        }
+    }
+
+    finishedClients_.increment();
+}
@@ -0,0 +1,44 @@
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef _CONN_BENCH_H_
+#define _CONN_BENCH_H_
+
+#include "ise/main/ise.h"
+
+using namespace ise;
+
+///////////////////////////////////////////////////////////////////////////////
+
+class AppBusiness : public IseBusiness
+{
+public:
+    AppBusiness();
+    virtual ~AppBusiness() {}
+
+    virtual bool parseArguments(int argc, char *argv[]);
+    virtual string getAppHelp();
+    virtual void afterInit();
+    virtual void onInitFailed(Exception& e);
+    virtual void initIseOptions(IseOptions& options);
+
+    virtual void onTcpConnected(const TcpConnectionPtr& connection);
+    virtual void onTcpRecvComplete(const TcpConnectionPtr& connection, void *packetBuffer,
+        int packetSize, const Context& context);
+
+private:
+    void benchThreadProc(Thread& thread);
+    void clientThreadProc(Thread& thread);
+
+private:
+    bool reusePort_;
+    int clientCount_;
+    int seconds_;
+    AtomicInt stopped_;
+    AtomicInt finishedClients_;
+    AtomicInt64 completedCount_;
+    AtomicInt64 failedCount_;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+#endif // _CONN_BENCH_H_
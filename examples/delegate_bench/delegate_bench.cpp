@@ -0,0 +1,124 @@
+///////////////////////////////////////////////////////////////////////////////
+// 委托吞吐量压测: 多个生产者线程同时向一个事件循环委托仿函数 (delegateToLoop)，
+// 分别测量 1、4、16 个生产者时事件循环每秒能执行的委托数。
+//
+// 用法: delegate_bench [tasksPerRound]
+
+#include "delegate_bench.h"
+
+IseBusiness* createIseBusinessObject()
+{
+    return new AppBusiness();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+const int PRODUCER_COUNTS[] = { 1, 4, 16 };
+
+//-----------------------------------------------------------------------------
+
+AppBusiness::AppBusiness() :
+    eventLoop_(NULL),
+    taskCount_(1000000)
+{
+    // nothing
+}
+
+//-----------------------------------------------------------------------------
+
+bool AppBusiness::parseArguments(int argc, char *argv[])
+{
+    if (argc > 1) taskCount_ = ise::max(1, strToInt(argv[1]));
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+
+string AppBusiness::getAppHelp()
+{
+    return formatString("Usage: %s [tasksPerRound]\n",
+        extractFileName(getAppExeName()).c_str());
+}
+
+//-----------------------------------------------------------------------------
+
+void AppBusiness::afterInit()
+{
+    eventLoop_ = iseApp().mainServer().getMainTcpServer().getTcpClientEventLoopList()[0];
+    Thread::create(boost::bind(&AppBusiness::benchThreadProc, this, _1));
+}
+
+//-----------------------------------------------------------------------------
+
+void AppBusiness::onInitFailed(Exception& e)
+{
+    std::cout << "fail to start delegate_bench: " << e.makeLogStr() << std::endl;
+}
+
+//-----------------------------------------------------------------------------
+
+void AppBusiness::initIseOptions(IseOptions& options)
+{
+    options.setIsDaemon(false);
+    options.setAllowMultiInstance(true);
+    options.setServerType(ST_TCP);
+    options.setTcpServerCount(0);
+    options.setTcpClientEventLoopCount(1);
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 压测主线程: 依次以不同的生产者数量进行测量
+//-----------------------------------------------------------------------------
+void AppBusiness::benchThreadProc(Thread& thread)
+{
+    for (size_t i = 0; i < sizeof(PRODUCER_COUNTS) / sizeof(PRODUCER_COUNTS[0]); ++i)
+        runRound(PRODUCER_COUNTS[i]);
+
+    iseApp().setTerminated(true);
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 生产者线程: 连续委托 taskCount 个仿函数
+//-----------------------------------------------------------------------------
+void AppBusiness::producerThreadProc(Thread& thread, int taskCount)
+{
+    for (int i = 0; i < taskCount; ++i)
+        eventLoop_->delegateToLoop(boost::bind(&AppBusiness::onTask, this, i, (void*)NULL));
+
+    finishedProducers_.increment();
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 进行一轮测量
+//-----------------------------------------------------------------------------
+void AppBusiness::runRound(int producerCount)
+{
+    int taskCount = taskCount_ / producerCount;
+    int totalCount = taskCount * producerCount;
+    int issuedCount = eventLoop_->getWakeupIssuedCount();
+
+    executedCount_.set(0);
+    finishedProducers_.set(0);
+
+    UINT64 startTicks = getCurTicks();
+    for (int i = 0; i < producerCount; ++i)
+        Thread::create(boost::bind(&AppBusiness::producerThreadProc, this, _1, taskCount));
+
+    while (executedCount_.get() < totalCount)
+        sleepSeconds(0.001);
+    UINT64 elapsedMSecs = ise::max<UINT64>(1, getTickDiff(startTicks, getCurTicks()));
+
+    std::cout << formatString("producers=%-2d tasks=%d elapsed=%dms %.0f tasks/s wakeups=%d",
+        producerCount, totalCount, (int)elapsedMSecs, totalCount * 1000.0 / elapsedMSecs,
+        eventLoop_->getWakeupIssuedCount() - issuedCount) << std::endl;
+
+    while (finishedProducers_.get() < producerCount)
+        sleepSeconds(0.001);
+}
+
+//-----------------------------------------------------------------------------
+
+void AppBusiness::onTask(int seq, void *arg)
+{
+    executedCount_.increment();
+}
@@ -0,0 +1,39 @@
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef _DELEGATE_BENCH_H_
+#define _DELEGATE_BENCH_H_
+
+#include "ise/main/ise.h"
+
+using namespace ise;
+
+///////////////////////////////////////////////////////////////////////////////
+
+class AppBusiness : public IseBusiness
+{
+public:
+    AppBusiness();
+    virtual ~AppBusiness() {}
+
+    virtual bool parseArguments(int argc, char *argv[]);
+    virtual string getAppHelp();
+    virtual void afterInit();
+    virtual void onInitFailed(Exception& e);
+    virtual void initIseOptions(IseOptions& options);
+
+private:
+    void benchThreadProc(Thread& thread);
+    void producerThreadProc(Thread& thread, int taskCount);
+    void runRound(int producerCount);
+    void onTask(int seq, void *arg);
+
+private:
+    EventLoop *eventLoop_;
+    int taskCount_;
+    AtomicInt executedCount_;
+    AtomicInt finishedProducers_;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+#endif // _DELEGATE_BENCH_H_
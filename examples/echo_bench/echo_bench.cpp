@@ -0,0 +1,210 @@
+///////////////////////////////////////////////////////////////////////////////
+// 回显服务器压测: 比较 EPoll 水平触发 (LT) 与边沿触发 (ET) 模式的吞吐量。
+//
+// 用法: echo_bench [lt|et] [connections] [seconds] [messageSize] [busyPollMicroSecs]
+//
+// 程序内同时启动回显服务器和若干客户端线程，每个客户端线程通过阻塞套接字与
+// 服务器进行 "发送-等待回显" 的往返通信，计时结束后输出吞吐量并退出。
+// 指定 busyPollMicroSecs 时服务器事件循环启用忙轮询，并输出忙轮询的统计。
+
+#include "echo_bench.h"
+
+IseBusiness* createIseBusinessObject()
+{
+    return new AppBusiness();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+const int SERVER_PORT = 10010;
+
+//-----------------------------------------------------------------------------
+
+AppBusiness::AppBusiness() :
+    edgeTriggered_(false),
+    connCount_(16),
+    seconds_(10),
+    messageSize_(1024*4),
+    busyPollMicroSecs_(0)
+{
+    // nothing
+}
+
+//-----------------------------------------------------------------------------
+
+void AppBusiness::initialize()
+{
+    // nothing
+}
+
+//-----------------------------------------------------------------------------
+
+void AppBusiness::finalize()
+{
+    // nothing
+}
+
+//-----------------------------------------------------------------------------
+
+bool AppBusiness::parseArguments(int argc, char *argv[])
+{
+    if (argc > 1)
+    {
+        string mode = argv[1];
+        if (mode != "lt" && mode != "et")
+        {
+            std::cout << getAppHelp() << std::endl;
+            return false;
+        }
+        edgeTriggered_ = (mode == "et");
+    }
+
+    if (argc > 2) connCount_ = ise::max(1, strToInt(argv[2]));
+    if (argc > 3) seconds_ = ise::max(1, strToInt(argv[3]));
+    if (argc > 4) messageSize_ = ise::max(1, strToInt(argv[4]));
+    if (argc > 5) busyPollMicroSecs_ = ise::max(0, strToInt(argv[5]));
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+
+string AppBusiness::getAppHelp()
+{
+    return formatString("Usage: %s [lt|et] [connections] [seconds] [messageSize] [busyPollMicroSecs]\n",
+        extractFileName(getAppExeName()).c_str());
+}
+
+//-----------------------------------------------------------------------------
+
+void AppBusiness::afterInit()
+{
+    std::cout << formatString("echo_bench: mode=%s, connections=%d, seconds=%d, messageSize=%d, busyPoll=%dus",
+        (edgeTriggered_ ? "ET" : "LT"), connCount_, seconds_, messageSize_, busyPollMicroSecs_) << std::endl;
+
+    Thread::create(boost::bind(&AppBusiness::benchThreadProc, this, _1));
+}
+
+//-----------------------------------------------------------------------------
+
+void AppBusiness::onInitFailed(Exception& e)
+{
+    std::cout << "fail to start echo_bench: " << e.makeLogStr() << std::endl;
+}
+
+//-----------------------------------------------------------------------------
+
+void AppBusiness::initIseOptions(IseOptions& options)
+{
+    options.setIsDaemon(false);
+    options.setServerType(ST_TCP);
+    options.setTcpServerCount(1);
+    options.setTcpServerPort(SERVER_PORT);
+    options.setTcpServerEventLoopCount(1);
+    options.setTcpServerEdgeTriggered(edgeTriggered_);
+    options.setTcpServerBusyPoll(busyPollMicroSecs_);
+}
+
+//-----------------------------------------------------------------------------
+
+void AppBusiness::onTcpConnected(const TcpConnectionPtr& connection)
+{
+    connection->recv();
+}
+
+//-----------------------------------------------------------------------------
+
+void AppBusiness::onTcpRecvComplete(const TcpConnectionPtr& connection, void *packetBuffer,
+    int packetSize, const Context& context)
+{
+    connection->send(packetBuffer, packetSize);
+}
+
+//-----------------------------------------------------------------------------
+
+void AppBusiness::onTcpSendComplete(const TcpConnectionPtr& connection, const Context& context)
+{
+    connection->recv();
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 压测主线程: 启动客户端线程，计时，汇总结果
+//-----------------------------------------------------------------------------
+void AppBusiness::benchThreadProc(Thread& thread)
+{
+    UINT64 startTicks = getCurTicks();
+    for (int i = 0; i < connCount_; ++i)
+        Thread::create(boost::bind(&AppBusiness::clientThreadProc, this, _1));
+
+    sleepSeconds(seconds_);
+    stopped_.set(1);
+    while (finishedClients_.get() < connCount_)
+        sleepSeconds(0.01);
+    double elapsedSecs = getTickDiff(startTicks, getCurTicks()) / 1000.0;
+
+    INT64 bytes = totalBytes_.get();
+    INT64 messages = totalMessages_.get();
+    std::cout << formatString("%s: %d clients finished, %.1f MB/s, %.0f msgs/s",
+        (edgeTriggered_ ? "ET" : "LT"), finishedClients_.get(),
+        bytes / elapsedSecs / (1024*1024), messages / elapsedSecs) << std::endl;
+
+    if (busyPollMicroSecs_ > 0)
+    {
+        TcpEventLoop *eventLoop = iseApp().mainServer().getMainTcpServer().
+            getTcpServer(0).getEventLoopList()[0];
+        INT64 spins = eventLoop->getBusyPollSpinCount();
+        INT64 hits = eventLoop->getBusyPollHitCount();
+        std::cout << formatString("busy poll: spins %s, hits %s (%.1f%%), sleeps %s, idle spin time %.1f ms",
+            addThousandSep(spins).c_str(), addThousandSep(hits).c_str(),
+            (spins > 0 ? hits * 100.0 / spins : 0.0),
+            addThousandSep(eventLoop->getBusyPollSleepCount()).c_str(),
+            eventLoop->getBusyPollSpinMicroSecs() / 1000.0) << std::endl;
+    }
+
+    iseApp().setTerminated(true);
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 客户端线程: 阻塞式 "发送-接收回显" 往返
+//-----------------------------------------------------------------------------
+void AppBusiness::clientThreadProc(Thread& thread)
+{
+    BaseTcpClient client;
+    try
+    {
+        client.connect("127.0.0.1", SERVER_PORT);
+    }
+    catch (Exception& e)
+    {
+        std::cout << "connect failed: " << e.makeLogStr() << std::endl;
+        finishedClients_.increment();
+        return;
+    }
+
+    SOCKET handle = client.getConnection().getSocket().getHandle();
+    client.getConnection().getSocket().setBlockMode(true);
+
+    string message(messageSize_, 'x');
+    Buffer buffer(messageSize_);
+
+    while (stopped_.get() == 0)
+    {
+        if (::send(handle, message.c_str(), messageSize_, 0) != messageSize_)
+            break;
+
+        int received = 0;
+        while (received < messageSize_)
+        {
+            int r = ::recv(handle, buffer.data() + received, messageSize_ - received, 0);
+            if (r <= 0) break;
+            received += r;
+        }
+        if (received < messageSize_)
+            break;
+
+        totalBytes_.getAndAdd(messageSize_);
+        totalMessages_.increment();
+    }
+
+    finishedClients_.increment();
+}
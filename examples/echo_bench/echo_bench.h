@@ -0,0 +1,50 @@
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef _ECHO_BENCH_H_
+#define _ECHO_BENCH_H_
+
+#include "ise/main/ise.h"
+
+using namespace ise;
+
+///////////////////////////////////////////////////////////////////////////////
+
+class AppBusiness : public IseBusiness
+{
+public:
+    AppBusiness();
+    virtual ~AppBusiness() {}
+
+    virtual void initialize();
+    virtual void finalize();
+
+    virtual bool parseArguments(int argc, char *argv[]);
+    virtual string getAppHelp();
+    virtual void afterInit();
+    virtual void onInitFailed(Exception& e);
+    virtual void initIseOptions(IseOptions& options);
+
+    virtual void onTcpConnected(const TcpConnectionPtr& connection);
+    virtual void onTcpRecvComplete(const TcpConnectionPtr& connection, void *packetBuffer,
+        int packetSize, const Context& context);
+    virtual void onTcpSendComplete(const TcpConnectionPtr& connection, const Context& context);
+
+private:
+    void benchThreadProc(Thread& thread);
+    void clientThreadProc(Thread& thread);
+
+private:
+    bool edgeTriggered_;
+    int connCount_;
+    int seconds_;
+    int messageSize_;
+    int busyPollMicroSecs_;
+    AtomicInt stopped_;
+    AtomicInt finishedClients_;
+    AtomicInt64 totalBytes_;
+    AtomicInt64 totalMessages_;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+#endif // _ECHO_BENCH_H_
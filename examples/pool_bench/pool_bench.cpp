@@ -0,0 +1,291 @@
+///////////////////////////////////////////////////////////////////////////////
+// 线程池压测: 比较原实现 (一个互斥锁保护的任务队列，LockedThreadPool) 与工作窃取的
+// ThreadPool 在 1-64 个工作线程下的吞吐量。任务均为约数百纳秒的纯计算。
+//
+// submit:  PRODUCER_COUNT 个外部线程 (模拟事件循环) 逐个调用 addTask() 提交任务。
+// batch:   同上，但每 BATCH_SIZE 个任务调用一次 addTasks()。
+// spawn:   任务在工作线程中派生子任务 (二叉树，深度 SPAWN_DEPTH)。
+//
+// 用法: pool_bench [taskCount]
+
+#include "pool_bench.h"
+
+IseBusiness* createIseBusinessObject()
+{
+    return new AppBusiness();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+const int THREAD_COUNTS[] = { 1, 2, 4, 8, 16, 32, 64 };
+const int PRODUCER_COUNT = 4;
+const int BATCH_SIZE = 64;
+const int SPAWN_DEPTH = 10;
+const int WORK_ITERATIONS = 200;
+
+///////////////////////////////////////////////////////////////////////////////
+// class LockedThreadPool
+
+LockedThreadPool::LockedThreadPool() :
+    condition_(mutex_),
+    isRunning_(false)
+{
+    // nothing
+}
+
+LockedThreadPool::~LockedThreadPool()
+{
+    stop();
+}
+
+void LockedThreadPool::start(int threadCount)
+{
+    AutoLocker locker(mutex_);
+
+    isRunning_ = true;
+    for (int i = 0; i < threadCount; ++i)
+        threadList_.add(Thread::create(boost::bind(&LockedThreadPool::threadProc, this, _1)));
+}
+
+void LockedThreadPool::stop()
+{
+    {
+        AutoLocker locker(mutex_);
+        if (!isRunning_) return;
+        isRunning_ = false;
+        condition_.notifyAll();
+    }
+
+    // 不调用 Thread::terminate()，尚未开始执行的线程也会执行到 threadProc() 并退出
+    while (threadList_.getCount() > 0)
+        sleepSeconds(0.001);
+}
+
+void LockedThreadPool::addTask(const Task& task)
+{
+    AutoLocker locker(mutex_);
+    tasks_.push_back(task);
+    condition_.notify();
+}
+
+void LockedThreadPool::addTasks(const TaskList& tasks)
+{
+    for (size_t i = 0; i < tasks.size(); ++i)
+        addTask(tasks[i]);
+}
+
+bool LockedThreadPool::takeTask(Task& task)
+{
+    AutoLocker locker(mutex_);
+
+    while (tasks_.empty() && isRunning_)
+        condition_.wait();
+
+    if (!tasks_.empty())
+    {
+        task = tasks_.front();
+        tasks_.pop_front();
+        return true;
+    }
+    else
+        return false;
+}
+
+void LockedThreadPool::threadProc(Thread& thread)
+{
+    AutoFinalizer autoFinalizer(boost::bind(&ThreadList::remove, &threadList_, &thread));
+
+    Task task;
+    while (takeTask(task))
+        task(thread);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// class AppBusiness
+
+AppBusiness::AppBusiness() :
+    taskCount_(200000)
+{
+    // nothing
+}
+
+//-----------------------------------------------------------------------------
+
+bool AppBusiness::parseArguments(int argc, char *argv[])
+{
+    if (argc > 1) taskCount_ = ise::max(PRODUCER_COUNT * BATCH_SIZE, strToInt(argv[1]));
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+
+string AppBusiness::getAppHelp()
+{
+    return formatString("Usage: %s [taskCount]\n",
+        extractFileName(getAppExeName()).c_str());
+}
+
+//-----------------------------------------------------------------------------
+
+void AppBusiness::afterInit()
+{
+    Thread::create(boost::bind(&AppBusiness::benchThreadProc, this, _1));
+}
+
+//-----------------------------------------------------------------------------
+
+void AppBusiness::onInitFailed(Exception& e)
+{
+    std::cout << "fail to start pool_bench: " << e.makeLogStr() << std::endl;
+}
+
+//-----------------------------------------------------------------------------
+
+void AppBusiness::initIseOptions(IseOptions& options)
+{
+    options.setIsDaemon(false);
+    options.setAllowMultiInstance(true);
+    options.setServerType(ST_TCP);
+    options.setTcpServerCount(0);
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 压测主线程
+//-----------------------------------------------------------------------------
+void AppBusiness::benchThreadProc(Thread& thread)
+{
+    std::cout << formatString("%d tasks of %d iterations, %d producers, "
+        "throughput in thousand tasks/s (locked / work-stealing)",
+        taskCount_, WORK_ITERATIONS, PRODUCER_COUNT) << std::endl;
+    std::cout << formatString("  %-8s %-20s %-20s %-20s",
+        "threads", "submit", "batch", "spawn") << std::endl;
+
+    for (size_t i = 0; i < sizeof(THREAD_COUNTS) / sizeof(THREAD_COUNTS[0]); ++i)
+    {
+        int threadCount = THREAD_COUNTS[i];
+
+        double lockedSubmit = runSubmitRound<LockedThreadPool>(threadCount, 1);
+        double stealSubmit = runSubmitRound<ThreadPool>(threadCount, 1);
+        double lockedBatch = runSubmitRound<LockedThreadPool>(threadCount, BATCH_SIZE);
+        double stealBatch = runSubmitRound<ThreadPool>(threadCount, BATCH_SIZE);
+        double lockedSpawn = runSpawnRound<LockedThreadPool>(threadCount);
+        double stealSpawn = runSpawnRound<ThreadPool>(threadCount);
+
+        std::cout << formatString("  %-8d %-20s %-20s %-20s", threadCount,
+            formatString("%.0f / %.0f", lockedSubmit, stealSubmit).c_str(),
+            formatString("%.0f / %.0f", lockedBatch, stealBatch).c_str(),
+            formatString("%.0f / %.0f", lockedSpawn, stealSpawn).c_str()) << std::endl;
+    }
+
+    iseApp().setTerminated(true);
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 外部线程提交任务的场景，返回吞吐量 (千任务/秒)
+//-----------------------------------------------------------------------------
+template<typename PoolType>
+double AppBusiness::runSubmitRound(int threadCount, int batchSize)
+{
+    PoolType pool;
+    pool.start(threadCount);
+    doneCount_.set(0);
+    producerCount_.set(PRODUCER_COUNT);
+
+    UINT64 startMicroTicks = getCurMicroTicks();
+    for (int i = 0; i < PRODUCER_COUNT; ++i)
+    {
+        Thread::create(boost::bind(&AppBusiness::producerProc<PoolType>, this, _1,
+            &pool, taskCount_ / PRODUCER_COUNT, batchSize));
+    }
+    waitForTasks(taskCount_ / PRODUCER_COUNT * PRODUCER_COUNT);
+    UINT64 elapsedMicroSecs = ise::max<UINT64>(1, getCurMicroTicks() - startMicroTicks);
+
+    while (producerCount_.get() > 0)
+        sleepSeconds(0.001);
+    pool.stop();
+
+    return doneCount_.get() * 1000.0 / elapsedMicroSecs;
+}
+
+//-----------------------------------------------------------------------------
+
+template<typename PoolType>
+void AppBusiness::producerProc(Thread& thread, PoolType *pool, int taskCount, int batchSize)
+{
+    typename PoolType::Task task = boost::bind(&AppBusiness::doWork, this);
+    typename PoolType::TaskList batch;
+
+    for (int i = 0; i < taskCount; ++i)
+    {
+        if (batchSize <= 1)
+            pool->addTask(task);
+        else
+        {
+            batch.push_back(task);
+            if ((int)batch.size() >= batchSize || i == taskCount - 1)
+            {
+                pool->addTasks(batch);
+                batch.clear();
+            }
+        }
+    }
+
+    producerCount_.decrement();
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 任务派生子任务的场景，返回吞吐量 (千任务/秒)
+//-----------------------------------------------------------------------------
+template<typename PoolType>
+double AppBusiness::runSpawnRound(int threadCount)
+{
+    const int TREE_SIZE = (1 << (SPAWN_DEPTH + 1)) - 1;
+    int rootCount = ise::max(1, taskCount_ / TREE_SIZE);
+
+    PoolType pool;
+    pool.start(threadCount);
+    doneCount_.set(0);
+
+    UINT64 startMicroTicks = getCurMicroTicks();
+    for (int i = 0; i < rootCount; ++i)
+        pool.addTask(boost::bind(&AppBusiness::spawnTask<PoolType>, this, _1, &pool, SPAWN_DEPTH));
+    waitForTasks(rootCount * TREE_SIZE);
+    UINT64 elapsedMicroSecs = ise::max<UINT64>(1, getCurMicroTicks() - startMicroTicks);
+
+    pool.stop();
+
+    return doneCount_.get() * 1000.0 / elapsedMicroSecs;
+}
+
+//-----------------------------------------------------------------------------
+
+template<typename PoolType>
+void AppBusiness::spawnTask(Thread& thread, PoolType *pool, int depth)
+{
+    if (depth > 0)
+    {
+        pool->addTask(boost::bind(&AppBusiness::spawnTask<PoolType>, this, _1, pool, depth - 1));
+        pool->addTask(boost::bind(&AppBusiness::spawnTask<PoolType>, this, _1, pool, depth - 1));
+    }
+    doWork();
+}
+
+//-----------------------------------------------------------------------------
+
+void AppBusiness::waitForTasks(int taskCount)
+{
+    while (doneCount_.get() < taskCount)
+        sleepSeconds(0.0002);
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 一个任务的计算量
+//-----------------------------------------------------------------------------
+void AppBusiness::doWork()
+{
+    volatile UINT value = 1;
+    for (int i = 0; i < WORK_ITERATIONS; ++i)
+        value = value * 1103515245 + 12345;
+
+    doneCount_.increment();
+}
@@ -0,0 +1,78 @@
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef _POOL_BENCH_H_
+#define _POOL_BENCH_H_
+
+#include "ise/main/ise.h"
+
+using namespace ise;
+
+///////////////////////////////////////////////////////////////////////////////
+// class LockedThreadPool - 原 ThreadPool 的实现 (一个互斥锁保护的任务队列)，作为对照
+
+class LockedThreadPool : boost::noncopyable
+{
+public:
+    typedef ThreadPool::Task Task;
+    typedef ThreadPool::TaskList TaskList;
+
+public:
+    LockedThreadPool();
+    ~LockedThreadPool();
+
+    void start(int threadCount);
+    void stop();
+
+    void addTask(const Task& task);
+    void addTasks(const TaskList& tasks);
+
+private:
+    bool takeTask(Task& task);
+    void threadProc(Thread& thread);
+
+private:
+    Condition::Mutex mutex_;
+    Condition condition_;
+    std::deque<Task> tasks_;
+    ThreadList threadList_;
+    bool isRunning_;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+class AppBusiness : public IseBusiness
+{
+public:
+    AppBusiness();
+    virtual ~AppBusiness() {}
+
+    virtual bool parseArguments(int argc, char *argv[]);
+    virtual string getAppHelp();
+    virtual void afterInit();
+    virtual void onInitFailed(Exception& e);
+    virtual void initIseOptions(IseOptions& options);
+
+private:
+    void benchThreadProc(Thread& thread);
+
+    template<typename PoolType>
+    double runSubmitRound(int threadCount, int batchSize);
+    template<typename PoolType>
+    void producerProc(Thread& thread, PoolType *pool, int taskCount, int batchSize);
+    template<typename PoolType>
+    double runSpawnRound(int threadCount);
+    template<typename PoolType>
+    void spawnTask(Thread& thread, PoolType *pool, int depth);
+
+    void waitForTasks(int taskCount);
+    void doWork();
+
+private:
+    int taskCount_;
+    AtomicInt doneCount_;
+    AtomicInt producerCount_;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+#endif // _POOL_BENCH_H_
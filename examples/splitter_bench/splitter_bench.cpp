@@ -0,0 +1,241 @@
+///////////////////////////////////////////////////////////////////////////////
+// 分包器压测: 比较逐字节扫描、无状态重扫描的分包器与可续扫的分包器模板。
+//
+// 大包场景: 一个大数据包按 chunkSize 分批到达，每到一批就以缓存中的全部数据调用一次
+// 分包器 (与 TcpConnection 的调用方式相同)。
+// 小包场景: 缓存中有大量 64 字节的小包，连续分包直至取完。
+//
+// 用法: splitter_bench [largePacketSize] [chunkSize]
+
+#include "splitter_bench.h"
+
+IseBusiness* createIseBusinessObject()
+{
+    return new AppBusiness();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+const int SMALL_PACKET_SIZE = 64;
+const int SMALL_STREAM_SIZE = 64 * 1024 * 1024;
+
+typedef LengthFieldSplitter<0, 4, BO_BIG_ENDIAN, -4> Int32LengthSplitter;
+
+//-----------------------------------------------------------------------------
+// 描述: 原 linePacketSplitter 的逐字节实现，作为对照
+//-----------------------------------------------------------------------------
+static void byteLoopLineSplitter(const char *data, int bytes, int& retrieveBytes)
+{
+    retrieveBytes = 0;
+    for (int i = 0; i < bytes; ++i)
+    {
+        if (data[i] == '\r' || data[i] == '\n')
+        {
+            retrieveBytes = i + 1;
+            if (i < bytes - 1)
+            {
+                char next = data[i+1];
+                if ((next == '\r' || next == '\n') && next != data[i])
+                    ++retrieveBytes;
+            }
+            break;
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 原 nullTerminatedPacketSplitter 的逐字节实现，作为对照
+//-----------------------------------------------------------------------------
+static void byteLoopNullSplitter(const char *data, int bytes, int& retrieveBytes)
+{
+    retrieveBytes = 0;
+    for (int i = 0; i < bytes; ++i)
+    {
+        if (data[i] == '\0')
+        {
+            retrieveBytes = i + 1;
+            break;
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 手写的4字节长度前缀分包器，作为对照
+//-----------------------------------------------------------------------------
+static void handWrittenLengthSplitter(const char *data, int bytes, int& retrieveBytes)
+{
+    retrieveBytes = 0;
+    if (bytes < 4) return;
+
+    const BYTE *p = (const BYTE*)data;
+    int packetSize = (int)(((UINT32)p[0] << 24) | ((UINT32)p[1] << 16) | ((UINT32)p[2] << 8) | p[3]);
+    if (bytes >= packetSize)
+        retrieveBytes = packetSize;
+}
+
+//-----------------------------------------------------------------------------
+
+static string makeLengthPacket(int size)
+{
+    string packet(size, 'x');
+    packet[0] = (char)((size >> 24) & 0xFF);
+    packet[1] = (char)((size >> 16) & 0xFF);
+    packet[2] = (char)((size >> 8) & 0xFF);
+    packet[3] = (char)(size & 0xFF);
+    return packet;
+}
+
+//-----------------------------------------------------------------------------
+
+static string makeSmallPacketStream(char delimiter, bool lengthPrefixed)
+{
+    string stream;
+    stream.reserve(SMALL_STREAM_SIZE);
+    while ((int)stream.size() < SMALL_STREAM_SIZE)
+    {
+        if (lengthPrefixed)
+            stream += makeLengthPacket(SMALL_PACKET_SIZE);
+        else
+            stream += string(SMALL_PACKET_SIZE - 1, 'x') + delimiter;
+    }
+    return stream;
+}
+
+//-----------------------------------------------------------------------------
+
+AppBusiness::AppBusiness() :
+    largePacketSize_(4 * 1024 * 1024),
+    chunkSize_(4096)
+{
+    // nothing
+}
+
+//-----------------------------------------------------------------------------
+
+bool AppBusiness::parseArguments(int argc, char *argv[])
+{
+    if (argc > 1) largePacketSize_ = ise::max(16, strToInt(argv[1]));
+    if (argc > 2) chunkSize_ = ise::max(1, strToInt(argv[2]));
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+
+string AppBusiness::getAppHelp()
+{
+    return formatString("Usage: %s [largePacketSize] [chunkSize]\n",
+        extractFileName(getAppExeName()).c_str());
+}
+
+//-----------------------------------------------------------------------------
+
+void AppBusiness::afterInit()
+{
+    Thread::create(boost::bind(&AppBusiness::benchThreadProc, this, _1));
+}
+
+//-----------------------------------------------------------------------------
+
+void AppBusiness::onInitFailed(Exception& e)
+{
+    std::cout << "fail to start splitter_bench: " << e.makeLogStr() << std::endl;
+}
+
+//-----------------------------------------------------------------------------
+
+void AppBusiness::initIseOptions(IseOptions& options)
+{
+    options.setIsDaemon(false);
+    options.setAllowMultiInstance(true);
+    options.setServerType(ST_TCP);
+    options.setTcpServerCount(0);
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 压测主线程
+//-----------------------------------------------------------------------------
+void AppBusiness::benchThreadProc(Thread& thread)
+{
+    string linePacket = string(largePacketSize_ - 1, 'x') + '\n';
+    string nullPacket = string(largePacketSize_ - 1, 'x') + '\0';
+    string lengthPacket = makeLengthPacket(largePacketSize_);
+
+    std::cout << formatString("large packet: %d bytes, arriving in %d-byte chunks",
+        largePacketSize_, chunkSize_) << std::endl;
+    runLargePacketRound("line/byte-loop", linePacket, &byteLoopLineSplitter);
+    runLargePacketRound("line/LineSplitter", linePacket, LineSplitter());
+    runLargePacketRound("null/byte-loop", nullPacket, &byteLoopNullSplitter);
+    runLargePacketRound("null/DelimiterSplitter", nullPacket, DelimiterSplitter<'\0'>());
+    runLargePacketRound("length/hand-written", lengthPacket, &handWrittenLengthSplitter);
+    runLargePacketRound("length/LengthFieldSplitter", lengthPacket, Int32LengthSplitter());
+
+    string lineStream = makeSmallPacketStream('\n', false);
+    string nullStream = makeSmallPacketStream('\0', false);
+    string lengthStream = makeSmallPacketStream(0, true);
+
+    std::cout << formatString("small packets: %d bytes each, %d MB in total",
+        SMALL_PACKET_SIZE, SMALL_STREAM_SIZE / 1024 / 1024) << std::endl;
+    runSmallPacketRound("line/byte-loop", lineStream, &byteLoopLineSplitter);
+    runSmallPacketRound("line/LineSplitter", lineStream, LineSplitter());
+    runSmallPacketRound("null/byte-loop", nullStream, &byteLoopNullSplitter);
+    runSmallPacketRound("null/DelimiterSplitter", nullStream, DelimiterSplitter<'\0'>());
+    runSmallPacketRound("length/hand-written", lengthStream, &handWrittenLengthSplitter);
+    runSmallPacketRound("length/LengthFieldSplitter", lengthStream, Int32LengthSplitter());
+    runSmallPacketRound("fixed/FixedSizeSplitter", lengthStream, FixedSizeSplitter<SMALL_PACKET_SIZE>());
+
+    iseApp().setTerminated(true);
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 大包场景: 数据分批到达，每批到达后调用一次分包器
+//-----------------------------------------------------------------------------
+void AppBusiness::runLargePacketRound(const char *name, const string& packet,
+    const PacketSplitter& splitter)
+{
+    PacketSplitter task = splitter;   // 与接收任务一样，每个包使用一份新的分包器
+    int packetSize = (int)packet.size();
+    int retrieveBytes = 0;
+    int calls = 0;
+
+    UINT64 startTicks = getCurTicks();
+    for (int bytes = ise::min(chunkSize_, packetSize); retrieveBytes == 0;
+        bytes = ise::min(bytes + chunkSize_, packetSize))
+    {
+        task(packet.data(), bytes, retrieveBytes);
+        ++calls;
+    }
+    UINT64 elapsedMSecs = ise::max<UINT64>(1, getTickDiff(startTicks, getCurTicks()));
+
+    std::cout << formatString("  %-28s calls=%-6d elapsed=%-6dms %s",
+        name, calls, (int)elapsedMSecs,
+        retrieveBytes == packetSize ? "ok" : "WRONG SIZE") << std::endl;
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 小包场景: 缓存中的数据包已全部到达，连续分包
+//-----------------------------------------------------------------------------
+void AppBusiness::runSmallPacketRound(const char *name, const string& stream,
+    const PacketSplitter& splitter)
+{
+    const char *data = stream.data();
+    int remainBytes = (int)stream.size();
+    int packets = 0;
+
+    UINT64 startTicks = getCurTicks();
+    while (remainBytes > 0)
+    {
+        PacketSplitter task = splitter;
+        int retrieveBytes = 0;
+        task(data, remainBytes, retrieveBytes);
+        if (retrieveBytes <= 0) break;
+
+        data += retrieveBytes;
+        remainBytes -= retrieveBytes;
+        ++packets;
+    }
+    UINT64 elapsedMSecs = ise::max<UINT64>(1, getTickDiff(startTicks, getCurTicks()));
+
+    std::cout << formatString("  %-28s packets=%-8d elapsed=%-5dms %.0f MB/s",
+        name, packets, (int)elapsedMSecs,
+        (stream.size() / 1024.0 / 1024.0) * 1000.0 / elapsedMSecs) << std::endl;
+}
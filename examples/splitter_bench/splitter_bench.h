@@ -0,0 +1,36 @@
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef _SPLITTER_BENCH_H_
+#define _SPLITTER_BENCH_H_
+
+#include "ise/main/ise.h"
+
+using namespace ise;
+
+///////////////////////////////////////////////////////////////////////////////
+
+class AppBusiness : public IseBusiness
+{
+public:
+    AppBusiness();
+    virtual ~AppBusiness() {}
+
+    virtual bool parseArguments(int argc, char *argv[]);
+    virtual string getAppHelp();
+    virtual void afterInit();
+    virtual void onInitFailed(Exception& e);
+    virtual void initIseOptions(IseOptions& options);
+
+private:
+    void benchThreadProc(Thread& thread);
+    void runLargePacketRound(const char *name, const string& packet, const PacketSplitter& splitter);
+    void runSmallPacketRound(const char *name, const string& stream, const PacketSplitter& splitter);
+
+private:
+    int largePacketSize_;
+    int chunkSize_;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+#endif // _SPLITTER_BENCH_H_
@@ -0,0 +1,272 @@
+///////////////////////////////////////////////////////////////////////////////
+// 定时器队列压测: 比较原 std::set 实现的定时器队列 (SetTimerQueue) 与基于分层时间轮
+// 和定时器池的 TimerQueue。
+//
+// 添加/取消场景: 模拟会话层，每个请求添加一个超时定时器，稍后 (WINDOW_SIZE 个请求后)
+// 再将其取消。队列中另有 population 个长期存在的定时器 (如空闲超时)。
+// 到期场景: 添加大量在 0-19 毫秒内到期的定时器，并处理至全部到期，只统计 CPU 时间。
+//
+// 用法: timer_bench [timerCount]
+
+#include "timer_bench.h"
+
+IseBusiness* createIseBusinessObject()
+{
+    return new AppBusiness();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+const int WINDOW_SIZE = 1000;
+const int POPULATIONS[] = { 0, 100000, 1000000 };
+const INT64 LONG_TIMER_DELAY = 60 * 1000;
+
+///////////////////////////////////////////////////////////////////////////////
+// class SetTimer
+
+SeqNumberAlloc SetTimer::s_timerIdAlloc(1);
+
+SetTimer::SetTimer(Timestamp expiration, INT64 interval, const TimerCallback& callback) :
+    expiration_(expiration),
+    interval_(interval),
+    repeat_(interval > 0),
+    timerId_(s_timerIdAlloc.allocId()),
+    callback_(callback)
+{
+    // nothing
+}
+
+void SetTimer::restart(Timestamp now)
+{
+    if (repeat_)
+        expiration_ = now + interval_;
+    else
+        expiration_ = Timestamp(0);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// class SetTimerQueue
+
+SetTimerQueue::SetTimerQueue() :
+    callingExpiredTimers_(false)
+{
+    // nothing
+}
+
+SetTimerQueue::~SetTimerQueue()
+{
+    for (TimerList::iterator iter = timerList_.begin(); iter != timerList_.end(); ++iter)
+        delete iter->second;
+}
+
+TimerId SetTimerQueue::addTimer(Timestamp expiration, INT64 interval, const TimerCallback& callback)
+{
+    SetTimer *timer = new SetTimer(expiration, interval, callback);
+    timerList_.insert(TimerItem(timer->expiration(), timer));
+    timerIdMap_.insert(std::make_pair(timer->timerId(), timer));
+    return timer->timerId();
+}
+
+void SetTimerQueue::cancelTimer(TimerId timerId)
+{
+    TimerIdMap::iterator iter = timerIdMap_.find(timerId);
+    if (iter != timerIdMap_.end())
+    {
+        SetTimer *timer = iter->second;
+        timerList_.erase(TimerItem(timer->expiration(), timer));
+        timerIdMap_.erase(iter);
+        delete timer;
+    }
+    else if (callingExpiredTimers_)
+    {
+        cancelingTimers_.insert(timerId);
+    }
+}
+
+bool SetTimerQueue::getNearestExpiration(Timestamp& expiration)
+{
+    bool result = !timerList_.empty();
+    if (result)
+        expiration = timerList_.begin()->first;
+    return result;
+}
+
+void SetTimerQueue::processExpiredTimers(Timestamp now)
+{
+    std::vector<SetTimer*> expiredTimers;
+    TimerItem timerItem(now, reinterpret_cast<SetTimer*>(std::numeric_limits<uintptr_t>::max()));
+
+    TimerList::iterator bound = timerList_.upper_bound(timerItem);
+    for (TimerList::iterator iter = timerList_.begin(); iter != bound;)
+    {
+        SetTimer *timer = iter->second;
+        expiredTimers.push_back(timer);
+        timerList_.erase(iter++);
+        timerIdMap_.erase(timer->timerId());
+    }
+
+    for (size_t i = 0; i < expiredTimers.size(); i++)
+    {
+        SetTimer *timer = expiredTimers[i];
+
+        cancelingTimers_.clear();
+        callingExpiredTimers_ = true;
+        timer->invokeCallback();
+        callingExpiredTimers_ = false;
+
+        if (timer->repeat() &&
+            cancelingTimers_.find(timer->timerId()) == cancelingTimers_.end())
+        {
+            timer->restart(now);
+            timerList_.insert(TimerItem(timer->expiration(), timer));
+            timerIdMap_.insert(std::make_pair(timer->timerId(), timer));
+        }
+        else
+            delete timer;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// class AppBusiness
+
+AppBusiness::AppBusiness() :
+    timerCount_(1000000),
+    firedCount_(0)
+{
+    // nothing
+}
+
+//-----------------------------------------------------------------------------
+
+bool AppBusiness::parseArguments(int argc, char *argv[])
+{
+    if (argc > 1) timerCount_ = ise::max(WINDOW_SIZE, strToInt(argv[1]));
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+
+string AppBusiness::getAppHelp()
+{
+    return formatString("Usage: %s [timerCount]\n",
+        extractFileName(getAppExeName()).c_str());
+}
+
+//-----------------------------------------------------------------------------
+
+void AppBusiness::afterInit()
+{
+    Thread::create(boost::bind(&AppBusiness::benchThreadProc, this, _1));
+}
+
+//-----------------------------------------------------------------------------
+
+void AppBusiness::onInitFailed(Exception& e)
+{
+    std::cout << "fail to start timer_bench: " << e.makeLogStr() << std::endl;
+}
+
+//-----------------------------------------------------------------------------
+
+void AppBusiness::initIseOptions(IseOptions& options)
+{
+    options.setIsDaemon(false);
+    options.setAllowMultiInstance(true);
+    options.setServerType(ST_TCP);
+    options.setTcpServerCount(0);
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 压测主线程
+//-----------------------------------------------------------------------------
+void AppBusiness::benchThreadProc(Thread& thread)
+{
+    randomize();
+    delays_.resize(timerCount_);
+    for (int i = 0; i < timerCount_; ++i)
+        delays_[i] = getRandom(1000, 30000);
+
+    std::cout << formatString("arm/cancel: %d timers, each canceled %d arms later",
+        timerCount_, WINDOW_SIZE) << std::endl;
+    for (size_t i = 0; i < sizeof(POPULATIONS) / sizeof(POPULATIONS[0]); ++i)
+    {
+        runArmCancelRound<SetTimerQueue>("std::set", POPULATIONS[i]);
+        runArmCancelRound<TimerQueue>("timing wheel", POPULATIONS[i]);
+    }
+
+    std::cout << formatString("expire: %d timers due within 20ms", timerCount_) << std::endl;
+    runExpireRound<SetTimerQueue>("std::set");
+    runExpireRound<TimerQueue>("timing wheel");
+
+    iseApp().setTerminated(true);
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 添加/取消场景
+//-----------------------------------------------------------------------------
+template<typename QueueType>
+void AppBusiness::runArmCancelRound(const char *name, int population)
+{
+    QueueType queue;
+    Timestamp now = Timestamp::now();
+    TimerCallback callback = boost::bind(&AppBusiness::onTimer, this);
+    std::vector<TimerId> window(WINDOW_SIZE, 0);
+
+    for (int i = 0; i < population; ++i)
+        queue.addTimer(now + LONG_TIMER_DELAY + delays_[i % timerCount_], 0, callback);
+
+    UINT64 startMicroTicks = getCurMicroTicks();
+    for (int i = 0; i < timerCount_; ++i)
+    {
+        TimerId& timerId = window[i % WINDOW_SIZE];
+        if (timerId != 0)
+            queue.cancelTimer(timerId);
+        timerId = queue.addTimer(now + delays_[i], 0, callback);
+    }
+    for (int i = 0; i < WINDOW_SIZE; ++i)
+        queue.cancelTimer(window[i]);
+    UINT64 elapsedMicroSecs = ise::max<UINT64>(1, getCurMicroTicks() - startMicroTicks);
+
+    std::cout << formatString("  %-14s population=%-8d elapsed=%-6dms %.1f ns/op %s",
+        name, population, (int)(elapsedMicroSecs / 1000),
+        elapsedMicroSecs * 1000.0 / (timerCount_ * 2.0),
+        queue.getCount() == population ? "ok" : "WRONG COUNT") << std::endl;
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 到期场景: 只统计添加和处理定时器的时间，不含事件循环的等待时间
+//-----------------------------------------------------------------------------
+template<typename QueueType>
+void AppBusiness::runExpireRound(const char *name)
+{
+    QueueType queue;
+    Timestamp now = Timestamp::now();
+    TimerCallback callback = boost::bind(&AppBusiness::onTimer, this);
+    firedCount_ = 0;
+
+    UINT64 startMicroTicks = getCurMicroTicks();
+    for (int i = 0; i < timerCount_; ++i)
+        queue.addTimer(now + delays_[i] % 20, 0, callback);
+    UINT64 elapsedMicroSecs = getCurMicroTicks() - startMicroTicks;
+
+    UINT64 startTicks = getCurTicks();
+    while (firedCount_ < timerCount_ && getTickDiff(startTicks, getCurTicks()) < 5000)
+    {
+        Timestamp expiration;
+        if (queue.getNearestExpiration(expiration))
+        {
+            INT64 waitMSecs = expiration - Timestamp::now();
+            if (waitMSecs > 0)
+                sleepSeconds(waitMSecs / 1000.0);
+        }
+
+        startMicroTicks = getCurMicroTicks();
+        queue.processExpiredTimers(Timestamp::now());
+        elapsedMicroSecs += getCurMicroTicks() - startMicroTicks;
+    }
+    elapsedMicroSecs = ise::max<UINT64>(1, elapsedMicroSecs);
+
+    std::cout << formatString("  %-14s fired=%-8d cpu=%-6dms %.1f ns/timer",
+        name, firedCount_, (int)(elapsedMicroSecs / 1000),
+        elapsedMicroSecs * 1000.0 / timerCount_) << std::endl;
+}
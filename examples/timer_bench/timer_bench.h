@@ -0,0 +1,91 @@
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef _TIMER_BENCH_H_
+#define _TIMER_BENCH_H_
+
+#include "ise/main/ise.h"
+
+using namespace ise;
+
+///////////////////////////////////////////////////////////////////////////////
+// class SetTimer - 原 Timer 的实现 (每个定时器单独分配，TimerId 由加锁的序号分配器分配)
+
+class SetTimer : boost::noncopyable
+{
+public:
+    SetTimer(Timestamp expiration, INT64 interval, const TimerCallback& callback);
+
+    Timestamp expiration() const { return expiration_; }
+    bool repeat() const { return repeat_; }
+    TimerId timerId() const { return timerId_; }
+    void invokeCallback() { if (callback_) callback_(); }
+    void restart(Timestamp now);
+
+private:
+    Timestamp expiration_;
+    const INT64 interval_;
+    const bool repeat_;
+    TimerId timerId_;
+    const TimerCallback callback_;
+
+    static SeqNumberAlloc s_timerIdAlloc;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// class SetTimerQueue - 原 TimerQueue 的实现 (std::set + std::map)，作为对照
+
+class SetTimerQueue : boost::noncopyable
+{
+public:
+    SetTimerQueue();
+    ~SetTimerQueue();
+
+    TimerId addTimer(Timestamp expiration, INT64 interval, const TimerCallback& callback);
+    void cancelTimer(TimerId timerId);
+    bool getNearestExpiration(Timestamp& expiration);
+    void processExpiredTimers(Timestamp now);
+    int getCount() const { return (int)timerIdMap_.size(); }
+
+private:
+    typedef std::pair<Timestamp, SetTimer*> TimerItem;
+    typedef std::set<TimerItem> TimerList;
+    typedef std::map<TimerId, SetTimer*> TimerIdMap;
+    typedef std::set<TimerId> TimerIds;
+
+    TimerList timerList_;
+    TimerIdMap timerIdMap_;
+    bool callingExpiredTimers_;
+    TimerIds cancelingTimers_;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+class AppBusiness : public IseBusiness
+{
+public:
+    AppBusiness();
+    virtual ~AppBusiness() {}
+
+    virtual bool parseArguments(int argc, char *argv[]);
+    virtual string getAppHelp();
+    virtual void afterInit();
+    virtual void onInitFailed(Exception& e);
+    virtual void initIseOptions(IseOptions& options);
+
+private:
+    void benchThreadProc(Thread& thread);
+    template<typename QueueType>
+    void runArmCancelRound(const char *name, int population);
+    template<typename QueueType>
+    void runExpireRound(const char *name);
+    void onTimer() { ++firedCount_; }
+
+private:
+    int timerCount_;
+    std::vector<INT64> delays_;
+    int firedCount_;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+#endif // _TIMER_BENCH_H_
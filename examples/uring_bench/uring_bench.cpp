@@ -0,0 +1,245 @@
+///////////////////////////////////////////////////////////////////////////////
+// io_uring 后端压测: 比较 EPoll 与 io_uring 两种 I/O 后端的吞吐量和往返延迟。
+//
+// 用法: uring_bench [epoll|io_uring] [connections] [seconds] [messageSize]
+//
+// 程序内同时启动回显服务器和若干客户端线程，每个客户端线程通过阻塞套接字与
+// 服务器进行 "发送-等待回显" 的往返通信并记录每次往返的耗时，计时结束后输出
+// 吞吐量、延迟分位数及服务器事件循环的轮循次数并退出。
+// 运行中的内核不支持 io_uring 时，服务器自动回退到 EPoll (见日志)。
+
+#include "uring_bench.h"
+
+IseBusiness* createIseBusinessObject()
+{
+    return new AppBusiness();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+const int SERVER_PORT = 10040;
+
+//-----------------------------------------------------------------------------
+
+AppBusiness::AppBusiness() :
+    ioBackend_(IOB_IO_URING),
+    connCount_(16),
+    seconds_(10),
+    messageSize_(1024*4)
+{
+    // nothing
+}
+
+//-----------------------------------------------------------------------------
+
+void AppBusiness::initialize()
+{
+    // nothing
+}
+
+//-----------------------------------------------------------------------------
+
+void AppBusiness::finalize()
+{
+    // nothing
+}
+
+//-----------------------------------------------------------------------------
+
+bool AppBusiness::parseArguments(int argc, char *argv[])
+{
+    if (argc > 1)
+    {
+        string mode = argv[1];
+        if (mode != "epoll" && mode != "io_uring")
+        {
+            std::cout << getAppHelp() << std::endl;
+            return false;
+        }
+        ioBackend_ = (mode == "io_uring" ? IOB_IO_URING : IOB_EPOLL);
+    }
+
+    if (argc > 2) connCount_ = ise::max(1, strToInt(argv[2]));
+    if (argc > 3) seconds_ = ise::max(1, strToInt(argv[3]));
+    if (argc > 4) messageSize_ = ise::max(1, strToInt(argv[4]));
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+
+string AppBusiness::getAppHelp()
+{
+    return formatString("Usage: %s [epoll|io_uring] [connections] [seconds] [messageSize]\n",
+        extractFileName(getAppExeName()).c_str());
+}
+
+//-----------------------------------------------------------------------------
+
+void AppBusiness::afterInit()
+{
+    // 实际采用的后端 (可能已回退到 EPoll)
+    ioBackend_ = TcpEventLoopList::getIoBackend();
+
+    std::cout << formatString("uring_bench: backend=%s, connections=%d, seconds=%d, messageSize=%d",
+        (ioBackend_ == IOB_IO_URING ? "io_uring" : "epoll"),
+        connCount_, seconds_, messageSize_) << std::endl;
+
+    Thread::create(boost::bind(&AppBusiness::benchThreadProc, this, _1));
+}
+
+//-----------------------------------------------------------------------------
+
+void AppBusiness::onInitFailed(Exception& e)
+{
+    std::cout << "fail to start uring_bench: " << e.makeLogStr() << std::endl;
+}
+
+//-----------------------------------------------------------------------------
+
+void AppBusiness::initIseOptions(IseOptions& options)
+{
+    options.setIsDaemon(false);
+    options.setAllowMultiInstance(true);
+    options.setServerType(ST_TCP);
+    options.setTcpServerCount(1);
+    options.setTcpServerPort(SERVER_PORT);
+    options.setTcpServerEventLoopCount(1);
+    options.setTcpIoBackend(ioBackend_);
+}
+
+//-----------------------------------------------------------------------------
+
+void AppBusiness::onTcpConnected(const TcpConnectionPtr& connection)
+{
+    connection->recv();
+}
+
+//-----------------------------------------------------------------------------
+
+void AppBusiness::onTcpRecvComplete(const TcpConnectionPtr& connection, void *packetBuffer,
+    int packetSize, const Context& context)
+{
+    connection->send(packetBuffer, packetSize);
+}
+
+//-----------------------------------------------------------------------------
+
+void AppBusiness::onTcpSendComplete(const TcpConnectionPtr& connection, const Context& context)
+{
+    connection->recv();
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 压测主线程: 启动客户端线程，计时，汇总结果
+//-----------------------------------------------------------------------------
+void AppBusiness::benchThreadProc(Thread& thread)
+{
+    TcpEventLoop *eventLoop = iseApp().mainServer().getMainTcpServer().
+        getTcpServer(0).getEventLoopList()[0];
+    INT64 startIterations = eventLoop->getIterationCount();
+
+    UINT64 startTicks = getCurTicks();
+    for (int i = 0; i < connCount_; ++i)
+        Thread::create(boost::bind(&AppBusiness::clientThreadProc, this, _1));
+
+    sleepSeconds(seconds_);
+    stopped_.set(1);
+    while (finishedClients_.get() < connCount_)
+        sleepSeconds(0.01);
+    double elapsedSecs = getTickDiff(startTicks, getCurTicks()) / 1000.0;
+    INT64 iterations = eventLoop->getIterationCount() - startIterations;
+
+    INT64 bytes = totalBytes_.get();
+    INT64 messages = totalMessages_.get();
+    const char *backendName = (ioBackend_ == IOB_IO_URING ? "io_uring" : "epoll");
+
+    std::sort(latencies_.begin(), latencies_.end());
+
+    std::cout << formatString("%s: %d clients finished, %.1f MB/s, %.0f msgs/s",
+        backendName, finishedClients_.get(),
+        bytes / elapsedSecs / (1024*1024), messages / elapsedSecs) << std::endl;
+    std::cout << formatString("%s: round-trip latency (us): p50 %.1f, p99 %.1f, p99.9 %.1f, max %.1f",
+        backendName, getPercentile(latencies_, 50) / 1000, getPercentile(latencies_, 99) / 1000,
+        getPercentile(latencies_, 99.9) / 1000, getPercentile(latencies_, 100) / 1000) << std::endl;
+    std::cout << formatString("%s: server loop iterations: %s (%.2f msgs per iteration)",
+        backendName, addThousandSep(iterations).c_str(),
+        (iterations > 0 ? (double)messages / iterations : 0.0)) << std::endl;
+
+    iseApp().setTerminated(true);
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 客户端线程: 阻塞式 "发送-接收回显" 往返，记录每次往返的耗时
+//-----------------------------------------------------------------------------
+void AppBusiness::clientThreadProc(Thread& thread)
+{
+    BaseTcpClient client;
+    try
+    {
+        client.connect("127.0.0.1", SERVER_PORT);
+    }
+    catch (Exception& e)
+    {
+        std::cout << "connect failed: " << e.makeLogStr() << std::endl;
+        finishedClients_.increment();
+        return;
+    }
+
+    SOCKET handle = client.getConnection().getSocket().getHandle();
+    client.getConnection().getSocket().setBlockMode(true);
+
+    string message(messageSize_, 'x');
+    Buffer buffer(messageSize_);
+    Latencies latencies;
+
+    while (stopped_.get() == 0)
+    {
+        UINT64 startTime = getNanoSeconds();
+        if (::send(handle, message.c_str(), messageSize_, 0) != messageSize_)
+            break;
+
+        int received = 0;
+        while (received < messageSize_)
+        {
+            int r = ::recv(handle, buffer.data() + received, messageSize_ - received, 0);
+            if (r <= 0) break;
+            received += r;
+        }
+        if (received < messageSize_)
+            break;
+
+        latencies.push_back(getNanoSeconds() - startTime);
+        totalBytes_.getAndAdd(messageSize_);
+        totalMessages_.increment();
+    }
+
+    {
+        AutoLocker locker(mutex_);
+        latencies_.insert(latencies_.end(), latencies.begin(), latencies.end());
+    }
+
+    finishedClients_.increment();
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 返回单调时钟的当前值 (纳秒)
+//-----------------------------------------------------------------------------
+UINT64 AppBusiness::getNanoSeconds()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (UINT64)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 返回已排序的 latencies 中的 percent 分位数 (纳秒)
+//-----------------------------------------------------------------------------
+double AppBusiness::getPercentile(const Latencies& latencies, double percent)
+{
+    if (latencies.empty()) return 0;
+
+    size_t index = (size_t)(latencies.size() * percent / 100);
+    if (index >= latencies.size()) index = latencies.size() - 1;
+    return (double)latencies[index];
+}
@@ -0,0 +1,56 @@
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef _URING_BENCH_H_
+#define _URING_BENCH_H_
+
+#include "ise/main/ise.h"
+
+using namespace ise;
+
+///////////////////////////////////////////////////////////////////////////////
+
+class AppBusiness : public IseBusiness
+{
+public:
+    AppBusiness();
+    virtual ~AppBusiness() {}
+
+    virtual void initialize();
+    virtual void finalize();
+
+    virtual bool parseArguments(int argc, char *argv[]);
+    virtual string getAppHelp();
+    virtual void afterInit();
+    virtual void onInitFailed(Exception& e);
+    virtual void initIseOptions(IseOptions& options);
+
+    virtual void onTcpConnected(const TcpConnectionPtr& connection);
+    virtual void onTcpRecvComplete(const TcpConnectionPtr& connection, void *packetBuffer,
+        int packetSize, const Context& context);
+    virtual void onTcpSendComplete(const TcpConnectionPtr& connection, const Context& context);
+
+private:
+    typedef std::vector<UINT64> Latencies;
+
+    void benchThreadProc(Thread& thread);
+    void clientThreadProc(Thread& thread);
+
+    static UINT64 getNanoSeconds();
+    static double getPercentile(const Latencies& latencies, double percent);
+
+private:
+    IO_BACKEND_TYPE ioBackend_;
+    int connCount_;
+    int seconds_;
+    int messageSize_;
+    AtomicInt stopped_;
+    AtomicInt finishedClients_;
+    AtomicInt64 totalBytes_;
+    AtomicInt64 totalMessages_;
+    Latencies latencies_;         // 全部客户端的往返延迟 (纳秒)
+    Mutex mutex_;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+#endif // _URING_BENCH_H_
@@ -173,6 +173,19 @@ void outOfMemoryHandler()
     abort();
 }
 
+///////////////////////////////////////////////////////////////////////////////
+// class TcpCallbacks
+
+//-----------------------------------------------------------------------------
+// 描述: TCP连接在连续接收模式下收到了一批数据包
+//-----------------------------------------------------------------------------
+void TcpCallbacks::onTcpRecvBatch(const TcpConnectionPtr& connection,
+    const RecvPacket *packets, int count, const Context& context)
+{
+    for (int i = 0; i < count; ++i)
+        onTcpRecvComplete(connection, packets[i].buffer, packets[i].size, context);
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 // class IseOptions
 
@@ -184,6 +197,7 @@ IseOptions::IseOptions()
 
     setServerType(DEF_SERVER_TYPE);
     setAssistorThreadCount(DEF_ASSISTOR_THREAD_COUNT);
+    setPreciseTimers(false);
 
     setUdpServerPort(DEF_UDP_SERVER_PORT);
     setUdpListenerThreadCount(DEF_UDP_LISTENER_THREAD_COUNT);
@@ -204,7 +218,11 @@ IseOptions::IseOptions()
     for (int i = 0; i < DEF_TCP_SERVER_COUNT; i++)
         setTcpServerEventLoopCount(i, DEF_TCP_SERVER_EVENT_LOOP_COUNT);
     setTcpClientEventLoopCount(DEF_TCP_CLIENT_EVENT_LOOP_COUNT);
+    setTcpClientLoopPlacement(LPP_ROUND_ROBIN);
     setTcpMaxRecvBufferSize(DEF_TCP_MAX_RECV_BUFFER_SIZE);
+    setTcpIdleTimeout(DEF_TCP_IDLE_TIMEOUT);
+    setTcpSendBatching(false);
+    setTcpIoBackend(IOB_EPOLL);
 }
 
 //-----------------------------------------------------------------------------
@@ -309,6 +327,21 @@ void IseOptions::setUdpWorkerThreadCount(int groupIndex, int minThreads, int max
     udpRequestGroupOpts_[groupIndex].maxWorkerThreads = maxThreads;
 }
 
+//-----------------------------------------------------------------------------
+// 描述: 设置UDP请求组别中工作者线程绑定的CPU
+// 参数:
+//   groupIndex - 组别号 (0-based)
+//   cpuList    - CPU列表 (如 "0-3,8")，为空表示不绑定；格式不正确时忽略
+//-----------------------------------------------------------------------------
+void IseOptions::setUdpGroupCpuAffinity(int groupIndex, const string& cpuList)
+{
+    if (groupIndex < 0 || groupIndex >= udpRequestGroupCount_) return;
+
+    IntegerArray cpus;
+    if (parseCpuList(cpuList, cpus))
+        udpRequestGroupOpts_[groupIndex].cpuAffinity = cpus;
+}
+
 //-----------------------------------------------------------------------------
 // 描述: 设置UDP工作者线程的工作超时时间(秒)，若为0表示不进行超时检测
 //-----------------------------------------------------------------------------
@@ -365,6 +398,128 @@ void IseOptions::setTcpServerEventLoopCount(int serverIndex, int eventLoopCount)
     tcpServerOpts_[serverIndex].eventLoopCount = eventLoopCount;
 }
 
+//-----------------------------------------------------------------------------
+// 描述: 设置TCP服务器是否采用边沿触发 (EPOLLET) 模式
+// 参数:
+//   serverIndex - TCP服务器序号 (0-based)
+//   value       - true 表示边沿触发，false 表示水平触发
+// 备注:
+//   仅在 Linux 下有效。边沿触发模式下，每次可读事件都会把套接字中的数据读空，
+//   并且只有在发送受阻时才监视可发送事件。
+//-----------------------------------------------------------------------------
+void IseOptions::setTcpServerEdgeTriggered(int serverIndex, bool value)
+{
+    if (serverIndex < 0 || serverIndex >= tcpServerCount_) return;
+
+    tcpServerOpts_[serverIndex].edgeTriggered = value;
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 设置TCP服务器是否由每个事件循环各自监听并接受连接
+// 参数:
+//   serverIndex - TCP服务器序号 (0-based)
+//   value       - true 表示每个事件循环各自拥有一个 SO_REUSEPORT 监听套接字
+// 备注:
+//   仅在 Linux 下有效。缺省由一个监听线程接受连接，再分派给各事件循环；启用后
+//   由内核在各事件循环的监听套接字间分配新连接，接受与注册均在事件循环线程中
+//   完成，适合新连接到达速率很高的场景。
+//-----------------------------------------------------------------------------
+void IseOptions::setTcpServerReusePort(int serverIndex, bool value)
+{
+    if (serverIndex < 0 || serverIndex >= tcpServerCount_) return;
+
+    tcpServerOpts_[serverIndex].reusePort = value;
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 设置TCP服务器的新连接在事件循环间的分派策略
+// 参数:
+//   serverIndex - TCP服务器序号 (0-based)
+//   policy      - 分派策略 (LPP_XXX)
+// 备注:
+//   启用 SO_REUSEPORT (setTcpServerReusePort) 时，新连接由内核分配，此设置无效。
+//-----------------------------------------------------------------------------
+void IseOptions::setTcpServerLoopPlacement(int serverIndex, LOOP_PLACEMENT_POLICY policy)
+{
+    if (serverIndex < 0 || serverIndex >= tcpServerCount_) return;
+
+    tcpServerOpts_[serverIndex].loopPlacement = policy;
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 设置TCP服务器中连接的待发送数据的高、低水位
+// 参数:
+//   serverIndex - TCP服务器序号 (0-based)
+//   highBytes   - 高水位 (字节)，为 0 表示不启用水位回调
+//   lowBytes    - 低水位 (字节)，不大于高水位
+// 备注:
+//   待发送数据达到高水位时回调 onTcpSendBufferHigh()，此后回落到低水位时回调
+//   onTcpSendBufferDrained()，生产者可据此暂停和恢复发送。
+//-----------------------------------------------------------------------------
+void IseOptions::setTcpServerSendBufferWatermarks(int serverIndex, INT64 highBytes, INT64 lowBytes)
+{
+    if (serverIndex < 0 || serverIndex >= tcpServerCount_) return;
+
+    highBytes = ise::max<INT64>(highBytes, 0);
+    lowBytes = ise::min(ise::max<INT64>(lowBytes, 0), highBytes);
+
+    tcpServerOpts_[serverIndex].sendBufferLimits.highWatermark = highBytes;
+    tcpServerOpts_[serverIndex].sendBufferLimits.lowWatermark = lowBytes;
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 设置TCP服务器中连接的待发送数据上限
+// 参数:
+//   serverIndex - TCP服务器序号 (0-based)
+//   bytes       - 上限 (字节)，为 0 表示不限制
+//   policy      - 发送的数据将使待发送数据超过上限时的处理策略 (SOP_XXX)
+//-----------------------------------------------------------------------------
+void IseOptions::setTcpServerSendBufferHardCap(int serverIndex, INT64 bytes, SEND_BUFFER_OVERFLOW_POLICY policy)
+{
+    if (serverIndex < 0 || serverIndex >= tcpServerCount_) return;
+
+    tcpServerOpts_[serverIndex].sendBufferLimits.hardCap = ise::max<INT64>(bytes, 0);
+    tcpServerOpts_[serverIndex].sendBufferLimits.overflowPolicy = policy;
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 设置TCP服务器的忙轮询参数
+// 参数:
+//   serverIndex     - TCP服务器序号 (0-based)
+//   spinMicroSecs   - 事件循环在最近一次取得事件后，以零超时轮询 (自旋) 的时长 (微秒)，
+//                     超过此时长无事件才阻塞等待。为 0 表示不启用
+//   socketMicroSecs - 为每个连接设置的 SO_BUSY_POLL 时长 (微秒)，为 0 表示不设置 (仅Linux)
+// 备注:
+//   1. 忙轮询以CPU换取延迟: 省去线程睡眠、唤醒及调度的延迟，但自旋期间占满一个CPU核心。
+//      适用于对延迟敏感、且每个事件循环可独占一个核心的场合。
+//   2. SO_BUSY_POLL 超过 net.core.busy_read 的值时需要 CAP_NET_ADMIN 权限，设置失败时
+//      记录一次日志并忽略。
+//-----------------------------------------------------------------------------
+void IseOptions::setTcpServerBusyPoll(int serverIndex, int spinMicroSecs, int socketMicroSecs)
+{
+    if (serverIndex < 0 || serverIndex >= tcpServerCount_) return;
+
+    tcpServerOpts_[serverIndex].busyPollMicroSecs = ise::max(spinMicroSecs, 0);
+    tcpServerOpts_[serverIndex].socketBusyPollMicroSecs = ise::max(socketMicroSecs, 0);
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 设置TCP服务器的事件循环绑定的CPU
+// 参数:
+//   serverIndex - TCP服务器的序号 (0-based)
+//   cpuList     - CPU列表 (如 "0-3,8")，为空表示不绑定；格式不正确时忽略
+// 备注:
+//   第 i 个事件循环绑定到列表中的第 (i % CPU个数) 个CPU上。
+//-----------------------------------------------------------------------------
+void IseOptions::setTcpServerCpuAffinity(int serverIndex, const string& cpuList)
+{
+    if (serverIndex < 0 || serverIndex >= tcpServerCount_) return;
+
+    IntegerArray cpus;
+    if (parseCpuList(cpuList, cpus))
+        tcpServerOpts_[serverIndex].cpuAffinity = cpus;
+}
+
 //-----------------------------------------------------------------------------
 // 描述: 设置用于全部TCP客户端的事件循环的个数
 //-----------------------------------------------------------------------------
@@ -383,6 +538,18 @@ void IseOptions::setTcpMaxRecvBufferSize(int bytes)
     tcpMaxRecvBufferSize_ = bytes;
 }
 
+//-----------------------------------------------------------------------------
+// 描述: 设置TCP连接的空闲超时 (毫秒)
+// 备注:
+//   连接在指定时间内既无接收也无发送即被断开，为 0 表示不检测。
+//   检测由事件循环的时间轮完成，精度为 TcpEventLoop::TIMING_WHEEL_TICK 毫秒。
+//-----------------------------------------------------------------------------
+void IseOptions::setTcpIdleTimeout(int msecs)
+{
+    msecs = ise::max(msecs, 0);
+    tcpIdleTimeout_ = msecs;
+}
+
 //-----------------------------------------------------------------------------
 // 描述: 取得UDP请求队列的最大容量 (即可容纳多少个数据包)
 // 参数:
@@ -410,6 +577,16 @@ void IseOptions::getUdpWorkerThreadCount(int groupIndex, int& minThreads, int& m
     maxThreads = udpRequestGroupOpts_[groupIndex].maxWorkerThreads;
 }
 
+//-----------------------------------------------------------------------------
+// 描述: 取得UDP请求组别中工作者线程绑定的CPU
+//-----------------------------------------------------------------------------
+IntegerArray IseOptions::getUdpGroupCpuAffinity(int groupIndex)
+{
+    if (groupIndex < 0 || groupIndex >= udpRequestGroupCount_) return IntegerArray();
+
+    return udpRequestGroupOpts_[groupIndex].cpuAffinity;
+}
+
 //-----------------------------------------------------------------------------
 // 描述: 取得TCP服务端口号
 // 参数:
@@ -434,6 +611,116 @@ int IseOptions::getTcpServerEventLoopCount(int serverIndex)
     return tcpServerOpts_[serverIndex].eventLoopCount;
 }
 
+//-----------------------------------------------------------------------------
+// 描述: 取得TCP服务器是否采用边沿触发模式
+// 参数:
+//   serverIndex - TCP服务器的序号 (0-based)
+//-----------------------------------------------------------------------------
+bool IseOptions::getTcpServerEdgeTriggered(int serverIndex)
+{
+    if (serverIndex < 0 || serverIndex >= tcpServerCount_) return false;
+
+    return tcpServerOpts_[serverIndex].edgeTriggered;
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 取得TCP服务器是否由每个事件循环各自监听并接受连接
+// 参数:
+//   serverIndex - TCP服务器的序号 (0-based)
+//-----------------------------------------------------------------------------
+bool IseOptions::getTcpServerReusePort(int serverIndex)
+{
+    if (serverIndex < 0 || serverIndex >= tcpServerCount_) return false;
+
+    return tcpServerOpts_[serverIndex].reusePort;
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 取得TCP服务器的新连接在事件循环间的分派策略
+// 参数:
+//   serverIndex - TCP服务器的序号 (0-based)
+//-----------------------------------------------------------------------------
+LOOP_PLACEMENT_POLICY IseOptions::getTcpServerLoopPlacement(int serverIndex)
+{
+    if (serverIndex < 0 || serverIndex >= tcpServerCount_) return LPP_ROUND_ROBIN;
+
+    return tcpServerOpts_[serverIndex].loopPlacement;
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 取得TCP服务器中连接的待发送数据水位及上限
+// 参数:
+//   serverIndex - TCP服务器的序号 (0-based)
+//-----------------------------------------------------------------------------
+SendBufferLimits IseOptions::getTcpServerSendBufferLimits(int serverIndex)
+{
+    if (serverIndex < 0 || serverIndex >= tcpServerCount_) return SendBufferLimits();
+
+    return tcpServerOpts_[serverIndex].sendBufferLimits;
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 取得TCP服务器的忙轮询参数
+// 参数:
+//   serverIndex     - TCP服务器的序号 (0-based)
+//   spinMicroSecs   - 存放事件循环的忙轮询时长 (微秒)
+//   socketMicroSecs - 存放连接的 SO_BUSY_POLL 时长 (微秒)
+//-----------------------------------------------------------------------------
+void IseOptions::getTcpServerBusyPoll(int serverIndex, int& spinMicroSecs, int& socketMicroSecs)
+{
+    if (serverIndex < 0 || serverIndex >= tcpServerCount_) return;
+
+    spinMicroSecs = tcpServerOpts_[serverIndex].busyPollMicroSecs;
+    socketMicroSecs = tcpServerOpts_[serverIndex].socketBusyPollMicroSecs;
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 取得TCP服务器的事件循环绑定的CPU
+//-----------------------------------------------------------------------------
+IntegerArray IseOptions::getTcpServerCpuAffinity(int serverIndex)
+{
+    if (serverIndex < 0 || serverIndex >= tcpServerCount_) return IntegerArray();
+
+    return tcpServerOpts_[serverIndex].cpuAffinity;
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 添加一个阻塞任务卸载池
+// 参数:
+//   name        - 池的名称 (以 iseApp().offloadPool(name) 取得)
+//   threadCount - 线程数 (至少为1)
+//   maxInFlight - 池内任务数 (排队及执行中的) 的上限，达到上限时拒绝新任务 (0 表示不限)
+//-----------------------------------------------------------------------------
+void IseOptions::addOffloadPool(const string& name, int threadCount, int maxInFlight)
+{
+    OffloadPoolOption option;
+    option.name = name;
+    option.threadCount = ise::max(threadCount, 1);
+    option.maxInFlight = ise::max(maxInFlight, 0);
+
+    for (size_t i = 0; i < offloadPoolOpts_.size(); ++i)
+    {
+        if (offloadPoolOpts_[i].name == name)
+        {
+            offloadPoolOpts_[i] = option;
+            return;
+        }
+    }
+    offloadPoolOpts_.push_back(option);
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 取得阻塞任务卸载池的配置
+//-----------------------------------------------------------------------------
+void IseOptions::getOffloadPool(int index, string& name, int& threadCount, int& maxInFlight)
+{
+    if (index < 0 || index >= (int)offloadPoolOpts_.size()) return;
+
+    name = offloadPoolOpts_[index].name;
+    threadCount = offloadPoolOpts_[index].threadCount;
+    maxInFlight = offloadPoolOpts_[index].maxInFlight;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 // class IseMainServer
 
@@ -443,6 +730,7 @@ IseMainServer::IseMainServer() :
     assistorServer_(NULL),
     timerManager_(NULL),
     tcpConnector_(NULL),
+    offloadPools_(NULL),
     sysThreadMgr_(NULL)
 {
     // nothing
@@ -462,6 +750,10 @@ void IseMainServer::initialize()
     // 定时器管理器
     timerManager_ = new TimerManager();
 
+    // 阻塞任务卸载池 (先于各服务器启动，以便回调中即可提交任务)
+    offloadPools_ = new OffloadPoolList();
+    offloadPools_->start();
+
     // 初始化 UDP 服务器
     if (iseApp().iseOptions().getServerType() & ST_UDP)
     {
@@ -496,6 +788,15 @@ void IseMainServer::initialize()
 //-----------------------------------------------------------------------------
 void IseMainServer::finalize()
 {
+    // 先停止卸载池，此后不再有任务结果委托给事件循环；未执行的任务随池销毁，
+    // 其持有的连接在各服务器关闭之前释放
+    if (offloadPools_)
+    {
+        offloadPools_->stop();
+        delete offloadPools_;
+        offloadPools_ = NULL;
+    }
+
     if (assistorServer_)
     {
         assistorServer_->close();
@@ -586,6 +887,27 @@ TcpConnector& IseMainServer::getTcpConnector()
     return *tcpConnector_;
 }
 
+//-----------------------------------------------------------------------------
+// 描述: 按名称取得阻塞任务卸载池 (由 IseOptions::addOffloadPool() 配置)
+//-----------------------------------------------------------------------------
+OffloadPool& IseMainServer::getOffloadPool(const string& name)
+{
+    ISE_ASSERT(offloadPools_ != NULL);
+
+    OffloadPool *pool = offloadPools_->find(name);
+    if (pool == NULL)
+        iseThrowException(formatString(SEM_OFFLOAD_POOL_NOT_FOUND, name.c_str()).c_str());
+    return *pool;
+}
+
+//-----------------------------------------------------------------------------
+
+OffloadPoolList& IseMainServer::getOffloadPoolList()
+{
+    ISE_ASSERT(offloadPools_ != NULL);
+    return *offloadPools_;
+}
+
 //-----------------------------------------------------------------------------
 // 描述: 服务器开始运行后，主线程进行后台守护工作
 //-----------------------------------------------------------------------------
@@ -101,8 +101,15 @@ public:
     // TCP连接上的一个接收任务已完成
     virtual void onTcpRecvComplete(const TcpConnectionPtr& connection, void *packetBuffer,
         int packetSize, const Context& context) = 0;
+    // TCP连接在连续接收模式下收到了一批数据包 (缺省逐个转给 onTcpRecvComplete)
+    virtual void onTcpRecvBatch(const TcpConnectionPtr& connection, const RecvPacket *packets,
+        int count, const Context& context);
     // TCP连接上的一个发送任务已完成
     virtual void onTcpSendComplete(const TcpConnectionPtr& connection, const Context& context) = 0;
+    // TCP连接的待发送数据达到了高水位
+    virtual void onTcpSendBufferHigh(const TcpConnectionPtr& connection, INT64 queuedBytes) {}
+    // TCP连接的待发送数据从高水位回落到了低水位
+    virtual void onTcpSendBufferDrained(const TcpConnectionPtr& connection) {}
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -155,6 +162,10 @@ public:  /* interface TcpCallbacks */
         int packetSize, const Context& context) {}
     // TCP连接上的一个发送任务已完成
     virtual void onTcpSendComplete(const TcpConnectionPtr& connection, const Context& context) {}
+    // TCP连接的待发送数据达到了高水位
+    virtual void onTcpSendBufferHigh(const TcpConnectionPtr& connection, INT64 queuedBytes) {}
+    // TCP连接的待发送数据从高水位回落到了低水位
+    virtual void onTcpSendBufferDrained(const TcpConnectionPtr& connection) {}
 
 public:
     // 辅助服务线程执行(assistorIndex: 0-based)
@@ -199,6 +210,7 @@ public:
         DEF_TCP_SERVER_EVENT_LOOP_COUNT = 1,             // TCP服务器中事件循环个数的缺省值
         DEF_TCP_CLIENT_EVENT_LOOP_COUNT = 1,             // 用于全部TCP客户端的事件循环的个数的缺省值
         DEF_TCP_MAX_RECV_BUFFER_SIZE    = 1024*1024*1,   // TCP接收缓存的最大字节数
+        DEF_TCP_IDLE_TIMEOUT            = 0,             // TCP连接的空闲超时 (毫秒，0表示不检测)
     };
 
     // UDP请求组别的配置
@@ -207,6 +219,7 @@ public:
         int requestQueueCapacity;      // 请求队列的容量(即可容纳多少个数据包)
         int minWorkerThreads;          // 工作者线程的最少个数
         int maxWorkerThreads;          // 工作者线程的最多个数
+        IntegerArray cpuAffinity;      // 工作者线程绑定的CPU (为空表示不绑定)
 
         UdpRequestGroupOption()
         {
@@ -222,15 +235,36 @@ public:
     {
         int serverPort;                // TCP服务端口号
         int eventLoopCount;            // 事件循环个数
+        bool edgeTriggered;            // 是否采用边沿触发 (EPOLLET) 模式 (仅Linux)
+        bool reusePort;                // 是否每个事件循环各自以 SO_REUSEPORT 监听并接受连接 (仅Linux)
+        LOOP_PLACEMENT_POLICY loopPlacement;  // 新连接在事件循环间的分派策略
+        SendBufferLimits sendBufferLimits;    // 新连接的待发送数据水位及上限
+        int busyPollMicroSecs;         // 事件循环的忙轮询时长 (微秒，0 表示不启用)
+        int socketBusyPollMicroSecs;   // 连接的 SO_BUSY_POLL 时长 (微秒，0 表示不设置，仅Linux)
+        IntegerArray cpuAffinity;      // 事件循环依次绑定的CPU (为空表示不绑定)
 
         TcpServerOption()
         {
             serverPort = DEF_TCP_SERVER_PORT;
             eventLoopCount = DEF_TCP_SERVER_EVENT_LOOP_COUNT;
+            edgeTriggered = false;
+            reusePort = false;
+            loopPlacement = LPP_ROUND_ROBIN;
+            busyPollMicroSecs = 0;
+            socketBusyPollMicroSecs = 0;
         }
     };
     typedef std::vector<TcpServerOption> TcpServerOptions;
 
+    // 阻塞任务卸载池的配置
+    struct OffloadPoolOption
+    {
+        string name;                   // 池的名称
+        int threadCount;               // 线程数
+        int maxInFlight;               // 池内任务数 (排队及执行中的) 的上限 (0 表示不限)
+    };
+    typedef std::vector<OffloadPoolOption> OffloadPoolOptions;
+
 public:
     IseOptions();
 
@@ -252,6 +286,8 @@ public:
     void setServerType(UINT serverType);
     // 设置辅助线程的数量
     void setAssistorThreadCount(int count);
+    // 设置事件循环是否采用高精度定时器 (仅Linux，缺省为否，此时定时器可能推迟约50微秒触发)
+    void setPreciseTimers(bool value) { preciseTimers_ = value; }
 
     // 设置UDP服务端口号
     void setUdpServerPort(int port);
@@ -267,6 +303,8 @@ public:
     void setUdpRequestQueueAlertLine(int count);
     // 设置UDP工作者线程个数的上下限
     void setUdpWorkerThreadCount(int groupIndex, int minThreads, int maxThreads);
+    // 设置UDP工作者线程绑定的CPU (如 "0-3,8"，为空表示不绑定)
+    void setUdpGroupCpuAffinity(int groupIndex, const string& cpuList);
     // 设置UDP工作者线程的工作超时时间(秒)，若为0表示不进行超时检测
     void setUdpWorkerThreadTimeout(int seconds);
     // 设置后台调整UDP工作者线程数量的时间间隔(秒)
@@ -280,21 +318,55 @@ public:
     // 设置每个TCP服务器中事件循环的个数
     void setTcpServerEventLoopCount(int serverIndex, int eventLoopCount);
     void setTcpServerEventLoopCount(int eventLoopCount) { setTcpServerEventLoopCount(0, eventLoopCount); }
+    // 设置TCP服务器是否采用边沿触发模式 (仅Linux，缺省为水平触发)
+    void setTcpServerEdgeTriggered(int serverIndex, bool value);
+    void setTcpServerEdgeTriggered(bool value) { setTcpServerEdgeTriggered(0, value); }
+    // 设置TCP服务器是否由每个事件循环各自监听并接受连接 (仅Linux，缺省由监听线程接受)
+    void setTcpServerReusePort(int serverIndex, bool value);
+    void setTcpServerReusePort(bool value) { setTcpServerReusePort(0, value); }
+    // 设置TCP服务器的新连接在事件循环间的分派策略
+    void setTcpServerLoopPlacement(int serverIndex, LOOP_PLACEMENT_POLICY policy);
+    void setTcpServerLoopPlacement(LOOP_PLACEMENT_POLICY policy) { setTcpServerLoopPlacement(0, policy); }
+    // 设置TCP服务器中连接的待发送数据的高、低水位 (字节，高水位为0表示不启用)
+    void setTcpServerSendBufferWatermarks(int serverIndex, INT64 highBytes, INT64 lowBytes);
+    void setTcpServerSendBufferWatermarks(INT64 highBytes, INT64 lowBytes) { setTcpServerSendBufferWatermarks(0, highBytes, lowBytes); }
+    // 设置TCP服务器中连接的待发送数据上限 (字节，为0表示不限制) 及超限时的处理策略
+    void setTcpServerSendBufferHardCap(int serverIndex, INT64 bytes, SEND_BUFFER_OVERFLOW_POLICY policy);
+    void setTcpServerSendBufferHardCap(INT64 bytes, SEND_BUFFER_OVERFLOW_POLICY policy) { setTcpServerSendBufferHardCap(0, bytes, policy); }
+    // 设置TCP服务器中事件循环的忙轮询时长及连接的 SO_BUSY_POLL 时长 (微秒，0 表示不启用)
+    void setTcpServerBusyPoll(int serverIndex, int spinMicroSecs, int socketMicroSecs);
+    void setTcpServerBusyPoll(int spinMicroSecs, int socketMicroSecs = 0) { setTcpServerBusyPoll(0, spinMicroSecs, socketMicroSecs); }
+    // 设置TCP服务器的事件循环绑定的CPU (如 "0-3,8"，事件循环依次各绑定其中一个，为空表示不绑定)
+    void setTcpServerCpuAffinity(int serverIndex, const string& cpuList);
+    void setTcpServerCpuAffinity(const string& cpuList) { setTcpServerCpuAffinity(0, cpuList); }
     // 设置用于全部TCP客户端的事件循环的个数
     void setTcpClientEventLoopCount(int eventLoopCount);
+    // 设置TCP客户端连接在事件循环间的分派策略
+    void setTcpClientLoopPlacement(LOOP_PLACEMENT_POLICY policy) { tcpClientLoopPlacement_ = policy; }
     // 设置TCP接收缓存在无接收任务时的最大字节数
     void setTcpMaxRecvBufferSize(int bytes);
+    // 设置TCP连接的空闲超时 (毫秒)，连接在此时间内无任何收发即被断开 (0表示不检测)
+    void setTcpIdleTimeout(int msecs);
+    // 设置是否将一轮事件循环内的多次发送合并后再写套接字 (仅Linux，缺省为否)
+    void setTcpSendBatching(bool value) { tcpSendBatching_ = value; }
+    // 设置TCP事件循环采用的 I/O 后端 (仅Linux，缺省为 EPoll；内核不支持 io_uring 时自动回退到 EPoll)
+    void setTcpIoBackend(IO_BACKEND_TYPE value) { tcpIoBackend_ = value; }
+
+    // 添加一个阻塞任务卸载池 (同名的池只保留最后一次的配置)
+    void addOffloadPool(const string& name, int threadCount, int maxInFlight = 0);
 
     // 服务器配置获取----------------------------------------------------------
 
     UINT getServerType() { return serverType_; }
     int getAssistorThreadCount() { return assistorThreadCount_; }
+    bool getPreciseTimers() { return preciseTimers_; }
 
     int getUdpServerPort() { return udpServerPort_; }
     int getUdpListenerThreadCount() { return udpListenerThreadCount_; }
     int getUdpRequestGroupCount() { return udpRequestGroupCount_; }
     int getUdpRequestQueueCapacity(int groupIndex);
     void getUdpWorkerThreadCount(int groupIndex, int& minThreads, int& maxThreads);
+    IntegerArray getUdpGroupCpuAffinity(int groupIndex);
     int getUdpRequestMaxWaitTime() { return udpRequestMaxWaitTime_; }
     int getUdpRequestQueueAlertLine() { return udpRequestQueueAlertLine_; }
     int getUdpWorkerThreadTimeout() { return udpWorkerThreadTimeout_; }
@@ -303,8 +375,21 @@ public:
     int getTcpServerCount() { return tcpServerCount_; }
     int getTcpServerPort(int serverIndex);
     int getTcpServerEventLoopCount(int serverIndex);
+    bool getTcpServerEdgeTriggered(int serverIndex);
+    bool getTcpServerReusePort(int serverIndex);
+    LOOP_PLACEMENT_POLICY getTcpServerLoopPlacement(int serverIndex);
+    SendBufferLimits getTcpServerSendBufferLimits(int serverIndex);
+    void getTcpServerBusyPoll(int serverIndex, int& spinMicroSecs, int& socketMicroSecs);
+    IntegerArray getTcpServerCpuAffinity(int serverIndex);
     int getTcpClientEventLoopCount() { return tcpClientEventLoopCount_; }
+    LOOP_PLACEMENT_POLICY getTcpClientLoopPlacement() { return tcpClientLoopPlacement_; }
     int getTcpMaxRecvBufferSize() { return tcpMaxRecvBufferSize_; }
+    int getTcpIdleTimeout() { return tcpIdleTimeout_; }
+    bool getTcpSendBatching() { return tcpSendBatching_; }
+    IO_BACKEND_TYPE getTcpIoBackend() { return tcpIoBackend_; }
+
+    int getOffloadPoolCount() { return (int)offloadPoolOpts_.size(); }
+    void getOffloadPool(int index, string& name, int& threadCount, int& maxInFlight);
 
 private:
     /* ------------ 系统配置: ------------------ */
@@ -320,6 +405,8 @@ private:
     UINT serverType_;
     // 辅助线程的个数
     int assistorThreadCount_;
+    // 事件循环是否采用高精度定时器
+    bool preciseTimers_;
 
     /* ------------ UDP服务器配置: ------------ */
 
@@ -348,8 +435,21 @@ private:
     TcpServerOptions tcpServerOpts_;
     // 用于全部TCP客户端的事件循环的个数
     int tcpClientEventLoopCount_;
+    // TCP客户端连接在事件循环间的分派策略
+    LOOP_PLACEMENT_POLICY tcpClientLoopPlacement_;
     // TCP接收缓存在无接收任务时的最大字节数
     int tcpMaxRecvBufferSize_;
+    // TCP连接的空闲超时 (毫秒)
+    int tcpIdleTimeout_;
+    // 是否合并一轮事件循环内的多次发送
+    bool tcpSendBatching_;
+    // TCP事件循环采用的 I/O 后端
+    IO_BACKEND_TYPE tcpIoBackend_;
+
+    /* ------------ 阻塞任务卸载池配置: -------- */
+
+    // 各卸载池的配置
+    OffloadPoolOptions offloadPoolOpts_;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -370,6 +470,8 @@ public:
     AssistorServer& getAssistorServer();
     TimerManager& getTimerManager();
     TcpConnector& getTcpConnector();
+    OffloadPool& getOffloadPool(const string& name);
+    OffloadPoolList& getOffloadPoolList();
 private:
     void runBackground();
 private:
@@ -378,6 +480,7 @@ private:
     AssistorServer *assistorServer_;      // 辅助服务器
     TimerManager *timerManager_;          // 定时器管理器
     TcpConnector *tcpConnector_;          // TCP连接器
+    OffloadPoolList *offloadPools_;       // 阻塞任务卸载池
     SysThreadMgr *sysThreadMgr_;          // 系统线程管理器
 };
 
@@ -412,6 +515,7 @@ public:
     BaseTcpServer& tcpServer(int index) { return mainServer_->getMainTcpServer().getTcpServer(index); }
     TimerManager& timerManager() { return mainServer_->getTimerManager(); }
     TcpConnector& tcpConnector() { return mainServer_->getTcpConnector(); }
+    OffloadPool& offloadPool(const string& name) { return mainServer_->getOffloadPool(name); }
 
     void setTerminated(bool value) { terminated_ = value; }
     bool isTerminated() { return terminated_; }
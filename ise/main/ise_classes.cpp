@@ -417,7 +417,7 @@ Timestamp Timestamp::now()
 #ifdef ISE_LINUX
     struct timeval tv;
     gettimeofday(&tv, NULL);
-    result.value_ = TimeVal(tv.tv_sec) * MILLISECS_PER_SECOND + tv.tv_usec;
+    result.value_ = TimeVal(tv.tv_sec) * MILLISECS_PER_SECOND + tv.tv_usec / 1000;
 #endif
 
     return result;
@@ -470,6 +470,179 @@ string Timestamp::toString(const string& dateSep, const string& dateTimeSep,
     return result;
 }
 
+///////////////////////////////////////////////////////////////////////////////
+// class Clock
+
+// 各线程的时钟缓存 (由 Clock::update() 刷新)
+static ISE_THREAD_LOCAL bool t_isClockCached = false;
+static ISE_THREAD_LOCAL UINT64 t_cachedTicks = 0;
+static ISE_THREAD_LOCAL UINT64 t_cachedMicroTicks = 0;
+static ISE_THREAD_LOCAL INT64 t_cachedNowMicroSecs = 0;
+
+// 各线程按秒缓存的日期字符串
+static ISE_THREAD_LOCAL time_t t_dateTimeSecs = -1;
+static ISE_THREAD_LOCAL char t_dateTimeStr[32];
+static ISE_THREAD_LOCAL time_t t_httpDateSecs = -1;
+static ISE_THREAD_LOCAL char t_httpDateStr[32];
+
+//-----------------------------------------------------------------------------
+// 描述: 同时读取单调时钟 (毫秒、微秒) 和墙上时间 (微秒)
+//-----------------------------------------------------------------------------
+static void readClocks(UINT64& ticks, UINT64& microTicks, INT64& nowMicroSecs)
+{
+#ifdef ISE_WINDOWS
+    ticks = getCurTicks();
+    microTicks = getCurMicroTicks();
+    nowMicroSecs = Timestamp::now().epochMilliseconds() * 1000;
+#endif
+#ifdef ISE_LINUX
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    microTicks = static_cast<UINT64>(ts.tv_sec) * 1000000 + ts.tv_nsec / 1000;
+    ticks = microTicks / 1000;
+
+    clock_gettime(CLOCK_REALTIME, &ts);
+    nowMicroSecs = INT64(ts.tv_sec) * 1000000 + ts.tv_nsec / 1000;
+#endif
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 读取时钟并存入本线程的缓存 (由事件循环每轮调用一次)
+//-----------------------------------------------------------------------------
+void Clock::update()
+{
+    readClocks(t_cachedTicks, t_cachedMicroTicks, t_cachedNowMicroSecs);
+    t_isClockCached = true;
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 停用本线程的缓存 (事件循环退出后调用)，此后恢复为每次直接读取时钟
+//-----------------------------------------------------------------------------
+void Clock::resetCache()
+{
+    t_isClockCached = false;
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 返回单调时钟的毫秒数
+//-----------------------------------------------------------------------------
+UINT64 Clock::getTicks()
+{
+    return t_isClockCached ? t_cachedTicks : getCurTicks();
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 返回单调时钟的微秒数
+//-----------------------------------------------------------------------------
+UINT64 Clock::getMicroTicks()
+{
+    return t_isClockCached ? t_cachedMicroTicks : getCurMicroTicks();
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 返回当前时间戳 (墙上时间)
+//-----------------------------------------------------------------------------
+Timestamp Clock::now()
+{
+    return t_isClockCached ? Timestamp(t_cachedNowMicroSecs / 1000) : Timestamp::now();
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 将墙上时间的时刻换算为单调时钟的 Ticks (毫秒，向上取整，不早于当前 Ticks)
+// 备注: 两个时钟的毫秒边界并不对齐，故以微秒换算，以免到期时刻提前或推迟近1毫秒。
+//-----------------------------------------------------------------------------
+UINT64 Clock::toTicks(Timestamp time)
+{
+    UINT64 ticks, microTicks;
+    INT64 nowMicroSecs;
+
+    if (t_isClockCached)
+    {
+        ticks = t_cachedTicks;
+        microTicks = t_cachedMicroTicks;
+        nowMicroSecs = t_cachedNowMicroSecs;
+    }
+    else
+        readClocks(ticks, microTicks, nowMicroSecs);
+
+    INT64 delayMicroSecs = time.epochMilliseconds() * 1000 - nowMicroSecs;
+    if (delayMicroSecs <= 0) return ticks;
+
+#ifdef ISE_WINDOWS
+    return ticks + (UINT64)(delayMicroSecs + 999) / 1000;
+#endif
+#ifdef ISE_LINUX
+    return (microTicks + (UINT64)delayMicroSecs + 999) / 1000;
+#endif
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 返回秒级精度的当前时间 (未缓存时读取 CLOCK_REALTIME_COARSE，读取无需陷入内核)
+//-----------------------------------------------------------------------------
+static time_t getCoarseEpochTime()
+{
+    if (t_isClockCached)
+        return (time_t)(t_cachedNowMicroSecs / 1000000);
+
+#ifdef ISE_WINDOWS
+    return time(NULL);
+#endif
+#ifdef ISE_LINUX
+    timespec ts;
+    clock_gettime(CLOCK_REALTIME_COARSE, &ts);
+    return ts.tv_sec;
+#endif
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 返回当前本地时间的字符串，格式为 YYYY-MM-DD HH:MM:SS (每秒格式化一次)
+//-----------------------------------------------------------------------------
+string Clock::getDateTimeStr()
+{
+    time_t secs = getCoarseEpochTime();
+
+    if (secs != t_dateTimeSecs)
+    {
+        string str = DateTime(secs).toDateTimeString();
+        strncpy(t_dateTimeStr, str.c_str(), sizeof(t_dateTimeStr) - 1);
+        t_dateTimeSecs = secs;
+    }
+
+    return t_dateTimeStr;
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 返回当前时间的 HTTP 日期字符串 (每秒格式化一次)
+// 格式:
+//   Sun, 06 Nov 1994 08:49:37 GMT
+//-----------------------------------------------------------------------------
+string Clock::getHttpDateStr()
+{
+    static const char* const WEEK_DAYS[] = { "Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat" };
+    static const char* const MONTHS[] = { "Jan", "Feb", "Mar", "Apr", "May", "Jun",
+        "Jul", "Aug", "Sep", "Oct", "Nov", "Dec" };
+
+    time_t secs = getCoarseEpochTime();
+
+    if (secs != t_httpDateSecs)
+    {
+        struct tm tm;
+#ifdef ISE_WINDOWS
+        gmtime_s(&tm, &secs);
+#endif
+#ifdef ISE_LINUX
+        gmtime_r(&secs, &tm);
+#endif
+        string str = formatString("%s, %02d %s %04d %02d:%02d:%02d GMT",
+            WEEK_DAYS[tm.tm_wday], tm.tm_mday, MONTHS[tm.tm_mon], tm.tm_year + 1900,
+            tm.tm_hour, tm.tm_min, tm.tm_sec);
+        strncpy(t_httpDateStr, str.c_str(), sizeof(t_httpDateStr) - 1);
+        t_httpDateSecs = secs;
+    }
+
+    return t_httpDateStr;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 // class Mutex
 
@@ -815,6 +988,233 @@ int SignalMasker::sigProcMask(int how, const sigset_t *newSet, sigset_t *oldSet)
 
 #endif
 
+///////////////////////////////////////////////////////////////////////////////
+// class MpscQueue
+
+//-----------------------------------------------------------------------------
+// 描述: 压入一个节点
+// 返回: 压入前队列是否为空
+// 备注: 线程安全
+//-----------------------------------------------------------------------------
+bool MpscQueue::push(Node *node)
+{
+    Node *oldHead;
+    do
+    {
+        oldHead = head_;
+        node->next = oldHead;
+    }
+#ifdef ISE_WINDOWS
+    while (InterlockedCompareExchangePointer((PVOID volatile*)&head_, node, oldHead) != oldHead);
+#endif
+#ifdef ISE_LINUX
+    while (!__sync_bool_compare_and_swap(&head_, oldHead, node));
+#endif
+
+    return (oldHead == NULL);
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 一次压入一串节点 (线程安全)
+// 参数:
+//   newest - 链表头，视为最后压入的节点
+//   oldest - 链表尾，视为最先压入的节点
+// 返回: 压入前队列是否为空
+//-----------------------------------------------------------------------------
+bool MpscQueue::pushChain(Node *newest, Node *oldest)
+{
+    Node *oldHead;
+    do
+    {
+        oldHead = head_;
+        oldest->next = oldHead;
+    }
+#ifdef ISE_WINDOWS
+    while (InterlockedCompareExchangePointer((PVOID volatile*)&head_, newest, oldHead) != oldHead);
+#endif
+#ifdef ISE_LINUX
+    while (!__sync_bool_compare_and_swap(&head_, oldHead, newest));
+#endif
+
+    return (oldHead == NULL);
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 取走队列中的所有节点
+// 返回: 按压入先后顺序排列的节点链表 (队列为空时返回 NULL)
+// 备注: 通常由唯一的消费者线程调用 (多个线程同时调用也是安全的)
+//-----------------------------------------------------------------------------
+MpscQueue::Node* MpscQueue::popAll()
+{
+    if (head_ == NULL) return NULL;
+
+#ifdef ISE_WINDOWS
+    Node *node = (Node*)InterlockedExchangePointer((PVOID volatile*)&head_, NULL);
+#endif
+#ifdef ISE_LINUX
+    Node *node = __sync_lock_test_and_set(&head_, (Node*)NULL);
+#endif
+
+    // 栈中的节点是后进先出的，反转为压入顺序
+    Node *result = NULL;
+    while (node != NULL)
+    {
+        Node *next = node->next;
+        node->next = result;
+        result = node;
+        node = next;
+    }
+
+    return result;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// class WorkStealingDeque
+
+// 全屏障: 其前后的内存读写不会被编译器或CPU重排
+static inline void fullMemoryBarrier()
+{
+#ifdef ISE_WINDOWS
+    MemoryBarrier();
+#endif
+#ifdef ISE_LINUX
+    __sync_synchronize();
+#endif
+}
+
+static inline bool compareAndSetInt64(volatile INT64 *target, INT64 expected, INT64 newValue)
+{
+#ifdef ISE_WINDOWS
+    return InterlockedCompareExchange64((LONGLONG volatile*)target, newValue, expected) == expected;
+#endif
+#ifdef ISE_LINUX
+    return __sync_bool_compare_and_swap(target, expected, newValue);
+#endif
+}
+
+//-----------------------------------------------------------------------------
+
+WorkStealingDeque::WorkStealingDeque(int initCapacity) :
+    top_(0),
+    bottom_(0),
+    array_(NULL)
+{
+    INT64 capacity = 16;
+    while (capacity < initCapacity)
+        capacity *= 2;
+
+    Array *array = new Array();
+    array->capacity = capacity;
+    array->items = new void* volatile[capacity];
+    array->prior = NULL;
+    array_ = array;
+}
+
+//-----------------------------------------------------------------------------
+
+WorkStealingDeque::~WorkStealingDeque()
+{
+    Array *array = array_;
+    while (array != NULL)
+    {
+        Array *prior = array->prior;
+        delete[] array->items;
+        delete array;
+        array = prior;
+    }
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 在底部压入一个元素 (仅限所有者线程调用)
+//-----------------------------------------------------------------------------
+void WorkStealingDeque::push(void *item)
+{
+    INT64 bottom = bottom_;
+    INT64 top = top_;
+    Array *array = array_;
+
+    if (bottom - top >= array->capacity)
+        array = growArray(array, bottom, top);
+
+    array->items[bottom & (array->capacity - 1)] = item;
+    fullMemoryBarrier();  // 元素须先于 bottom_ 对窃取者可见
+    bottom_ = bottom + 1;
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 从底部弹出一个元素，队列为空时返回 NULL (仅限所有者线程调用)
+//-----------------------------------------------------------------------------
+void* WorkStealingDeque::pop()
+{
+    INT64 bottom = bottom_ - 1;
+    Array *array = array_;
+    bottom_ = bottom;
+    fullMemoryBarrier();  // 先占住底部元素，再读 top_ (与 steal() 中的顺序相对)
+    INT64 top = top_;
+
+    void *item = NULL;
+    if (top <= bottom)
+    {
+        item = array->items[bottom & (array->capacity - 1)];
+        if (top == bottom)
+        {
+            // 仅剩最后一个元素，与窃取者竞争
+            if (!compareAndSetInt64(&top_, top, top + 1))
+                item = NULL;
+            bottom_ = bottom + 1;
+        }
+    }
+    else
+        bottom_ = bottom + 1;
+
+    return item;
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 从顶部窃取一个元素，队列为空或竞争失败时返回 NULL (线程安全)
+//-----------------------------------------------------------------------------
+void* WorkStealingDeque::steal()
+{
+    INT64 top = top_;
+    fullMemoryBarrier();
+    INT64 bottom = bottom_;
+    if (top >= bottom) return NULL;
+
+    fullMemoryBarrier();  // 须在读到 bottom_ 之后再读数组及元素
+    Array *array = array_;
+    void *item = array->items[top & (array->capacity - 1)];
+
+    if (!compareAndSetInt64(&top_, top, top + 1))
+        return NULL;
+    return item;
+}
+
+//-----------------------------------------------------------------------------
+
+int WorkStealingDeque::getCount() const
+{
+    INT64 count = bottom_ - top_;
+    return (int)ise::max(count, (INT64)0);
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 将数组容量扩大一倍，复制 [top, bottom) 中的元素
+//-----------------------------------------------------------------------------
+WorkStealingDeque::Array* WorkStealingDeque::growArray(Array *array, INT64 bottom, INT64 top)
+{
+    Array *newArray = new Array();
+    newArray->capacity = array->capacity * 2;
+    newArray->items = new void* volatile[newArray->capacity];
+    newArray->prior = array;
+
+    for (INT64 i = top; i < bottom; ++i)
+        newArray->items[i & (newArray->capacity - 1)] = array->items[i & (array->capacity - 1)];
+
+    fullMemoryBarrier();
+    array_ = newArray;
+    return newArray;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 // class SeqNumberAlloc
 
@@ -3683,7 +4083,7 @@ void Logger::writeStr(const char *str)
 #endif
 
     text = formatString("[%s](%05d|%05u) %s%s",
-        DateTime::now().toDateTimeString().c_str(),
+        Clock::getDateTimeStr().c_str(),
         processId, threadId, str, S_CRLF);
 
     writeToFile(text);
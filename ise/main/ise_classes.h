@@ -69,6 +69,7 @@ namespace ise
 class Buffer;
 class DateTime;
 class Timestamp;
+class Clock;
 class AutoFinalizer;
 class AutoInvoker;
 class AutoInvokable;
@@ -78,6 +79,8 @@ class Condition;
 class SignalMasker;
 class AtomicInt;
 class AtomicInt64;
+class MpscQueue;
+class WorkStealingDeque;
 class SeqNumberAlloc;
 class Stream;
 class MemoryStream;
@@ -226,6 +229,34 @@ private:
     TimeVal value_;
 };
 
+///////////////////////////////////////////////////////////////////////////////
+// class Clock - 时钟服务 (带线程局部缓存)
+//
+// 说明:
+// 1. getTicks()/getMicroTicks() 返回单调时钟 (与 getCurTicks()/getCurMicroTicks() 同源)，
+//    不受系统时间调整 (NTP、手工修改) 的影响，用于计算超时和定时器。now() 返回墙上时间。
+// 2. 事件循环每轮等待完毕后调用一次 update()，将时钟读入本线程的缓存，此后本线程读取的
+//    都是缓存值，没有系统调用。未调用过 update() 的线程每次都直接读取时钟。
+// 3. 缓存值最多落后一轮事件循环的处理时间。测量延迟等需要精确时间的场合，应直接使用
+//    getCurTicks()/getCurMicroTicks()/Timestamp::now()。
+// 4. getDateTimeStr() 和 getHttpDateStr() 返回按秒缓存的日期字符串，前者供日志使用，
+//    后者为 HTTP Date 头的格式 (RFC 1123)。未缓存时钟的线程取自 CLOCK_REALTIME_COARSE。
+
+class Clock
+{
+public:
+    static void update();
+    static void resetCache();
+
+    static UINT64 getTicks();
+    static UINT64 getMicroTicks();
+    static Timestamp now();
+    static UINT64 toTicks(Timestamp time);
+
+    static string getDateTimeStr();
+    static string getHttpDateStr();
+};
+
 ///////////////////////////////////////////////////////////////////////////////
 // class AutoFinalizer - 基于 RAII 的自动析构器
 
@@ -499,6 +530,8 @@ public:
     LONG increment() { return InterlockedIncrement(&value_); }
     LONG decrement() { return InterlockedDecrement(&value_); }
     LONG getAndSet(LONG newValue) { return set(newValue); }
+    bool compareAndSet(LONG expected, LONG newValue)
+        { return InterlockedCompareExchange(&value_, newValue, expected) == expected; }
 
 private:
     volatile LONG value_;
@@ -550,6 +583,13 @@ public:
     {
         return set(newValue);
     }
+    bool compareAndSet(INT64 expected, INT64 newValue)
+    {
+        AutoLocker locker(mutex_);
+        if (value_ != expected) return false;
+        value_ = newValue;
+        return true;
+    }
 
 private:
     volatile INT64 value_;
@@ -573,6 +613,7 @@ public:
     T increment() { return addAndGet(1); }
     T decrement() { return addAndGet(-1); }
     T getAndSet(T newValue) { return set(newValue); }
+    bool compareAndSet(T expected, T newValue) { return __sync_bool_compare_and_swap(&value_, expected, newValue); }
 
 private:
     volatile T value_;
@@ -583,6 +624,88 @@ class AtomicInt64 : public AtomicInteger<INT64> {};
 
 #endif
 
+///////////////////////////////////////////////////////////////////////////////
+// class MpscQueue - 无锁的多生产者单消费者侵入式队列
+//
+// 说明:
+// 1. 任意线程均可调用 push() 压入节点；只有唯一的消费者线程可调用 popAll()，
+//    一次性取走当前所有节点，取走的链表按压入的先后顺序排列；
+// 2. 消费者总是整体取走 (原子交换)，不存在单个节点的弹出，因此没有 ABA 问题；
+// 3. 节点的内存由调用者负责分配和释放；
+// 4. 由于 popAll() 是整体的原子交换，多个线程同时调用也是安全的 (各自取走互不相交的部分)，
+//    此时可作为多消费者的批量队列使用。
+
+class MpscQueue : boost::noncopyable
+{
+public:
+    struct Node
+    {
+        Node *next;
+        Node() : next(NULL) {}
+    };
+
+public:
+    MpscQueue() : head_(NULL) {}
+
+    // 压入一个节点，返回压入前队列是否为空 (线程安全)
+    bool push(Node *node);
+    // 一次压入一串节点 (以 next 相连，newest 为最后压入者，oldest 为最先压入者)
+    bool pushChain(Node *newest, Node *oldest);
+    // 取走所有节点，返回按压入顺序排列的链表 (仅限消费者线程调用)
+    Node* popAll();
+    // 队列是否为空
+    bool isEmpty() const { return head_ == NULL; }
+
+private:
+    Node * volatile head_;     // 最后压入的节点 (栈顶)
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// class WorkStealingDeque - 无锁的工作窃取双端队列 (Chase-Lev)
+//
+// 说明:
+// 1. 队列有唯一的所有者线程，只有它可以在底部 push()/pop() (后进先出)；其它线程可随时
+//    从顶部 steal() (先进先出)。所有者的操作通常不需要原子指令，只在仅剩一个元素时与
+//    窃取者竞争一次 CAS。
+// 2. 元素为非空指针，其内存由调用者负责；队列空间不足时自动扩容 (扩容前的数组保留至
+//    析构，因为窃取者可能仍在读取)。
+// 3. steal() 在与其它线程竞争失败时也返回 NULL，调用者可换一个队列再试。
+
+class WorkStealingDeque : boost::noncopyable
+{
+public:
+    explicit WorkStealingDeque(int initCapacity = 256);
+    ~WorkStealingDeque();
+
+    // 在底部压入一个元素 (仅限所有者线程调用)
+    void push(void *item);
+    // 从底部弹出一个元素，队列为空时返回 NULL (仅限所有者线程调用)
+    void* pop();
+    // 从顶部窃取一个元素，队列为空或竞争失败时返回 NULL (线程安全)
+    void* steal();
+
+    // 队列中的元素个数 (其它线程调用时为近似值)
+    int getCount() const;
+    bool isEmpty() const { return getCount() <= 0; }
+
+private:
+    struct Array
+    {
+        INT64 capacity;            // 容量 (2的整数次幂)
+        void * volatile *items;
+        Array *prior;              // 扩容前的数组
+    };
+
+    Array* growArray(Array *array, INT64 bottom, INT64 top);
+
+private:
+    volatile INT64 top_;           // 窃取者取走元素的位置
+    char padding1_[CACHE_LINE_SIZE - sizeof(INT64)];
+    volatile INT64 bottom_;        // 所有者压入元素的位置
+    Array * volatile array_;
+    char padding2_[CACHE_LINE_SIZE - sizeof(INT64) - sizeof(Array*)];
+};
+
 ///////////////////////////////////////////////////////////////////////////////
 // class SeqNumberAlloc - 整数序列号分配器类
 //
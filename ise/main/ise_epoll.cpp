@@ -38,20 +38,33 @@ namespace ise
 
 #ifdef ISE_LINUX
 
+#ifndef EPOLLRDHUP
+#define EPOLLRDHUP 0x2000
+#endif
+
 ///////////////////////////////////////////////////////////////////////////////
 // class EpollObject
 
 EpollObject::EpollObject(EventLoop *eventLoop) :
-    eventLoop_(eventLoop)
+    eventLoop_(eventLoop),
+    wakeupFd_(-1),
+    timerFd_(-1),
+    timerFdExpireTicks_(0),
+    isTimerFdExpired_(false),
+    listenHandle_(INVALID_SOCKET),
+    isListenerSuspended_(false)
 {
     events_.resize(INITIAL_EVENT_SIZE);
     createEpoll();
-    createPipe();
+    createWakeupFd();
+    createTimerFd();
 }
 
 EpollObject::~EpollObject()
 {
-    destroyPipe();
+    removeListener();
+    destroyTimerFd();
+    destroyWakeupFd();
     destroyEpoll();
 }
 
@@ -62,10 +75,14 @@ void EpollObject::poll()
 {
     int timeout = eventLoop_->calcLoopWaitTimeout();
 
-    int eventCount = ::epoll_wait(epollFd_, &events_[0], (int)events_.size(), timeout);
+    // 定时器尚未到期时，由 timerfd 在到期时刻唤醒
+    bool useTimerFd = (timerFd_ >= 0 && timeout != TIMEOUT_INFINITE && timeout > 0);
+    if (useTimerFd)
+        armTimerFd(Clock::getTicks() + timeout);
 
-    if (timeout != TIMEOUT_INFINITE)
-        eventLoop_->processExpiredTimers();
+    int waitTimeout = eventLoop_->beforeLoopWait(useTimerFd ? TIMEOUT_INFINITE : timeout);
+    int eventCount = ::epoll_wait(epollFd_, &events_[0], (int)events_.size(), waitTimeout);
+    eventLoop_->afterLoopWait(eventCount > 0);
 
     if (eventCount > 0)
     {
@@ -78,35 +95,49 @@ void EpollObject::poll()
     {
         logger().writeStr(SEM_EPOLL_WAIT_ERROR);
     }
+
+    if (isTimerFdExpired_ || (!useTimerFd && timeout != TIMEOUT_INFINITE))
+    {
+        isTimerFdExpired_ = false;
+        eventLoop_->processExpiredTimers();
+    }
 }
 
 //-----------------------------------------------------------------------------
 // 描述: 唤醒正在阻塞的 Poll() 函数
+// 备注: 重复唤醒的合并由 EventLoop::tryMarkWakeupPending() 负责。
 //-----------------------------------------------------------------------------
 void EpollObject::wakeup()
 {
-    BYTE val = 0;
-    ::write(pipeFds_[1], &val, sizeof(BYTE));
+    UINT64 val = 1;
+    ::write(wakeupFd_, &val, sizeof(val));
 }
 
 //-----------------------------------------------------------------------------
 // 描述: 向 EPoll 中添加一个连接
+// 参数:
+//   edgeTriggered - 是否采用边沿触发 (EPOLLET) 模式
 //-----------------------------------------------------------------------------
-void EpollObject::addConnection(BaseTcpConnection *connection, bool enableSend, bool enableRecv)
+void EpollObject::addConnection(BaseTcpConnection *connection, bool enableSend, bool enableRecv,
+    bool edgeTriggered)
 {
     epollControl(
         EPOLL_CTL_ADD, connection, connection->getSocket().getHandle(),
-        enableSend, enableRecv);
+        enableSend, enableRecv, edgeTriggered);
 }
 
 //-----------------------------------------------------------------------------
 // 描述: 更新 EPoll 中的一个连接
+// 备注:
+//   EPOLL_CTL_MOD 会重新评估句柄的就绪状态，所以在边沿触发模式下，也可用此函数
+//   重新 "武装" 事件 (若句柄已就绪，会再次产生通知)。
 //-----------------------------------------------------------------------------
-void EpollObject::updateConnection(BaseTcpConnection *connection, bool enableSend, bool enableRecv)
+void EpollObject::updateConnection(BaseTcpConnection *connection, bool enableSend, bool enableRecv,
+    bool edgeTriggered)
 {
     epollControl(
         EPOLL_CTL_MOD, connection, connection->getSocket().getHandle(),
-        enableSend, enableRecv);
+        enableSend, enableRecv, edgeTriggered);
 }
 
 //-----------------------------------------------------------------------------
@@ -119,6 +150,76 @@ void EpollObject::removeConnection(BaseTcpConnection *connection)
         false, false);
 }
 
+//-----------------------------------------------------------------------------
+// 描述: 向 EPoll 中添加监听套接字，有新连接到达时调用 callback
+// 备注:
+//   1. 每个 EpollObject 最多只有一个监听套接字。
+//   2. 采用水平触发，callback 中不必一次接受全部连接。
+//   3. epoll_ctl() 是线程安全的，可在任意线程中调用此函数和 removeListener()。
+//      但须在事件循环停止后才能关闭监听套接字。
+//-----------------------------------------------------------------------------
+void EpollObject::addListener(SOCKET handle, const AcceptEventCallback& callback)
+{
+    removeListener();
+
+    listenHandle_ = handle;
+    onAcceptEvent_ = callback;
+    isListenerSuspended_ = false;
+    epollControl(EPOLL_CTL_ADD, this, listenHandle_, false, true);
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 从 EPoll 中删除监听套接字
+//-----------------------------------------------------------------------------
+void EpollObject::removeListener()
+{
+    if (listenHandle_ != INVALID_SOCKET)
+    {
+        epollControl(EPOLL_CTL_DEL, this, listenHandle_, false, false);
+        listenHandle_ = INVALID_SOCKET;
+    }
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 暂停监视监听套接字，LISTENER_SUSPEND_TIME 毫秒后自动恢复
+// 备注:
+//   进程的文件描述符耗尽 (EMFILE/ENFILE) 时，待接受的连接无法取走，水平触发的
+//   监听套接字会一直可读，事件循环将空转。此时暂停监视一段时间，待其它连接关闭
+//   释放描述符后再恢复。须在事件循环线程中调用。
+//-----------------------------------------------------------------------------
+void EpollObject::suspendListener()
+{
+    if (listenHandle_ == INVALID_SOCKET || isListenerSuspended_) return;
+
+    isListenerSuspended_ = true;
+    epollControl(EPOLL_CTL_MOD, this, listenHandle_, false, false);
+    eventLoop_->executeAfter(LISTENER_SUSPEND_TIME,
+        boost::bind(&EpollObject::resumeListener, this));
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 等待连接上的非阻塞 connect() 完成
+// 备注:
+//   1. 一次性等待: 套接字可写或出错时，先自动删除等待，再调用 ConnectEventCallback。
+//   2. 连接尚未加入事件循环，所以登记时以带标记的连接指针区别于普通连接的事件。
+//-----------------------------------------------------------------------------
+void EpollObject::addConnectWatch(BaseTcpConnection *connection)
+{
+    epollControl(
+        EPOLL_CTL_ADD, makeConnectWatchParam(connection), connection->getSocket().getHandle(),
+        true, false);
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 撤销 addConnectWatch() 登记的等待
+//-----------------------------------------------------------------------------
+void EpollObject::removeConnectWatch(BaseTcpConnection *connection)
+{
+    epollControl(
+        EPOLL_CTL_DEL, makeConnectWatchParam(connection), connection->getSocket().getHandle(),
+        false, false);
+}
+
 //-----------------------------------------------------------------------------
 // 描述: 设置回调
 //-----------------------------------------------------------------------------
@@ -127,6 +228,14 @@ void EpollObject::setNotifyEventCallback(const NotifyEventCallback& callback)
     onNotifyEvent_ = callback;
 }
 
+//-----------------------------------------------------------------------------
+// 描述: 设置回调
+//-----------------------------------------------------------------------------
+void EpollObject::setConnectEventCallback(const ConnectEventCallback& callback)
+{
+    onConnectEvent_ = callback;
+}
+
 //-----------------------------------------------------------------------------
 
 void EpollObject::createEpoll()
@@ -146,34 +255,78 @@ void EpollObject::destroyEpoll()
 
 //-----------------------------------------------------------------------------
 
-void EpollObject::createPipe()
+void EpollObject::createWakeupFd()
+{
+    // eventfd 内部是一个 64 位计数器: 多次写入只累加计数，一次读取即可清零
+    wakeupFd_ = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wakeupFd_ >= 0)
+        epollControl(EPOLL_CTL_ADD, NULL, wakeupFd_, false, true);
+    else
+        logger().writeStr(SEM_CREATE_EVENTFD_ERROR);
+}
+
+//-----------------------------------------------------------------------------
+
+void EpollObject::destroyWakeupFd()
+{
+    if (wakeupFd_ >= 0)
+    {
+        epollControl(EPOLL_CTL_DEL, NULL, wakeupFd_, false, false);
+        ::close(wakeupFd_);
+        wakeupFd_ = -1;
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+void EpollObject::createTimerFd()
 {
-    // pipeFds_[0] for reading, pipeFds_[1] for writing.
-    memset(pipeFds_, 0, sizeof(pipeFds_));
-    if (::pipe(pipeFds_) == 0)
-        epollControl(EPOLL_CTL_ADD, NULL, pipeFds_[0], false, true);
+    timerFd_ = ::timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (timerFd_ >= 0)
+        epollControl(EPOLL_CTL_ADD, &timerFd_, timerFd_, false, true);
     else
-        logger().writeStr(SEM_CREATE_PIPE_ERROR);
+        logger().writeStr(SEM_CREATE_TIMERFD_ERROR);
 }
 
 //-----------------------------------------------------------------------------
 
-void EpollObject::destroyPipe()
+void EpollObject::destroyTimerFd()
 {
-    epollControl(EPOLL_CTL_DEL, NULL, pipeFds_[0], false, false);
+    if (timerFd_ >= 0)
+    {
+        epollControl(EPOLL_CTL_DEL, &timerFd_, timerFd_, false, false);
+        ::close(timerFd_);
+        timerFd_ = -1;
+    }
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 设置 timerfd 在 expireTicks (单调时钟 Clock::getTicks() 的时间，毫秒) 时触发
+// 备注:
+//   到期时刻不变时不重复设置。没有定时器后不撤销已设定的 timerfd，
+//   到时只多唤醒一次。
+//-----------------------------------------------------------------------------
+void EpollObject::armTimerFd(UINT64 expireTicks)
+{
+    if (expireTicks == timerFdExpireTicks_) return;
 
-    if (pipeFds_[0]) close(pipeFds_[0]);
-    if (pipeFds_[1]) close(pipeFds_[1]);
+    struct itimerspec spec;
+    memset(&spec, 0, sizeof(spec));
+    spec.it_value.tv_sec = (time_t)(expireTicks / MILLISECS_PER_SECOND);
+    spec.it_value.tv_nsec = (long)(expireTicks % MILLISECS_PER_SECOND) * 1000000;
 
-    memset(pipeFds_, 0, sizeof(pipeFds_));
+    if (::timerfd_settime(timerFd_, TFD_TIMER_ABSTIME, &spec, NULL) == 0)
+        timerFdExpireTicks_ = expireTicks;
 }
 
 //-----------------------------------------------------------------------------
 
 void EpollObject::epollControl(int operation, void *param, int handle,
-    bool enableSend, bool enableRecv)
+    bool enableSend, bool enableRecv, bool edgeTriggered)
 {
-    // 注: 采用 Level Triggered (LT, 也称 "电平触发") 模式
+    // 注: 默认采用 Level Triggered (LT, 也称 "电平触发") 模式。
+    // 若 edgeTriggered 为 true，则采用 Edge Triggered (ET, "边沿触发") 模式，此时
+    // 调用者必须在每次通知后一直读/写直至 EAGAIN，否则将不会再收到通知。
 
     struct epoll_event event;
     memset(&event, 0, sizeof(event));
@@ -182,6 +335,8 @@ void EpollObject::epollControl(int operation, void *param, int handle,
         event.events |= EPOLLOUT;
     if (enableRecv)
         event.events |= (EPOLLIN | EPOLLPRI);
+    if (edgeTriggered)
+        event.events |= (EPOLLET | EPOLLRDHUP);
 
     if (::epoll_ctl(epollFd_, operation, handle, &event) < 0)
     {
@@ -190,12 +345,38 @@ void EpollObject::epollControl(int operation, void *param, int handle,
 }
 
 //-----------------------------------------------------------------------------
-// 描述: 处理管道事件
+// 描述: 恢复监视被 suspendListener() 暂停的监听套接字
+//-----------------------------------------------------------------------------
+void EpollObject::resumeListener()
+{
+    if (!isListenerSuspended_) return;
+
+    isListenerSuspended_ = false;
+    if (listenHandle_ != INVALID_SOCKET)
+        epollControl(EPOLL_CTL_MOD, this, listenHandle_, false, true);
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 处理唤醒事件
+//-----------------------------------------------------------------------------
+void EpollObject::processWakeupEvent()
+{
+    UINT64 val;
+    ::read(wakeupFd_, &val, sizeof(val));
+
+    // 先消耗唤醒再清除标志，此后的 wakeup() 请求会重新唤醒
+    eventLoop_->clearWakeupPending();
+}
+
 //-----------------------------------------------------------------------------
-void EpollObject::processPipeEvent()
+
+void EpollObject::processTimerEvent()
 {
-    BYTE val;
-    ::read(pipeFds_[0], &val, sizeof(BYTE));
+    UINT64 val;
+    ::read(timerFd_, &val, sizeof(val));
+
+    timerFdExpireTicks_ = 0;
+    isTimerFdExpired_ = true;
 }
 
 //-----------------------------------------------------------------------------
@@ -223,37 +404,60 @@ enum EPOLL_EVENTS
 };
 */
 
-#ifndef EPOLLRDHUP
-#define EPOLLRDHUP 0x2000
-#endif
-
     for (int i = 0; i < eventCount; i++)
     {
         epoll_event& ev = events_[i];
-        if (ev.data.ptr == NULL)  // for pipe
+        if (ev.data.ptr == NULL)  // for eventfd
         {
-            processPipeEvent();
+            processWakeupEvent();
+        }
+        else if (ev.data.ptr == &timerFd_)  // for timerfd
+        {
+            processTimerEvent();
+        }
+        else if (ev.data.ptr == this)  // for listener
+        {
+            if (onAcceptEvent_)
+                onAcceptEvent_();
+        }
+        else if ((size_t)ev.data.ptr & 1)  // for connect watch
+        {
+            BaseTcpConnection *connection = (BaseTcpConnection*)((size_t)ev.data.ptr & ~(size_t)1);
+            removeConnectWatch(connection);
+            if (onConnectEvent_)
+                onConnectEvent_(connection);
         }
         else
         {
             BaseTcpConnection *connection = (BaseTcpConnection*)ev.data.ptr;
-            EVENT_TYPE eventType = ET_NONE;
 
             //logger().writeFmt("processEvents: %u", ev.events);  // debug
 
+            if (!onNotifyEvent_) continue;
+
+            // 注: 可接收与可发送事件可能同时到来。边沿触发模式下，若只处理其中之一，
+            // 另一个事件将会丢失，所以两者都须通知。
             if ((ev.events & EPOLLERR) || ((ev.events & EPOLLHUP) && !(ev.events & EPOLLIN)))
-                eventType = ET_ERROR;
-            else if (ev.events & (EPOLLIN | EPOLLPRI | EPOLLRDHUP))
-                eventType = ET_ALLOW_RECV;
-            else if (ev.events & EPOLLOUT)
-                eventType = ET_ALLOW_SEND;
-
-            if (eventType != ET_NONE && onNotifyEvent_)
-                onNotifyEvent_(connection, eventType);
+                onNotifyEvent_(connection, ET_ERROR);
+            else
+            {
+                if (ev.events & (EPOLLIN | EPOLLPRI | EPOLLRDHUP))
+                    onNotifyEvent_(connection, ET_ALLOW_RECV);
+                if (ev.events & EPOLLOUT)
+                    onNotifyEvent_(connection, ET_ALLOW_SEND);
+            }
         }
     }
 }
 
+//-----------------------------------------------------------------------------
+// 描述: 取得连接等待所用的 epoll 参数 (连接指针的最低位置 1)
+//-----------------------------------------------------------------------------
+void* EpollObject::makeConnectWatchParam(BaseTcpConnection *connection)
+{
+    return (void*)((size_t)connection | 1);
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
 #endif  /* ifdef ISE_LINUX */
@@ -34,6 +34,8 @@
 
 #ifdef ISE_LINUX
 #include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
 #endif
 
 namespace ise
@@ -55,11 +57,18 @@ class EventLoop;
 
 ///////////////////////////////////////////////////////////////////////////////
 // class EpollObject - Linux EPoll 功能封装
+//
+// 说明:
+// 1. 定时器的到期由一个 timerfd 通知: 按最近的到期时刻以绝对时间设置 timerfd，
+//    epoll_wait() 本身则无限等待。这样唤醒时刻不受 epoll_wait() 毫秒级超时参数的
+//    取整影响，且只在 timerfd 触发时才处理到期定时器。
+// 2. 若 timerfd 不可用，则退回到以 epoll_wait() 的超时参数等待定时器。
 
 class EpollObject
 {
 public:
     enum { INITIAL_EVENT_SIZE = 32 };
+    enum { LISTENER_SUSPEND_TIME = 100 };   // 暂停监视监听套接字的时长 (毫秒)
 
     enum EVENT_TYPE
     {
@@ -70,9 +79,10 @@ public:
     };
 
     typedef std::vector<struct epoll_event> EventList;
-    typedef int EventPipe[2];
 
     typedef boost::function<void (BaseTcpConnection *connection, EVENT_TYPE eventType)> NotifyEventCallback;
+    typedef boost::function<void ()> AcceptEventCallback;
+    typedef boost::function<void (BaseTcpConnection *connection)> ConnectEventCallback;
 
 public:
     EpollObject(EventLoop *eventLoop);
@@ -81,29 +91,54 @@ public:
     void poll();
     void wakeup();
 
-    void addConnection(BaseTcpConnection *connection, bool enableSend, bool enableRecv);
-    void updateConnection(BaseTcpConnection *connection, bool enableSend, bool enableRecv);
+    void addConnection(BaseTcpConnection *connection, bool enableSend, bool enableRecv,
+        bool edgeTriggered = false);
+    void updateConnection(BaseTcpConnection *connection, bool enableSend, bool enableRecv,
+        bool edgeTriggered = false);
     void removeConnection(BaseTcpConnection *connection);
 
+    void addListener(SOCKET handle, const AcceptEventCallback& callback);
+    void removeListener();
+    void suspendListener();
+
+    void addConnectWatch(BaseTcpConnection *connection);
+    void removeConnectWatch(BaseTcpConnection *connection);
+
     void setNotifyEventCallback(const NotifyEventCallback& callback);
+    void setConnectEventCallback(const ConnectEventCallback& callback);
 
 private:
     void createEpoll();
     void destroyEpoll();
-    void createPipe();
-    void destroyPipe();
+    void createWakeupFd();
+    void destroyWakeupFd();
+    void createTimerFd();
+    void destroyTimerFd();
+    void armTimerFd(UINT64 expireTicks);
 
-    void epollControl(int operation, void *param, int handle, bool enableSend, bool enableRecv);
+    void epollControl(int operation, void *param, int handle, bool enableSend, bool enableRecv,
+        bool edgeTriggered = false);
 
-    void processPipeEvent();
+    void processWakeupEvent();
+    void processTimerEvent();
     void processEvents(int eventCount);
+    void resumeListener();
+
+    static void* makeConnectWatchParam(BaseTcpConnection *connection);
 
 private:
     EventLoop *eventLoop_;        // 所属 EventLoop
     int epollFd_;                 // EPoll 的文件描述符
     EventList events_;            // 存放 epoll_wait() 返回的事件
-    EventPipe pipeFds_;           // 用于唤醒 epoll_wait() 的管道
+    int wakeupFd_;                // 用于唤醒 epoll_wait() 的 eventfd
+    int timerFd_;                 // 用于在定时器到期时唤醒 epoll_wait() 的 timerfd
+    UINT64 timerFdExpireTicks_;   // timerfd 当前设定的到期时刻 (0 表示未设定)
+    bool isTimerFdExpired_;       // timerfd 是否已触发 (尚未处理到期定时器)
+    SOCKET listenHandle_;         // 监听套接字 (INVALID_SOCKET 表示无)
+    bool isListenerSuspended_;    // 是否已暂停监视监听套接字
     NotifyEventCallback onNotifyEvent_;
+    AcceptEventCallback onAcceptEvent_;
+    ConnectEventCallback onConnectEvent_;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -77,15 +77,23 @@ const char* const SEM_ALREADY_RUNNING             = "The application is already
 const char* const SEM_INIT_DAEMON_ERROR           = "Init daemon error.";
 
 // ise_server_*
-const char* const SEM_CREATE_PIPE_ERROR           = "Fail to create pipe.";
+const char* const SEM_CREATE_EVENTFD_ERROR        = "Fail to create eventfd.";
+const char* const SEM_CREATE_TIMERFD_ERROR        = "Fail to create timerfd.";
 const char* const SEM_CREATE_EPOLL_ERROR          = "Fail to create epoll object.";
 const char* const SEM_EPOLL_WAIT_ERROR            = "epoll_wait error.";
 const char* const SEM_EPOLL_CTRL_ERROR            = "epoll_ctl error (op: %d).";
+const char* const SEM_TCP_ACCEPT_ERROR            = "accept error (errno: %d).";
+const char* const SEM_CREATE_IO_URING_ERROR       = "Fail to create io_uring (errno: %d).";
+const char* const SEM_IO_URING_ENTER_ERROR        = "io_uring_enter error (errno: %d).";
+const char* const SEM_IO_URING_NOT_SUPPORTED      = "io_uring is not supported, fall back to epoll.";
+const char* const SEM_SOCKET_BUSY_POLL_ERROR      = "Fail to set SO_BUSY_POLL (errno: %d), CAP_NET_ADMIN may be required.";
 const char* const SEM_THREAD_KILLED               = "Killed %d %s thread.";
+const char* const SEM_THREAD_AFFINITY_ERROR       = "Fail to set cpu affinity of thread '%s' to cpus %s (errno: %d).";
 const char* const SEM_WAIT_FOR_THREADS            = "Waiting %s threads to exit...";
 const char* const SEM_IOCP_ERROR                  = "IOCP Error #%d";
 const char* const SEM_INVALID_OP_FOR_IOCP         = "Invalid operation for IOCP.";
 const char* const SEM_EVENT_LOOP_NOT_SPECIFIED    = "Event loop not specified.";
+const char* const SEM_OFFLOAD_POOL_NOT_FOUND      = "Offload pool '%s' not found.";
 
 // ise_database
 const char* const SEM_GET_CONN_FROM_POOL_ERROR    = "Cannot get connection from connection pool.";
@@ -39,7 +39,17 @@ namespace ise
 EventLoop::EventLoop() :
     thread_(NULL),
     loopThreadId_(0),
-    lastCheckTimeoutTicks_(0)
+    isPreciseTimers_(false),
+    statStartTicks_(getCurTicks()),
+    waitStartTicks_(0),
+    waitMSecs_(0),
+    busyPollMicroSecs_(0),
+    isSpinning_(false),
+    isSleeping_(false),
+    isLastSpinIdle_(false),
+    waitStartMicroTicks_(0),
+    waitEndMicroTicks_(0),
+    lastActiveMicroTicks_(0)
 {
     // nothing
 }
@@ -47,6 +57,8 @@ EventLoop::EventLoop() :
 EventLoop::~EventLoop()
 {
     stop(false, true);
+    deleteTasks(static_cast<LoopTask*>(delegatedTasks_.popAll()));
+    deleteTasks(static_cast<LoopTask*>(finalizers_.popAll()));
 }
 
 //-----------------------------------------------------------------------------
@@ -57,6 +69,8 @@ void EventLoop::start()
     if (!thread_)
     {
         thread_ = new EventLoopThread(*this);
+        thread_->setName(threadName_);
+        thread_->setCpuAffinity(cpuAffinity_);
         thread_->run();
     }
 }
@@ -113,66 +127,33 @@ void EventLoop::assertInLoopThread()
     ISE_ASSERT(isInLoopThread());
 }
 
-//-----------------------------------------------------------------------------
-// 描述: 在事件循环线程中立即执行指定的仿函数
-// 备注: 线程安全
-//-----------------------------------------------------------------------------
-void EventLoop::executeInLoop(const Functor& functor)
-{
-    if (isInLoopThread())
-        functor();
-    else
-        delegateToLoop(functor);
-}
-
-//-----------------------------------------------------------------------------
-// 描述: 将指定的仿函数委托给事件循环线程执行。线程在完成当前一轮事件循环后再
-//       执行被委托的仿函数。
-// 备注: 线程安全
-//-----------------------------------------------------------------------------
-void EventLoop::delegateToLoop(const Functor& functor)
-{
-    {
-        AutoLocker locker(delegatedFunctors_.mutex);
-        delegatedFunctors_.items.push_back(functor);
-    }
-
-    wakeupLoop();
-}
-
-//-----------------------------------------------------------------------------
-// 描述: 添加一个清理器 (finalizer) 到事件循环中，在每次循环的最后会执行它们
-//-----------------------------------------------------------------------------
-void EventLoop::addFinalizer(const Functor& finalizer)
-{
-    AutoLocker locker(finalizers_.mutex);
-    finalizers_.items.push_back(finalizer);
-}
-
 //-----------------------------------------------------------------------------
 // 描述: 添加定时器 (指定时间执行)
+// 参数:
+//   slack - 允许推迟执行的毫秒数。到期时间相近的定时器可借此合并为一次唤醒处理，
+//           适用于对时间精度要求不高的定时器 (如超时检查、周期性维护)。
 //-----------------------------------------------------------------------------
-TimerId EventLoop::executeAt(Timestamp time, const TimerCallback& callback)
+TimerId EventLoop::executeAt(Timestamp time, const TimerCallback& callback, INT64 slack)
 {
-    return addTimer(time, 0, callback);
+    return addTimer(time, 0, callback, slack);
 }
 
 //-----------------------------------------------------------------------------
 // 描述: 添加定时器 (在 delay 毫秒后执行)
 //-----------------------------------------------------------------------------
-TimerId EventLoop::executeAfter(INT64 delay, const TimerCallback& callback)
+TimerId EventLoop::executeAfter(INT64 delay, const TimerCallback& callback, INT64 slack)
 {
-    Timestamp time(Timestamp::now() + delay);
-    return addTimer(time, 0, callback);
+    Timestamp time(Clock::now() + delay);
+    return addTimer(time, 0, callback, slack);
 }
 
 //-----------------------------------------------------------------------------
 // 描述: 添加定时器 (每 interval 毫秒循环执行)
 //-----------------------------------------------------------------------------
-TimerId EventLoop::executeEvery(INT64 interval, const TimerCallback& callback)
+TimerId EventLoop::executeEvery(INT64 interval, const TimerCallback& callback, INT64 slack)
 {
-    Timestamp time(Timestamp::now() + interval);
-    return addTimer(time, interval, callback);
+    Timestamp time(Clock::now() + interval);
+    return addTimer(time, interval, callback, slack);
 }
 
 //-----------------------------------------------------------------------------
@@ -217,14 +198,7 @@ void EventLoop::runLoop(Thread *thread)
 //-----------------------------------------------------------------------------
 void EventLoop::executeDelegatedFunctors()
 {
-    Functors functors;
-    {
-        AutoLocker locker(delegatedFunctors_.mutex);
-        functors.swap(delegatedFunctors_.items);
-    }
-
-    for (size_t i = 0; i < functors.size(); ++i)
-        functors[i]();
+    executeTasks(delegatedTasks_);
 }
 
 //-----------------------------------------------------------------------------
@@ -232,14 +206,47 @@ void EventLoop::executeDelegatedFunctors()
 //-----------------------------------------------------------------------------
 void EventLoop::executeFinalizer()
 {
-    Functors finalizers;
+    executeTasks(finalizers_);
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 取出队列中现有的全部任务并依次执行
+// 备注:
+//   执行期间新加入的任务留待下一轮执行。若某个任务抛出异常，本批中其余的任务
+//   将被丢弃。
+//-----------------------------------------------------------------------------
+void EventLoop::executeTasks(MpscQueue& taskQueue)
+{
+    LoopTask *task = static_cast<LoopTask*>(taskQueue.popAll());
+
+    try
+    {
+        while (task != NULL)
+        {
+            LoopTask *next = task->getNext();
+            task->run();
+            delete task;
+            task = next;
+        }
+    }
+    catch (...)
     {
-        AutoLocker locker(finalizers_.mutex);
-        finalizers.swap(finalizers_.items);
+        deleteTasks(task);
+        throw;
     }
+}
 
-    for (size_t i = 0; i < finalizers.size(); ++i)
-        finalizers[i]();
+//-----------------------------------------------------------------------------
+// 描述: 释放任务链表
+//-----------------------------------------------------------------------------
+void EventLoop::deleteTasks(LoopTask *task)
+{
+    while (task != NULL)
+    {
+        LoopTask *next = task->getNext();
+        delete task;
+        task = next;
+    }
 }
 
 //-----------------------------------------------------------------------------
@@ -252,7 +259,7 @@ int EventLoop::calcLoopWaitTimeout()
 
     if (timerQueue_.getNearestExpiration(expiration))
     {
-        Timestamp now(Timestamp::now());
+        Timestamp now(Clock::now());
         if (expiration <= now)
             result = 0;
         else
@@ -267,21 +274,141 @@ int EventLoop::calcLoopWaitTimeout()
 //-----------------------------------------------------------------------------
 void EventLoop::processExpiredTimers()
 {
-    timerQueue_.processExpiredTimers(Timestamp::now());
+    timerQueue_.processExpiredTimers(Clock::now());
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 请求唤醒事件循环前调用，返回是否需要真正发出唤醒
+// 备注:
+//   自上次唤醒被事件循环处理以来，只有第一个请求者需要发出唤醒 (一次系统调用)，
+//   其后的请求者可省去唤醒，因为事件循环必将醒来并执行全部被委托的仿函数。
+//-----------------------------------------------------------------------------
+bool EventLoop::tryMarkWakeupPending()
+{
+    bool result = wakeupPending_.compareAndSet(0, 1);
+
+    if (result)
+        wakeupIssuedCount_.increment();
+    else
+        wakeupSuppressedCount_.increment();
+
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 事件循环收到唤醒后调用 (由 IocpObject/EpollObject 调用)
+// 备注:
+//   必须在消耗掉唤醒 (读取 eventfd 等) 之后、执行被委托的仿函数之前调用。
+//   此后的 delegateToLoop() 会重新发出唤醒。
+//-----------------------------------------------------------------------------
+void EventLoop::clearWakeupPending()
+{
+    wakeupPending_.set(0);
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 事件循环开始等待事件之前调用 (由 IocpObject/EpollObject/IoUringObject 调用)
+// 参数:
+//   timeout - 由 calcLoopWaitTimeout() 算出的等待超时 (毫秒)
+// 返回: 实际采用的等待超时
+// 备注:
+//   启用忙轮询 (setBusyPollTime) 时，若距最近一次取得事件尚不足忙轮询时长，则以零超时
+//   等待 (自旋)，省去线程睡眠、唤醒及调度的延迟；超过时长后才恢复阻塞等待。
+//-----------------------------------------------------------------------------
+int EventLoop::beforeLoopWait(int timeout)
+{
+    waitStartTicks_ = getCurTicks();
+    isSpinning_ = false;
+    isSleeping_ = (timeout != 0);
+
+    if (busyPollMicroSecs_ > 0 && timeout != 0)
+    {
+        waitStartMicroTicks_ = getCurMicroTicks();
+        if (waitStartMicroTicks_ - lastActiveMicroTicks_ < (UINT64)busyPollMicroSecs_)
+        {
+            isSpinning_ = true;
+            isSleeping_ = false;
+            timeout = 0;
+        }
+    }
+
+    return timeout;
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 事件循环等待事件完毕后调用，刷新本线程的时钟缓存并统计繁忙度
+//       (hasEvents 为本次等待是否取得了事件)
+// 备注:
+//   繁忙度 = 1 - 等待时间 / 统计周期。只统计等待时间 (通常较长) 而不统计每次的
+//   处理时间 (通常不足1毫秒)，以免毫秒精度的时钟带来系统性误差。
+//-----------------------------------------------------------------------------
+void EventLoop::afterLoopWait(bool hasEvents)
+{
+    Clock::update();
+    UINT64 curTicks = Clock::getTicks();
+    waitMSecs_ += getTickDiff(waitStartTicks_, curTicks);
+
+    if (busyPollMicroSecs_ > 0)
+        updateBusyPollStat(hasEvents);
+
+    UINT64 elapsedMSecs = getTickDiff(statStartTicks_, curTicks);
+    if (elapsedMSecs >= LOAD_STAT_INTERVAL)
+    {
+        UINT64 busyMSecs = (elapsedMSecs > waitMSecs_ ? elapsedMSecs - waitMSecs_ : 0);
+        busyPermille_.set((int)(busyMSecs * 1000 / elapsedMSecs));
+        statStartTicks_ = curTicks;
+        waitMSecs_ = 0;
+    }
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 忙轮询模式下，记录最近一次取得事件的时间并更新统计
+// 备注:
+//   连续的空转轮询之间的时间 (包括每轮循环自身的开销) 都计入空耗时间，
+//   而不仅仅是零超时等待本身的耗时。
+//-----------------------------------------------------------------------------
+void EventLoop::updateBusyPollStat(bool hasEvents)
+{
+    UINT64 curMicroTicks = getCurMicroTicks();
+
+    if (isSpinning_)
+    {
+        busyPollSpinCount_.increment();
+        if (hasEvents)
+            busyPollHitCount_.increment();
+        else
+        {
+            UINT64 spinStart = (isLastSpinIdle_ ? waitEndMicroTicks_ : waitStartMicroTicks_);
+            busyPollSpinMicroSecs_.getAndAdd(curMicroTicks - spinStart);
+        }
+    }
+    else if (isSleeping_)
+        busyPollSleepCount_.increment();
+
+    if (hasEvents)
+        lastActiveMicroTicks_ = curMicroTicks;
+    isLastSpinIdle_ = (isSpinning_ && !hasEvents);
+    waitEndMicroTicks_ = curMicroTicks;
 }
 
 //-----------------------------------------------------------------------------
 // 描述: 添加定时器 (线程安全)
+// 备注: 在事件循环线程中直接放入定时器队列，事件循环进入等待前会重新计算超时时间。
 //-----------------------------------------------------------------------------
-TimerId EventLoop::addTimer(Timestamp expiration, INT64 interval, const TimerCallback& callback)
+TimerId EventLoop::addTimer(Timestamp expiration, INT64 interval, const TimerCallback& callback,
+    INT64 slack)
 {
-    Timer *timer = new Timer(expiration, interval, callback);
+    if (isInLoopThread())
+        return timerQueue_.addTimer(expiration, interval, callback, slack);
+
+    TimerId timerId = TimerQueue::allocRemoteTimerId();
 
     // 此处必须调用 delegateToLoop，而不可以是 executeInLoop，因为前者能保证 wakeupLoop，
     // 从而马上重新计算事件循环的等待超时时间。
-    delegateToLoop(boost::bind(&TimerQueue::addTimer, &timerQueue_, timer));
+    delegateToLoop(boost::bind(&TimerQueue::addRemoteTimer, &timerQueue_,
+        timerId, expiration, interval, callback, slack));
 
-    return timer->timerId();
+    return timerId;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -297,8 +424,16 @@ EventLoopThread::EventLoopThread(EventLoop& eventLoop) :
 
 void EventLoopThread::execute()
 {
+    // 此后由本线程分配的内存 (事件循环的各内存池) 位于所绑定CPU的本地节点
+    if (!eventLoop_.cpuAffinity_.empty())
+        setLocalMemoryPolicy();
+    if (eventLoop_.isPreciseTimers_)
+        setThreadTimerSlack(1);
+
     eventLoop_.loopThreadId_ = getThreadId();
+    Clock::update();
     eventLoop_.runLoop(this);
+    Clock::resetCache();
 }
 
 //-----------------------------------------------------------------------------
@@ -313,7 +448,9 @@ void EventLoopThread::afterExecute()
 
 EventLoopList::EventLoopList(int loopCount) :
     items_(false, true),
-    wantLoopCount_(loopCount)
+    wantLoopCount_(loopCount),
+    threadNamePrefix_("ise-loop"),
+    isPreciseTimers_(false)
 {
     // nothing
 }
@@ -381,6 +518,43 @@ EventLoop* EventLoopList::findEventLoop(THREAD_ID loopThreadId)
     return NULL;
 }
 
+//-----------------------------------------------------------------------------
+// 描述: 设置事件循环线程的名称前缀 (第 i 个事件循环的线程名为 "前缀-i")
+// 备注: 须在事件循环启动前设置
+//-----------------------------------------------------------------------------
+void EventLoopList::setThreadName(const string& namePrefix)
+{
+    threadNamePrefix_ = namePrefix;
+
+    for (int i = 0; i < getCount(); ++i)
+        applyThreadOptions(i);
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 设置可供事件循环绑定的CPU (为空表示不绑定)
+// 备注:
+//   第 i 个事件循环绑定到 cpus[i % cpus.size()] 上，使各事件循环尽量独占一个CPU，
+//   其内存池也随之分配在该CPU的本地NUMA节点上。须在事件循环启动前设置。
+//-----------------------------------------------------------------------------
+void EventLoopList::setCpuAffinity(const IntegerArray& cpus)
+{
+    cpuAffinity_ = cpus;
+
+    for (int i = 0; i < getCount(); ++i)
+        applyThreadOptions(i);
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 设置各事件循环是否采用高精度定时器，须在事件循环启动前设置
+//-----------------------------------------------------------------------------
+void EventLoopList::setPreciseTimers(bool value)
+{
+    isPreciseTimers_ = value;
+
+    for (int i = 0; i < getCount(); ++i)
+        applyThreadOptions(i);
+}
+
 //-----------------------------------------------------------------------------
 
 EventLoop* EventLoopList::createEventLoop()
@@ -396,19 +570,48 @@ void EventLoopList::setCount(int count)
     count = ensureRange(count, 1, (int)MAX_LOOP_COUNT);
 
     for (int i = 0; i < count; i++)
+    {
         items_.add(createEventLoop());
+        applyThreadOptions(i);
+    }
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 将线程名称、CPU亲和性等线程选项设置到第 index 个事件循环上
+//-----------------------------------------------------------------------------
+void EventLoopList::applyThreadOptions(int index)
+{
+    EventLoop *eventLoop = items_[index];
+
+    eventLoop->setThreadName(formatString("%s-%d", threadNamePrefix_.c_str(), index));
+    if (cpuAffinity_.empty())
+        eventLoop->setCpuAffinity(IntegerArray());
+    else
+        eventLoop->setCpuAffinity(IntegerArray(1, cpuAffinity_[index % cpuAffinity_.size()]));
+    eventLoop->setPreciseTimers(isPreciseTimers_);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 // class OsEventLoop
 
-OsEventLoop::OsEventLoop()
+//-----------------------------------------------------------------------------
+// 参数:
+//   ioBackend - I/O 后端 (仅 Linux 有效)，由调用者保证其可用 (见 IoUringObject::isSupported())
+//-----------------------------------------------------------------------------
+OsEventLoop::OsEventLoop(IO_BACKEND_TYPE ioBackend) :
+    ioBackend_(ioBackend)
 {
 #ifdef ISE_WINDOWS
     iocpObject_ = new IocpObject(this);
 #endif
 #ifdef ISE_LINUX
-    epollObject_ = new EpollObject(this);
+#ifndef ISE_IO_URING
+    ioBackend_ = IOB_EPOLL;
+#endif
+    epollObject_ = (ioBackend_ == IOB_EPOLL ? new EpollObject(this) : NULL);
+#endif
+#ifdef ISE_IO_URING
+    ioUringObject_ = (ioBackend_ == IOB_IO_URING ? new IoUringObject(this) : NULL);
 #endif
 }
 
@@ -422,6 +625,9 @@ OsEventLoop::~OsEventLoop()
 #ifdef ISE_LINUX
     delete epollObject_;
 #endif
+#ifdef ISE_IO_URING
+    delete ioUringObject_;
+#endif
 }
 
 //-----------------------------------------------------------------------------
@@ -432,19 +638,35 @@ void OsEventLoop::doLoopWork(Thread *thread)
 #ifdef ISE_WINDOWS
     iocpObject_->work();
 #endif
+#ifdef ISE_IO_URING
+    if (ioUringObject_ != NULL)
+    {
+        ioUringObject_->poll();
+        return;
+    }
+#endif
 #ifdef ISE_LINUX
     epollObject_->poll();
 #endif
 }
 
 //-----------------------------------------------------------------------------
-// 描述: 唤醒事件循环中的阻塞操作
+// 描述: 唤醒事件循环中的阻塞操作 (已有唤醒尚未处理时不再重复唤醒)
 //-----------------------------------------------------------------------------
 void OsEventLoop::wakeupLoop()
 {
+    if (!tryMarkWakeupPending()) return;
+
 #ifdef ISE_WINDOWS
     iocpObject_->wakeup();
 #endif
+#ifdef ISE_IO_URING
+    if (ioUringObject_ != NULL)
+    {
+        ioUringObject_->wakeup();
+        return;
+    }
+#endif
 #ifdef ISE_LINUX
     epollObject_->wakeup();
 #endif
@@ -39,33 +39,108 @@
 #endif
 #ifdef ISE_LINUX
 #include "ise/main/ise_epoll.h"
+#include "ise/main/ise_io_uring.h"
 #endif
 
+#include <new>
+#include "boost/type_traits/alignment_of.hpp"
+
 namespace ise
 {
 
 ///////////////////////////////////////////////////////////////////////////////
 // classes
 
+class LoopTask;
 class EventLoop;
 class EventLoopThread;
 class EventLoopList;
 class OsEventLoop;
 
 ///////////////////////////////////////////////////////////////////////////////
-// class EventLoop
+// 类型定义
 
-class EventLoop : boost::noncopyable
+// 事件循环采用的 I/O 后端 (仅 Linux 可选)
+enum IO_BACKEND_TYPE
+{
+    IOB_EPOLL,              // EPoll 就绪通知 (缺省)
+    IOB_IO_URING            // io_uring 提交操作、等待完成 (内核不支持时回退到 EPoll)
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// class LoopTask - 委托给事件循环执行的任务
+//
+// 说明:
+// 1. 任务对象本身即是 MpscQueue 的节点，入队时无需再分配链表节点；
+// 2. 仿函数的尺寸不超过 INLINE_SIZE 时直接存放在对象内部的缓冲区中，否则才在堆上
+//    分配。常见的 boost::bind 结果 (成员函数指针加上几个参数) 都能内部存放，从而
+//    省去了 boost::function 对这类仿函数的堆分配。
+
+class LoopTask :
+    public MpscQueue::Node,
+    boost::noncopyable
 {
 public:
-    typedef std::vector<Functor> Functors;
+    enum { INLINE_SIZE = 64 };
 
-    struct FunctorList
+public:
+    template<typename F>
+    explicit LoopTask(const F& functor)
     {
-        Functors items;
-        Mutex mutex;
+        if (sizeof(F) <= INLINE_SIZE &&
+            boost::alignment_of<F>::value <= boost::alignment_of<Storage>::value)
+        {
+            new (storage_.buffer) F(functor);
+            invoker_ = &invokeInline<F>;
+            destroyer_ = &destroyInline<F>;
+        }
+        else
+        {
+            storage_.ptr = new F(functor);
+            invoker_ = &invokeHeap<F>;
+            destroyer_ = &destroyHeap<F>;
+        }
+    }
+
+    ~LoopTask() { destroyer_(storage_); }
+
+    void run() { invoker_(storage_); }
+    LoopTask* getNext() const { return static_cast<LoopTask*>(next); }
+
+private:
+    union Storage
+    {
+        char buffer[INLINE_SIZE];
+        void *ptr;
+        double alignDouble;
+        INT64 alignInt64;
     };
 
+    typedef void (*Invoker)(Storage& storage);
+
+    template<typename F>
+    static void invokeInline(Storage& storage) { (*reinterpret_cast<F*>(storage.buffer))(); }
+    template<typename F>
+    static void destroyInline(Storage& storage) { reinterpret_cast<F*>(storage.buffer)->~F(); }
+    template<typename F>
+    static void invokeHeap(Storage& storage) { (*static_cast<F*>(storage.ptr))(); }
+    template<typename F>
+    static void destroyHeap(Storage& storage) { delete static_cast<F*>(storage.ptr); }
+
+private:
+    Storage storage_;
+    Invoker invoker_;
+    Invoker destroyer_;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// class EventLoop
+
+class EventLoop : boost::noncopyable
+{
+public:
+    enum { LOAD_STAT_INTERVAL = 1000 };  // 繁忙度的统计周期 (毫秒)
+
 public:
     EventLoop();
     virtual ~EventLoop();
@@ -76,16 +151,42 @@ public:
     bool isRunning();
     bool isInLoopThread();
     void assertInLoopThread();
-    void executeInLoop(const Functor& functor);
-    void delegateToLoop(const Functor& functor);
-    void addFinalizer(const Functor& finalizer);
+    template<typename F> void executeInLoop(const F& functor);
+    template<typename F> void delegateToLoop(const F& functor);
+    template<typename F> void addFinalizer(const F& finalizer);
 
-    TimerId executeAt(Timestamp time, const TimerCallback& callback);
-    TimerId executeAfter(INT64 delay, const TimerCallback& callback);
-    TimerId executeEvery(INT64 interval, const TimerCallback& callback);
+    TimerId executeAt(Timestamp time, const TimerCallback& callback, INT64 slack = 0);
+    TimerId executeAfter(INT64 delay, const TimerCallback& callback, INT64 slack = 0);
+    TimerId executeEvery(INT64 interval, const TimerCallback& callback, INT64 slack = 0);
     void cancelTimer(TimerId timerId);
 
     THREAD_ID getLoopThreadId() const { return loopThreadId_; };
+    // 最近一个统计周期内的繁忙度 (千分比，即非等待时间所占比例)
+    int getBusyPermille() const { return busyPermille_.get(); }
+    // 实际发出的唤醒次数，以及因已有唤醒尚未处理而省去的唤醒次数
+    int getWakeupIssuedCount() const { return wakeupIssuedCount_.get(); }
+    int getWakeupSuppressedCount() const { return wakeupSuppressedCount_.get(); }
+
+    // 设置忙轮询时长 (微秒，0 表示不启用)，须在事件循环启动前设置
+    void setBusyPollTime(int microSecs) { busyPollMicroSecs_ = ise::max(microSecs, 0); }
+    int getBusyPollTime() const { return busyPollMicroSecs_; }
+    // 以下忙轮询的统计可在任意线程中读取
+    INT64 getBusyPollSpinCount() const { return busyPollSpinCount_.get(); }
+    INT64 getBusyPollHitCount() const { return busyPollHitCount_.get(); }
+    INT64 getBusyPollSleepCount() const { return busyPollSleepCount_.get(); }
+    INT64 getBusyPollSpinMicroSecs() const { return busyPollSpinMicroSecs_.get(); }
+
+    // 设置事件循环线程的名称及CPU亲和性，须在事件循环启动前设置。
+    // 绑定了CPU的事件循环线程在其本地NUMA节点上分配内存 (包括各内存池)。
+    void setThreadName(const string& name) { threadName_ = name; }
+    void setCpuAffinity(const IntegerArray& cpus) { cpuAffinity_ = cpus; }
+    const string& getThreadName() const { return threadName_; }
+    const IntegerArray& getCpuAffinity() const { return cpuAffinity_; }
+
+    // 设置是否采用高精度定时器 (仅Linux)，须在事件循环启动前设置。
+    // 启用后事件循环线程的定时器松弛量降为最小，定时器在到期时刻的数微秒内触发。
+    void setPreciseTimers(bool value) { isPreciseTimers_ = value; }
+    bool getPreciseTimers() const { return isPreciseTimers_; }
 
 protected:
     virtual void runLoop(Thread *thread);
@@ -95,26 +196,93 @@ protected:
 protected:
     void executeDelegatedFunctors();
     void executeFinalizer();
+    void executeTasks(MpscQueue& taskQueue);
+    static void deleteTasks(LoopTask *task);
 
-    int calcLoopWaitTimeout();
+    virtual int calcLoopWaitTimeout();
     void processExpiredTimers();
 
+    int beforeLoopWait(int timeout);
+    void afterLoopWait(bool hasEvents);
+    void updateBusyPollStat(bool hasEvents);
+
+    bool tryMarkWakeupPending();
+    void clearWakeupPending();
+
 private:
-    TimerId addTimer(Timestamp expiration, INT64 interval, const TimerCallback& callback);
+    TimerId addTimer(Timestamp expiration, INT64 interval, const TimerCallback& callback, INT64 slack);
 
 protected:
     EventLoopThread *thread_;
     THREAD_ID loopThreadId_;
-    FunctorList delegatedFunctors_;
-    FunctorList finalizers_;
-    UINT64 lastCheckTimeoutTicks_;
+    string threadName_;                  // 事件循环线程的名称
+    IntegerArray cpuAffinity_;           // 事件循环线程绑定的CPU (为空表示不绑定)
+    bool isPreciseTimers_;               // 是否采用高精度定时器
+    MpscQueue delegatedTasks_;           // 被委托的任务
+    MpscQueue finalizers_;               // 清理器
     TimerQueue timerQueue_;
 
+    UINT64 statStartTicks_;              // 当前统计周期的开始时间
+    UINT64 waitStartTicks_;              // 本次等待的开始时间
+    UINT64 waitMSecs_;                   // 当前统计周期内的累计等待时间
+    mutable AtomicInt busyPermille_;     // 最近一个统计周期的繁忙度
+
+    int busyPollMicroSecs_;              // 忙轮询时长 (微秒)
+    bool isSpinning_;                    // 本次等待是否为忙轮询 (零超时)
+    bool isSleeping_;                    // 本次等待是否为阻塞等待
+    bool isLastSpinIdle_;                // 上次等待是否为未取得事件的忙轮询
+    UINT64 waitStartMicroTicks_;         // 本次等待的开始时间 (微秒)
+    UINT64 waitEndMicroTicks_;           // 上次等待的结束时间 (微秒)
+    UINT64 lastActiveMicroTicks_;        // 最近一次取得事件的时间 (微秒)
+    mutable AtomicInt64 busyPollSpinCount_;     // 忙轮询 (零超时等待) 的次数
+    mutable AtomicInt64 busyPollHitCount_;      // 其中取得了事件的次数
+    mutable AtomicInt64 busyPollSleepCount_;    // 超过忙轮询时长后转入阻塞等待的次数
+    mutable AtomicInt64 busyPollSpinMicroSecs_; // 忙轮询未取得事件的累计耗时 (即空耗的CPU时间)
+
+    AtomicInt wakeupPending_;            // 是否已发出唤醒且尚未被事件循环处理
+    mutable AtomicInt wakeupIssuedCount_;
+    mutable AtomicInt wakeupSuppressedCount_;
+
     friend class EventLoopThread;
     friend class IocpObject;
     friend class EpollObject;
+    friend class IoUringObject;
 };
 
+//-----------------------------------------------------------------------------
+// 描述: 在事件循环线程中立即执行指定的仿函数
+// 备注: 线程安全
+//-----------------------------------------------------------------------------
+template<typename F>
+void EventLoop::executeInLoop(const F& functor)
+{
+    if (isInLoopThread())
+        functor();
+    else
+        delegateToLoop(functor);
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 将指定的仿函数委托给事件循环线程执行。线程在完成当前一轮事件循环后再
+//       执行被委托的仿函数。
+// 备注: 线程安全。仿函数以原始类型存入任务对象，不经 boost::function 转换。
+//-----------------------------------------------------------------------------
+template<typename F>
+void EventLoop::delegateToLoop(const F& functor)
+{
+    delegatedTasks_.push(new LoopTask(functor));
+    wakeupLoop();
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 添加一个清理器 (finalizer) 到事件循环中，在每次循环的最后会执行它们
+//-----------------------------------------------------------------------------
+template<typename F>
+void EventLoop::addFinalizer(const F& finalizer)
+{
+    finalizers_.push(new LoopTask(finalizer));
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 // class EventLoopThread - 事件循环执行线程
 
@@ -147,6 +315,11 @@ public:
     int getCount() { return items_.getCount(); }
     EventLoop* findEventLoop(THREAD_ID loopThreadId);
 
+    void setThreadName(const string& namePrefix);
+    void setCpuAffinity(const IntegerArray& cpus);
+    const IntegerArray& getCpuAffinity() const { return cpuAffinity_; }
+    void setPreciseTimers(bool value);
+
     EventLoop* getItem(int index) { return items_[index]; }
     EventLoop* operator[] (int index) { return getItem(index); }
 
@@ -154,9 +327,13 @@ protected:
     virtual EventLoop* createEventLoop();
 private:
     void setCount(int count);
+    void applyThreadOptions(int index);
 protected:
     ObjectList<EventLoop> items_;
     int wantLoopCount_;
+    string threadNamePrefix_;       // 线程名称前缀，第 i 个事件循环的线程名为 "前缀-i"
+    IntegerArray cpuAffinity_;      // 可供绑定的CPU，事件循环依次各绑定其中一个
+    bool isPreciseTimers_;          // 事件循环是否采用高精度定时器
     Mutex mutex_;
 };
 
@@ -166,19 +343,25 @@ protected:
 class OsEventLoop : public EventLoop
 {
 public:
-    OsEventLoop();
+    explicit OsEventLoop(IO_BACKEND_TYPE ioBackend = IOB_EPOLL);
     virtual ~OsEventLoop();
 
+    IO_BACKEND_TYPE getIoBackend() const { return ioBackend_; }
+
 protected:
     virtual void doLoopWork(Thread *thread);
     virtual void wakeupLoop();
 
 protected:
+    IO_BACKEND_TYPE ioBackend_;
 #ifdef ISE_WINDOWS
     IocpObject *iocpObject_;
 #endif
 #ifdef ISE_LINUX
-    EpollObject *epollObject_;
+    EpollObject *epollObject_;        // 采用 IOB_EPOLL 时有效
+#endif
+#ifdef ISE_IO_URING
+    IoUringObject *ioUringObject_;    // 采用 IOB_IO_URING 时有效
 #endif
 };
 
@@ -167,6 +167,9 @@ const int SECONDS_PER_DAY        = 86400;
 
 const int TIMEOUT_INFINITE = -1;
 
+// 缓存行大小 (用于隔开被不同线程频繁修改的数据，避免伪共享)
+const int CACHE_LINE_SIZE = 64;
+
 const Context EMPTY_CONTEXT = Context();
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -175,6 +178,14 @@ const Context EMPTY_CONTEXT = Context();
 #define SAFE_DELETE(x)          { delete x; x = NULL; }
 #define CATCH_ALL_EXCEPTION(x)  try { x; } catch(...) {}
 
+// 线程局部变量 (只可用于 POD 类型)
+#ifdef ISE_WINDOWS
+#define ISE_THREAD_LOCAL        __declspec(thread)
+#endif
+#ifdef ISE_LINUX
+#define ISE_THREAD_LOCAL        __thread
+#endif
+
 ///////////////////////////////////////////////////////////////////////////////
 
 } // namespace ise
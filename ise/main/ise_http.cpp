@@ -1519,16 +1519,30 @@ void HttpServer::onTcpSendComplete(const TcpConnectionPtr& connection, const Con
     case SRS_SENDING_RES_HEADERS:
     case SRS_SENDING_CONTENT:
         {
-            connContext->sendResState = SRS_SENDING_CONTENT;
-
             Stream *contentStream = connContext->httpResponse.getContentStream();
 
+#ifdef ISE_LINUX
+            // File content is sent by the kernel (sendfile) without copying it through user space.
+            FileStream *fileStream = dynamic_cast<FileStream*>(contentStream);
+            if (connContext->sendResState == SRS_SENDING_RES_HEADERS &&
+                fileStream != NULL && fileStream->isOpen() && fileStream->getSize() > 0)
+            {
+                connContext->sendResState = SRS_SENDING_CONTENT_FILE;
+                connection->sendFile(fileStream->getHandle(), 0, fileStream->getSize(),
+                    EMPTY_CONTEXT, options_.sendContentFileTimeout);
+                break;
+            }
+#endif
+
+            connContext->sendResState = SRS_SENDING_CONTENT;
+
             const int SEND_BLOCK_SIZE = 1024*64;
             Buffer buffer(SEND_BLOCK_SIZE);
 
-            int readSize = contentStream->read(buffer.data(), buffer.getSize());
+            int readSize = (contentStream != NULL ?
+                contentStream->read(buffer.data(), buffer.getSize()) : 0);
             if (readSize > 0)
-                connection->send(buffer.data(), buffer.getSize(), EMPTY_CONTEXT, options_.sendContentBlockTimeout);
+                connection->send(buffer.data(), readSize, EMPTY_CONTEXT, options_.sendContentBlockTimeout);
             else
             {
                 connContext->sendResState = SRS_COMPLETE;
@@ -1538,6 +1552,13 @@ void HttpServer::onTcpSendComplete(const TcpConnectionPtr& connection, const Con
             break;
         }
 
+    case SRS_SENDING_CONTENT_FILE:
+        {
+            connContext->sendResState = SRS_COMPLETE;
+            connection->disconnect();
+            break;
+        }
+
     case SRS_COMPLETE:
         break;
 
@@ -161,6 +161,7 @@ public:
     int recvContentTimeout;               // The timeout of receiving any data of the request content stream.
     int sendResponseHeaderTimeout;        // The timeout of sending the response header.
     int sendContentBlockTimeout;          // The timeout of sending a response content block.
+    int sendContentFileTimeout;           // The timeout of sending a whole response content file (FileStream).
     int maxConnectionCount;               // The maximum connections, -1 for no limitation.
 public:
     HttpServerOptions()
@@ -169,6 +170,7 @@ public:
         recvContentTimeout = TIMEOUT_INFINITE;
         sendResponseHeaderTimeout = TIMEOUT_INFINITE;
         sendContentBlockTimeout = TIMEOUT_INFINITE;
+        sendContentFileTimeout = TIMEOUT_INFINITE;
         maxConnectionCount = -1;
     }
 };
@@ -594,6 +596,7 @@ private:
     {
         SRS_SENDING_RES_HEADERS,
         SRS_SENDING_CONTENT,
+        SRS_SENDING_CONTENT_FILE,
         SRS_COMPLETE,
     };
 
@@ -260,6 +260,159 @@ void IseServerInspector::onHttpSession(const HttpRequest& request, HttpResponse&
 ///////////////////////////////////////////////////////////////////////////////
 // class PredefinedInspector
 
+string PredefinedInspector::getTcpStat(const PropertyList& argList,
+    string& contentType)
+{
+    contentType = "text/plain";
+
+    TcpInspectInfo& info = TcpInspectInfo::instance();
+
+    StrList strList;
+    strList.add(formatString("tcp_conn_create_count: %d", (int)info.tcpConnCreateCount.get()));
+    strList.add(formatString("tcp_conn_destroy_count: %d", (int)info.tcpConnDestroyCount.get()));
+    strList.add(formatString("error_occurred_count: %d", (int)info.errorOccurredCount.get()));
+    strList.add(formatString("add_conn_count: %d", (int)info.addConnCount.get()));
+    strList.add(formatString("remove_conn_count: %d", (int)info.removeConnCount.get()));
+    strList.add(formatString("send_timeout_count: %d", (int)info.sendTimeoutCount.get()));
+    strList.add(formatString("recv_timeout_count: %d", (int)info.recvTimeoutCount.get()));
+    strList.add(formatString("idle_timeout_count: %d", (int)info.idleTimeoutCount.get()));
+    strList.add(formatString("io_buffer_in_use_bytes: %s", addThousandSep(info.ioBufferInUseBytes.get()).c_str()));
+    strList.add(formatString("io_buffer_pooled_bytes: %s", addThousandSep(info.ioBufferPooledBytes.get()).c_str()));
+    strList.add(formatString("send_syscalls_saved: %s", addThousandSep(info.sendSyscallsSaved.get()).c_str()));
+    strList.add(formatString("send_buffer_high_count: %d", (int)info.sendBufferHighCount.get()));
+    strList.add(formatString("send_buffer_overflow_count: %d", (int)info.sendBufferOverflowCount.get()));
+
+    INT64 acquireCount = info.peerPoolAcquireCount.get();
+    INT64 waitCount = info.peerPoolWaitCount.get();
+    strList.add(formatString("peer_pool_acquire_count: %s", addThousandSep(acquireCount).c_str()));
+    strList.add(formatString("peer_pool_hit_rate: %.1f%%",
+        acquireCount > 0 ? info.peerPoolHitCount.get() * 100.0 / acquireCount : 0.0));
+    strList.add(formatString("peer_pool_wait_count: %s", addThousandSep(waitCount).c_str()));
+    strList.add(formatString("peer_pool_avg_wait_ms: %.1f",
+        waitCount > 0 ? (double)info.peerPoolWaitMSecs.get() / waitCount : 0.0));
+    strList.add(formatString("peer_pool_wait_fail_count: %d", (int)info.peerPoolWaitFailCount.get()));
+    strList.add(formatString("peer_pool_reconnect_count: %d", (int)info.peerPoolReconnectCount.get()));
+    strList.add(formatString("peer_pool_connect_fail_count: %d", (int)info.peerPoolConnectFailCount.get()));
+    strList.add(formatString("peer_pool_idle_close_count: %d", (int)info.peerPoolIdleCloseCount.get()));
+
+    return strList.getText();
+}
+
+string PredefinedInspector::getTcpLoops(const PropertyList& argList,
+    string& contentType)
+{
+    contentType = "text/plain";
+
+    StrList strList;
+    if (iseApp().iseOptions().getServerType() & ST_TCP)
+    {
+        MainTcpServer& mainTcpServer = iseApp().mainServer().getMainTcpServer();
+
+#ifdef ISE_WINDOWS
+        const char *ioBackend = "iocp";
+#else
+        const char *ioBackend = (TcpEventLoopList::getIoBackend() == IOB_IO_URING ? "io_uring" : "epoll");
+#endif
+        strList.add(formatString("io backend: %s", ioBackend));
+
+        for (int i = 0; i < mainTcpServer.getTcpServerCount(); ++i)
+        {
+            TcpServer& tcpServer = mainTcpServer.getTcpServer(i);
+            strList.add(formatString("server[%d]: port: %d, connections: %d, placement: %s",
+                i, tcpServer.getLocalPort(), tcpServer.getConnectionCount(),
+                tcpServer.isReusePort() ? "reuse_port" :
+                tcpServer.getEventLoopList().getPlacementPolicy().getName().c_str()));
+            addEventLoopListInfo(tcpServer.getEventLoopList(), strList);
+        }
+
+        if (mainTcpServer.isTcpClientEventLoopListCreated())
+        {
+            TcpEventLoopList& eventLoopList = mainTcpServer.getTcpClientEventLoopList();
+            strList.add(formatString("client: placement: %s",
+                eventLoopList.getPlacementPolicy().getName().c_str()));
+            addEventLoopListInfo(eventLoopList, strList);
+        }
+    }
+
+    return strList.getText();
+}
+
+string PredefinedInspector::getTcpOffload(const PropertyList& argList,
+    string& contentType)
+{
+    contentType = "text/plain";
+
+    StrList strList;
+    OffloadPoolList& poolList = iseApp().mainServer().getOffloadPoolList();
+    for (int i = 0; i < poolList.getCount(); ++i)
+    {
+        OffloadPool& pool = poolList.getItem(i);
+        INT64 execCount = pool.getExecCount();
+        INT64 startCount = pool.getStartCount();
+
+        strList.add(formatString("pool[%s]: threads: %d, in_flight: %d/%s",
+            pool.getName().c_str(), pool.getThreadCount(), pool.getInFlightCount(),
+            pool.getMaxInFlight() > 0 ? intToStr(pool.getMaxInFlight()).c_str() : "unlimited"));
+        strList.add(formatString("  submit_count: %s", addThousandSep(pool.getSubmitCount()).c_str()));
+        strList.add(formatString("  reject_count: %s", addThousandSep(pool.getRejectCount()).c_str()));
+        strList.add(formatString("  complete_count: %s", addThousandSep(pool.getCompleteCount()).c_str()));
+        strList.add(formatString("  fail_count: %s", addThousandSep(pool.getFailCount()).c_str()));
+        strList.add(formatString("  cancel_count: %s", addThousandSep(pool.getCancelCount()).c_str()));
+        strList.add(formatString("  avg_queue_wait_us: %.1f",
+            startCount > 0 ? (double)pool.getQueueWaitMicroSecs() / startCount : 0.0));
+        strList.add(formatString("  avg_exec_us: %.1f",
+            execCount > 0 ? (double)pool.getExecMicroSecs() / execCount : 0.0));
+    }
+
+    return strList.getText();
+}
+
+void PredefinedInspector::addEventLoopListInfo(TcpEventLoopList& eventLoopList, StrList& strList)
+{
+    for (int i = 0; i < eventLoopList.getCount(); ++i)
+    {
+        TcpEventLoop *eventLoop = eventLoopList[i];
+        int busy = eventLoop->getBusyPermille();
+        strList.add(formatString("  loop[%d]: connections: %d, pending: %d, placed: %d, busy: %d.%d%%, "
+            "wakeups issued: %d, suppressed: %d, pooled buffer bytes: %s, pooled conns: %d",
+            i, eventLoop->getConnectionCount(), eventLoop->getPendingConnCount(),
+            eventLoop->getPlacedCount(), busy / 10, busy % 10,
+            eventLoop->getWakeupIssuedCount(), eventLoop->getWakeupSuppressedCount(),
+            addThousandSep(eventLoop->getIoBufferPool().getPooledBytes()).c_str(),
+            eventLoop->getConnectionPool().getPooledCount()));
+
+        INT64 iterations = eventLoop->getIterationCount();
+        INT64 saved = eventLoop->getSendSyscallsSaved();
+        strList.add(formatString("           send flushes: %s, syscalls saved: %s (%.3f per iteration)",
+            addThousandSep(eventLoop->getSendFlushCount()).c_str(), addThousandSep(saved).c_str(),
+            (iterations > 0 ? (double)saved / iterations : 0.0)));
+
+        if (eventLoop->getBusyPollTime() > 0)
+        {
+            INT64 spins = eventLoop->getBusyPollSpinCount();
+            INT64 hits = eventLoop->getBusyPollHitCount();
+            strList.add(formatString("           busy poll: %d us, spins: %s, hits: %s (%.1f%%), "
+                "sleeps: %s, idle spin time: %s us",
+                eventLoop->getBusyPollTime(), addThousandSep(spins).c_str(), addThousandSep(hits).c_str(),
+                (spins > 0 ? hits * 100.0 / spins : 0.0),
+                addThousandSep(eventLoop->getBusyPollSleepCount()).c_str(),
+                addThousandSep(eventLoop->getBusyPollSpinMicroSecs()).c_str()));
+        }
+
+#ifdef ISE_IO_URING
+        if (eventLoop->getIoBackend() == IOB_IO_URING)
+        {
+            IoUringObject *ioUringObject = static_cast<UringTcpEventLoop*>(eventLoop)->getIoUringObject();
+            INT64 enters = ioUringObject->getEnterCount();
+            INT64 submits = ioUringObject->getSubmitCount();
+            strList.add(formatString("           io_uring enters: %s, submitted ops: %s (%.3f per enter)",
+                addThousandSep(enters).c_str(), addThousandSep(submits).c_str(),
+                (enters > 0 ? (double)submits / enters : 0.0)));
+        }
+#endif
+    }
+}
+
 #ifdef ISE_WINDOWS
 
 IseServerInspector::CommandItems PredefinedInspector::getItems() const
@@ -271,6 +424,9 @@ IseServerInspector::CommandItems PredefinedInspector::getItems() const
     CommandItems items;
 
     items.push_back(CommandItem(category, "basic_info", PredefinedInspector::getBasicInfo, "show the basic info."));
+    items.push_back(CommandItem("tcp", "stat", PredefinedInspector::getTcpStat, "show tcp statistics."));
+    items.push_back(CommandItem("tcp", "loops", PredefinedInspector::getTcpLoops, "show load and placement of tcp event loops."));
+    items.push_back(CommandItem("tcp", "offload", PredefinedInspector::getTcpOffload, "show offload pool statistics."));
 
     return items;
 }
@@ -315,6 +471,10 @@ IseServerInspector::CommandItems PredefinedInspector::getItems() const
     items.push_back(CommandItem(category, "status", PredefinedInspector::getProcStatus, "print /proc/self/status."));
     items.push_back(CommandItem(category, "opened_file_count", PredefinedInspector::getOpenedFileCount, "count /proc/self/fd."));
     items.push_back(CommandItem(category, "thread_count", PredefinedInspector::getThreadCount, "count /proc/self/task."));
+    items.push_back(CommandItem(category, "threads", PredefinedInspector::getThreadList, "list threads with their names, cpu affinity and current cpu."));
+    items.push_back(CommandItem("tcp", "stat", PredefinedInspector::getTcpStat, "show tcp statistics."));
+    items.push_back(CommandItem("tcp", "loops", PredefinedInspector::getTcpLoops, "show load and placement of tcp event loops."));
+    items.push_back(CommandItem("tcp", "offload", PredefinedInspector::getTcpOffload, "show offload pool statistics."));
 
     return items;
 }
@@ -379,6 +539,66 @@ string PredefinedInspector::getThreadCount(const PropertyList& argList,
     return intToStr(count);
 }
 
+string PredefinedInspector::getThreadList(const PropertyList& argList,
+    string& contentType)
+{
+    contentType = "text/plain";
+
+    IntegerArray threadIds;
+    FileFindResult findResult;
+    findFiles("/proc/self/task/*", FA_ANY_FILE, findResult);
+    for (size_t i = 0; i < findResult.size(); ++i)
+    {
+        const string& name = findResult[i].fileName;
+        if (isIntStr(name))
+            threadIds.push_back(strToInt(name));
+    }
+    std::sort(threadIds.begin(), threadIds.end());
+
+    StrList strList;
+    for (size_t i = 0; i < threadIds.size(); ++i)
+    {
+        int tid = threadIds[i];
+        string taskPath = formatString("/proc/self/task/%d/", tid);
+
+        StrList lines;
+        string threadName;
+        if (lines.loadFromFile((taskPath + "comm").c_str()) && lines.getCount() > 0)
+            threadName = trimString(lines[0]);
+
+        // /proc/<tid>/stat 的第39个字段为线程最近一次运行所在的CPU (从命令名之后的第37个字段)
+        int curCpu = -1;
+        if (lines.loadFromFile((taskPath + "stat").c_str()) && lines.getCount() > 0)
+        {
+            string stat = lines[0];
+            string::size_type pos = stat.rfind(')');
+            if (pos != string::npos)
+            {
+                StrList fields;
+                splitString(trimString(stat.substr(pos + 1)), ' ', fields);
+                if (fields.getCount() > 36)
+                    curCpu = strToInt(fields[36], -1);
+            }
+        }
+
+        string affinity = "?";
+        cpu_set_t cpuSet;
+        CPU_ZERO(&cpuSet);
+        if (sched_getaffinity(tid, sizeof(cpuSet), &cpuSet) == 0)
+        {
+            IntegerArray cpus;
+            for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+                if (CPU_ISSET(cpu, &cpuSet)) cpus.push_back(cpu);
+            affinity = cpuListToStr(cpus);
+        }
+
+        strList.add(formatString("tid: %d, name: %s, affinity: %s, cpu: %d",
+            tid, threadName.c_str(), affinity.c_str(), curCpu));
+    }
+
+    return strList.getText();
+}
+
 #endif
 
 
@@ -121,6 +121,10 @@ class PredefinedInspector : boost::noncopyable
 public:
     IseServerInspector::CommandItems getItems() const;
 private:
+    static string getTcpStat(const PropertyList& argList, string& contentType);
+    static string getTcpLoops(const PropertyList& argList, string& contentType);
+    static string getTcpOffload(const PropertyList& argList, string& contentType);
+    static void addEventLoopListInfo(TcpEventLoopList& eventLoopList, StrList& strList);
 
 #ifdef ISE_WINDOWS
     static string getBasicInfo(const PropertyList& argList, string& contentType);
@@ -131,6 +135,7 @@ private:
     static string getProcStatus(const PropertyList& argList, string& contentType);
     static string getOpenedFileCount(const PropertyList& argList, string& contentType);
     static string getThreadCount(const PropertyList& argList, string& contentType);
+    static string getThreadList(const PropertyList& argList, string& contentType);
 #endif
 };
 
@@ -0,0 +1,722 @@
+/****************************************************************************\
+*                                                                            *
+*  ISE (Iris Server Engine) Project                                          *
+*  http://github.com/haoxingeng/ise                                          *
+*                                                                            *
+*  Copyright 2013 HaoXinGeng (haoxingeng@gmail.com)                          *
+*  All rights reserved.                                                      *
+*                                                                            *
+*  Licensed under the Apache License, Version 2.0 (the "License");           *
+*  you may not use this file except in compliance with the License.          *
+*  You may obtain a copy of the License at                                   *
+*                                                                            *
+*      http://www.apache.org/licenses/LICENSE-2.0                            *
+*                                                                            *
+*  Unless required by applicable law or agreed to in writing, software       *
+*  distributed under the License is distributed on an "AS IS" BASIS,         *
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+*  See the License for the specific language governing permissions and       *
+*  limitations under the License.                                            *
+*                                                                            *
+\****************************************************************************/
+
+///////////////////////////////////////////////////////////////////////////////
+// 文件名称: ise_io_uring.cpp
+// 功能描述: io_uring 实现
+///////////////////////////////////////////////////////////////////////////////
+
+#include "ise/main/ise_io_uring.h"
+#include "ise/main/ise_err_msgs.h"
+#include "ise/main/ise_event_loop.h"
+
+#ifdef ISE_IO_URING
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#include <sys/mman.h>
+#include <sys/utsname.h>
+#include <poll.h>
+#include <linux/time_types.h>
+#endif
+
+using namespace ise;
+
+namespace ise
+{
+
+///////////////////////////////////////////////////////////////////////////////
+
+#ifdef ISE_IO_URING
+
+// 操作类型存放在 user_data 的低 3 位 (连接对象的地址至少按 8 字节对齐)
+const UINT64 OP_TYPE_MASK = 7;
+
+//-----------------------------------------------------------------------------
+
+static int ioUringSetup(UINT entries, struct io_uring_params *params)
+{
+    return (int)::syscall(__NR_io_uring_setup, entries, params);
+}
+
+static int ioUringEnter(int ringFd, UINT submitCount, UINT waitCount, UINT flags,
+    void *arg, size_t argSize)
+{
+    return (int)::syscall(__NR_io_uring_enter, ringFd, submitCount, waitCount, flags, arg, argSize);
+}
+
+static int ioUringRegister(int ringFd, UINT opCode, void *arg, UINT argCount)
+{
+    return (int)::syscall(__NR_io_uring_register, ringFd, opCode, arg, argCount);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// class IoUringObject
+
+IoUringObject::IoUringObject(EventLoop *eventLoop) :
+    eventLoop_(eventLoop),
+    ringFd_(-1),
+    sqRingPtr_(MAP_FAILED),
+    sqRingSize_(0),
+    cqRingPtr_(MAP_FAILED),
+    cqRingSize_(0),
+    sqes_((struct io_uring_sqe*)MAP_FAILED),
+    sqesSize_(0),
+    sqeTail_(0),
+    bufRing_((struct io_uring_buf_ring*)MAP_FAILED),
+    recvBuffers_((char*)MAP_FAILED),
+    bufRingTail_(0),
+    wakeupFd_(-1),
+    wakeupValue_(0),
+    listenHandle_(INVALID_SOCKET),
+    isAcceptSuspended_(false),
+    lastAcceptErrorTicks_(0)
+{
+    createRing();
+    createBufferRing();
+    createWakeupFd();
+}
+
+IoUringObject::~IoUringObject()
+{
+    // 关闭 io_uring 时内核会取消全部未完成的操作
+    destroyWakeupFd();
+    destroyRing();
+    destroyBufferRing();
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 判断运行中的内核是否支持本类所需的 io_uring 功能 (只在首次调用时检测)
+//-----------------------------------------------------------------------------
+bool IoUringObject::isSupported()
+{
+    static bool s_supported = checkSupport();
+    return s_supported;
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 执行一次轮循 (提交本轮填写的操作，等待并处理完成事件)
+//-----------------------------------------------------------------------------
+void IoUringObject::poll()
+{
+    int timeout = eventLoop_->calcLoopWaitTimeout();
+
+    int waitTimeout = eventLoop_->beforeLoopWait(timeout);
+    submitAndWait(waitTimeout);
+    eventLoop_->afterLoopWait(hasCompletions());
+
+    if (timeout != TIMEOUT_INFINITE)
+        eventLoop_->processExpiredTimers();
+
+    processCompletions();
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 唤醒正在阻塞的 Poll() 函数
+// 备注: 重复唤醒的合并由 EventLoop::tryMarkWakeupPending() 负责。
+//-----------------------------------------------------------------------------
+void IoUringObject::wakeup()
+{
+    UINT64 val = 1;
+    ::write(wakeupFd_, &val, sizeof(val));
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 在连接上开始多发接收
+// 备注: 每收到一段数据产生一个 OT_RECV 完成事件，直至出错、对方关闭连接、提供缓冲
+//       区耗尽 (-ENOBUFS) 或被取消，此时事件的 hasMore 为 false。
+//-----------------------------------------------------------------------------
+void IoUringObject::postRecv(BaseTcpConnection *connection)
+{
+    struct io_uring_sqe *sqe = getSqe();
+    sqe->opcode = IORING_OP_RECV;
+    sqe->fd = connection->getSocket().getHandle();
+    sqe->ioprio = IORING_RECV_MULTISHOT;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = RECV_BUFFER_GROUP;
+    sqe->user_data = makeUserData(connection, OT_RECV);
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 在连接上提交一个聚集发送操作
+// 备注:
+//   1. msg 及其引用的数据在操作完成之前必须保持有效且不可移动。
+//   2. 带有 MSG_WAITALL 标志，内核会持续发送直至全部发出或出错，然后才产生完成事件。
+//-----------------------------------------------------------------------------
+void IoUringObject::postSend(BaseTcpConnection *connection, const struct msghdr *msg)
+{
+    struct io_uring_sqe *sqe = getSqe();
+    sqe->opcode = IORING_OP_SENDMSG;
+    sqe->fd = connection->getSocket().getHandle();
+    sqe->addr = (UINT64)(size_t)msg;
+    sqe->len = 1;
+    sqe->msg_flags = MSG_NOSIGNAL | MSG_WAITALL;
+    sqe->user_data = makeUserData(connection, OT_SEND);
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 等待连接可发送 (单次)
+//-----------------------------------------------------------------------------
+void IoUringObject::postPollSend(BaseTcpConnection *connection)
+{
+    struct io_uring_sqe *sqe = getSqe();
+    sqe->opcode = IORING_OP_POLL_ADD;
+    sqe->fd = connection->getSocket().getHandle();
+    sqe->poll32_events = POLLOUT;
+    sqe->user_data = makeUserData(connection, OT_POLL_SEND);
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 等待连接上的非阻塞 connect() 完成 (套接字可写或出错)
+//-----------------------------------------------------------------------------
+void IoUringObject::postPollConnect(BaseTcpConnection *connection)
+{
+    struct io_uring_sqe *sqe = getSqe();
+    sqe->opcode = IORING_OP_POLL_ADD;
+    sqe->fd = connection->getSocket().getHandle();
+    sqe->poll32_events = POLLOUT;
+    sqe->user_data = makeUserData(connection, OT_POLL_CONNECT);
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 取消 postPollConnect() 提交的等待
+// 备注: 被取消的等待仍会产生一个完成事件 (result 为 -ECANCELED)。
+//-----------------------------------------------------------------------------
+void IoUringObject::cancelPollConnect(BaseTcpConnection *connection)
+{
+    postCancel(makeUserData(connection, OT_POLL_CONNECT));
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 取消连接上的多发接收
+//-----------------------------------------------------------------------------
+void IoUringObject::cancelRecv(BaseTcpConnection *connection)
+{
+    postCancel(makeUserData(connection, OT_RECV));
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 取消连接上的全部操作
+//-----------------------------------------------------------------------------
+void IoUringObject::cancelAll(BaseTcpConnection *connection)
+{
+    struct io_uring_sqe *sqe = getSqe();
+    sqe->opcode = IORING_OP_ASYNC_CANCEL;
+    sqe->fd = connection->getSocket().getHandle();
+    sqe->cancel_flags = IORING_ASYNC_CANCEL_FD | IORING_ASYNC_CANCEL_ALL;
+    sqe->user_data = makeUserData(NULL, OT_CANCEL);
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 添加监听套接字，以多发接受的方式接受新连接，每个新连接调用一次 callback
+// 备注:
+//   1. 每个 IoUringObject 最多只有一个监听套接字。
+//   2. 须在事件循环线程中调用，须在事件循环停止后才能关闭监听套接字。
+//-----------------------------------------------------------------------------
+void IoUringObject::addListener(SOCKET handle, const AcceptEventCallback& callback)
+{
+    removeListener();
+
+    listenHandle_ = handle;
+    onAcceptEvent_ = callback;
+    isAcceptSuspended_ = false;
+    postAccept();
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 删除监听套接字
+// 备注: 取消完成之前已被接受的连接将被直接关闭。
+//-----------------------------------------------------------------------------
+void IoUringObject::removeListener()
+{
+    if (listenHandle_ != INVALID_SOCKET)
+    {
+        postCancel(makeUserData(this, OT_ACCEPT));
+        listenHandle_ = INVALID_SOCKET;
+        onAcceptEvent_.clear();
+    }
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 设置回调
+//-----------------------------------------------------------------------------
+void IoUringObject::setCompleteEventCallback(const CompleteEventCallback& callback)
+{
+    onCompleteEvent_ = callback;
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 检测内核对 io_uring 的支持
+// 备注:
+//   除了所需的操作码 (由 IORING_REGISTER_PROBE 探测) 之外，多发接收要求 6.0 以上
+//   的内核，而这无法通过探测得知，所以同时检查内核版本。
+//-----------------------------------------------------------------------------
+bool IoUringObject::checkSupport()
+{
+    struct utsname name;
+    int major = 0, minor = 0;
+    if (::uname(&name) != 0 || sscanf(name.release, "%d.%d", &major, &minor) != 2 ||
+        major < 6)
+        return false;
+
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    int ringFd = ioUringSetup(8, &params);
+    if (ringFd < 0)
+        return false;
+
+    bool result = (params.features & IORING_FEAT_EXT_ARG) && (params.features & IORING_FEAT_NODROP);
+
+    if (result)
+    {
+        const int OP_COUNT = 256;
+        Buffer probeBuffer(sizeof(struct io_uring_probe) + OP_COUNT * sizeof(struct io_uring_probe_op));
+        memset(probeBuffer.data(), 0, probeBuffer.getSize());
+        struct io_uring_probe *probe = (struct io_uring_probe*)probeBuffer.data();
+
+        const int REQUIRED_OPS[] = {
+            IORING_OP_READ, IORING_OP_RECV, IORING_OP_SENDMSG, IORING_OP_ACCEPT,
+            IORING_OP_POLL_ADD, IORING_OP_ASYNC_CANCEL
+        };
+
+        result = (ioUringRegister(ringFd, IORING_REGISTER_PROBE, probe, OP_COUNT) == 0);
+        for (size_t i = 0; result && i < sizeof(REQUIRED_OPS) / sizeof(REQUIRED_OPS[0]); ++i)
+        {
+            int op = REQUIRED_OPS[i];
+            result = (op <= probe->last_op && (probe->ops[op].flags & IO_URING_OP_SUPPORTED));
+        }
+    }
+
+    ::close(ringFd);
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+
+void IoUringObject::createRing()
+{
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    params.flags = IORING_SETUP_CQSIZE | IORING_SETUP_COOP_TASKRUN;
+    params.cq_entries = SQ_ENTRY_COUNT * 4;
+
+    // IORING_SETUP_COOP_TASKRUN 要求 5.19 以上的内核，不支持时去掉重试
+    ringFd_ = ioUringSetup(SQ_ENTRY_COUNT, &params);
+    if (ringFd_ < 0 && errno == EINVAL)
+    {
+        params.flags &= ~IORING_SETUP_COOP_TASKRUN;
+        ringFd_ = ioUringSetup(SQ_ENTRY_COUNT, &params);
+    }
+    if (ringFd_ < 0)
+    {
+        logger().writeFmt(SEM_CREATE_IO_URING_ERROR, errno);
+        iseThrowException(formatString(SEM_CREATE_IO_URING_ERROR, errno).c_str());
+    }
+
+    sqRingSize_ = params.sq_off.array + params.sq_entries * sizeof(UINT);
+    cqRingSize_ = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    bool singleMmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (singleMmap)
+        sqRingSize_ = cqRingSize_ = ise::max(sqRingSize_, cqRingSize_);
+
+    sqRingPtr_ = ::mmap(NULL, sqRingSize_, PROT_READ | PROT_WRITE,
+        MAP_SHARED | MAP_POPULATE, ringFd_, IORING_OFF_SQ_RING);
+    cqRingPtr_ = singleMmap ? sqRingPtr_ : ::mmap(NULL, cqRingSize_, PROT_READ | PROT_WRITE,
+        MAP_SHARED | MAP_POPULATE, ringFd_, IORING_OFF_CQ_RING);
+    sqesSize_ = params.sq_entries * sizeof(struct io_uring_sqe);
+    sqes_ = (struct io_uring_sqe*)::mmap(NULL, sqesSize_, PROT_READ | PROT_WRITE,
+        MAP_SHARED | MAP_POPULATE, ringFd_, IORING_OFF_SQES);
+
+    if (sqRingPtr_ == MAP_FAILED || cqRingPtr_ == MAP_FAILED || sqes_ == MAP_FAILED)
+    {
+        int errorCode = errno;
+        destroyRing();
+        logger().writeFmt(SEM_CREATE_IO_URING_ERROR, errorCode);
+        iseThrowException(formatString(SEM_CREATE_IO_URING_ERROR, errorCode).c_str());
+    }
+
+    char *sqRing = (char*)sqRingPtr_;
+    sqHead_ = (UINT*)(sqRing + params.sq_off.head);
+    sqTail_ = (UINT*)(sqRing + params.sq_off.tail);
+    sqMask_ = *(UINT*)(sqRing + params.sq_off.ring_mask);
+    sqEntries_ = params.sq_entries;
+    sqeTail_ = *sqTail_;
+
+    // 提交队列项与索引数组一一对应，此后直接按队尾位置填写提交队列项
+    UINT *sqArray = (UINT*)(sqRing + params.sq_off.array);
+    for (UINT i = 0; i < sqEntries_; ++i)
+        sqArray[i] = i;
+
+    char *cqRing = (char*)cqRingPtr_;
+    cqHead_ = (UINT*)(cqRing + params.cq_off.head);
+    cqTail_ = (UINT*)(cqRing + params.cq_off.tail);
+    cqMask_ = *(UINT*)(cqRing + params.cq_off.ring_mask);
+    cqes_ = (struct io_uring_cqe*)(cqRing + params.cq_off.cqes);
+}
+
+//-----------------------------------------------------------------------------
+
+void IoUringObject::destroyRing()
+{
+    if (sqes_ != MAP_FAILED)
+        ::munmap(sqes_, sqesSize_);
+    if (cqRingPtr_ != MAP_FAILED && cqRingPtr_ != sqRingPtr_)
+        ::munmap(cqRingPtr_, cqRingSize_);
+    if (sqRingPtr_ != MAP_FAILED)
+        ::munmap(sqRingPtr_, sqRingSize_);
+    sqes_ = (struct io_uring_sqe*)MAP_FAILED;
+    sqRingPtr_ = cqRingPtr_ = MAP_FAILED;
+
+    if (ringFd_ >= 0)
+    {
+        ::close(ringFd_);
+        ringFd_ = -1;
+    }
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 创建提供缓冲区环，并向内核注册
+//-----------------------------------------------------------------------------
+void IoUringObject::createBufferRing()
+{
+    size_t ringSize = RECV_BUFFER_COUNT * sizeof(struct io_uring_buf);
+    size_t buffersSize = (size_t)RECV_BUFFER_COUNT * RECV_BUFFER_SIZE;
+
+    // 环须按页对齐，mmap 满足此要求
+    bufRing_ = (struct io_uring_buf_ring*)::mmap(NULL, ringSize, PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    recvBuffers_ = (char*)::mmap(NULL, buffersSize, PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+    struct io_uring_buf_reg reg;
+    memset(&reg, 0, sizeof(reg));
+    reg.ring_addr = (UINT64)(size_t)bufRing_;
+    reg.ring_entries = RECV_BUFFER_COUNT;
+    reg.bgid = RECV_BUFFER_GROUP;
+
+    if (bufRing_ == MAP_FAILED || recvBuffers_ == MAP_FAILED ||
+        ioUringRegister(ringFd_, IORING_REGISTER_PBUF_RING, &reg, 1) != 0)
+    {
+        int errorCode = errno;
+        destroyBufferRing();
+        destroyRing();
+        logger().writeFmt(SEM_CREATE_IO_URING_ERROR, errorCode);
+        iseThrowException(formatString(SEM_CREATE_IO_URING_ERROR, errorCode).c_str());
+    }
+
+    bufRingTail_ = 0;
+    for (int i = 0; i < RECV_BUFFER_COUNT; ++i)
+        recycleRecvBuffer(i);
+}
+
+//-----------------------------------------------------------------------------
+
+void IoUringObject::destroyBufferRing()
+{
+    // 关闭 io_uring 时内核自动注销提供缓冲区环
+    if (bufRing_ != MAP_FAILED)
+        ::munmap(bufRing_, RECV_BUFFER_COUNT * sizeof(struct io_uring_buf));
+    if (recvBuffers_ != MAP_FAILED)
+        ::munmap(recvBuffers_, (size_t)RECV_BUFFER_COUNT * RECV_BUFFER_SIZE);
+    bufRing_ = (struct io_uring_buf_ring*)MAP_FAILED;
+    recvBuffers_ = (char*)MAP_FAILED;
+}
+
+//-----------------------------------------------------------------------------
+
+void IoUringObject::createWakeupFd()
+{
+    // 由 io_uring 读取 eventfd，读取完成即表示被唤醒，不必再调用 read()
+    wakeupFd_ = ::eventfd(0, EFD_CLOEXEC);
+    if (wakeupFd_ >= 0)
+        postWakeupRead();
+    else
+        logger().writeStr(SEM_CREATE_EVENTFD_ERROR);
+}
+
+//-----------------------------------------------------------------------------
+
+void IoUringObject::destroyWakeupFd()
+{
+    if (wakeupFd_ >= 0)
+    {
+        ::close(wakeupFd_);
+        wakeupFd_ = -1;
+    }
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 取得一个空闲的提交队列项
+// 备注: 提交队列已满时先将已填写的项提交给内核。
+//-----------------------------------------------------------------------------
+struct io_uring_sqe* IoUringObject::getSqe()
+{
+    UINT head = __atomic_load_n(sqHead_, __ATOMIC_ACQUIRE);
+    if (sqeTail_ - head >= sqEntries_)
+    {
+        enter(sqeTail_ - head, 0, 0, NULL, 0);
+        head = __atomic_load_n(sqHead_, __ATOMIC_ACQUIRE);
+    }
+
+    struct io_uring_sqe *sqe = &sqes_[sqeTail_ & sqMask_];
+    ++sqeTail_;
+    memset(sqe, 0, sizeof(*sqe));
+    return sqe;
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 公布已填写的提交队列项，并调用 io_uring_enter()
+//-----------------------------------------------------------------------------
+int IoUringObject::enter(UINT submitCount, UINT waitCount, UINT flags, void *arg, size_t argSize)
+{
+    __atomic_store_n(sqTail_, sqeTail_, __ATOMIC_RELEASE);
+
+    int result = ioUringEnter(ringFd_, submitCount, waitCount, flags, arg, argSize);
+    enterCount_.increment();
+    if (result > 0)
+        submitCount_.getAndAdd(result);
+
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 提交本轮填写的全部操作，并等待完成事件 (timeout 为毫秒)
+// 备注: 即使不等待也要调用 io_uring_enter()，以便内核投递已完成操作的完成事件。
+//-----------------------------------------------------------------------------
+void IoUringObject::submitAndWait(int timeout)
+{
+    UINT submitCount = sqeTail_ - __atomic_load_n(sqHead_, __ATOMIC_ACQUIRE);
+    UINT waitCount = 1;
+    UINT flags = IORING_ENTER_GETEVENTS;
+    struct __kernel_timespec ts;
+    struct io_uring_getevents_arg arg;
+    void *argPtr = NULL;
+    size_t argSize = 0;
+
+    if (timeout == 0 || hasCompletions())
+        waitCount = 0;
+    else if (timeout != TIMEOUT_INFINITE)
+    {
+        ts.tv_sec = timeout / 1000;
+        ts.tv_nsec = (long long)(timeout % 1000) * 1000000;
+        memset(&arg, 0, sizeof(arg));
+        arg.ts = (UINT64)(size_t)&ts;
+        flags |= IORING_ENTER_EXT_ARG;
+        argPtr = &arg;
+        argSize = sizeof(arg);
+    }
+
+    if (enter(submitCount, waitCount, flags, argPtr, argSize) < 0)
+    {
+        int errorCode = errno;
+        if (errorCode != ETIME && errorCode != EINTR && errorCode != EBUSY && errorCode != EAGAIN)
+            logger().writeFmt(SEM_IO_URING_ENTER_ERROR, errorCode);
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+bool IoUringObject::hasCompletions() const
+{
+    return *cqHead_ != __atomic_load_n(cqTail_, __ATOMIC_ACQUIRE);
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 处理完成队列中的完成事件
+// 备注: 只处理进入时已有的事件，处理期间新到的事件留待下一轮循环。
+//-----------------------------------------------------------------------------
+void IoUringObject::processCompletions()
+{
+    UINT head = *cqHead_;
+    UINT tail = __atomic_load_n(cqTail_, __ATOMIC_ACQUIRE);
+
+    while (head != tail)
+    {
+        struct io_uring_cqe *cqe = &cqes_[head & cqMask_];
+        UINT64 userData = cqe->user_data;
+        int result = cqe->res;
+        UINT flags = cqe->flags;
+
+        // 先归还完成队列项，回调中可能会提交新的操作
+        ++head;
+        __atomic_store_n(cqHead_, head, __ATOMIC_RELEASE);
+
+        processCompleteEvent(userData, result, flags);
+    }
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 处理一个完成事件
+//-----------------------------------------------------------------------------
+void IoUringObject::processCompleteEvent(UINT64 userData, int result, UINT flags)
+{
+    OP_TYPE opType = (OP_TYPE)(userData & OP_TYPE_MASK);
+    void *ptr = (void*)(size_t)(userData & ~OP_TYPE_MASK);
+    bool hasMore = (flags & IORING_CQE_F_MORE) != 0;
+
+    switch (opType)
+    {
+    case OT_WAKEUP:
+        // 先消耗唤醒再清除标志，此后的 wakeup() 请求会重新唤醒
+        if (wakeupFd_ >= 0)
+            postWakeupRead();
+        eventLoop_->clearWakeupPending();
+        break;
+
+    case OT_ACCEPT:
+        if (result >= 0)
+        {
+            if (onAcceptEvent_)
+                onAcceptEvent_((SOCKET)result);
+            else
+                ::close(result);
+        }
+        else if (result != -ECANCELED && result != -EAGAIN && result != -EINTR &&
+            result != -ECONNABORTED)
+        {
+            UINT64 nowTicks = Clock::getTicks();
+            if (lastAcceptErrorTicks_ == 0 ||
+                nowTicks - lastAcceptErrorTicks_ >= ACCEPT_ERROR_LOG_INTERVAL)
+            {
+                lastAcceptErrorTicks_ = nowTicks;
+                logger().writeFmt(SEM_TCP_ACCEPT_ERROR, -result);
+            }
+        }
+
+        if (!hasMore && listenHandle_ != INVALID_SOCKET && result != -ECANCELED)
+        {
+            // 文件描述符耗尽时立即重新投递只会不断失败，须暂停一段时间后再投递
+            if (result == -EMFILE || result == -ENFILE)
+            {
+                isAcceptSuspended_ = true;
+                eventLoop_->executeAfter(ACCEPT_SUSPEND_TIME,
+                    boost::bind(&IoUringObject::resumeAccept, this));
+            }
+            else
+                postAccept();
+        }
+        break;
+
+    case OT_CANCEL:
+        break;
+
+    default:
+    {
+        CompleteEvent event;
+        event.opType = opType;
+        event.result = result;
+        event.hasMore = hasMore;
+        event.data = NULL;
+
+        int bufferId = -1;
+        if (flags & IORING_CQE_F_BUFFER)
+        {
+            bufferId = (int)(flags >> IORING_CQE_BUFFER_SHIFT);
+            event.data = recvBuffers_ + (size_t)bufferId * RECV_BUFFER_SIZE;
+        }
+
+        if (onCompleteEvent_)
+            onCompleteEvent_((BaseTcpConnection*)ptr, event);
+
+        if (bufferId >= 0)
+            recycleRecvBuffer(bufferId);
+        break;
+    }
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+void IoUringObject::postWakeupRead()
+{
+    struct io_uring_sqe *sqe = getSqe();
+    sqe->opcode = IORING_OP_READ;
+    sqe->fd = wakeupFd_;
+    sqe->addr = (UINT64)(size_t)&wakeupValue_;
+    sqe->len = sizeof(wakeupValue_);
+    sqe->user_data = makeUserData(NULL, OT_WAKEUP);
+}
+
+//-----------------------------------------------------------------------------
+
+void IoUringObject::postAccept()
+{
+    struct io_uring_sqe *sqe = getSqe();
+    sqe->opcode = IORING_OP_ACCEPT;
+    sqe->fd = listenHandle_;
+    sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+    sqe->accept_flags = SOCK_NONBLOCK | SOCK_CLOEXEC;
+    sqe->user_data = makeUserData(this, OT_ACCEPT);
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 恢复因文件描述符耗尽而暂停的接受连接
+//-----------------------------------------------------------------------------
+void IoUringObject::resumeAccept()
+{
+    if (!isAcceptSuspended_) return;
+
+    isAcceptSuspended_ = false;
+    if (listenHandle_ != INVALID_SOCKET)
+        postAccept();
+}
+
+//-----------------------------------------------------------------------------
+
+void IoUringObject::postCancel(UINT64 userData)
+{
+    struct io_uring_sqe *sqe = getSqe();
+    sqe->opcode = IORING_OP_ASYNC_CANCEL;
+    sqe->fd = -1;
+    sqe->addr = userData;
+    sqe->user_data = makeUserData(NULL, OT_CANCEL);
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 将缓冲区归还给提供缓冲区环
+//-----------------------------------------------------------------------------
+void IoUringObject::recycleRecvBuffer(int bufferId)
+{
+    // 注意: 以 C++ 编译时 bufRing_->bufs 的偏移不为 0 (__DECLARE_FLEX_ARRAY 的空结构体占 1 字节)，
+    // 所以直接将环视为 io_uring_buf 数组
+    struct io_uring_buf *buf = (struct io_uring_buf*)bufRing_ + (bufRingTail_ & (RECV_BUFFER_COUNT - 1));
+    buf->addr = (UINT64)(size_t)(recvBuffers_ + (size_t)bufferId * RECV_BUFFER_SIZE);
+    buf->len = RECV_BUFFER_SIZE;
+    buf->bid = (UINT16)bufferId;
+    ++bufRingTail_;
+    __atomic_store_n(&bufRing_->tail, bufRingTail_, __ATOMIC_RELEASE);
+}
+
+//-----------------------------------------------------------------------------
+
+UINT64 IoUringObject::makeUserData(void *ptr, OP_TYPE opType)
+{
+    ISE_ASSERT(((UINT64)(size_t)ptr & OP_TYPE_MASK) == 0);
+    return (UINT64)(size_t)ptr | (UINT64)opType;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+#endif  /* ifdef ISE_IO_URING */
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // namespace ise
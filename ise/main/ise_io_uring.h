@@ -0,0 +1,198 @@
+/****************************************************************************\
+*                                                                            *
+*  ISE (Iris Server Engine) Project                                          *
+*  http://github.com/haoxingeng/ise                                          *
+*                                                                            *
+*  Copyright 2013 HaoXinGeng (haoxingeng@gmail.com)                          *
+*  All rights reserved.                                                      *
+*                                                                            *
+*  Licensed under the Apache License, Version 2.0 (the "License");           *
+*  you may not use this file except in compliance with the License.          *
+*  You may obtain a copy of the License at                                   *
+*                                                                            *
+*      http://www.apache.org/licenses/LICENSE-2.0                            *
+*                                                                            *
+*  Unless required by applicable law or agreed to in writing, software       *
+*  distributed under the License is distributed on an "AS IS" BASIS,         *
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+*  See the License for the specific language governing permissions and       *
+*  limitations under the License.                                            *
+*                                                                            *
+\****************************************************************************/
+
+///////////////////////////////////////////////////////////////////////////////
+// ise_io_uring.h
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef _ISE_IO_URING_H_
+#define _ISE_IO_URING_H_
+
+#include "ise/main/ise_options.h"
+#include "ise/main/ise_classes.h"
+#include "ise/main/ise_socket.h"
+#include "ise/main/ise_exceptions.h"
+
+#ifdef ISE_IO_URING
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+
+// <linux/io_uring.h> 会经由 <linux/fs.h> 引入 BLOCK_SIZE 等宏，故只在 ise_io_uring.cpp 中包含
+struct io_uring_sqe;
+struct io_uring_cqe;
+struct io_uring_buf_ring;
+#endif
+
+namespace ise
+{
+
+///////////////////////////////////////////////////////////////////////////////
+// classes
+
+#ifdef ISE_IO_URING
+class IoUringObject;
+#endif
+
+// 提前声明
+class EventLoop;
+
+///////////////////////////////////////////////////////////////////////////////
+
+#ifdef ISE_IO_URING
+
+///////////////////////////////////////////////////////////////////////////////
+// class IoUringObject - Linux io_uring 功能封装
+//
+// 说明:
+// 1. 与 EpollObject 的 "就绪通知" 不同，io_uring 是 "提交操作、等待完成" 的模式，
+//    与 Windows 下的 IOCP 相同。收发操作的完成通过 CompleteEventCallback 回调。
+// 2. 各种操作只是填入提交队列 (SQ)，在 poll() 中与等待完成事件合并为一次
+//    io_uring_enter() 系统调用提交 (批量提交)。
+// 3. 接收使用多发接收 (multishot recv)：提交一次即持续接收，数据存放在向内核注册的
+//    提供缓冲区环 (provided buffer ring) 中，回调返回后缓冲区立即归还给内核。
+// 4. 除 wakeup() 外，全部函数只能在事件循环线程中调用。
+
+class IoUringObject : boost::noncopyable
+{
+public:
+    enum { SQ_ENTRY_COUNT = 1024 };          // 提交队列的长度 (完成队列为其 4 倍)
+    enum { RECV_BUFFER_SIZE = 1024*16 };     // 提供缓冲区环中每个缓冲区的字节数
+    enum { RECV_BUFFER_COUNT = 256 };        // 提供缓冲区环中的缓冲区个数 (须为 2 的幂)
+    enum { RECV_BUFFER_GROUP = 0 };          // 提供缓冲区环的组号
+    enum { ACCEPT_SUSPEND_TIME = 100 };      // 文件描述符耗尽时暂停接受连接的时长 (毫秒)
+    enum { ACCEPT_ERROR_LOG_INTERVAL = 1000 };  // accept 错误日志的最小间隔 (毫秒)
+
+    enum OP_TYPE
+    {
+        OT_WAKEUP      = 0,    // 读取唤醒用的 eventfd
+        OT_ACCEPT      = 1,    // 多发接受连接 (multishot accept)
+        OT_RECV        = 2,    // 多发接收 (multishot recv)
+        OT_SEND        = 3,    // 聚集发送 (sendmsg)
+        OT_POLL_SEND   = 4,    // 等待可发送 (用于 sendfile)
+        OT_CANCEL      = 5,    // 取消操作
+        OT_POLL_CONNECT = 6,   // 等待非阻塞连接完成 (用于 TcpConnector)
+    };
+
+    // 操作完成事件
+    struct CompleteEvent
+    {
+        OP_TYPE opType;
+        int result;            // 操作结果 (>= 0 表示成功，< 0 为 -errno)
+        bool hasMore;          // 多发操作是否仍然有效 (为 false 表示该操作已结束)
+        const char *data;      // OT_RECV: 收到的数据 (位于提供缓冲区中，仅在回调期间有效)
+    };
+
+    typedef boost::function<void (BaseTcpConnection *connection, const CompleteEvent& event)> CompleteEventCallback;
+    typedef boost::function<void (SOCKET acceptHandle)> AcceptEventCallback;
+
+public:
+    IoUringObject(EventLoop *eventLoop);
+    ~IoUringObject();
+
+    static bool isSupported();
+
+    void poll();
+    void wakeup();
+
+    void postRecv(BaseTcpConnection *connection);
+    void postSend(BaseTcpConnection *connection, const struct msghdr *msg);
+    void postPollSend(BaseTcpConnection *connection);
+    void postPollConnect(BaseTcpConnection *connection);
+    void cancelPollConnect(BaseTcpConnection *connection);
+    void cancelRecv(BaseTcpConnection *connection);
+    void cancelAll(BaseTcpConnection *connection);
+
+    void addListener(SOCKET handle, const AcceptEventCallback& callback);
+    void removeListener();
+
+    void setCompleteEventCallback(const CompleteEventCallback& callback);
+
+    // 以下统计可在任意线程中读取
+    INT64 getEnterCount() const { return enterCount_.get(); }
+    INT64 getSubmitCount() const { return submitCount_.get(); }
+
+private:
+    static bool checkSupport();
+
+    void createRing();
+    void destroyRing();
+    void createBufferRing();
+    void destroyBufferRing();
+    void createWakeupFd();
+    void destroyWakeupFd();
+
+    struct io_uring_sqe* getSqe();
+    int enter(UINT submitCount, UINT waitCount, UINT flags, void *arg, size_t argSize);
+    void submitAndWait(int timeout);
+    bool hasCompletions() const;
+    void processCompletions();
+    void processCompleteEvent(UINT64 userData, int result, UINT flags);
+
+    void postWakeupRead();
+    void postAccept();
+    void resumeAccept();
+    void postCancel(UINT64 userData);
+    void recycleRecvBuffer(int bufferId);
+
+    static UINT64 makeUserData(void *ptr, OP_TYPE opType);
+
+private:
+    EventLoop *eventLoop_;        // 所属 EventLoop
+    int ringFd_;                  // io_uring 的文件描述符
+    void *sqRingPtr_;             // 提交队列环的映射地址
+    size_t sqRingSize_;
+    void *cqRingPtr_;             // 完成队列环的映射地址 (与 sqRingPtr_ 可能相同)
+    size_t cqRingSize_;
+    struct io_uring_sqe *sqes_;   // 提交队列项数组
+    size_t sqesSize_;
+    UINT *sqHead_;                // 以下指针均指向与内核共享的环
+    UINT *sqTail_;
+    UINT sqMask_;
+    UINT sqEntries_;
+    UINT sqeTail_;                // 本地的提交队列尾 (已填写但尚未提交的项位于 *sqTail_ 之后)
+    UINT *cqHead_;
+    UINT *cqTail_;
+    UINT cqMask_;
+    struct io_uring_cqe *cqes_;
+    struct io_uring_buf_ring *bufRing_;  // 提供缓冲区环
+    char *recvBuffers_;           // 提供缓冲区环中各缓冲区的存储空间
+    UINT16 bufRingTail_;
+    int wakeupFd_;                // 用于唤醒 io_uring_enter() 的 eventfd
+    UINT64 wakeupValue_;          // 读取 eventfd 的缓冲区
+    SOCKET listenHandle_;         // 监听套接字 (INVALID_SOCKET 表示无)
+    bool isAcceptSuspended_;      // 是否已暂停接受连接 (等待定时器恢复)
+    UINT64 lastAcceptErrorTicks_; // 最近一次记录 accept 错误日志的时刻
+    CompleteEventCallback onCompleteEvent_;
+    AcceptEventCallback onAcceptEvent_;
+    mutable AtomicInt64 enterCount_;  // io_uring_enter() 的调用次数
+    mutable AtomicInt64 submitCount_; // 已提交的操作数
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+#endif  /* ifdef ISE_IO_URING */
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // namespace ise
+
+#endif // _ISE_IO_URING_H_
@@ -285,8 +285,10 @@ void IocpObject::work()
         int timeout = eventLoop_->calcLoopWaitTimeout();
 
         // 等待事件
+        int waitTimeout = eventLoop_->beforeLoopWait(timeout);
         BOOL ret = ::GetQueuedCompletionStatus(iocpHandle_, &bytesTransferred, &nTemp,
-            (LPOVERLAPPED*)&overlappedPtr, timeout);
+            (LPOVERLAPPED*)&overlappedPtr, waitTimeout);
+        eventLoop_->afterLoopWait(overlappedPtr != NULL);
 
         // 处理定时器事件
         if (timeout != TIMEOUT_INFINITE)
@@ -326,7 +328,12 @@ void IocpObject::work()
             invokeCallback(*taskPtr);
         }
         else
+        {
+            // 唤醒事件 (见 wakeup())，超时则 ret 为 FALSE
+            if (ret)
+                eventLoop_->clearWakeupPending();
             break;
+        }
     }
 }
 
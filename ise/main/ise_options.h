@@ -83,6 +83,17 @@
 // 是否使用 "非标准STL"
 //#define ISE_USING_EXT_STL
 
+// 是否编译 io_uring 后端 (仅 Linux，运行时内核不支持时自动回退到 EPoll)
+// 内核头文件须不早于 6.0 (多发接收等功能)
+#if defined(ISE_LINUX) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>) && __has_include(<linux/version.h>)
+#include <linux/version.h>
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(6,0,0)
+#define ISE_IO_URING
+#endif
+#endif
+#endif
+
 ///////////////////////////////////////////////////////////////////////////////
 
 #endif // _ISE_OPTIONS_H_
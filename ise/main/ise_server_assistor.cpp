@@ -161,6 +161,7 @@ void AssistorServer::open()
         {
             AssistorThread *thread;
             thread = new AssistorThread(&threadPool_, i);
+            thread->setName(formatString("ise-assist-%d", i));
             thread->run();
         }
 
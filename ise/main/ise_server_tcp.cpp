@@ -29,11 +29,50 @@
 #include "ise/main/ise_err_msgs.h"
 #include "ise/main/ise_application.h"
 
+#if defined(ISE_COMPILER_GCC) && defined(__SSE2__)
+#define ISE_SPLITTER_USE_SSE2
+#include <emmintrin.h>
+#endif
+
 using namespace ise;
 
 namespace ise
 {
 
+///////////////////////////////////////////////////////////////////////////////
+// 分包器模板
+
+//-----------------------------------------------------------------------------
+// 描述: 在 [begin, end) 中查找第一个 '\r' 或 '\n'
+// 返回: 找到时返回其位置，否则返回 NULL
+// 备注: 支持 SSE2 时每次比较 16 个字节。
+//-----------------------------------------------------------------------------
+const char* findLineDelimiter(const char *begin, const char *end)
+{
+    const char *p = begin;
+
+#ifdef ISE_SPLITTER_USE_SSE2
+    const __m128i cr = _mm_set1_epi8('\r');
+    const __m128i lf = _mm_set1_epi8('\n');
+
+    while (end - p >= 16)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i*)p);
+        int mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(v, cr), _mm_cmpeq_epi8(v, lf)));
+        if (mask != 0)
+            return p + __builtin_ctz(mask);
+        p += 16;
+    }
+#endif
+
+    for (; p < end; ++p)
+    {
+        if (*p == '\r' || *p == '\n')
+            return p;
+    }
+    return NULL;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 // 预定义分包器
 
@@ -44,58 +83,379 @@ void bytePacketSplitter(const char *data, int bytes, int& retrieveBytes)
 
 void linePacketSplitter(const char *data, int bytes, int& retrieveBytes)
 {
-    retrieveBytes = 0;
+    LineSplitter()(data, bytes, retrieveBytes);
+}
+
+//-----------------------------------------------------------------------------
+
+void nullTerminatedPacketSplitter(const char *data, int bytes, int& retrieveBytes)
+{
+    DelimiterSplitter<'\0'>()(data, bytes, retrieveBytes);
+}
+
+//-----------------------------------------------------------------------------
+
+void anyPacketSplitter(const char *data, int bytes, int& retrieveBytes)
+{
+    retrieveBytes = (bytes > 0 ? bytes : 0);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// class IoBufferPool
+
+IoBufferPool::IoBufferPool()
+{
+    for (int i = 0; i < CLASS_COUNT; ++i)
+    {
+        freeLists_[i] = NULL;
+        classBytes_[i] = 0;
+    }
+}
 
-    const char *p = data;
-    int i = 0;
-    while (i < bytes)
+IoBufferPool::~IoBufferPool()
+{
+    for (int i = 0; i < CLASS_COUNT; ++i)
     {
-        if (*p == '\r' || *p == '\n')
+        while (freeLists_[i] != NULL)
         {
-            retrieveBytes = i + 1;
-            if (i < bytes - 1)
-            {
-                char next = *(p+1);
-                if ((next == '\r' || next == '\n') && next != *p)
-                    ++retrieveBytes;
-            }
-            break;
+            FreeChunk *chunk = freeLists_[i];
+            freeLists_[i] = chunk->next;
+            free(chunk);
         }
 
-        ++p;
-        ++i;
+        pooledBytes_.getAndAdd(-classBytes_[i]);
+        TcpInspectInfo::instance().ioBufferPooledBytes.getAndAdd(-classBytes_[i]);
+        classBytes_[i] = 0;
+    }
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 取得一个尺寸为 chunkSize 的缓存块 (优先复用池中的空闲块)
+// 参数:
+//   chunkSize - 块尺寸，须由 calcChunkSize() 计算得出
+//-----------------------------------------------------------------------------
+char* IoBufferPool::allocChunk(int chunkSize)
+{
+    int index = getClassIndex(chunkSize);
+    if (index >= 0 && freeLists_[index] != NULL)
+    {
+        FreeChunk *chunk = freeLists_[index];
+        freeLists_[index] = chunk->next;
+        classBytes_[index] -= chunkSize;
+        pooledBytes_.getAndAdd(-chunkSize);
+        TcpInspectInfo::instance().ioBufferPooledBytes.getAndAdd(-chunkSize);
+        return (char*)chunk;
+    }
+
+    return allocHeapChunk(chunkSize);
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 归还缓存块。池中该级空闲块已达上限或块过大时，直接归还给堆。
+//-----------------------------------------------------------------------------
+void IoBufferPool::freeChunk(char *chunk, int chunkSize)
+{
+    int index = getClassIndex(chunkSize);
+    if (index >= 0 && classBytes_[index] + chunkSize <= MAX_POOLED_BYTES_PER_CLASS)
+    {
+        FreeChunk *freeChunk = (FreeChunk*)chunk;
+        freeChunk->next = freeLists_[index];
+        freeLists_[index] = freeChunk;
+        classBytes_[index] += chunkSize;
+        pooledBytes_.getAndAdd(chunkSize);
+        TcpInspectInfo::instance().ioBufferPooledBytes.getAndAdd(chunkSize);
     }
+    else
+        freeHeapChunk(chunk, chunkSize);
 }
 
 //-----------------------------------------------------------------------------
+// 描述: 计算能容纳 minSize 个字节的缓存块尺寸 (不小于 minSize 的 2 的整数次幂)
+//-----------------------------------------------------------------------------
+int IoBufferPool::calcChunkSize(int minSize)
+{
+    const int MAX_POWER_OF_TWO = 1 << 30;
+    if (minSize > MAX_POWER_OF_TWO) return minSize;
 
-void nullTerminatedPacketSplitter(const char *data, int bytes, int& retrieveBytes)
+    int result = MIN_CHUNK_SIZE;
+    while (result < minSize)
+        result <<= 1;
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 从堆中分配缓存块
+//-----------------------------------------------------------------------------
+char* IoBufferPool::allocHeapChunk(int chunkSize)
+{
+    char *result = (char*)malloc(chunkSize);
+    if (!result)
+        iseThrowMemoryException();
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 将缓存块归还给堆
+//-----------------------------------------------------------------------------
+void IoBufferPool::freeHeapChunk(char *chunk, int chunkSize)
+{
+    free(chunk);
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 返回块尺寸对应的缓存级别 (-1 表示不缓存此尺寸的块)
+//-----------------------------------------------------------------------------
+int IoBufferPool::getClassIndex(int chunkSize)
+{
+    if (chunkSize > MAX_POOLED_CHUNK_SIZE) return -1;
+
+    int index = 0;
+    while ((MIN_CHUNK_SIZE << index) < chunkSize)
+        ++index;
+    return ((MIN_CHUNK_SIZE << index) == chunkSize) ? index : -1;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// class TcpConnectionPool
+
+//-----------------------------------------------------------------------------
+// 描述: TcpConnectionPtr 的删除器: 只析构对象，内存随控制块一起释放
+//-----------------------------------------------------------------------------
+struct TcpConnectionPool::ConnectionDeleter
 {
-    const char DELIMITER = '\0';
+    void operator()(TcpConnection *connection) const
+    {
+        void *object = dynamic_cast<void*>(connection);
+        bool hasControlBlock = getHeader(object)->hasControlBlock;
+
+        connection->~TcpConnection();
+        if (!hasControlBlock)
+            TcpConnectionPool::deallocate(object);
+    }
+};
 
-    retrieveBytes = 0;
-    for (int i = 0; i < bytes; ++i)
+//-----------------------------------------------------------------------------
+// 描述: TcpConnectionPtr 控制块的分配器: 控制块存放在对象所在内存块的末尾，
+//       控制块释放时 (弱引用也已全部释放) 整块归还
+//-----------------------------------------------------------------------------
+template<typename T>
+class TcpConnectionPool::ControlBlockAllocator
+{
+public:
+    typedef T value_type;
+    typedef T* pointer;
+    typedef const T* const_pointer;
+    typedef T& reference;
+    typedef const T& const_reference;
+    typedef size_t size_type;
+    typedef ptrdiff_t difference_type;
+
+    template<typename U> struct rebind { typedef ControlBlockAllocator<U> other; };
+
+public:
+    explicit ControlBlockAllocator(void *object) : object_(object) {}
+    template<typename U>
+    ControlBlockAllocator(const ControlBlockAllocator<U>& other) : object_(other.object_) {}
+
+    T* allocate(size_t count)
     {
-        if (data[i] == DELIMITER)
+        BlockHeader *header = getHeader(object_);
+        if (count * sizeof(T) <= CONTROL_BLOCK_SIZE && !header->hasControlBlock)
         {
-            retrieveBytes = i + 1;
-            break;
+            header->hasControlBlock = true;
+            return (T*)getControlBlock();
         }
+        return (T*)::operator new(count * sizeof(T));
+    }
+
+    void deallocate(T *p, size_t count)
+    {
+        if ((void*)p == getControlBlock())
+            TcpConnectionPool::deallocate(object_);
+        else
+            ::operator delete(p);
+    }
+
+    bool operator == (const ControlBlockAllocator& rhs) const { return object_ == rhs.object_; }
+    bool operator != (const ControlBlockAllocator& rhs) const { return object_ != rhs.object_; }
+
+private:
+    void* getControlBlock() const { return (char*)object_ + getHeader(object_)->objectSize; }
+
+private:
+    void *object_;
+
+    template<typename U> friend class ControlBlockAllocator;
+};
+
+//-----------------------------------------------------------------------------
+
+TcpConnectionPool::TcpConnectionPool() :
+    freeList_(NULL)
+{
+#ifdef ISE_WINDOWS
+    objectCapacity_ = alignSize(sizeof(WinTcpConnection));
+#endif
+#ifdef ISE_LINUX
+    objectCapacity_ = alignSize(sizeof(LinuxTcpConnection));
+#endif
+
+    refCount_.set(1);
+}
+
+TcpConnectionPool::~TcpConnectionPool()
+{
+    while (freeList_ != NULL)
+    {
+        MpscQueue::Node *next = freeList_->next;
+        ::free(freeList_);
+        freeList_ = next;
+    }
+
+    MpscQueue::Node *node = returnedBlocks_.popAll();
+    while (node != NULL)
+    {
+        MpscQueue::Node *next = node->next;
+        ::free(node);
+        node = next;
     }
 }
 
 //-----------------------------------------------------------------------------
+// 描述: 创建一个池 (所属者持有一个引用)
+//-----------------------------------------------------------------------------
+TcpConnectionPool* TcpConnectionPool::create()
+{
+    return new TcpConnectionPool();
+}
 
-void anyPacketSplitter(const char *data, int bytes, int& retrieveBytes)
+//-----------------------------------------------------------------------------
+// 描述: 所属者释放池 (此后不可再从池中分配)
+//-----------------------------------------------------------------------------
+void TcpConnectionPool::release()
 {
-    retrieveBytes = (bytes > 0 ? bytes : 0);
+    releaseRef();
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 分配对象内存
+// 参数:
+//   pool       - 连接对象池，为 NULL 时直接从堆分配 (须在池的所属线程中调用)
+//   objectSize - 对象的字节数
+//-----------------------------------------------------------------------------
+void* TcpConnectionPool::allocate(TcpConnectionPool *pool, size_t objectSize)
+{
+    BlockHeader *header;
+
+    if (pool != NULL && alignSize(objectSize) <= pool->objectCapacity_)
+        header = pool->allocBlock();
+    else
+        header = allocHeapBlock(objectSize);
+
+    header->hasControlBlock = false;
+    return getObject(header);
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 释放对象内存
+//-----------------------------------------------------------------------------
+void TcpConnectionPool::deallocate(void *object)
+{
+    if (object == NULL) return;
+
+    BlockHeader *header = getHeader(object);
+    if (header->pool != NULL)
+        header->pool->freeBlock(header);
+    else
+        ::free(header);
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 为连接对象创建 TcpConnectionPtr
+// 备注:
+//   对象与控制块位于同一内存块中，相当于 allocate_shared()。对象在最后一个强引用
+//   释放时析构，内存块在最后一个弱引用释放时才归还。
+//-----------------------------------------------------------------------------
+TcpConnectionPtr TcpConnectionPool::makeConnectionPtr(TcpConnection *connection)
+{
+    return TcpConnectionPtr(connection, ConnectionDeleter(),
+        ControlBlockAllocator<TcpConnection>(dynamic_cast<void*>(connection)));
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 从池中取出一个空闲块，没有则从堆中分配 (仅所属线程调用)
+//-----------------------------------------------------------------------------
+TcpConnectionPool::BlockHeader* TcpConnectionPool::allocBlock()
+{
+    if (freeList_ == NULL)
+        freeList_ = returnedBlocks_.popAll();
+
+    BlockHeader *header;
+    if (freeList_ != NULL)
+    {
+        header = static_cast<BlockHeader*>(freeList_);
+        freeList_ = freeList_->next;
+        pooledCount_.decrement();
+    }
+    else
+    {
+        header = (BlockHeader*)::malloc(getHeaderSize() + objectCapacity_ + CONTROL_BLOCK_SIZE);
+        if (header == NULL) throw std::bad_alloc();
+    }
+
+    header->next = NULL;
+    header->pool = this;
+    header->objectSize = objectCapacity_;
+    refCount_.increment();
+    return header;
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 归还一个块 (可在任意线程中调用)
+//-----------------------------------------------------------------------------
+void TcpConnectionPool::freeBlock(BlockHeader *header)
+{
+    if (pooledCount_.get() < MAX_POOLED_COUNT)
+    {
+        pooledCount_.increment();
+        returnedBlocks_.push(header);
+    }
+    else
+        ::free(header);
+
+    releaseRef();
+}
+
+//-----------------------------------------------------------------------------
+
+void TcpConnectionPool::releaseRef()
+{
+    if (refCount_.decrement() == 0)
+        delete this;
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 直接从堆中分配一个块 (不归还给池)
+//-----------------------------------------------------------------------------
+TcpConnectionPool::BlockHeader* TcpConnectionPool::allocHeapBlock(size_t objectSize)
+{
+    size_t alignedSize = alignSize(objectSize);
+    BlockHeader *header = (BlockHeader*)::malloc(getHeaderSize() + alignedSize + CONTROL_BLOCK_SIZE);
+    if (header == NULL) throw std::bad_alloc();
+
+    header->next = NULL;
+    header->pool = NULL;
+    header->objectSize = alignedSize;
+    return header;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 // class IoBuffer
 
 IoBuffer::IoBuffer() :
-    buffer_(INITIAL_SIZE),
+    pool_(NULL),
+    buffer_(NULL),
+    size_(0),
     readerIndex_(0),
     writerIndex_(0)
 {
@@ -104,7 +464,13 @@ IoBuffer::IoBuffer() :
 
 IoBuffer::~IoBuffer()
 {
-    // nothing
+    // 连接对象可能在任意线程中析构，而缓存池仅限其事件循环线程访问，所以此处
+    // 直接将缓存块归还给堆。
+    if (buffer_ != NULL)
+    {
+        TcpInspectInfo::instance().ioBufferInUseBytes.getAndAdd(-size_);
+        IoBufferPool::freeHeapChunk(buffer_, size_);
+    }
 }
 
 //-----------------------------------------------------------------------------
@@ -154,6 +520,10 @@ void IoBuffer::retrieve(int bytes)
     {
         ISE_ASSERT(bytes <= getReadableBytes());
         readerIndex_ += bytes;
+
+        // 数据已全部读出，立即归还缓存块
+        if (readerIndex_ == writerIndex_)
+            releaseChunk();
     }
 }
 
@@ -175,19 +545,77 @@ void IoBuffer::retrieveAll(string& str)
 //-----------------------------------------------------------------------------
 void IoBuffer::retrieveAll()
 {
-    readerIndex_ = 0;
-    writerIndex_ = 0;
+    releaseChunk();
 }
 
 //-----------------------------------------------------------------------------
 
 void IoBuffer::swap(IoBuffer& rhs)
 {
-    buffer_.swap(rhs.buffer_);
+    std::swap(pool_, rhs.pool_);
+    std::swap(buffer_, rhs.buffer_);
+    std::swap(size_, rhs.size_);
     std::swap(readerIndex_, rhs.readerIndex_);
     std::swap(writerIndex_, rhs.writerIndex_);
 }
 
+#ifdef ISE_LINUX
+//-----------------------------------------------------------------------------
+// 描述: 从套接字 (非阻塞) 中读取数据并追加到缓存
+// 返回:
+//   < 0    - 读取过程发生了错误，或对方已关闭连接。
+//   >= 0   - 实际读取到的字节数 (0 表示暂无数据可读，即 EAGAIN)。
+// 备注:
+//   采用 readv 分散读: 先填满缓存尾部的可写空间，溢出部分暂存于栈上的额外缓冲区，
+//   再追加到缓存中。如此既避免了预先扩大缓存，又能一次系统调用读取尽量多的数据。
+//-----------------------------------------------------------------------------
+int IoBuffer::appendFromSocket(SOCKET handle)
+{
+    const int EXTRA_BUFFER_SIZE = 1024*64;
+    char extraBuf[EXTRA_BUFFER_SIZE];
+
+    if (buffer_ == NULL)
+    {
+        buffer_ = allocChunk(INITIAL_SIZE);
+        size_ = INITIAL_SIZE;
+    }
+
+    const int writableBytes = getWritableBytes();
+    struct iovec vec[2];
+    vec[0].iov_base = getWriterPtr();
+    vec[0].iov_len = writableBytes;
+    vec[1].iov_base = extraBuf;
+    vec[1].iov_len = EXTRA_BUFFER_SIZE;
+
+    int result;
+    do
+    {
+        result = (int)::readv(handle, vec, 2);
+    }
+    while (result < 0 && errno == EINTR);
+
+    if (result > 0)
+    {
+        if (result <= writableBytes)
+            writerIndex_ += result;
+        else
+        {
+            writerIndex_ = size_;
+            append(extraBuf, result - writableBytes);
+        }
+    }
+    else if (result == 0)
+        result = -1;   // 对方关闭了连接
+    else
+        result = (errno == EAGAIN || errno == EWOULDBLOCK) ? 0 : -1;
+
+    if (getReadableBytes() == 0)
+        releaseChunk();
+
+    return result;
+}
+#endif
+
 //-----------------------------------------------------------------------------
 // 描述: 扩展缓存空间以便可再写进 moreBytes 个字节
 //-----------------------------------------------------------------------------
@@ -195,7 +623,17 @@ void IoBuffer::makeSpace(int moreBytes)
 {
     if (getWritableBytes() + getUselessBytes() < moreBytes)
     {
-        buffer_.resize(writerIndex_ + moreBytes);
+        // 换用更大的缓存块，并将可读数据移至新块的开始处
+        int readableBytes = getReadableBytes();
+        int chunkSize = IoBufferPool::calcChunkSize(readableBytes + moreBytes);
+        char *chunk = allocChunk(chunkSize);
+        if (readableBytes > 0)
+            memcpy(chunk, peek(), readableBytes);
+
+        releaseChunk();
+        buffer_ = chunk;
+        size_ = chunkSize;
+        writerIndex_ = readableBytes;
     }
     else
     {
@@ -210,61 +648,171 @@ void IoBuffer::makeSpace(int moreBytes)
     }
 }
 
-///////////////////////////////////////////////////////////////////////////////
-// class TcpEventLoop
+//-----------------------------------------------------------------------------
+// 描述: 取得缓存块 (有缓存池时从池中取)
+//-----------------------------------------------------------------------------
+char* IoBuffer::allocChunk(int chunkSize)
+{
+    char *result = (pool_ != NULL ?
+        pool_->allocChunk(chunkSize) : IoBufferPool::allocHeapChunk(chunkSize));
+    TcpInspectInfo::instance().ioBufferInUseBytes.getAndAdd(chunkSize);
+    return result;
+}
 
-TcpEventLoop::TcpEventLoop()
+//-----------------------------------------------------------------------------
+// 描述: 归还缓存块并清空缓存
+//-----------------------------------------------------------------------------
+void IoBuffer::releaseChunk()
 {
-    // nothing
+    if (buffer_ != NULL)
+    {
+        TcpInspectInfo::instance().ioBufferInUseBytes.getAndAdd(-size_);
+        if (pool_ != NULL)
+            pool_->freeChunk(buffer_, size_);
+        else
+            IoBufferPool::freeHeapChunk(buffer_, size_);
+
+        buffer_ = NULL;
+        size_ = 0;
+    }
+
+    readerIndex_ = 0;
+    writerIndex_ = 0;
 }
 
-TcpEventLoop::~TcpEventLoop()
+///////////////////////////////////////////////////////////////////////////////
+// class TcpConnectionTable
+
+TcpConnectionTable::TcpConnectionTable() :
+    freeHead_(-1),
+    count_(0)
 {
-    tcpConnMap_.clear();
+    // nothing
 }
 
 //-----------------------------------------------------------------------------
-// 描述: 将指定连接注册到此 eventLoop 中
+// 描述: 将连接加入表中
 //-----------------------------------------------------------------------------
-void TcpEventLoop::addConnection(TcpConnection *connection)
+void TcpConnectionTable::add(const TcpConnectionPtr& connection)
 {
-    TcpInspectInfo::instance().addConnCount.increment();
-
-    TcpConnectionPtr connPtr(connection);
-    tcpConnMap_[connection->getConnectionName()] = connPtr;
+    int slot;
+    if (freeHead_ >= 0)
+    {
+        slot = freeHead_;
+        freeHead_ = slots_[slot].nextFree;
+    }
+    else
+    {
+        slot = (int)slots_.size();
+        slots_.push_back(Slot());
+    }
 
-    registerConnection(connection);
-    delegateToLoop(boost::bind(&IseBusiness::onTcpConnected, &iseApp().iseBusiness(), connPtr));
+    slots_[slot].connection = connection;
+    slots_[slot].nextFree = -1;
+    connection->tableSlot_ = slot;
+    ++count_;
 }
 
 //-----------------------------------------------------------------------------
-// 描述: 将指定连接从此 eventLoop 中注销
+// 描述: 将连接从表中删除
+// 备注: 此处 shared_ptr 计数递减，有可能会销毁 TcpConnection 对象
 //-----------------------------------------------------------------------------
-void TcpEventLoop::removeConnection(TcpConnection *connection)
+void TcpConnectionTable::remove(TcpConnection *connection)
 {
-    TcpInspectInfo::instance().removeConnCount.increment();
-
-    unregisterConnection(connection);
+    int slot = connection->tableSlot_;
+    if (slot < 0 || slot >= (int)slots_.size() || slots_[slot].connection.get() != connection)
+        return;
 
-    // 此处 shared_ptr 计数递减，有可能会销毁 TcpConnection 对象
-    tcpConnMap_.erase(connection->getConnectionName());
+    // 先更新表的状态，最后再释放连接，以免析构过程中访问到不一致的表
+    TcpConnectionPtr temp;
+    temp.swap(slots_[slot].connection);
+    slots_[slot].nextFree = freeHead_;
+    freeHead_ = slot;
+    connection->tableSlot_ = -1;
+    --count_;
 }
 
 //-----------------------------------------------------------------------------
-// 描述: 清除全部连接
-// 备注:
-//   conn->shutdown(true, true) 使 IOCP 返回错误，从而释放 IOCP 持有的 shared_ptr。
-//   之后 TcpConnection::errorOccurred() 被调用，进而调用 onTcpDisconnected() 和
+
+void TcpConnectionTable::clear()
+{
+    std::vector<Slot> temp;
+    temp.swap(slots_);
+    freeHead_ = -1;
+    count_ = 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// class TcpEventLoop
+
+TcpEventLoop::TcpEventLoop(IO_BACKEND_TYPE ioBackend) :
+    OsEventLoop(ioBackend),
+    timingWheel_(TIMING_WHEEL_TICK),
+    connectionPool_(TcpConnectionPool::create()),
+    socketBusyPollMicroSecs_(0),
+    socketBusyPollFailed_(false)
+{
+    // nothing
+}
+
+TcpEventLoop::~TcpEventLoop()
+{
+    tcpConnTable_.clear();
+    connectionPool_->release();
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 将指定连接注册到此 eventLoop 中
+//-----------------------------------------------------------------------------
+void TcpEventLoop::addConnection(TcpConnection *connection)
+{
+    TcpInspectInfo::instance().addConnCount.increment();
+    connCount_.increment();
+
+    TcpConnectionPtr connPtr = TcpConnectionPool::makeConnectionPtr(connection);
+    tcpConnTable_.add(connPtr);
+
+    if (socketBusyPollMicroSecs_ > 0 && !connection->setBusyPoll(socketBusyPollMicroSecs_) &&
+        !socketBusyPollFailed_)
+    {
+        socketBusyPollFailed_ = true;
+        logger().writeFmt(SEM_SOCKET_BUSY_POLL_ERROR, errno);
+    }
+
+    registerConnection(connection);
+    delegateToLoop(boost::bind(&IseBusiness::onTcpConnected, &iseApp().iseBusiness(), connPtr));
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 将指定连接从此 eventLoop 中注销
+//-----------------------------------------------------------------------------
+void TcpEventLoop::removeConnection(TcpConnection *connection)
+{
+    TcpInspectInfo::instance().removeConnCount.increment();
+    connCount_.decrement();
+
+    unregisterConnection(connection);
+
+    // 此处 shared_ptr 计数递减，有可能会销毁 TcpConnection 对象
+    tcpConnTable_.remove(connection);
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 清除全部连接
+// 备注:
+//   conn->shutdown(true, true) 使 IOCP 返回错误，从而释放 IOCP 持有的 shared_ptr。
+//   之后 TcpConnection::errorOccurred() 被调用，进而调用 onTcpDisconnected() 和
 //   TcpConnection::setEventLoop(NULL)。
 //-----------------------------------------------------------------------------
 void TcpEventLoop::clearConnections()
 {
     assertInLoopThread();
 
-    for (TcpConnectionMap::iterator iter = tcpConnMap_.begin(); iter != tcpConnMap_.end(); ++iter)
+    for (int slot = 0; slot < tcpConnTable_.getSlotCount(); ++slot)
     {
-        TcpConnectionPtr conn = tcpConnMap_.begin()->second;
-        conn->shutdown(true, true);
+        TcpConnectionPtr conn = tcpConnTable_.getSlot(slot);
+        if (conn)
+            conn->shutdown(true, true);
     }
 }
 
@@ -278,7 +826,7 @@ void TcpEventLoop::clearConnections()
 void TcpEventLoop::runLoop(Thread *thread)
 {
     bool isTerminated = false;
-    while (!isTerminated || !tcpConnMap_.empty())
+    while (!isTerminated || !tcpConnTable_.isEmpty() || hasPendingIo())
     {
         try
         {
@@ -290,9 +838,11 @@ void TcpEventLoop::runLoop(Thread *thread)
 	        }
 
             doLoopWork(thread);
-            checkTimeout();
+            timingWheel_.advance(Clock::getTicks());
             executeDelegatedFunctors();
+            flushBatchedSends();
             executeFinalizer();
+            iterationCount_.increment();
         }
         catch (Exception& e)
         {
@@ -304,30 +854,125 @@ void TcpEventLoop::runLoop(Thread *thread)
 }
 
 //-----------------------------------------------------------------------------
-// 描述: 检查每个TCP连接的超时
+// 描述: 将分派策略选定的连接加入本事件循环 (在事件循环线程中执行)
+//-----------------------------------------------------------------------------
+void TcpEventLoop::addPlacedConnection(TcpConnection *connection)
+{
+    pendingConnCount_.decrement();
+    connection->setEventLoop(this);
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 计算事件循环的等待超时，使时间轮上最近的到期项能被及时触发
 //-----------------------------------------------------------------------------
-void TcpEventLoop::checkTimeout()
+int TcpEventLoop::calcLoopWaitTimeout()
+{
+    int result = OsEventLoop::calcLoopWaitTimeout();
+    int wheelTimeout = timingWheel_.calcWaitTimeout(Clock::getTicks());
+
+    if (wheelTimeout != TIMEOUT_INFINITE &&
+        (result == TIMEOUT_INFINITE || wheelTimeout < result))
+        result = wheelTimeout;
+
+    // 尚有合并的发送未发出 (在本轮发送时新产生的)，不可等待
+    if (hasBatchedSends())
+        result = 0;
+
+    return result;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// class LoopPlacementPolicy
+
+LoopPlacementPolicy* LoopPlacementPolicy::create(LOOP_PLACEMENT_POLICY policy)
+{
+    switch (policy)
+    {
+    case LPP_LEAST_CONNECTIONS:
+        return new LeastConnectionsPlacement();
+    case LPP_LEAST_BUSY:
+        return new LeastBusyPlacement();
+    case LPP_PEER_HASH:
+        return new PeerHashPlacement();
+    default:
+        return new RoundRobinPlacement();
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// class RoundRobinPlacement
+
+int RoundRobinPlacement::selectLoop(TcpEventLoopList& eventLoopList, BaseTcpConnection *connection)
+{
+    if (nextIndex_ >= eventLoopList.getCount())
+        nextIndex_ = 0;
+    return nextIndex_++;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// class LeastConnectionsPlacement
+
+int LeastConnectionsPlacement::selectLoop(TcpEventLoopList& eventLoopList, BaseTcpConnection *connection)
 {
-    const UINT CHECK_INTERVAL = 1000;  // ms
+    int result = 0;
+    int minCount = 0;
 
-    UINT64 curTicks = getCurTicks();
-    if (getTickDiff(lastCheckTimeoutTicks_, curTicks) >= (UINT64)CHECK_INTERVAL)
+    for (int i = 0; i < eventLoopList.getCount(); ++i)
     {
-        lastCheckTimeoutTicks_ = curTicks;
+        TcpEventLoop *eventLoop = eventLoopList[i];
+        int count = eventLoop->getConnectionCount() + eventLoop->getPendingConnCount();
+        if (i == 0 || count < minCount)
+        {
+            result = i;
+            minCount = count;
+        }
+    }
+
+    return result;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// class LeastBusyPlacement
+
+int LeastBusyPlacement::selectLoop(TcpEventLoopList& eventLoopList, BaseTcpConnection *connection)
+{
+    int result = 0;
+    int minBusy = 0, minCount = 0;
 
-        for (TcpConnectionMap::iterator iter = tcpConnMap_.begin(); iter != tcpConnMap_.end(); ++iter)
+    for (int i = 0; i < eventLoopList.getCount(); ++i)
+    {
+        TcpEventLoop *eventLoop = eventLoopList[i];
+        int busy = eventLoop->getBusyPermille() / BUSY_GRANULARITY;
+        int count = eventLoop->getConnectionCount() + eventLoop->getPendingConnCount();
+        if (i == 0 || busy < minBusy || (busy == minBusy && count < minCount))
         {
-            TcpConnectionPtr& connPtr = iter->second;
-            connPtr->checkTimeout(curTicks);
+            result = i;
+            minBusy = busy;
+            minCount = count;
         }
     }
+
+    return result;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// class PeerHashPlacement
+
+int PeerHashPlacement::selectLoop(TcpEventLoopList& eventLoopList, BaseTcpConnection *connection)
+{
+    // Knuth 乘法散列，取高位以充分混合IP的各字节
+    UINT hash = (UINT)(connection->getPeerAddr().ip * 2654435761U);
+    return (int)((UINT64)hash * (UINT)eventLoopList.getCount() >> 32);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 // class TcpEventLoopList
 
 TcpEventLoopList::TcpEventLoopList(int loopCount) :
-    EventLoopList(loopCount)
+    EventLoopList(loopCount),
+    placementPolicy_(new RoundRobinPlacement()),
+    busyPollMicroSecs_(0),
+    socketBusyPollMicroSecs_(0)
 {
     // nothing
 }
@@ -344,30 +989,106 @@ TcpEventLoopList::~TcpEventLoopList()
 //-----------------------------------------------------------------------------
 bool TcpEventLoopList::registerToEventLoop(BaseTcpConnection *connection, int eventLoopIndex)
 {
-    TcpEventLoop *eventLoop = NULL;
+    eventLoopIndex = placeConnection(connection, eventLoopIndex);
 
-    if (eventLoopIndex >= 0 && eventLoopIndex < getCount())
+    bool result = (eventLoopIndex >= 0);
+    if (result)
     {
-        AutoLocker locker(mutex_);
-        eventLoop = getItem(eventLoopIndex);
+        TcpEventLoop *eventLoop = getItem(eventLoopIndex);
+
+        // 将 ((TcpConnection*)connection)->setEventLoop(eventLoop) 委托给事件循环线程
+        eventLoop->delegateToLoop(boost::bind(
+            &TcpEventLoop::addPlacedConnection,
+            eventLoop,
+            static_cast<TcpConnection*>(connection)));
     }
-    else
+
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 为 connection 选定事件循环，并计入该事件循环的待加入连接数
+// 参数:
+//   index - EventLoop 的序号 (0-based)，为 -1 表示由分派策略选择。
+// 返回:
+//   选定的事件循环的序号，无事件循环时返回 -1。
+// 备注:
+//   调用者须随后在该事件循环线程中调用 TcpEventLoop::addPlacedConnection() 加入连接，
+//   或放弃加入并减少其待加入连接数。
+//-----------------------------------------------------------------------------
+int TcpEventLoopList::placeConnection(BaseTcpConnection *connection, int eventLoopIndex)
+{
+    AutoLocker locker(mutex_);
+
+    if (getCount() <= 0) return -1;
+
+    if (eventLoopIndex < 0 || eventLoopIndex >= getCount())
     {
-        static int s_index = 0;
-        AutoLocker locker(mutex_);
-        // round-robin
-        eventLoop = getItem(s_index);
-        s_index = (s_index >= getCount() - 1 ? 0 : s_index + 1);
+        eventLoopIndex = placementPolicy_->selectLoop(*this, connection);
+        eventLoopIndex = ise::min(ise::max(eventLoopIndex, 0), getCount() - 1);
+        getItem(eventLoopIndex)->placedCount_.increment();
     }
 
-    bool result = (eventLoop != NULL);
-    if (result)
+    getItem(eventLoopIndex)->pendingConnCount_.increment();
+    return eventLoopIndex;
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 设置新连接的分派策略 (接管 policy 的所有权)
+//-----------------------------------------------------------------------------
+void TcpEventLoopList::setPlacementPolicy(LoopPlacementPolicy *policy)
+{
+    if (policy == NULL) return;
+
+    AutoLocker locker(mutex_);
+    placementPolicy_.reset(policy);
+}
+
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// 描述: 设置各事件循环的忙轮询时长及连接的 SO_BUSY_POLL 时长 (微秒，0 表示不启用)
+// 备注: 须在事件循环启动前设置。参见 IseOptions::setTcpServerBusyPoll()。
+//-----------------------------------------------------------------------------
+void TcpEventLoopList::setBusyPoll(int spinMicroSecs, int socketMicroSecs)
+{
+    busyPollMicroSecs_ = ise::max(spinMicroSecs, 0);
+    socketBusyPollMicroSecs_ = ise::max(socketMicroSecs, 0);
+
+    for (int i = 0; i < getCount(); ++i)
     {
-        // 将 ((TcpConnection*)connection)->setEventLoop(eventLoop) 委托给事件循环线程
-        eventLoop->delegateToLoop(boost::bind(
-            &TcpConnection::setEventLoop,
-            static_cast<TcpConnection*>(connection),
-            eventLoop));
+        getItem(i)->setBusyPollTime(busyPollMicroSecs_);
+        getItem(i)->setSocketBusyPoll(socketBusyPollMicroSecs_);
+    }
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 返回TCP事件循环实际采用的 I/O 后端
+// 备注:
+//   选项要求 io_uring 但编译环境或运行中的内核不支持时，回退到 EPoll。
+//   只在首次调用时确定，此后全部TCP事件循环及连接均采用同一后端。
+//-----------------------------------------------------------------------------
+IO_BACKEND_TYPE TcpEventLoopList::getIoBackend()
+{
+    static IO_BACKEND_TYPE s_ioBackend = selectIoBackend();
+    return s_ioBackend;
+}
+
+//-----------------------------------------------------------------------------
+
+IO_BACKEND_TYPE TcpEventLoopList::selectIoBackend()
+{
+    IO_BACKEND_TYPE result = iseApp().iseOptions().getTcpIoBackend();
+
+    if (result == IOB_IO_URING)
+    {
+#ifdef ISE_IO_URING
+        if (!IoUringObject::isSupported())
+#endif
+        {
+            logger().writeStr(SEM_IO_URING_NOT_SUPPORTED);
+            result = IOB_EPOLL;
+        }
     }
 
     return result;
@@ -377,12 +1098,23 @@ bool TcpEventLoopList::registerToEventLoop(BaseTcpConnection *connection, int ev
 
 EventLoop* TcpEventLoopList::createEventLoop()
 {
+    TcpEventLoop *result = NULL;
+
 #ifdef ISE_WINDOWS
-    return new WinTcpEventLoop();
+    result = new WinTcpEventLoop();
 #endif
 #ifdef ISE_LINUX
-    return new LinuxTcpEventLoop();
+#ifdef ISE_IO_URING
+    if (getIoBackend() == IOB_IO_URING)
+        result = new UringTcpEventLoop();
 #endif
+    if (result == NULL)
+        result = new LinuxTcpEventLoop();
+#endif
+
+    result->setBusyPollTime(busyPollMicroSecs_);
+    result->setSocketBusyPoll(socketBusyPollMicroSecs_);
+    return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -401,6 +1133,7 @@ TcpConnection::TcpConnection(TcpServer *tcpServer, SOCKET socketHandle) :
 
     tcpServer_ = tcpServer;
     tcpServer_->incConnCount();
+    sendBufferLimits_ = tcpServer_->getSendBufferLimits();
     TcpInspectInfo::instance().tcpConnCreateCount.increment();
 }
 
@@ -419,9 +1152,21 @@ TcpConnection::~TcpConnection()
 
 void TcpConnection::init()
 {
+    static AtomicInt64 s_connIdAlloc;
+
     tcpServer_ = NULL;
     eventLoop_ = NULL;
+    connectionId_ = (UINT64)s_connIdAlloc.increment();
+    tableSlot_ = -1;
     isErrorOccurred_ = false;
+    lastActiveTicks_ = 0;
+    sendQueuedBytes_ = 0;
+    isSendBufferHigh_ = false;
+    isRecvBatchMode_ = false;
+
+    sendTimeoutEntry_.setCallback(boost::bind(&TcpConnection::onSendTimeout, this));
+    recvTimeoutEntry_.setCallback(boost::bind(&TcpConnection::onRecvTimeout, this));
+    idleTimeoutEntry_.setCallback(boost::bind(&TcpConnection::onIdleTimeout, this));
 }
 
 //-----------------------------------------------------------------------------
@@ -440,12 +1185,65 @@ void TcpConnection::send(const void *buffer, size_t size, const Context& context
         postSendTask(buffer, static_cast<int>(size), context, timeout);
     else
     {
-        string data((const char*)buffer, size);
+        SharedBuffer data(buffer, static_cast<int>(size));
         getEventLoop()->delegateToLoop(
             boost::bind(&TcpConnection::postSendTask, this, data, context, timeout));
     }
 }
 
+//-----------------------------------------------------------------------------
+// 描述: 提交一个发送任务 (线程安全)
+// 参数:
+//   timeout - 超时值 (毫秒)
+// 备注:
+//   buffer 中的数据不会被复制，而是以引用计数的方式被挂接到连接的待发送数据链上，
+//   适用于将同一份数据发送给大量连接。
+//-----------------------------------------------------------------------------
+void TcpConnection::send(const SharedBuffer& buffer, const Context& context, int timeout)
+{
+    if (buffer.empty()) return;
+
+    if (eventLoop_ == NULL)
+        iseThrowException(SEM_EVENT_LOOP_NOT_SPECIFIED);
+
+    if (getEventLoop()->isInLoopThread())
+        postSendTask(buffer, context, timeout);
+    else
+    {
+        getEventLoop()->delegateToLoop(
+            boost::bind(&TcpConnection::postSendTask, this, buffer, context, timeout));
+    }
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 提交一个发送文件的任务 (线程安全)
+// 参数:
+//   fileHandle - 文件句柄 (Linux 下即文件描述符)
+//   offset     - 待发送数据在文件中的起始位置
+//   length     - 待发送的字节数
+//   timeout    - 超时值 (毫秒)
+// 备注:
+//   1. 与其它发送任务按提交顺序依次发送，全部发送完毕后回调 onTcpSendComplete()。
+//   2. Linux 下以 sendfile() 由内核直接发送文件数据，不经用户态复制。
+//   3. 在 onTcpSendComplete() 回调之前，调用者不得关闭文件。
+//-----------------------------------------------------------------------------
+void TcpConnection::sendFile(HANDLE fileHandle, INT64 offset, INT64 length,
+    const Context& context, int timeout)
+{
+    if (fileHandle == INVALID_HANDLE_VALUE || offset < 0 || length <= 0) return;
+
+    if (eventLoop_ == NULL)
+        iseThrowException(SEM_EVENT_LOOP_NOT_SPECIFIED);
+
+    if (getEventLoop()->isInLoopThread())
+        postSendFileTask(fileHandle, offset, length, context, timeout);
+    else
+    {
+        getEventLoop()->delegateToLoop(boost::bind(&TcpConnection::postSendFileTask,
+            this, fileHandle, offset, length, context, timeout));
+    }
+}
+
 //-----------------------------------------------------------------------------
 // 描述: 提交一个接收任务 (线程安全)
 // 参数:
@@ -467,6 +1265,53 @@ void TcpConnection::recv(const PacketSplitter& packetSplitter, const Context& co
     }
 }
 
+//-----------------------------------------------------------------------------
+// 描述: 启用连续接收模式 (线程安全)
+// 参数:
+//   packetSplitter - 分包器，在整个连续接收期间持续使用
+//   batchMode      - 为 true 时每次以 onTcpRecvBatch() 投递一批数据包，否则逐个以
+//                    onTcpRecvComplete() 投递
+//   context        - 回调时传入的上下文
+// 备注:
+//   1. 启用后每收到数据，即分离出缓存中的全部完整数据包并投递，业务无须在每个包之后
+//      再次调用 recv()，也没有逐包的接收任务、任务队列操作和委托。
+//   2. 若期间调用了 recv()，则先完成这些接收任务，接收任务队列为空时再恢复连续接收。
+//   3. 连续接收没有超时，可借助空闲超时 (IseOptions::setTcpIdleTimeout) 清理连接。
+//-----------------------------------------------------------------------------
+void TcpConnection::startContinuousRecv(const PacketSplitter& packetSplitter,
+    bool batchMode, const Context& context)
+{
+    if (!packetSplitter) return;
+
+    if (eventLoop_ == NULL)
+        iseThrowException(SEM_EVENT_LOOP_NOT_SPECIFIED);
+
+    if (getEventLoop()->isInLoopThread())
+        postContinuousRecv(packetSplitter, batchMode, context);
+    else
+    {
+        getEventLoop()->delegateToLoop(boost::bind(&TcpConnection::postContinuousRecv,
+            this, packetSplitter, batchMode, context));
+    }
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 停止连续接收模式 (线程安全)
+//-----------------------------------------------------------------------------
+void TcpConnection::stopContinuousRecv()
+{
+    if (eventLoop_ == NULL)
+        iseThrowException(SEM_EVENT_LOOP_NOT_SPECIFIED);
+
+    if (getEventLoop()->isInLoopThread())
+        postContinuousRecv(PacketSplitter(), false, EMPTY_CONTEXT);
+    else
+    {
+        getEventLoop()->delegateToLoop(boost::bind(&TcpConnection::postContinuousRecv,
+            this, PacketSplitter(), false, EMPTY_CONTEXT));
+    }
+}
+
 //-----------------------------------------------------------------------------
 
 const string& TcpConnection::getConnectionName() const
@@ -474,14 +1319,15 @@ const string& TcpConnection::getConnectionName() const
     if (connectionName_.empty() && isConnected())
     {
         static Mutex mutex;
-        static SeqNumberAlloc connIdAlloc_;
-
         AutoLocker locker(mutex);
 
-        connectionName_ = formatString("%s-%s#%s",
-            getSocket().getLocalAddr().getDisplayStr().c_str(),
-            getSocket().getPeerAddr().getDisplayStr().c_str(),
-            intToStr((INT64)connIdAlloc_.allocId()).c_str());
+        if (connectionName_.empty())
+        {
+            connectionName_ = formatString("%s-%s#%s",
+                getSocket().getLocalAddr().getDisplayStr().c_str(),
+                getSocket().getPeerAddr().getDisplayStr().c_str(),
+                intToStr((INT64)connectionId_).c_str());
+        }
     }
 
     return connectionName_;
@@ -550,60 +1396,320 @@ void TcpConnection::errorOccurred()
 }
 
 //-----------------------------------------------------------------------------
-// 描述: 检查接收和发送任务是否超时
+// 描述: 发送任务队列变化后 (入队或出队)，更新队首任务的超时计时
 //-----------------------------------------------------------------------------
-void TcpConnection::checkTimeout(UINT curTicks)
+void TcpConnection::updateSendTimeout()
 {
-    if (!sendTaskQueue_.empty())
-    {
-        SendTask& task = sendTaskQueue_.front();
+    updateTaskTimeout(sendTaskQueue_, sendTimeoutEntry_);
+}
 
-        if (task.startTicks == 0)
-            task.startTicks = curTicks;
-        else
-        {
-            if (task.timeout > 0 &&
-                (int)getTickDiff(task.startTicks, curTicks) > task.timeout)
-            {
-                shutdown(true, true);
-            }
-        }
-    }
+//-----------------------------------------------------------------------------
+// 描述: 接收任务队列变化后 (入队或出队)，更新队首任务的超时计时
+//-----------------------------------------------------------------------------
+void TcpConnection::updateRecvTimeout()
+{
+    updateTaskTimeout(recvTaskQueue_, recvTimeoutEntry_);
+}
 
-    if (!recvTaskQueue_.empty())
+//-----------------------------------------------------------------------------
+// 描述: 更新任务队列的超时计时
+// 备注:
+//   超时只针对队首任务，从任务成为队首时开始计时。队列中的每个任务只会被计时
+//   一次，所以任务队列每次变化后调用此函数即可。
+//-----------------------------------------------------------------------------
+template<typename TaskQueue>
+void TcpConnection::updateTaskTimeout(TaskQueue& taskQueue, TimingWheel::Entry& entry)
+{
+    if (eventLoop_ == NULL) return;
+
+    if (taskQueue.empty())
     {
-        RecvTask& task = recvTaskQueue_.front();
+        entry.cancel();
+        return;
+    }
 
-        if (task.startTicks == 0)
-            task.startTicks = curTicks;
+    typename TaskQueue::value_type& task = taskQueue.front();
+    if (!task.isTimerStarted)
+    {
+        task.isTimerStarted = true;
+        if (task.timeout > 0)
+            getEventLoop()->getTimingWheel().schedule(entry, task.timeout);
         else
-        {
-            if (task.timeout > 0 &&
-                (int)getTickDiff(task.startTicks, curTicks) > task.timeout)
-            {
-                shutdown(true, true);
-            }
-        }
+            entry.cancel();
     }
 }
 
 //-----------------------------------------------------------------------------
-
-void TcpConnection::postSendTask(const string& data, const Context& context, int timeout)
+// 描述: 连接加入事件循环后，开始超时计时
+//-----------------------------------------------------------------------------
+void TcpConnection::startTimeouts()
 {
-    postSendTask(data.c_str(), (int)data.size(), context, timeout);
+    if (!sendTaskQueue_.empty())
+        sendTaskQueue_.front().isTimerStarted = false;
+    if (!recvTaskQueue_.empty())
+        recvTaskQueue_.front().isTimerStarted = false;
+
+    updateSendTimeout();
+    updateRecvTimeout();
+
+    markActive();
+    int idleTimeout = iseApp().iseOptions().getTcpIdleTimeout();
+    if (idleTimeout > 0)
+        getEventLoop()->getTimingWheel().schedule(idleTimeoutEntry_, idleTimeout);
 }
 
 //-----------------------------------------------------------------------------
-// 描述: 设置此连接从属于哪个 eventLoop
+// 描述: 连接离开事件循环前，停止超时计时
 //-----------------------------------------------------------------------------
-void TcpConnection::setEventLoop(TcpEventLoop *eventLoop)
+void TcpConnection::stopTimeouts()
 {
-    if (eventLoop != eventLoop_)
-    {
-        if (eventLoop_)
-        {
-            TcpEventLoop *temp = eventLoop_;
+    sendTimeoutEntry_.cancel();
+    recvTimeoutEntry_.cancel();
+    idleTimeoutEntry_.cancel();
+}
+
+//-----------------------------------------------------------------------------
+
+void TcpConnection::onSendTimeout()
+{
+    TcpInspectInfo::instance().sendTimeoutCount.increment();
+    shutdown(true, true);
+}
+
+//-----------------------------------------------------------------------------
+
+void TcpConnection::onRecvTimeout()
+{
+    TcpInspectInfo::instance().recvTimeoutCount.increment();
+    shutdown(true, true);
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 空闲超时定时项到期
+// 备注:
+//   收发数据时只记录时间 (markActive())，而不重新调度定时项。定时项到期时若发现
+//   期间有过收发，则按剩余时间重新调度。
+//-----------------------------------------------------------------------------
+void TcpConnection::onIdleTimeout()
+{
+    UINT64 idleMSecs = getTickDiff(lastActiveTicks_, Clock::getTicks());
+    UINT64 idleTimeout = (UINT64)iseApp().iseOptions().getTcpIdleTimeout();
+
+    if (idleTimeout == 0)
+        return;
+
+    if (idleMSecs >= idleTimeout)
+    {
+        TcpInspectInfo::instance().idleTimeoutCount.increment();
+        shutdown(true, true);
+    }
+    else
+        getEventLoop()->getTimingWheel().schedule(idleTimeoutEntry_, idleTimeout - idleMSecs);
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 设置待发送数据的高、低水位
+// 参数:
+//   highBytes - 高水位 (字节)，为 0 表示不启用水位回调
+//   lowBytes  - 低水位 (字节)，不大于高水位
+//-----------------------------------------------------------------------------
+void TcpConnection::setSendBufferWatermarks(INT64 highBytes, INT64 lowBytes)
+{
+    highBytes = ise::max<INT64>(highBytes, 0);
+    lowBytes = ise::min(ise::max<INT64>(lowBytes, 0), highBytes);
+
+    sendBufferLimits_.highWatermark = highBytes;
+    sendBufferLimits_.lowWatermark = lowBytes;
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 设置待发送数据的上限
+// 参数:
+//   bytes  - 上限 (字节)，为 0 表示不限制
+//   policy - 发送的数据将使待发送数据超过上限时的处理策略 (SOP_XXX)
+//-----------------------------------------------------------------------------
+void TcpConnection::setSendBufferHardCap(INT64 bytes, SEND_BUFFER_OVERFLOW_POLICY policy)
+{
+    sendBufferLimits_.hardCap = ise::max<INT64>(bytes, 0);
+    sendBufferLimits_.overflowPolicy = policy;
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 检查提交 bytes 个字节后待发送数据是否超过上限
+// 返回:
+//   true  - 未超过上限，可以提交。
+//   false - 超过上限，数据应被丢弃 (按策略可能已断开连接)。
+//-----------------------------------------------------------------------------
+bool TcpConnection::checkSendBufferCap(INT64 bytes)
+{
+    if (sendBufferLimits_.hardCap <= 0 || sendQueuedBytes_ + bytes <= sendBufferLimits_.hardCap)
+        return true;
+
+    TcpInspectInfo::instance().sendBufferOverflowCount.increment();
+    if (sendBufferLimits_.overflowPolicy == SOP_DISCONNECT)
+        shutdown(true, true);
+    return false;
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 待发送数据增加了 bytes 个字节
+// 备注:
+//   越过高水位时回调 onTcpSendBufferHigh()。回调经 delegateToLoop 延后到本轮事件
+//   循环的末尾，以免业务在回调中发送数据时重入发送流程。
+//-----------------------------------------------------------------------------
+void TcpConnection::addSendQueuedBytes(INT64 bytes)
+{
+    sendQueuedBytes_ += bytes;
+
+    if (!isSendBufferHigh_ && sendBufferLimits_.highWatermark > 0 &&
+        sendQueuedBytes_ >= sendBufferLimits_.highWatermark)
+    {
+        isSendBufferHigh_ = true;
+        TcpInspectInfo::instance().sendBufferHighCount.increment();
+        getEventLoop()->delegateToLoop(boost::bind(&IseBusiness::onTcpSendBufferHigh,
+            &iseApp().iseBusiness(), shared_from_this(), sendQueuedBytes_));
+    }
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 待发送数据减少了 bytes 个字节
+// 备注: 越过高水位后回落到低水位时回调 onTcpSendBufferDrained()。
+//-----------------------------------------------------------------------------
+void TcpConnection::removeSendQueuedBytes(INT64 bytes)
+{
+    sendQueuedBytes_ -= bytes;
+
+    if (isSendBufferHigh_ && sendQueuedBytes_ <= sendBufferLimits_.lowWatermark)
+    {
+        isSendBufferHigh_ = false;
+        getEventLoop()->delegateToLoop(boost::bind(&IseBusiness::onTcpSendBufferDrained,
+            &iseApp().iseBusiness(), shared_from_this()));
+    }
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 从 data 中分离出全部完整数据包，按连续接收模式投递
+// 参数:
+//   data  - 缓存中可用数据的首字节指针
+//   bytes - 缓存中可用数据的字节数
+// 返回: 已投递的字节数 (调用者应从缓存中移除)
+// 备注:
+//   回调中若停止了连续接收、提交了接收任务或发生了错误，则停止投递。
+//-----------------------------------------------------------------------------
+int TcpConnection::deliverContinuousPackets(const char *data, int bytes)
+{
+    const int MAX_BATCH_COUNT = 64;
+
+    RecvPacket packets[MAX_BATCH_COUNT];
+    int result = 0;
+
+    while (isContinuousRecv() && recvTaskQueue_.empty() && !isErrorOccurred_)
+    {
+        const int maxCount = (isRecvBatchMode_ ? MAX_BATCH_COUNT : 1);
+        int count = 0, batchBytes = 0;
+
+        while (count < maxCount && result + batchBytes < bytes)
+        {
+            const char *packet = data + result + batchBytes;
+            int packetSize = 0;
+            continuousRecvSplitter_(packet, bytes - result - batchBytes, packetSize);
+            if (packetSize <= 0) break;
+
+            packets[count].buffer = (void*)packet;
+            packets[count].size = packetSize;
+            batchBytes += packetSize;
+            ++count;
+        }
+
+        if (count == 0) break;
+
+        if (isRecvBatchMode_)
+            iseApp().iseBusiness().onTcpRecvBatch(shared_from_this(), packets, count, continuousRecvContext_);
+        else
+            iseApp().iseBusiness().onTcpRecvComplete(shared_from_this(),
+                packets[0].buffer, packets[0].size, continuousRecvContext_);
+
+        result += batchBytes;
+    }
+
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 启用或停止 (packetSplitter 为空) 连续接收模式
+//-----------------------------------------------------------------------------
+void TcpConnection::postContinuousRecv(const PacketSplitter& packetSplitter,
+    bool batchMode, const Context& context)
+{
+    continuousRecvSplitter_ = packetSplitter;
+    continuousRecvContext_ = context;
+    isRecvBatchMode_ = batchMode;
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 提交一个发送任务 (缺省实现: 复制数据)
+//-----------------------------------------------------------------------------
+void TcpConnection::postSendTask(const SharedBuffer& buffer, const Context& context, int timeout)
+{
+    postSendTask(buffer.data(), buffer.size(), context, timeout);
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 提交一个发送文件的任务 (缺省实现: 将文件数据读入内存后发送)
+//-----------------------------------------------------------------------------
+void TcpConnection::postSendFileTask(HANDLE fileHandle, INT64 offset, INT64 length,
+    const Context& context, int timeout)
+{
+    if (length > 0x7FFFFFFF)
+        iseThrowException(SEM_FEATURE_NOT_SUPPORTED);
+
+    Buffer *buffer = new Buffer((int)length);
+    SharedBuffer data(buffer);
+    int bytesRead = 0;
+
+#ifdef ISE_WINDOWS
+    LARGE_INTEGER position;
+    position.QuadPart = offset;
+    if (!::SetFilePointerEx(fileHandle, position, NULL, FILE_BEGIN))
+        iseThrowException(SEM_STREAM_READ_ERROR);
+
+    while (bytesRead < (int)length)
+    {
+        DWORD n = 0;
+        if (!::ReadFile(fileHandle, buffer->data() + bytesRead, (DWORD)(length - bytesRead), &n, NULL) || n == 0)
+            break;
+        bytesRead += (int)n;
+    }
+#endif
+#ifdef ISE_LINUX
+    while (bytesRead < (int)length)
+    {
+        ssize_t n = ::pread(fileHandle, buffer->data() + bytesRead, length - bytesRead, offset + bytesRead);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+        bytesRead += (int)n;
+    }
+#endif
+
+    if (bytesRead < (int)length)
+        iseThrowException(SEM_STREAM_READ_ERROR);
+
+    postSendTask(data, context, timeout);
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 设置此连接从属于哪个 eventLoop
+//-----------------------------------------------------------------------------
+void TcpConnection::setEventLoop(TcpEventLoop *eventLoop)
+{
+    if (eventLoop != eventLoop_)
+    {
+        if (eventLoop_)
+        {
+            stopTimeouts();
+            sendBuffer_.setPool(NULL);
+            recvBuffer_.setPool(NULL);
+            TcpEventLoop *temp = eventLoop_;
             eventLoop_ = NULL;
             temp->removeConnection(this);
             eventLoopChanged();
@@ -613,8 +1719,11 @@ void TcpConnection::setEventLoop(TcpEventLoop *eventLoop)
         {
             eventLoop->assertInLoopThread();
             eventLoop_ = eventLoop;
+            sendBuffer_.setPool(&eventLoop->getIoBufferPool());
+            recvBuffer_.setPool(&eventLoop->getIoBufferPool());
             eventLoop->addConnection(this);
             eventLoopChanged();
+            startTimeouts();
         }
     }
 }
@@ -630,6 +1739,10 @@ BaseTcpConnection* TcpClient::createConnection()
     result = new WinTcpConnection();
 #endif
 #ifdef ISE_LINUX
+#ifdef ISE_IO_URING
+    if (TcpEventLoopList::getIoBackend() == IOB_IO_URING)
+        return new UringTcpConnection();
+#endif
     result = new LinuxTcpConnection();
 #endif
 
@@ -662,39 +1775,100 @@ bool TcpClient::registerToEventLoop(int index)
 // class TcpServer
 
 TcpServer::TcpServer(int eventLoopCount) :
-    eventLoopList_(eventLoopCount)
+    eventLoopList_(eventLoopCount),
+    edgeTriggered_(false),
+    listenerConnPool_(TcpConnectionPool::create())
 {
     // nothing
 }
 
+TcpServer::~TcpServer()
+{
+    listenerConnPool_->release();
+}
+
 //-----------------------------------------------------------------------------
 
 void TcpServer::open()
 {
     BaseTcpServer::open();
     eventLoopList_.start();
+
+    if (isLoopAccept())
+    {
+        try
+        {
+            openLoopListeners();
+        }
+        catch (SocketException&)
+        {
+            close();
+            throw;
+        }
+    }
 }
 
 //-----------------------------------------------------------------------------
 
 void TcpServer::close()
 {
+    // 监听套接字须在事件循环停止后才能关闭
+    if (isLoopAccept())
+    {
+        for (int i = 0; i < eventLoopList_.getCount(); ++i)
+        {
+#ifdef ISE_IO_URING
+            if (eventLoopList_[i]->getIoBackend() == IOB_IO_URING)
+            {
+                static_cast<UringTcpEventLoop*>(eventLoopList_[i])->removeListener();
+                continue;
+            }
+#endif
+#ifdef ISE_LINUX
+            static_cast<LinuxTcpEventLoop*>(eventLoopList_[i])->removeListener();
+#endif
+        }
+    }
+
     eventLoopList_.stop();
+    closeLoopListeners();
     BaseTcpServer::close();
 }
 
+//-----------------------------------------------------------------------------
+// 描述: 启动监听线程
+// 备注: 若由事件循环直接接受连接，则不需要监听线程。
+//-----------------------------------------------------------------------------
+void TcpServer::startListenerThread()
+{
+    if (!isLoopAccept())
+        BaseTcpServer::startListenerThread();
+}
+
 //-----------------------------------------------------------------------------
 // 描述: 创建连接对象
 //-----------------------------------------------------------------------------
 BaseTcpConnection* TcpServer::createConnection(SOCKET socketHandle)
 {
-    BaseTcpConnection *result = NULL;
+    return createConnection(socketHandle, listenerConnPool_);
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 从指定的连接对象池中创建连接对象 (须在池的所属线程中调用)
+//-----------------------------------------------------------------------------
+TcpConnection* TcpServer::createConnection(SOCKET socketHandle, TcpConnectionPool *pool)
+{
+    TcpConnection *result = NULL;
 
 #ifdef ISE_WINDOWS
-    result = new WinTcpConnection(this, socketHandle);
+    result = new (pool) WinTcpConnection(this, socketHandle);
 #endif
 #ifdef ISE_LINUX
-    result = new LinuxTcpConnection(this, socketHandle);
+#ifdef ISE_IO_URING
+    if (TcpEventLoopList::getIoBackend() == IOB_IO_URING)
+        return new (pool) UringTcpConnection(this, socketHandle);
+#endif
+    result = new (pool) LinuxTcpConnection(this, socketHandle);
 #endif
 
     return result;
@@ -715,790 +1889,2539 @@ void TcpServer::acceptConnection(BaseTcpConnection *connection)
         delete connection;
 }
 
-///////////////////////////////////////////////////////////////////////////////
-// class TcpConnector
-
-TcpConnector::TcpConnector() :
-    taskList_(false, true),
-    thread_(NULL)
-{
-    // nothing
-}
-
-TcpConnector::~TcpConnector()
+//-----------------------------------------------------------------------------
+// 描述: 是否由各事件循环直接接受连接 (而非由监听线程接受后再分派)
+// 备注: 仅在 Linux 下且启用了 SO_REUSEPORT 时成立。
+//-----------------------------------------------------------------------------
+bool TcpServer::isLoopAccept() const
 {
-    stop();
-    clear();
+#ifdef ISE_LINUX
+    return isReusePort();
+#else
+    return false;
+#endif
 }
 
 //-----------------------------------------------------------------------------
-
-void TcpConnector::connect(const InetAddress& peerAddr,
-    const CompleteCallback& completeCallback, const Context& context)
+// 描述: 为每个事件循环注册一个 SO_REUSEPORT 监听套接字
+// 备注:
+//   0号事件循环使用 getSocket()，其余事件循环各自打开一个绑定同一端口的套接字。
+//   内核按连接的四元组散列，在这些套接字之间分配新连接。
+//-----------------------------------------------------------------------------
+void TcpServer::openLoopListeners()
 {
-    AutoLocker locker(mutex_);
-
-    TaskItem *item = new TaskItem();
-    item->peerAddr = peerAddr;
-    item->completeCallback = completeCallback;
-    item->state = ACS_NONE;
-    item->context = context;
+#ifdef ISE_LINUX
+    for (int i = 0; i < eventLoopList_.getCount(); ++i)
+    {
+        SOCKET handle = getSocket().getHandle();
+        if (i > 0)
+        {
+            TcpSocket *socket = new TcpSocket();
+            loopListenSockets_.push_back(socket);
+            openListenSocket(*socket);
+            handle = socket->getHandle();
+        }
 
-    taskList_.add(item);
-    start();
+        TcpEventLoop *eventLoop = eventLoopList_[i];
+#ifdef ISE_IO_URING
+        // io_uring: 多发接受，每个新连接回调一次
+        if (eventLoop->getIoBackend() == IOB_IO_URING)
+        {
+            static_cast<UringTcpEventLoop*>(eventLoop)->addListener(handle,
+                boost::bind(&TcpServer::addAcceptedConnection, this, eventLoop, _1));
+            continue;
+        }
+#endif
+        static_cast<LinuxTcpEventLoop*>(eventLoop)->addListener(handle,
+            boost::bind(&TcpServer::acceptInLoop, this, eventLoop, handle));
+    }
+#endif
 }
 
 //-----------------------------------------------------------------------------
-
-void TcpConnector::clear()
+// 描述: 关闭 openLoopListeners() 打开的监听套接字
+//-----------------------------------------------------------------------------
+void TcpServer::closeLoopListeners()
 {
-    AutoLocker locker(mutex_);
-    taskList_.clear();
+    for (int i = 0; i < (int)loopListenSockets_.size(); ++i)
+        delete loopListenSockets_[i];
+    loopListenSockets_.clear();
 }
 
 //-----------------------------------------------------------------------------
-
-void TcpConnector::start()
+// 描述: 在事件循环线程中接受新连接，直至没有待接受的连接 (EAGAIN)
+// 备注:
+//   新连接直接注册到本事件循环，不经过任何线程切换。
+//-----------------------------------------------------------------------------
+void TcpServer::acceptInLoop(TcpEventLoop *eventLoop, SOCKET listenHandle)
 {
-    if (thread_ == NULL)
+#ifdef ISE_LINUX
+    while (true)
     {
-        thread_ = new WorkerThread(*this);
-        thread_->setAutoDelete(true);
-        thread_->run();
+        SOCKET acceptHandle = ::accept4(listenHandle, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (acceptHandle == INVALID_SOCKET)
+        {
+            int errorCode = iseSocketGetLastError();
+            if (errorCode == EINTR || errorCode == ECONNABORTED)
+                continue;
+            if (errorCode != EAGAIN && errorCode != EWOULDBLOCK)
+                logAcceptError(errorCode);
+            // 文件描述符耗尽时连接无法取走，监听套接字会一直可读，须暂停监视以免空转
+            if (errorCode == EMFILE || errorCode == ENFILE)
+                static_cast<LinuxTcpEventLoop*>(eventLoop)->suspendListener();
+            break;
+        }
+
+        addAcceptedConnection(eventLoop, acceptHandle);
     }
+#endif
 }
 
 //-----------------------------------------------------------------------------
-
-void TcpConnector::stop()
+// 描述: 将事件循环接受的新连接直接注册到该事件循环
+//-----------------------------------------------------------------------------
+void TcpServer::addAcceptedConnection(TcpEventLoop *eventLoop, SOCKET acceptHandle)
 {
-    if (thread_ != NULL)
-    {
-        thread_->terminate();
-        thread_->waitFor();
-        thread_ = NULL;
-    }
+    TcpConnection *connection = createConnection(acceptHandle, &eventLoop->getConnectionPool());
+    if (!iseApp().isTerminated())
+        connection->setEventLoop(eventLoop);
+    else
+        delete connection;
 }
 
 //-----------------------------------------------------------------------------
-
-void TcpConnector::work(WorkerThread& thread)
+// 描述: 记录 accept 错误日志 (各事件循环合计每秒最多一条)
+//-----------------------------------------------------------------------------
+void TcpServer::logAcceptError(int errorCode)
 {
-    while (!thread.isTerminated() && !taskList_.isEmpty())
-    {
-        tryConnect();
+    const UINT64 LOG_INTERVAL = 1000;  // 毫秒
 
-        int fromIndex = 0;
-        FdList fds, connectedFds, failedFds;
+    UINT64 nowTicks = Clock::getTicks();
+    INT64 lastTicks = lastAcceptErrorTicks_.get();
+    if (lastTicks != 0 && nowTicks - (UINT64)lastTicks < LOG_INTERVAL)
+        return;
+    if (!lastAcceptErrorTicks_.compareAndSet(lastTicks, (INT64)nowTicks))
+        return;
 
-        getPendingFdsFromTaskList(fromIndex, fds);
-        checkAsyncConnectState(fds, connectedFds, failedFds);
+    logger().writeFmt(SEM_TCP_ACCEPT_ERROR, errorCode);
+}
 
-        if (fromIndex >= taskList_.getCount())
-            fromIndex = 0;
+///////////////////////////////////////////////////////////////////////////////
+// class TcpConnector
 
-        for (int i = 0; i < (int)connectedFds.size(); ++i)
-        {
-            TaskItem *task = findTask(connectedFds[i]);
-            if (task != NULL)
-            {
-                task->state = ACS_CONNECTED;
-                task->tcpClient.getConnection().setContext(task->context);
-            }
-        }
+TcpConnector::TcpConnector() :
+    nextTaskId_(1)
+{
+    // nothing
+}
 
-        for (int i = 0; i < (int)failedFds.size(); ++i)
-        {
-            TaskItem *task = findTask(failedFds[i]);
-            if (task != NULL)
-            {
-                task->state = ACS_FAILED;
-                task->tcpClient.disconnect();
-            }
-        }
+TcpConnector::~TcpConnector()
+{
+    // 客户端事件循环均已停止，未完成的任务不再回调
+    AutoLocker locker(mutex_);
 
-        invokeCompleteCallback();
-    }
+    for (TaskMap::iterator iter = tasks_.begin(); iter != tasks_.end(); ++iter)
+        delete iter->second;
+    tasks_.clear();
 }
 
 //-----------------------------------------------------------------------------
-
-void TcpConnector::tryConnect()
+// 描述: 发起异步连接
+// 参数:
+//   timeout - 连接超时 (毫秒)，TIMEOUT_INFINITE 表示不限 (受限于系统的 SYN 重试)
+// 备注:
+//   completeCallback 在负责该连接的客户端事件循环线程中调用。
+//-----------------------------------------------------------------------------
+void TcpConnector::connect(const InetAddress& peerAddr,
+    const CompleteCallback& completeCallback, const Context& context, int timeout)
 {
-    AutoLocker locker(mutex_);
+    TcpEventLoopList& eventLoopList = iseApp().mainServer().getMainTcpServer().getTcpClientEventLoopList();
+
+    TaskItem *task = new TaskItem();
+    task->owner = this;
+    task->taskId = 0;
+    task->peerAddr = peerAddr;
+    task->completeCallback = completeCallback;
+    task->state = ACS_NONE;
+    task->context = context;
+    task->timeout = timeout;
+    task->eventLoop = NULL;
+    task->isWatching = false;
+    task->isTimedOut = false;
+    task->isCancelled = false;
+
+    // 连接对象在连接完成前以任务作为上下文，供 onConnectEvent() 找回任务。
+    // 预先填入对端地址，使按对端散列的分派策略无需 getpeername()。
+    TcpConnection& connection = task->tcpClient.getConnection();
+    connection.peerAddr_ = peerAddr;
+    connection.setContext(task);
+
+    int index = eventLoopList.placeConnection(&connection);
+    if (index < 0)
+    {
+        if (completeCallback)
+            completeCallback(false, NULL, peerAddr, context);
+        delete task;
+        return;
+    }
+
+    task->eventLoop = eventLoopList[index];
+    task->state = startConnect(task);
 
-    for (int i = 0; i < taskList_.getCount(); ++i)
     {
-        TaskItem *task = taskList_[i];
-        if (task->state == ACS_NONE)
-        {
-            task->state = (ASYNC_CONNECT_STATE)task->tcpClient.asyncConnect(
-                ipToString(task->peerAddr.ip), task->peerAddr.port, 0);
-        }
+        AutoLocker locker(mutex_);
+        task->taskId = nextTaskId_++;
+        tasks_[task->taskId] = task;
     }
+
+    task->eventLoop->delegateToLoop(boost::bind(&TcpConnector::startWatch, this, task));
 }
 
 //-----------------------------------------------------------------------------
-
-void TcpConnector::getPendingFdsFromTaskList(int& fromIndex, FdList& fds)
+// 描述: 取消全部进行中的连接 (被取消的任务不再回调)
+//-----------------------------------------------------------------------------
+void TcpConnector::clear()
 {
     AutoLocker locker(mutex_);
 
-    fds.clear();
-    for (int i = fromIndex; i < taskList_.getCount(); ++i)
+    for (TaskMap::iterator iter = tasks_.begin(); iter != tasks_.end(); ++iter)
     {
-        TaskItem *task = taskList_[i];
-        if (task->state == ACS_CONNECTING)
+        TaskItem *task = iter->second;
+        if (!task->isCancelled)
         {
-            fds.push_back(task->tcpClient.getConnection().getSocket().getHandle());
-            if (fds.size() >= FD_SETSIZE)
-            {
-                fromIndex = i + 1;
-                break;
-            }
+            task->isCancelled = true;
+            task->eventLoop->delegateToLoop(boost::bind(&TcpConnector::abortTask, this, task->taskId));
         }
     }
 }
 
 //-----------------------------------------------------------------------------
-
-void TcpConnector::checkAsyncConnectState(const FdList& fds,
-    FdList& connectedFds, FdList& failedFds)
+// 描述: 返回进行中的连接数
+//-----------------------------------------------------------------------------
+int TcpConnector::getPendingCount() const
 {
-    const int WAIT_TIME = 1;  // ms
+    AutoLocker locker(mutex_);
+    return (int)tasks_.size();
+}
 
-    fd_set rset, wset;
-    struct timeval tv;
-
-    connectedFds.clear();
-    failedFds.clear();
-
-    // init wset & rset
-    FD_ZERO(&rset);
-    for (int i = 0; i < (int)fds.size(); ++i)
-        FD_SET(fds[i], &rset);
-    wset = rset;
+//-----------------------------------------------------------------------------
+// 描述: 事件循环等待的连接已完成 (在事件循环线程中执行)
+//-----------------------------------------------------------------------------
+void TcpConnector::onConnectEvent(BaseTcpConnection *connection)
+{
+    TaskItem *task = boost::any_cast<TaskItem*>(connection->getContext());
+    task->isWatching = false;
 
-    // find max fd
-    SOCKET maxFd = 0;
-    for (int i = 0; i < (int)fds.size(); ++i)
+    if (task->isTimedOut)
+        task->state = ACS_FAILED;
+    else
     {
-        if (maxFd < fds[i])
-            maxFd = fds[i];
+        SOCKET handle = connection->getSocket().getHandle();
+        socklen_t errLen = sizeof(int);
+        int errorCode = 0;
+        if (getsockopt(handle, SOL_SOCKET, SO_ERROR, (char*)&errorCode, &errLen) < 0 || errorCode)
+            task->state = ACS_FAILED;
+        else
+            task->state = ACS_CONNECTED;
     }
 
-    tv.tv_sec = 0;
-    tv.tv_usec = WAIT_TIME * 1000;
+    task->owner->completeTask(task);
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 发起非阻塞连接 (在调用者线程中执行)
+// 返回: ACS_CONNECTING / ACS_CONNECTED / ACS_FAILED
+//-----------------------------------------------------------------------------
+ASYNC_CONNECT_STATE TcpConnector::startConnect(TaskItem *task)
+{
+    ASYNC_CONNECT_STATE result = ACS_FAILED;
+    TcpSocket& socket = task->tcpClient.getConnection().getSocket();
 
-    int r = select(maxFd + 1, &rset, &wset, NULL, &tv);
-    if (r > 0)
+    try
     {
-        for (int i = 0; i < (int)fds.size(); ++i)
+        socket.open();
+        if (socket.isActive())
         {
-            int state = ACS_CONNECTING;
-            SOCKET fd = fds[i];
-            if (FD_ISSET(fd, &rset) || FD_ISSET(fd, &wset))
-            {
-                socklen_t errLen = sizeof(int);
-                int errorCode = 0;
-                if (getsockopt(fd, SOL_SOCKET, SO_ERROR, (char*)&errorCode, &errLen) < 0 || errorCode)
-                    state = ACS_FAILED;
-                else
-                    state = ACS_CONNECTED;
-            }
+            SockAddr addr = task->peerAddr.getSockAddr();
 
-            if (state == ACS_CONNECTED)
-                connectedFds.push_back(fd);
-            else if (state == ACS_FAILED)
-                failedFds.push_back(fd);
+            socket.setBlockMode(false);
+            int r = ::connect(socket.getHandle(), (struct sockaddr*)&addr, sizeof(addr));
+            if (r == 0)
+                result = ACS_CONNECTED;
+#ifdef ISE_WINDOWS
+            else if (iseSocketGetLastError() == SS_EWOULDBLOCK)
+#endif
+#ifdef ISE_LINUX
+            else if (iseSocketGetLastError() == SS_EINPROGRESS)
+#endif
+                result = ACS_CONNECTING;
         }
     }
+    catch (Exception&)
+    {
+        socket.close();
+        result = ACS_FAILED;
+    }
+
+    return result;
 }
 
 //-----------------------------------------------------------------------------
-
-TcpConnector::TaskItem* TcpConnector::findTask(SOCKET fd)
+// 描述: 由事件循环等待连接完成，并开始超时计时 (在事件循环线程中执行)
+//-----------------------------------------------------------------------------
+void TcpConnector::startWatch(TaskItem *task)
 {
-    TaskItem *result = NULL;
+    bool isCancelled;
+    {
+        AutoLocker locker(mutex_);
+        isCancelled = task->isCancelled;
+    }
 
-    for (int i = 0; i < taskList_.getCount(); ++i)
+    if (task->state != ACS_CONNECTING || isCancelled)
     {
-        TaskItem *task = taskList_[i];
-        if (task->tcpClient.getConnection().getSocket().getHandle() == fd)
-        {
-            result = task;
-            break;
-        }
+        completeTask(task);
+        return;
     }
 
-    return result;
+    task->eventLoop->watchConnect(&task->tcpClient.getConnection());
+    task->isWatching = true;
+
+    if (task->timeout >= 0)
+    {
+        task->timeoutEntry.setCallback(boost::bind(&TcpConnector::onConnectTimeout, this, task));
+        task->eventLoop->getTimingWheel().schedule(task->timeoutEntry, task->timeout);
+    }
 }
 
 //-----------------------------------------------------------------------------
-
-void TcpConnector::invokeCompleteCallback()
+// 描述: 撤销事件循环的等待，并以失败结束任务 (在事件循环线程中执行)
+// 备注: 若只能异步撤销，则留待 onConnectEvent() 结束任务。
+//-----------------------------------------------------------------------------
+void TcpConnector::abortWatch(TaskItem *task)
 {
-    TaskList completeList(false, true);
+    if (!task->isWatching) return;
 
+    task->isTimedOut = true;
+    if (task->eventLoop->unwatchConnect(&task->tcpClient.getConnection()))
     {
-        AutoLocker locker(mutex_);
+        task->isWatching = false;
+        task->state = ACS_FAILED;
+        completeTask(task);
+    }
+}
 
-        for (int i = 0; i < taskList_.getCount(); ++i)
-        {
-            TaskItem *task = taskList_[i];
-            if (task->state == ACS_CONNECTED || task->state == ACS_FAILED)
-            {
-                taskList_.extract(i);
-                completeList.add(task);
-            }
-        }
+//-----------------------------------------------------------------------------
+// 描述: 中止被 clear() 取消的任务 (在事件循环线程中执行)
+// 备注: 任务可能已先行结束，故按 taskId 查找。
+//-----------------------------------------------------------------------------
+void TcpConnector::abortTask(UINT64 taskId)
+{
+    TaskItem *task = NULL;
+    {
+        AutoLocker locker(mutex_);
+        TaskMap::iterator iter = tasks_.find(taskId);
+        if (iter != tasks_.end())
+            task = iter->second;
     }
 
-    for (int i = 0; i < completeList.getCount(); ++i)
+    // 尚未开始等待的任务由 startWatch() 结束
+    if (task != NULL)
+        abortWatch(task);
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 连接超时 (在事件循环线程中执行)
+//-----------------------------------------------------------------------------
+void TcpConnector::onConnectTimeout(TaskItem *task)
+{
+    abortWatch(task);
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 结束任务: 成功时将连接加入事件循环，回调，然后释放任务 (在事件循环线程中执行)
+// 备注: 连接先于回调加入事件循环，所以回调中即可收发数据。
+//-----------------------------------------------------------------------------
+void TcpConnector::completeTask(TaskItem *task)
+{
+    bool isCancelled;
     {
-        TaskItem *task = completeList[i];
-        if (task->completeCallback)
-        {
-            bool success = (task->state == ACS_CONNECTED);
+        AutoLocker locker(mutex_);
+        tasks_.erase(task->taskId);
+        isCancelled = task->isCancelled;
+    }
 
-            task->completeCallback(success,
-                success ? &task->tcpClient.getConnection() : NULL,
-                task->peerAddr, task->context);
+    task->timeoutEntry.cancel();
 
-            if (success)
-                task->tcpClient.registerToEventLoop();
-        }
+    TcpEventLoop *eventLoop = task->eventLoop;
+    TcpConnection *connection = &task->tcpClient.getConnection();
+    TcpConnectionPtr connPtr;
+    bool success = (task->state == ACS_CONNECTED && !isCancelled && !iseApp().isTerminated());
+
+    if (success)
+    {
+        connection->setContext(task->context);
+        task->tcpClient.connection_ = NULL;
+        eventLoop->addPlacedConnection(connection);
+        // 保证回调期间连接对象有效 (回调中可能断开连接)
+        connPtr = connection->shared_from_this();
+    }
+    else
+    {
+        task->tcpClient.disconnect();
+        eventLoop->pendingConnCount_.decrement();
     }
-}
 
-///////////////////////////////////////////////////////////////////////////////
+    if (!isCancelled && task->completeCallback)
+    {
+        task->completeCallback(success, success ? connection : NULL,
+            task->peerAddr, task->context);
+    }
 
-#ifdef ISE_WINDOWS
+    delete task;
+}
 
 ///////////////////////////////////////////////////////////////////////////////
-// class WinTcpConnection
-
-WinTcpConnection::WinTcpConnection()
+// class TcpPeerPool
+
+TcpPeerPool::TcpPeerPool() :
+    connsPerPeer_(DEF_CONNS_PER_PEER),
+    maxIdleTime_(DEF_MAX_IDLE_TIME),
+    connectTimeout_(DEF_CONNECT_TIMEOUT),
+    nextPeerId_(1),
+    lifeGuard_(new LifeGuard()),
+    maintainLoop_(NULL),
+    maintainTimerId_(0)
 {
-    init();
+    lifeGuard_->pool = this;
 }
 
-WinTcpConnection::WinTcpConnection(TcpServer *tcpServer, SOCKET socketHandle) :
-    TcpConnection(tcpServer, socketHandle)
+TcpPeerPool::~TcpPeerPool()
 {
-    init();
+    // 此后到达的连接器回调和定时器回调不再访问本对象
+    {
+        AutoLocker locker(lifeGuard_->mutex);
+        lifeGuard_->pool = NULL;
+    }
+
+    if (maintainLoop_ != NULL && !iseApp().isTerminated())
+        maintainLoop_->cancelTimer(maintainTimerId_);
+
+    // 空闲连接随 shared_ptr 的释放交还给各自的事件循环，等待者不再回调
+    for (PeerMap::iterator iter = peers_.begin(); iter != peers_.end(); ++iter)
+    {
+        Peer *peer = iter->second;
+        for (IdleConnList::iterator it = peer->idleConns.begin(); it != peer->idleConns.end(); ++it)
+            it->connection->disconnect();
+        delete peer;
+    }
+    peers_.clear();
 }
 
 //-----------------------------------------------------------------------------
-
-void WinTcpConnection::init()
+// 描述: 添加对端，并预先建立 getConnsPerPeer() 个连接
+// 备注: acquire() 会自动添加未知的对端，预先调用此函数可消除首批请求的连接延迟。
+//-----------------------------------------------------------------------------
+void TcpPeerPool::addPeer(const InetAddress& peerAddr)
 {
-    isSending_ = false;
-    isRecving_ = false;
-    bytesSent_ = 0;
-    bytesRecved_ = 0;
+    Deferred deferred;
+    {
+        AutoLocker locker(mutex_);
+        replenish(getPeer(peerAddr), deferred);
+    }
+
+    startMaintainTimer();
+    finish(deferred);
 }
 
 //-----------------------------------------------------------------------------
-
-void WinTcpConnection::eventLoopChanged()
+// 描述: 删除对端: 关闭其空闲连接，等待中的请求失败
+// 备注: 此后归还的该对端的连接将被关闭。
+//-----------------------------------------------------------------------------
+void TcpPeerPool::removePeer(const InetAddress& peerAddr)
 {
-    if (getEventLoop() != NULL)
+    Deferred deferred;
     {
-        getEventLoop()->assertInLoopThread();
-        tryRecv();
+        AutoLocker locker(mutex_);
+        Peer *peer = findPeer(peerAddr);
+        if (peer != NULL)
+            deletePeer(peer, deferred);
     }
+
+    finish(deferred);
 }
 
 //-----------------------------------------------------------------------------
-// 描述: 提交一个发送任务
+// 描述: 借出一个连接到 peerAddr 的连接
+// 参数:
+//   callback - 借出连接后的回调。有空闲连接时在本线程中立即回调，否则在连接归还或
+//              新建完成时回调。等待超时或连接失败时，回调的 connection 为空。
+//   timeout  - 最多等待的毫秒数 (精度为 MAINTAIN_INTERVAL)，TIMEOUT_INFINITE 表示不限。
 //-----------------------------------------------------------------------------
-void WinTcpConnection::postSendTask(const void *buffer, int size,
-    const Context& context, int timeout)
+void TcpPeerPool::acquire(const InetAddress& peerAddr, const AcquireCallback& callback,
+    int timeout)
 {
-    sendBuffer_.append(buffer, size);
+    TcpInspectInfo& info = TcpInspectInfo::instance();
+    Deferred deferred;
 
-    SendTask task;
-    task.bytes = size;
-    task.context = context;
-    task.timeout = timeout;
+    info.peerPoolAcquireCount.increment();
 
-    sendTaskQueue_.push_back(task);
+    {
+        AutoLocker locker(mutex_);
+        Peer *peer = getPeer(peerAddr);
+        TcpConnectionPtr connection;
 
-    trySend();
+        // 优先借出最近归还的连接
+        while (!peer->idleConns.empty() && !connection)
+        {
+            IdleConn& idleConn = peer->idleConns.back();
+            if (isAlive(*idleConn.connection))
+                connection = idleConn.connection;
+            else
+            {
+                deferred.closingConns.push_back(idleConn.connection);
+                info.peerPoolIdleCloseCount.increment();
+            }
+            peer->idleConns.pop_back();
+        }
+
+        if (connection)
+        {
+            info.peerPoolHitCount.increment();
+            peer->borrowedCount++;
+            PendingCall call = { callback, connection, peerAddr };
+            deferred.calls.push_back(call);
+        }
+        else
+        {
+            Waiter waiter;
+            waiter.callback = callback;
+            waiter.startTicks = Clock::getTicks();
+            waiter.timeout = timeout;
+            peer->waiters.push_back(waiter);
+        }
+
+        replenish(peer, deferred);
+    }
+
+    startMaintainTimer();
+    finish(deferred);
 }
 
 //-----------------------------------------------------------------------------
-// 描述: 提交一个接收任务
+// 描述: 归还 acquire() 借出的连接
+// 参数:
+//   reusable - 连接是否可以再次借出。连接上若还有未收完的应答等，应为 false，
+//              此时连接被关闭，由连接池补足。
 //-----------------------------------------------------------------------------
-void WinTcpConnection::postRecvTask(const PacketSplitter& packetSplitter,
-    const Context& context, int timeout)
+void TcpPeerPool::release(const TcpConnectionPtr& connection, bool reusable)
 {
-    RecvTask task;
-    task.packetSplitter = packetSplitter;
-    task.context = context;
-    task.timeout = timeout;
+    if (!connection) return;
 
-    recvTaskQueue_.push_back(task);
+    Deferred deferred;
+    {
+        AutoLocker locker(mutex_);
+        Peer *peer = findPeer(connection->getPeerAddr());
+        if (peer != NULL)
+        {
+            peer->borrowedCount--;
+            if (reusable && isAlive(*connection))
+                lend(peer, connection, deferred);
+            else
+            {
+                deferred.closingConns.push_back(connection);
+                replenish(peer, deferred);
+            }
+        }
+        else
+            deferred.closingConns.push_back(connection);
+    }
 
-    tryRecv();
+    finish(deferred);
 }
 
 //-----------------------------------------------------------------------------
 
-void WinTcpConnection::trySend()
+int TcpPeerPool::getPeerCount() const
 {
-    if (isSending_) return;
+    AutoLocker locker(mutex_);
+    return (int)peers_.size();
+}
 
-    int readableBytes = sendBuffer_.getReadableBytes();
-    if (readableBytes > 0)
-    {
-        const int MAX_SEND_SIZE = 1024*32;
+//-----------------------------------------------------------------------------
 
-        const char *buffer = sendBuffer_.peek();
-        int sendSize = ise::min(readableBytes, MAX_SEND_SIZE);
+int TcpPeerPool::getIdleCount() const
+{
+    AutoLocker locker(mutex_);
 
-        isSending_ = true;
-        getEventLoop()->getIocpObject()->send(
-            getSocket().getHandle(),
-            (PVOID)buffer, sendSize, 0,
-            boost::bind(&WinTcpConnection::onIocpCallback, shared_from_this(), _1),
-            this, EMPTY_CONTEXT);
-    }
+    int result = 0;
+    for (PeerMap::const_iterator iter = peers_.begin(); iter != peers_.end(); ++iter)
+        result += (int)iter->second->idleConns.size();
+    return result;
 }
 
 //-----------------------------------------------------------------------------
 
-void WinTcpConnection::tryRecv()
+int TcpPeerPool::getBorrowedCount() const
 {
-    if (isRecving_) return;
+    AutoLocker locker(mutex_);
 
-    const int MAX_BUFFER_SIZE = iseApp().iseOptions().getTcpMaxRecvBufferSize();
-    const int MAX_RECV_SIZE = 1024*16;
+    int result = 0;
+    for (PeerMap::const_iterator iter = peers_.begin(); iter != peers_.end(); ++iter)
+        result += iter->second->borrowedCount;
+    return result;
+}
 
-    if (recvTaskQueue_.empty() && recvBuffer_.getReadableBytes() >= MAX_BUFFER_SIZE)
-        return;
+//-----------------------------------------------------------------------------
 
-    isRecving_ = true;
-    recvBuffer_.append(MAX_RECV_SIZE);
-    const char *buffer = recvBuffer_.peek() + bytesRecved_;
+UINT64 TcpPeerPool::getPeerKey(const InetAddress& peerAddr)
+{
+    return ((UINT64)peerAddr.ip << 16) | peerAddr.port;
+}
 
-    getEventLoop()->getIocpObject()->recv(
-        getSocket().getHandle(),
-        (PVOID)buffer, MAX_RECV_SIZE, 0,
-        boost::bind(&WinTcpConnection::onIocpCallback, shared_from_this(), _1),
-        this, EMPTY_CONTEXT);
+//-----------------------------------------------------------------------------
+// 描述: 判断连接是否仍然可用
+// 备注: 事件循环始终在接收，对端关闭或连接出错时即已调用 errorOccurred()。
+//-----------------------------------------------------------------------------
+bool TcpPeerPool::isAlive(TcpConnection& connection)
+{
+    return connection.isConnected() && !connection.isErrorOccurred();
 }
 
 //-----------------------------------------------------------------------------
+// 描述: 连接池发起的连接已完成 (在客户端事件循环线程中执行)
+//-----------------------------------------------------------------------------
+void TcpPeerPool::onConnectComplete(const LifeGuardPtr& guard, bool success,
+    TcpConnection *connection, const InetAddress& peerAddr, const Context& context)
+{
+    AutoLocker locker(guard->mutex);
 
-void WinTcpConnection::onIocpCallback(const TcpConnectionPtr& thisObj, const IocpTaskData& taskData)
+    if (guard->pool != NULL)
+        guard->pool->connectComplete(success, connection, boost::any_cast<UINT64>(context), peerAddr);
+    else if (success)
+        connection->disconnect();
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 后台维护定时器 (在客户端事件循环线程中执行)
+//-----------------------------------------------------------------------------
+void TcpPeerPool::onMaintainTimer(const LifeGuardPtr& guard)
 {
-    WinTcpConnection *thisPtr = static_cast<WinTcpConnection*>(thisObj.get());
-    if (thisPtr->isErrorOccurred_) return;
+    AutoLocker locker(guard->mutex);
 
-    if (taskData.getErrorCode() == 0)
-    {
-        switch (taskData.getTaskType())
-        {
-        case ITT_SEND:
-            thisPtr->onSendCallback(taskData);
-            break;
-        case ITT_RECV:
-            thisPtr->onRecvCallback(taskData);
-            break;
-        }
-    }
-    else
+    if (guard->pool != NULL)
+        guard->pool->maintain();
+}
+
+//-----------------------------------------------------------------------------
+
+TcpPeerPool::Peer* TcpPeerPool::findPeer(const InetAddress& peerAddr)
+{
+    PeerMap::iterator iter = peers_.find(getPeerKey(peerAddr));
+    return (iter != peers_.end() ? iter->second : NULL);
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 查找对端，不存在则添加
+//-----------------------------------------------------------------------------
+TcpPeerPool::Peer* TcpPeerPool::getPeer(const InetAddress& peerAddr)
+{
+    Peer *result = findPeer(peerAddr);
+    if (result == NULL)
     {
-        thisPtr->errorOccurred();
+        result = new Peer();
+        result->peerId = nextPeerId_++;
+        result->addr = peerAddr;
+        result->borrowedCount = 0;
+        result->connectingCount = 0;
+        result->retryTicks = 0;
+        result->isWarmedUp = false;
+        peers_[getPeerKey(peerAddr)] = result;
     }
+
+    return result;
 }
 
 //-----------------------------------------------------------------------------
 
-void WinTcpConnection::onSendCallback(const IocpTaskData& taskData)
+void TcpPeerPool::deletePeer(Peer *peer, Deferred& deferred)
 {
-    ISE_ASSERT(taskData.getErrorCode() == 0);
+    for (IdleConnList::iterator iter = peer->idleConns.begin(); iter != peer->idleConns.end(); ++iter)
+        deferred.closingConns.push_back(iter->connection);
+    failWaiters(peer, deferred);
 
-    if (taskData.getBytesTrans() < taskData.getDataSize())
+    peers_.erase(getPeerKey(peer->addr));
+    delete peer;
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 将可用的连接交给最早的等待者，没有等待者则放入空闲连接
+//-----------------------------------------------------------------------------
+void TcpPeerPool::lend(Peer *peer, const TcpConnectionPtr& connection, Deferred& deferred)
+{
+    if (!peer->waiters.empty())
     {
-        getEventLoop()->getIocpObject()->send(
-            (SOCKET)taskData.getFileHandle(),
-            taskData.getEntireDataBuf(),
-            taskData.getEntireDataSize(),
-            taskData.getDataBuf() - taskData.getEntireDataBuf() + taskData.getBytesTrans(),
-            taskData.getCallback(), taskData.getCaller(), taskData.getContext());
+        TcpInspectInfo& info = TcpInspectInfo::instance();
+        Waiter& waiter = peer->waiters.front();
+
+        info.peerPoolWaitCount.increment();
+        info.peerPoolWaitMSecs.getAndAdd((INT64)getTickDiff(waiter.startTicks, Clock::getTicks()));
+
+        peer->borrowedCount++;
+        PendingCall call = { waiter.callback, connection, peer->addr };
+        deferred.calls.push_back(call);
+        peer->waiters.pop_front();
     }
     else
     {
-        isSending_ = false;
-        sendBuffer_.retrieve(taskData.getEntireDataSize());
+        IdleConn idleConn = { connection, Clock::getTicks() };
+        peer->idleConns.push_back(idleConn);
     }
+}
 
-    bytesSent_ += taskData.getBytesTrans();
-
-    while (!sendTaskQueue_.empty())
-    {
-        SendTask& task = sendTaskQueue_.front();
+//-----------------------------------------------------------------------------
+// 描述: 使全部等待者失败
+//-----------------------------------------------------------------------------
+void TcpPeerPool::failWaiters(Peer *peer, Deferred& deferred)
+{
+    for (WaiterList::iterator iter = peer->waiters.begin(); iter != peer->waiters.end(); ++iter)
+    {
+        TcpInspectInfo::instance().peerPoolWaitFailCount.increment();
+        PendingCall call = { iter->callback, TcpConnectionPtr(), peer->addr };
+        deferred.calls.push_back(call);
+    }
+    peer->waiters.clear();
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 补足对端的连接数 (连接失败后 RECONNECT_DELAY 毫秒内不再连接)
+//-----------------------------------------------------------------------------
+void TcpPeerPool::replenish(Peer *peer, Deferred& deferred)
+{
+    int count = connsPerPeer_ -
+        ((int)peer->idleConns.size() + peer->borrowedCount + peer->connectingCount);
+    if (count <= 0 || Clock::getTicks() < peer->retryTicks) return;
+
+    if (peer->isWarmedUp)
+        TcpInspectInfo::instance().peerPoolReconnectCount.getAndAdd(count);
+    peer->isWarmedUp = true;
+    peer->connectingCount += count;
+
+    PendingConnect connect = { peer->peerId, peer->addr, count };
+    deferred.connects.push_back(connect);
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 维护一个对端: 等待超时、丢弃失效或空闲超时的连接、补足连接数
+//-----------------------------------------------------------------------------
+void TcpPeerPool::maintainPeer(Peer *peer, Deferred& deferred)
+{
+    TcpInspectInfo& info = TcpInspectInfo::instance();
+    UINT64 now = Clock::getTicks();
+
+    for (WaiterList::iterator iter = peer->waiters.begin(); iter != peer->waiters.end(); )
+    {
+        if (iter->timeout >= 0 && getTickDiff(iter->startTicks, now) >= (UINT64)iter->timeout)
+        {
+            info.peerPoolWaitFailCount.increment();
+            PendingCall call = { iter->callback, TcpConnectionPtr(), peer->addr };
+            deferred.calls.push_back(call);
+            iter = peer->waiters.erase(iter);
+        }
+        else
+            ++iter;
+    }
+
+    for (IdleConnList::iterator iter = peer->idleConns.begin(); iter != peer->idleConns.end(); )
+    {
+        bool isExpired = (maxIdleTime_ > 0 &&
+            getTickDiff(iter->idleTicks, now) >= (UINT64)maxIdleTime_);
+
+        if (isExpired || !isAlive(*iter->connection))
+        {
+            info.peerPoolIdleCloseCount.increment();
+            deferred.closingConns.push_back(iter->connection);
+            iter = peer->idleConns.erase(iter);
+        }
+        else
+            ++iter;
+    }
+
+    replenish(peer, deferred);
+}
+
+//-----------------------------------------------------------------------------
+
+void TcpPeerPool::connectComplete(bool success, TcpConnection *connection, UINT64 peerId,
+    const InetAddress& peerAddr)
+{
+    Deferred deferred;
+    {
+        AutoLocker locker(mutex_);
+        Peer *peer = findPeer(peerAddr);
+
+        // 发起连接后对端已被删除 (或删除后又重新添加)
+        if (peer == NULL || peer->peerId != peerId)
+        {
+            if (success)
+                deferred.closingConns.push_back(connection->shared_from_this());
+        }
+        else
+        {
+            peer->connectingCount--;
+            if (success)
+            {
+                connection->setKeepAlive(true);
+                lend(peer, connection->shared_from_this(), deferred);
+            }
+            else
+            {
+                TcpInspectInfo::instance().peerPoolConnectFailCount.increment();
+                peer->retryTicks = Clock::getTicks() + RECONNECT_DELAY;
+
+                // 对端已无任何连接，等待者不必再等
+                if (peer->idleConns.empty() && peer->borrowedCount == 0 && peer->connectingCount == 0)
+                    failWaiters(peer, deferred);
+            }
+        }
+    }
+
+    finish(deferred);
+}
+
+//-----------------------------------------------------------------------------
+
+void TcpPeerPool::maintain()
+{
+    Deferred deferred;
+    {
+        AutoLocker locker(mutex_);
+        for (PeerMap::iterator iter = peers_.begin(); iter != peers_.end(); ++iter)
+            maintainPeer(iter->second, deferred);
+    }
+
+    finish(deferred);
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 在客户端事件循环中启动后台维护定时器
+//-----------------------------------------------------------------------------
+void TcpPeerPool::startMaintainTimer()
+{
+    if (maintainLoop_ != NULL) return;
+
+    AutoLocker locker(mutex_);
+
+    if (maintainLoop_ == NULL)
+    {
+        TcpEventLoopList& eventLoopList = iseApp().mainServer().getMainTcpServer().getTcpClientEventLoopList();
+        if (eventLoopList.getCount() > 0)
+        {
+            maintainLoop_ = eventLoopList[0];
+            maintainTimerId_ = maintainLoop_->executeEvery(MAINTAIN_INTERVAL,
+                boost::bind(&TcpPeerPool::onMaintainTimer, lifeGuard_), MAINTAIN_INTERVAL / 2);
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 在锁外发起连接、关闭连接并执行回调
+//-----------------------------------------------------------------------------
+void TcpPeerPool::finish(Deferred& deferred)
+{
+    TcpConnector& connector = iseApp().tcpConnector();
+
+    for (size_t i = 0; i < deferred.connects.size(); ++i)
+    {
+        const PendingConnect& connect = deferred.connects[i];
+        for (int j = 0; j < connect.count; ++j)
+        {
+            connector.connect(connect.peerAddr,
+                boost::bind(&TcpPeerPool::onConnectComplete, lifeGuard_, _1, _2, _3, _4),
+                connect.peerId, connectTimeout_);
+        }
+    }
+
+    for (size_t i = 0; i < deferred.closingConns.size(); ++i)
+        deferred.closingConns[i]->disconnect();
+
+    for (size_t i = 0; i < deferred.calls.size(); ++i)
+    {
+        const PendingCall& call = deferred.calls[i];
+        if (call.callback)
+            call.callback(call.connection, call.peerAddr);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+// class OffloadPool
+
+OffloadPool::OffloadPool(const string& name, int threadCount, int maxInFlight) :
+    name_(name),
+    threadCount_(ise::max(threadCount, 1)),
+    maxInFlight_(ise::max(maxInFlight, 0)),
+    stat_(new Stat())
+{
+    // nothing
+}
+
+OffloadPool::~OffloadPool()
+{
+    stop();
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 启动线程池
+//-----------------------------------------------------------------------------
+void OffloadPool::start()
+{
+    if (!threadPool_.isRunning())
+        threadPool_.start(threadCount_);
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 停止线程池 (等待执行中的任务返回)
+//-----------------------------------------------------------------------------
+void OffloadPool::stop()
+{
+    if (threadPool_.isRunning())
+        threadPool_.stop();
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 为新任务占用一个名额，池未启动或任务数已达上限时返回 false
+//-----------------------------------------------------------------------------
+bool OffloadPool::acquireSlot()
+{
+    bool result = threadPool_.isRunning();
+
+    if (result)
+    {
+        int count = stat_->inFlightCount.increment();
+        if (maxInFlight_ > 0 && count > maxInFlight_)
+        {
+            stat_->inFlightCount.decrement();
+            result = false;
+        }
+    }
+
+    if (result)
+        stat_->submitCount.increment();
+    else
+        stat_->rejectCount.increment();
+
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 连接已断开 (或已销毁) 时返回 true
+//-----------------------------------------------------------------------------
+bool OffloadPool::isConnectionClosed(const boost::weak_ptr<TcpConnection>& connection)
+{
+    TcpConnectionPtr conn = connection.lock();
+    return !conn || !conn->isConnected() || conn->isErrorOccurred();
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 检查任务是否已被取消
+//-----------------------------------------------------------------------------
+bool OffloadPool::isCanceled(const CancelCheck& cancelCheck, Stat& stat)
+{
+    bool result = (cancelCheck && cancelCheck());
+    if (result)
+        stat.cancelCount.increment();
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 执行任务，记录执行时长及异常信息
+//-----------------------------------------------------------------------------
+void OffloadPool::runWork(const boost::function<void ()>& invoker, OffloadStatus& status, Stat& stat)
+{
+    UINT64 startMicroTicks = getCurMicroTicks();
+
+    try
+    {
+        invoker();
+        status.isOk = true;
+    }
+    catch (Exception& e)
+    {
+        status.errorMsg = e.getErrorMessage();
+    }
+    catch (std::exception& e)
+    {
+        status.errorMsg = e.what();
+    }
+
+    status.execMicroSecs = (INT64)(getCurMicroTicks() - startMicroTicks);
+    stat.execMicroSecs.getAndAdd(status.execMicroSecs);
+    stat.execCount.increment();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// class OffloadPoolList
+
+OffloadPoolList::OffloadPoolList()
+{
+    IseOptions& options = iseApp().iseOptions();
+
+    for (int i = 0; i < options.getOffloadPoolCount(); ++i)
+    {
+        string name;
+        int threadCount, maxInFlight;
+        options.getOffloadPool(i, name, threadCount, maxInFlight);
+        items_.push_back(new OffloadPool(name, threadCount, maxInFlight));
+    }
+}
+
+OffloadPoolList::~OffloadPoolList()
+{
+    stop();
+    for (size_t i = 0; i < items_.size(); ++i)
+        delete items_[i];
+    items_.clear();
+}
+
+//-----------------------------------------------------------------------------
+
+void OffloadPoolList::start()
+{
+    for (size_t i = 0; i < items_.size(); ++i)
+        items_[i]->start();
+}
+
+//-----------------------------------------------------------------------------
+
+void OffloadPoolList::stop()
+{
+    for (size_t i = 0; i < items_.size(); ++i)
+        items_[i]->stop();
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 按名称查找卸载池，找不到时返回 NULL
+//-----------------------------------------------------------------------------
+OffloadPool* OffloadPoolList::find(const string& name)
+{
+    for (size_t i = 0; i < items_.size(); ++i)
+    {
+        if (items_[i]->getName() == name)
+            return items_[i];
+    }
+    return NULL;
+}
+
+
+#ifdef ISE_WINDOWS
+
+///////////////////////////////////////////////////////////////////////////////
+// class WinTcpConnection
+
+WinTcpConnection::WinTcpConnection()
+{
+    init();
+}
+
+WinTcpConnection::WinTcpConnection(TcpServer *tcpServer, SOCKET socketHandle) :
+    TcpConnection(tcpServer, socketHandle)
+{
+    init();
+}
+
+//-----------------------------------------------------------------------------
+
+void WinTcpConnection::init()
+{
+    isSending_ = false;
+    isRecving_ = false;
+    bytesSent_ = 0;
+    bytesRecved_ = 0;
+}
+
+//-----------------------------------------------------------------------------
+
+void WinTcpConnection::eventLoopChanged()
+{
+    if (getEventLoop() != NULL)
+    {
+        getEventLoop()->assertInLoopThread();
+        tryRecv();
+    }
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 提交一个发送任务
+//-----------------------------------------------------------------------------
+void WinTcpConnection::postSendTask(const void *buffer, int size,
+    const Context& context, int timeout)
+{
+    if (!checkSendBufferCap(size)) return;
+
+    sendBuffer_.append(buffer, size);
+    addSendQueuedBytes(size);
+
+    SendTask task;
+    task.bytes = size;
+    task.context = context;
+    task.timeout = timeout;
+
+    sendTaskQueue_.push_back(task);
+    updateSendTimeout();
+
+    trySend();
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 提交一个接收任务
+//-----------------------------------------------------------------------------
+void WinTcpConnection::postRecvTask(const PacketSplitter& packetSplitter,
+    const Context& context, int timeout)
+{
+    RecvTask task;
+    task.packetSplitter = packetSplitter;
+    task.context = context;
+    task.timeout = timeout;
+
+    recvTaskQueue_.push_back(task);
+    updateRecvTimeout();
+
+    tryRecv();
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 启用或停止连续接收模式
+//-----------------------------------------------------------------------------
+void WinTcpConnection::postContinuousRecv(const PacketSplitter& packetSplitter,
+    bool batchMode, const Context& context)
+{
+    TcpConnection::postContinuousRecv(packetSplitter, batchMode, context);
+
+    if (isContinuousRecv())
+        tryRecv();
+}
+
+//-----------------------------------------------------------------------------
+
+void WinTcpConnection::trySend()
+{
+    if (isSending_) return;
+
+    int readableBytes = sendBuffer_.getReadableBytes();
+    if (readableBytes > 0)
+    {
+        const int MAX_SEND_SIZE = 1024*32;
+
+        const char *buffer = sendBuffer_.peek();
+        int sendSize = ise::min(readableBytes, MAX_SEND_SIZE);
+
+        isSending_ = true;
+        getEventLoop()->getIocpObject()->send(
+            getSocket().getHandle(),
+            (PVOID)buffer, sendSize, 0,
+            boost::bind(&WinTcpConnection::onIocpCallback, shared_from_this(), _1),
+            this, EMPTY_CONTEXT);
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+void WinTcpConnection::tryRecv()
+{
+    if (isRecving_) return;
+
+    const int MAX_BUFFER_SIZE = iseApp().iseOptions().getTcpMaxRecvBufferSize();
+    const int MAX_RECV_SIZE = 1024*16;
+
+    if (!hasRecvDemand() && recvBuffer_.getReadableBytes() >= MAX_BUFFER_SIZE)
+        return;
+
+    isRecving_ = true;
+    recvBuffer_.append(MAX_RECV_SIZE);
+    const char *buffer = recvBuffer_.peek() + bytesRecved_;
+
+    getEventLoop()->getIocpObject()->recv(
+        getSocket().getHandle(),
+        (PVOID)buffer, MAX_RECV_SIZE, 0,
+        boost::bind(&WinTcpConnection::onIocpCallback, shared_from_this(), _1),
+        this, EMPTY_CONTEXT);
+}
+
+//-----------------------------------------------------------------------------
+
+void WinTcpConnection::onIocpCallback(const TcpConnectionPtr& thisObj, const IocpTaskData& taskData)
+{
+    WinTcpConnection *thisPtr = static_cast<WinTcpConnection*>(thisObj.get());
+    if (thisPtr->isErrorOccurred_) return;
+
+    if (taskData.getErrorCode() == 0)
+    {
+        switch (taskData.getTaskType())
+        {
+        case ITT_SEND:
+            thisPtr->onSendCallback(taskData);
+            break;
+        case ITT_RECV:
+            thisPtr->onRecvCallback(taskData);
+            break;
+        }
+    }
+    else
+    {
+        thisPtr->errorOccurred();
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+void WinTcpConnection::onSendCallback(const IocpTaskData& taskData)
+{
+    ISE_ASSERT(taskData.getErrorCode() == 0);
+
+    if (taskData.getBytesTrans() < taskData.getDataSize())
+    {
+        getEventLoop()->getIocpObject()->send(
+            (SOCKET)taskData.getFileHandle(),
+            taskData.getEntireDataBuf(),
+            taskData.getEntireDataSize(),
+            taskData.getDataBuf() - taskData.getEntireDataBuf() + taskData.getBytesTrans(),
+            taskData.getCallback(), taskData.getCaller(), taskData.getContext());
+    }
+    else
+    {
+        isSending_ = false;
+        sendBuffer_.retrieve(taskData.getEntireDataSize());
+    }
+
+    bytesSent_ += taskData.getBytesTrans();
+    removeSendQueuedBytes(taskData.getBytesTrans());
+    markActive();
+
+    while (!sendTaskQueue_.empty())
+    {
+        SendTask& task = sendTaskQueue_.front();
         if (bytesSent_ >= task.bytes)
         {
-            bytesSent_ -= task.bytes;
-            iseApp().iseBusiness().onTcpSendComplete(shared_from_this(), task.context);
-            sendTaskQueue_.pop_front();
+            bytesSent_ -= task.bytes;
+            iseApp().iseBusiness().onTcpSendComplete(shared_from_this(), task.context);
+            sendTaskQueue_.pop_front();
+            updateSendTimeout();
+        }
+        else
+            break;
+    }
+
+    if (!sendTaskQueue_.empty())
+        trySend();
+}
+
+//-----------------------------------------------------------------------------
+
+void WinTcpConnection::onRecvCallback(const IocpTaskData& taskData)
+{
+    ISE_ASSERT(taskData.getErrorCode() == 0);
+
+    if (taskData.getBytesTrans() < taskData.getDataSize())
+    {
+        getEventLoop()->getIocpObject()->recv(
+            (SOCKET)taskData.getFileHandle(),
+            taskData.getEntireDataBuf(),
+            taskData.getEntireDataSize(),
+            taskData.getDataBuf() - taskData.getEntireDataBuf() + taskData.getBytesTrans(),
+            taskData.getCallback(), taskData.getCaller(), taskData.getContext());
+    }
+    else
+    {
+        isRecving_ = false;
+    }
+
+    bytesRecved_ += taskData.getBytesTrans();
+    markActive();
+
+    while (!recvTaskQueue_.empty())
+    {
+        RecvTask& task = recvTaskQueue_.front();
+        const char *buffer = recvBuffer_.peek();
+        bool packetRecved = false;
+
+        if (bytesRecved_ > 0)
+        {
+            int packetSize = 0;
+            task.packetSplitter(buffer, bytesRecved_, packetSize);
+            if (packetSize > 0)
+            {
+                bytesRecved_ -= packetSize;
+                iseApp().iseBusiness().onTcpRecvComplete(shared_from_this(),
+                    (void*)buffer, packetSize, task.context);
+                recvTaskQueue_.pop_front();
+                recvBuffer_.retrieve(packetSize);
+                updateRecvTimeout();
+                packetRecved = true;
+            }
+        }
+
+        if (!packetRecved)
+            break;
+    }
+
+    if (recvTaskQueue_.empty() && isContinuousRecv() && bytesRecved_ > 0)
+    {
+        int packetBytes = deliverContinuousPackets(recvBuffer_.peek(), bytesRecved_);
+        bytesRecved_ -= packetBytes;
+        recvBuffer_.retrieve(packetBytes);
+    }
+
+    tryRecv();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// class WinTcpEventLoop
+
+WinTcpEventLoop::WinTcpEventLoop() :
+    connectCheckTimerId_(0)
+{
+    // nothing
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 将新连接注册到事件循环中
+//-----------------------------------------------------------------------------
+void WinTcpEventLoop::registerConnection(TcpConnection *connection)
+{
+    iocpObject_->associateHandle(connection->getSocket().getHandle());
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 从事件循环中注销连接
+//-----------------------------------------------------------------------------
+void WinTcpEventLoop::unregisterConnection(TcpConnection *connection)
+{
+    // nothing
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 等待非阻塞连接完成
+// 备注: IOCP 无法通知 connect() 完成 (ConnectEx 须预先 bind)，故每隔
+//       CONNECT_CHECK_INTERVAL 毫秒以零超时的 select() 检查一次。
+//-----------------------------------------------------------------------------
+void WinTcpEventLoop::watchConnect(BaseTcpConnection *connection)
+{
+    connectWatches_.insert(connection);
+    if (connectCheckTimerId_ == 0)
+    {
+        connectCheckTimerId_ = executeEvery(CONNECT_CHECK_INTERVAL,
+            boost::bind(&WinTcpEventLoop::checkConnectWatches, this));
+    }
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 撤销连接等待 (同步完成)
+//-----------------------------------------------------------------------------
+bool WinTcpEventLoop::unwatchConnect(BaseTcpConnection *connection)
+{
+    connectWatches_.erase(connection);
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 检查等待中的连接是否已完成 (每次最多 select() FD_SETSIZE 个套接字)
+//-----------------------------------------------------------------------------
+void WinTcpEventLoop::checkConnectWatches()
+{
+    std::vector<BaseTcpConnection*> connections(connectWatches_.begin(), connectWatches_.end());
+    std::vector<BaseTcpConnection*> completed;
+
+    for (size_t from = 0; from < connections.size(); from += FD_SETSIZE)
+    {
+        size_t to = ise::min(from + FD_SETSIZE, connections.size());
+        fd_set wset, eset;
+        struct timeval tv = { 0, 0 };
+
+        FD_ZERO(&wset);
+        for (size_t i = from; i < to; ++i)
+            FD_SET(connections[i]->getSocket().getHandle(), &wset);
+        eset = wset;
+
+        // 连接成功时套接字可写，失败时出现在异常集中
+        if (select(0, NULL, &wset, &eset, &tv) > 0)
+        {
+            for (size_t i = from; i < to; ++i)
+            {
+                SOCKET handle = connections[i]->getSocket().getHandle();
+                if (FD_ISSET(handle, &wset) || FD_ISSET(handle, &eset))
+                    completed.push_back(connections[i]);
+            }
+        }
+    }
+
+    for (size_t i = 0; i < completed.size(); ++i)
+    {
+        connectWatches_.erase(completed[i]);
+        TcpConnector::onConnectEvent(completed[i]);
+    }
+
+    if (connectWatches_.empty())
+    {
+        cancelTimer(connectCheckTimerId_);
+        connectCheckTimerId_ = 0;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+#endif  /* ifdef ISE_WINDOWS */
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+#ifdef ISE_LINUX
+
+///////////////////////////////////////////////////////////////////////////////
+// class LinuxTcpConnection
+
+LinuxTcpConnection::LinuxTcpConnection()
+{
+    init();
+}
+
+LinuxTcpConnection::LinuxTcpConnection(TcpServer *tcpServer, SOCKET socketHandle) :
+    TcpConnection(tcpServer, socketHandle)
+{
+    init();
+}
+
+//-----------------------------------------------------------------------------
+
+void LinuxTcpConnection::init()
+{
+    bytesSent_ = 0;
+    enableSend_ = false;
+    enableRecv_ = false;
+    edgeTriggered_ = (tcpServer_ != NULL && tcpServer_->isEdgeTriggered());
+    sendBatching_ = iseApp().iseOptions().getTcpSendBatching();
+    batchedSendCount_ = 0;
+}
+
+//-----------------------------------------------------------------------------
+
+void LinuxTcpConnection::eventLoopChanged()
+{
+    if (getEventLoop() != NULL)
+    {
+        getEventLoop()->assertInLoopThread();
+        setRecvEnabled(true);
+    }
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 提交一个发送任务
+//-----------------------------------------------------------------------------
+void LinuxTcpConnection::postSendTask(const void *buffer, int size,
+    const Context& context, int timeout)
+{
+    if (!checkSendBufferCap(size)) return;
+
+    sendBuffer_.append(buffer, size);
+    addSendQueuedBytes(size);
+
+    // 连续复制进来的数据在 sendBuffer_ 中是相邻的，合并为一个数据块
+    if (!sendChunks_.empty() && sendChunks_.back().buffer.empty() && !sendChunks_.back().isFile())
+        sendChunks_.back().bytes += size;
+    else
+    {
+        SendChunk chunk;
+        chunk.bytes = size;
+        sendChunks_.push_back(chunk);
+    }
+
+    afterAppendSendData(size, context, timeout);
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 提交一个发送任务 (不复制数据)
+//-----------------------------------------------------------------------------
+void LinuxTcpConnection::postSendTask(const SharedBuffer& buffer,
+    const Context& context, int timeout)
+{
+    if (!checkSendBufferCap(buffer.size())) return;
+
+    SendChunk chunk;
+    chunk.buffer = buffer;
+    chunk.bytes = buffer.size();
+    sendChunks_.push_back(chunk);
+    addSendQueuedBytes(buffer.size());
+
+    afterAppendSendData(buffer.size(), context, timeout);
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 提交一个发送文件的任务
+// 备注: 文件数据以文件数据块挂接到待发送数据链上，发送时由 sendfile() 完成。
+//-----------------------------------------------------------------------------
+void LinuxTcpConnection::postSendFileTask(HANDLE fileHandle, INT64 offset, INT64 length,
+    const Context& context, int timeout)
+{
+    INT64 remainBytes = length;
+    while (remainBytes > 0)
+    {
+        SendChunk chunk;
+        chunk.fileHandle = fileHandle;
+        chunk.fileOffset = offset + (length - remainBytes);
+        chunk.bytes = (int)ise::min<INT64>(remainBytes, MAX_FILE_CHUNK_SIZE);
+        sendChunks_.push_back(chunk);
+        remainBytes -= chunk.bytes;
+    }
+
+    afterAppendSendData(length, context, timeout);
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 待发送数据加入数据链之后，登记发送任务并启动发送
+//-----------------------------------------------------------------------------
+void LinuxTcpConnection::afterAppendSendData(INT64 size, const Context& context, int timeout)
+{
+    SendTask task;
+    task.bytes = size;
+    task.context = context;
+    task.timeout = timeout;
+
+    sendTaskQueue_.push_back(task);
+    updateSendTimeout();
+
+    if (enableSend_) return;
+
+    // 合并发送模式: 只登记，待本轮循环末尾统一发送 (见 flushBatchedSends())
+    if (sendBatching_)
+    {
+        if (batchedSendCount_++ == 0)
+            getEventLoop()->addBatchedSend(this);
+        return;
+    }
+
+    if (!edgeTriggered_)
+    {
+        setSendEnabled(true);
+        return;
+    }
+
+    // 边沿触发模式: 先直接发送，仅当内核发送缓冲区已满 (EAGAIN) 时才监视可发送事件。
+    // 若发生错误，同样交由监视可发送事件来处理 (EPoll 会报告 EPOLLERR)，以免在
+    // 用户的调用中嵌套回调 onTcpDisconnected()。
+    INT64 bytesSent = doSend();
+    if (bytesSent < 0 || !sendChunks_.empty())
+        setSendEnabled(true);
+
+    // 同理，发送完成的回调也须委托给事件循环执行。
+    if (bytesSent > 0 && bytesSent_ >= sendTaskQueue_.front().bytes)
+    {
+        getEventLoop()->delegateToLoop(boost::bind(
+            &LinuxTcpConnection::afterPostSendTask, shared_from_this()));
+    }
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 提交一个接收任务
+//-----------------------------------------------------------------------------
+void LinuxTcpConnection::postRecvTask(const PacketSplitter& packetSplitter,
+    const Context& context, int timeout)
+{
+    RecvTask task;
+    task.packetSplitter = packetSplitter;
+    task.context = context;
+    task.timeout = timeout;
+
+    recvTaskQueue_.push_back(task);
+    updateRecvTimeout();
+
+    if (!enableRecv_)
+        setRecvEnabled(true);
+
+    // 注意: 此处必须调用 tryRetrievePacket()，否则会造成接收中止。但是，直接
+    // 调用 tryRetrievePacket() 又会造成循环调用，所以必须用 delegateToLoop()，
+    // 且必须使用 shared_from_this()，否则在某些情况下会导致程序崩溃。
+    getEventLoop()->delegateToLoop(boost::bind(
+        &LinuxTcpConnection::afterPostRecvTask, shared_from_this()));
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 启用或停止连续接收模式
+//-----------------------------------------------------------------------------
+void LinuxTcpConnection::postContinuousRecv(const PacketSplitter& packetSplitter,
+    bool batchMode, const Context& context)
+{
+    TcpConnection::postContinuousRecv(packetSplitter, batchMode, context);
+    if (!isContinuousRecv()) return;
+
+    if (!enableRecv_)
+        setRecvEnabled(true);
+
+    // 缓存中可能已有数据，与 postRecvTask() 同理须委托处理
+    getEventLoop()->delegateToLoop(boost::bind(
+        &LinuxTcpConnection::afterPostRecvTask, shared_from_this()));
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 设置“是否监视可发送事件”
+//-----------------------------------------------------------------------------
+void LinuxTcpConnection::setSendEnabled(bool enabled)
+{
+    ISE_ASSERT(eventLoop_ != NULL);
+
+    enableSend_ = enabled;
+    getEventLoop()->updateConnection(this, enableSend_, enableRecv_);
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 设置“是否监视可接收事件”
+//-----------------------------------------------------------------------------
+void LinuxTcpConnection::setRecvEnabled(bool enabled)
+{
+    ISE_ASSERT(eventLoop_ != NULL);
+
+    enableRecv_ = enabled;
+    getEventLoop()->updateConnection(this, enableSend_, enableRecv_);
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 当“可发送”事件到来时，尝试发送数据
+//-----------------------------------------------------------------------------
+void LinuxTcpConnection::trySend()
+{
+    if (sendChunks_.empty())
+    {
+        setSendEnabled(false);
+        return;
+    }
+
+    INT64 bytesSent = doSend();
+    if (bytesSent < 0)
+    {
+        errorOccurred();
+        return;
+    }
+
+    // 边沿触发模式下，数据发送完毕后立即停止监视可发送事件
+    if (edgeTriggered_ && sendChunks_.empty())
+        setSendEnabled(false);
+
+    if (bytesSent > 0)
+        invokeSendCompleteCallbacks();
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 将待发送数据链中的数据写入套接字
+// 返回:
+//   < 0    - 发生了错误。
+//   >= 0   - 实际发出的字节数。
+// 备注:
+//   1. 采用 writev 聚集写，一次系统调用最多发送 IOV_MAX 个数据块。
+//   2. 文件数据块以 sendfile() 单独发送，writev 只聚集其前面的内存数据块。
+//   3. 边沿触发模式下，会一直发送直至数据链为空或内核发送缓冲区已满 (EAGAIN)。
+//-----------------------------------------------------------------------------
+INT64 LinuxTcpConnection::doSend()
+{
+#ifdef IOV_MAX
+    const int MAX_IOV_COUNT = IOV_MAX;
+#else
+    const int MAX_IOV_COUNT = 1024;
+#endif
+
+    struct iovec vec[MAX_IOV_COUNT];
+    INT64 result = 0;
+
+    while (!sendChunks_.empty())
+    {
+        int totalBytes = 0, bytesSent = 0;
+        SendChunk& firstChunk = sendChunks_.front();
+
+        if (firstChunk.isFile())
+        {
+            off_t offset = (off_t)firstChunk.fileOffset;
+            totalBytes = firstChunk.bytes;
+            bytesSent = (int)::sendfile(getSocket().getHandle(), firstChunk.fileHandle,
+                &offset, firstChunk.bytes);
+
+            // 文件长度不足 (例如文件已被截短)，数据块将永远无法发完
+            if (bytesSent == 0)
+                return (result > 0 ? result : -1);
         }
         else
+        {
+            // sendBuffer_ 中的数据块依次相邻，localBytes 为当前块在 sendBuffer_ 中的偏移
+            int vecCount = 0, localBytes = 0;
+            for (SendChunkList::iterator it = sendChunks_.begin();
+                it != sendChunks_.end() && !it->isFile() && vecCount < MAX_IOV_COUNT; ++it)
+            {
+                const SendChunk& chunk = *it;
+                if (chunk.buffer.empty())
+                {
+                    vec[vecCount].iov_base = (void*)(sendBuffer_.peek() + localBytes);
+                    localBytes += chunk.bytes;
+                }
+                else
+                    vec[vecCount].iov_base = (void*)(chunk.buffer.data() + chunk.offset);
+                vec[vecCount].iov_len = chunk.bytes;
+
+                totalBytes += chunk.bytes;
+                ++vecCount;
+            }
+
+            bytesSent = (int)::writev(getSocket().getHandle(), vec, vecCount);
+        }
+
+        if (bytesSent < 0)
+        {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+                return (result > 0 ? result : -1);
+            bytesSent = 0;
+        }
+
+        if (bytesSent > 0)
+        {
+            removeSendQueuedBytes(retrieveSentChunks(bytesSent));
+            bytesSent_ += bytesSent;
+            result += bytesSent;
+            markActive();
+        }
+
+        if (bytesSent < totalBytes || !edgeTriggered_)
             break;
     }
 
-    if (!sendTaskQueue_.empty())
-        trySend();
+    return result;
 }
 
 //-----------------------------------------------------------------------------
+// 描述: 在本轮事件循环的末尾，发出本轮中合并的发送数据 (合并发送模式)
+// 返回: 与逐次发送相比省去的系统调用次数
+// 备注:
+//   先直接写一次套接字，仅当内核发送缓冲区已满时才监视可发送事件。与逐次发送相比:
+//   水平触发模式下省去了开启、关闭可发送事件监视的两次 epoll_ctl；边沿触发模式下，
+//   本轮的多次发送合并为一次 writev。
+//-----------------------------------------------------------------------------
+int LinuxTcpConnection::flushBatchedSends()
+{
+    int sendCount = batchedSendCount_;
+    batchedSendCount_ = 0;
 
-void WinTcpConnection::onRecvCallback(const IocpTaskData& taskData)
+    if (isErrorOccurred_ || enableSend_ || sendChunks_.empty())
+        return 0;
+
+    INT64 bytesSent = doSend();
+    if (bytesSent < 0)
+    {
+        errorOccurred();
+        return 0;
+    }
+
+    int result = 0;
+    if (edgeTriggered_)
+        result = sendCount - 1;
+    else if (sendChunks_.empty())
+        result = 2;
+
+    if (!sendChunks_.empty())
+        setSendEnabled(true);
+
+    if (bytesSent > 0)
+        invokeSendCompleteCallbacks();
+
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 从待发送数据链的头部移除已发送的 bytes 个字节
+// 返回: 其中内存数据块的字节数 (不含文件数据块)
+//-----------------------------------------------------------------------------
+INT64 LinuxTcpConnection::retrieveSentChunks(INT64 bytes)
 {
-    ISE_ASSERT(taskData.getErrorCode() == 0);
+    INT64 memoryBytes = 0;
 
-    if (taskData.getBytesTrans() < taskData.getDataSize())
+    while (bytes > 0)
     {
-        getEventLoop()->getIocpObject()->recv(
-            (SOCKET)taskData.getFileHandle(),
-            taskData.getEntireDataBuf(),
-            taskData.getEntireDataSize(),
-            taskData.getDataBuf() - taskData.getEntireDataBuf() + taskData.getBytesTrans(),
-            taskData.getCallback(), taskData.getCaller(), taskData.getContext());
+        ISE_ASSERT(!sendChunks_.empty());
+        SendChunk& chunk = sendChunks_.front();
+        int n = (int)ise::min<INT64>(bytes, chunk.bytes);
+
+        if (chunk.isFile())
+            chunk.fileOffset += n;
+        else if (chunk.buffer.empty())
+            sendBuffer_.retrieve(n);
+        else
+            chunk.offset += n;
+        if (!chunk.isFile())
+            memoryBytes += n;
+        chunk.bytes -= n;
+        bytes -= n;
+
+        if (chunk.bytes == 0)
+            sendChunks_.pop_front();
     }
-    else
+
+    return memoryBytes;
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 对已发送完毕的发送任务执行 onTcpSendComplete() 回调
+//-----------------------------------------------------------------------------
+void LinuxTcpConnection::invokeSendCompleteCallbacks()
+{
+    while (!sendTaskQueue_.empty())
     {
-        isRecving_ = false;
+        SendTask& task = sendTaskQueue_.front();
+        if (bytesSent_ >= task.bytes)
+        {
+            bytesSent_ -= task.bytes;
+            Context context = task.context;
+            sendTaskQueue_.pop_front();
+            updateSendTimeout();
+            iseApp().iseBusiness().onTcpSendComplete(shared_from_this(), context);
+        }
+        else
+            break;
     }
+}
 
-    bytesRecved_ += taskData.getBytesTrans();
+//-----------------------------------------------------------------------------
+// 描述: 当“可接收”事件到来时，尝试接收数据
+//-----------------------------------------------------------------------------
+void LinuxTcpConnection::tryRecv()
+{
+    const int MAX_BUFFER_SIZE = iseApp().iseOptions().getTcpMaxRecvBufferSize();
+    if (!hasRecvDemand() && recvBuffer_.getReadableBytes() >= MAX_BUFFER_SIZE)
+    {
+        setRecvEnabled(false);
+        return;
+    }
 
-    while (!recvTaskQueue_.empty())
+    while (true)
     {
-        RecvTask& task = recvTaskQueue_.front();
-        const char *buffer = recvBuffer_.peek();
-        bool packetRecved = false;
+        int bytesRecved = recvBuffer_.appendFromSocket(getSocket().getHandle());
+        if (bytesRecved < 0)
+        {
+            errorOccurred();
+            return;
+        }
+        if (bytesRecved > 0)
+            markActive();
 
-        if (bytesRecved_ > 0)
+        retrievePackets();
+
+        // 水平触发模式下每次通知只读一次；边沿触发模式下须一直读到 EAGAIN (返回 0)。
+        // 末尾的数据与对方的 FIN 同时到达时不会再有新的通知，只有再读一次才能发现连接已关闭。
+        if (!edgeTriggered_ || bytesRecved == 0 || isErrorOccurred_)
+            break;
+
+        // 边沿触发模式下，若上层暂无接收需求则停止读取，剩余数据 (及 FIN) 留在内核中，
+        // 待投递接收任务时 setRecvEnabled(true) 重新布防后再读。否则读到 EOF 会在
+        // 上层取走数据之前断开连接 (如 onTcpConnected() 尚未投递接收任务时)。
+        if (!hasRecvDemand())
         {
-            int packetSize = 0;
-            task.packetSplitter(buffer, bytesRecved_, packetSize);
-            if (packetSize > 0)
-            {
-                bytesRecved_ -= packetSize;
-                iseApp().iseBusiness().onTcpRecvComplete(shared_from_this(),
-                    (void*)buffer, packetSize, task.context);
-                recvTaskQueue_.pop_front();
-                recvBuffer_.retrieve(packetSize);
-                packetRecved = true;
-            }
+            setRecvEnabled(false);
+            break;
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 尝试从缓存中取出一个完整数据包
+//-----------------------------------------------------------------------------
+bool LinuxTcpConnection::tryRetrievePacket()
+{
+    if (recvTaskQueue_.empty()) return false;
+
+    bool result = false;
+    RecvTask& task = recvTaskQueue_.front();
+    const char *buffer = recvBuffer_.peek();
+    int readableBytes = recvBuffer_.getReadableBytes();
+
+    if (readableBytes > 0)
+    {
+        int packetSize = 0;
+        task.packetSplitter(buffer, readableBytes, packetSize);
+        if (packetSize > 0)
+        {
+            iseApp().iseBusiness().onTcpRecvComplete(shared_from_this(),
+                (void*)buffer, packetSize, task.context);
+            recvTaskQueue_.pop_front();
+            recvBuffer_.retrieve(packetSize);
+            updateRecvTimeout();
+            result = true;
         }
+    }
+
+    return result;
+}
 
+//-----------------------------------------------------------------------------
+// 描述: 依次完成接收任务，接收任务队列为空时按连续接收模式投递其余的完整数据包
+//-----------------------------------------------------------------------------
+void LinuxTcpConnection::retrievePackets()
+{
+    while (!recvTaskQueue_.empty())
+    {
+        bool packetRecved = tryRetrievePacket();
         if (!packetRecved)
             break;
     }
 
-    tryRecv();
+    if (recvTaskQueue_.empty() && isContinuousRecv() && recvBuffer_.getReadableBytes() > 0)
+        recvBuffer_.retrieve(deliverContinuousPackets(recvBuffer_.peek(), recvBuffer_.getReadableBytes()));
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 在 postSendTask() 中调用此函数 (仅边沿触发模式)
+//-----------------------------------------------------------------------------
+void LinuxTcpConnection::afterPostSendTask(const TcpConnectionPtr& thisObj)
+{
+    LinuxTcpConnection *thisPtr = static_cast<LinuxTcpConnection*>(thisObj.get());
+    if (!thisPtr->isErrorOccurred_)
+        thisPtr->invokeSendCompleteCallbacks();
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 在 postRecvTask() 中调用此函数
+//-----------------------------------------------------------------------------
+void LinuxTcpConnection::afterPostRecvTask(const TcpConnectionPtr& thisObj)
+{
+    LinuxTcpConnection *thisPtr = static_cast<LinuxTcpConnection*>(thisObj.get());
+    if (!thisPtr->isErrorOccurred_)
+        thisPtr->retrievePackets();
 }
 
 ///////////////////////////////////////////////////////////////////////////////
-// class WinTcpEventLoop
+// class LinuxTcpEventLoop
+
+LinuxTcpEventLoop::LinuxTcpEventLoop()
+{
+    epollObject_->setNotifyEventCallback(boost::bind(&LinuxTcpEventLoop::onEpollNotifyEvent, this, _1, _2));
+    epollObject_->setConnectEventCallback(&TcpConnector::onConnectEvent);
+}
+
+LinuxTcpEventLoop::~LinuxTcpEventLoop()
+{
+    // nothing
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 登记有待发数据的连接 (合并发送模式)，在本轮循环的末尾统一发送
+//-----------------------------------------------------------------------------
+void LinuxTcpEventLoop::addBatchedSend(LinuxTcpConnection *connection)
+{
+    batchedSendConns_.push_back(connection->shared_from_this());
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 发出本轮循环中合并的发送数据
+// 备注: 发送完成的回调中再次发送的数据，留待下一轮循环发出。
+//-----------------------------------------------------------------------------
+void LinuxTcpEventLoop::flushBatchedSends()
+{
+    if (batchedSendConns_.empty()) return;
+
+    TcpConnectionPtrs connections;
+    connections.swap(batchedSendConns_);
+
+    int syscallsSaved = 0;
+    for (size_t i = 0; i < connections.size(); ++i)
+    {
+        LinuxTcpConnection *connection = static_cast<LinuxTcpConnection*>(connections[i].get());
+        if (connection->getEventLoop() == this)
+            syscallsSaved += connection->flushBatchedSends();
+    }
+
+    sendFlushCount_.getAndAdd(connections.size());
+    sendSyscallsSaved_.getAndAdd(syscallsSaved);
+    TcpInspectInfo::instance().sendSyscallsSaved.getAndAdd(syscallsSaved);
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 更新此 eventLoop 中的指定连接的设置
+//-----------------------------------------------------------------------------
+void LinuxTcpEventLoop::updateConnection(LinuxTcpConnection *connection, bool enableSend, bool enableRecv)
+{
+    epollObject_->updateConnection(connection, enableSend, enableRecv, connection->edgeTriggered_);
+}
 
 //-----------------------------------------------------------------------------
 // 描述: 将新连接注册到事件循环中
 //-----------------------------------------------------------------------------
-void WinTcpEventLoop::registerConnection(TcpConnection *connection)
+void LinuxTcpEventLoop::registerConnection(TcpConnection *connection)
 {
-    iocpObject_->associateHandle(connection->getSocket().getHandle());
+    LinuxTcpConnection *conn = static_cast<LinuxTcpConnection*>(connection);
+    epollObject_->addConnection(conn, false, false, conn->edgeTriggered_);
 }
 
 //-----------------------------------------------------------------------------
 // 描述: 从事件循环中注销连接
 //-----------------------------------------------------------------------------
-void WinTcpEventLoop::unregisterConnection(TcpConnection *connection)
+void LinuxTcpEventLoop::unregisterConnection(TcpConnection *connection)
+{
+    epollObject_->removeConnection(connection);
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 以 EPoll 等待非阻塞连接完成
+//-----------------------------------------------------------------------------
+void LinuxTcpEventLoop::watchConnect(BaseTcpConnection *connection)
+{
+    epollObject_->addConnectWatch(connection);
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 撤销连接等待 (同步完成)
+//-----------------------------------------------------------------------------
+bool LinuxTcpEventLoop::unwatchConnect(BaseTcpConnection *connection)
+{
+    epollObject_->removeConnectWatch(connection);
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 注册监听套接字，由本事件循环直接接受新连接
+//-----------------------------------------------------------------------------
+void LinuxTcpEventLoop::addListener(SOCKET handle, const EpollObject::AcceptEventCallback& callback)
+{
+    epollObject_->addListener(handle, callback);
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 注销监听套接字
+//-----------------------------------------------------------------------------
+void LinuxTcpEventLoop::removeListener()
+{
+    epollObject_->removeListener();
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 暂停监视监听套接字 (一段时间后自动恢复)
+//-----------------------------------------------------------------------------
+void LinuxTcpEventLoop::suspendListener()
+{
+    epollObject_->suspendListener();
+}
+
+//-----------------------------------------------------------------------------
+// 描述: EPoll 事件回调
+//-----------------------------------------------------------------------------
+void LinuxTcpEventLoop::onEpollNotifyEvent(BaseTcpConnection *connection,
+    EpollObject::EVENT_TYPE eventType)
 {
-    // nothing
+    LinuxTcpConnection *conn = static_cast<LinuxTcpConnection*>(connection);
+
+    // 同一轮询中可能先后收到可接收和可发送事件，前者可能已引发了错误
+    if (conn->isErrorOccurred_) return;
+
+    if (eventType == EpollObject::ET_ALLOW_SEND)
+        conn->trySend();
+    else if (eventType == EpollObject::ET_ALLOW_RECV)
+        conn->tryRecv();
+    else if (eventType == EpollObject::ET_ERROR)
+        conn->errorOccurred();
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 
-#endif  /* ifdef ISE_WINDOWS */
+#endif  /* ifdef ISE_LINUX */
 
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
 
-#ifdef ISE_LINUX
+#ifdef ISE_IO_URING
 
 ///////////////////////////////////////////////////////////////////////////////
-// class LinuxTcpConnection
+// class UringTcpConnection
 
-LinuxTcpConnection::LinuxTcpConnection()
+UringTcpConnection::UringTcpConnection()
 {
     init();
 }
 
-LinuxTcpConnection::LinuxTcpConnection(TcpServer *tcpServer, SOCKET socketHandle) :
-    TcpConnection(tcpServer, socketHandle)
+UringTcpConnection::UringTcpConnection(TcpServer *tcpServer, SOCKET socketHandle) :
+    LinuxTcpConnection(tcpServer, socketHandle)
 {
     init();
 }
 
 //-----------------------------------------------------------------------------
 
-void LinuxTcpConnection::init()
+void UringTcpConnection::init()
 {
-    bytesSent_ = 0;
-    enableSend_ = false;
-    enableRecv_ = false;
+    memset(&sendMsg_, 0, sizeof(sendMsg_));
+    memset(sendVec_, 0, sizeof(sendVec_));
+    sendMsg_.msg_iov = sendVec_;
+    isSending_ = false;
+    isSendScheduled_ = false;
+    isRecving_ = false;
+    isRecvCancelling_ = false;
+    pendingOps_ = 0;
 }
 
 //-----------------------------------------------------------------------------
 
-void LinuxTcpConnection::eventLoopChanged()
+void UringTcpConnection::eventLoopChanged()
 {
+    pendingBuffer_.setPool(eventLoop_ != NULL ? &eventLoop_->getIoBufferPool() : NULL);
+
     if (getEventLoop() != NULL)
     {
         getEventLoop()->assertInLoopThread();
-        setRecvEnabled(true);
+        startRecv();
     }
 }
 
 //-----------------------------------------------------------------------------
 // 描述: 提交一个发送任务
 //-----------------------------------------------------------------------------
-void LinuxTcpConnection::postSendTask(const void *buffer, int size,
+void UringTcpConnection::postSendTask(const void *buffer, int size,
     const Context& context, int timeout)
 {
-    sendBuffer_.append(buffer, size);
+    if (!checkSendBufferCap(size)) return;
 
-    SendTask task;
-    task.bytes = size;
-    task.context = context;
-    task.timeout = timeout;
+    // 发送操作进行期间 sendBuffer_ 正被内核引用，新数据只能暂存于 pendingBuffer_
+    SendChunkList& chunks = getAppendChunks();
+    (isSending_ ? pendingBuffer_ : sendBuffer_).append(buffer, size);
+    addSendQueuedBytes(size);
 
-    sendTaskQueue_.push_back(task);
+    if (!chunks.empty() && chunks.back().buffer.empty() && !chunks.back().isFile())
+        chunks.back().bytes += size;
+    else
+    {
+        SendChunk chunk;
+        chunk.bytes = size;
+        chunks.push_back(chunk);
+    }
 
-    if (!enableSend_)
-        setSendEnabled(true);
+    appendSendTask(size, context, timeout);
 }
 
 //-----------------------------------------------------------------------------
-// 描述: 提交一个接收任务
+// 描述: 提交一个发送任务 (不复制数据)
 //-----------------------------------------------------------------------------
-void LinuxTcpConnection::postRecvTask(const PacketSplitter& packetSplitter,
+void UringTcpConnection::postSendTask(const SharedBuffer& buffer,
     const Context& context, int timeout)
 {
-    RecvTask task;
-    task.packetSplitter = packetSplitter;
-    task.context = context;
-    task.timeout = timeout;
-
-    recvTaskQueue_.push_back(task);
+    if (!checkSendBufferCap(buffer.size())) return;
 
-    if (!enableRecv_)
-        setRecvEnabled(true);
+    SendChunk chunk;
+    chunk.buffer = buffer;
+    chunk.bytes = buffer.size();
+    getAppendChunks().push_back(chunk);
+    addSendQueuedBytes(buffer.size());
 
-    // 注意: 此处必须调用 tryRetrievePacket()，否则会造成接收中止。但是，直接
-    // 调用 tryRetrievePacket() 又会造成循环调用，所以必须用 delegateToLoop()，
-    // 且必须使用 shared_from_this()，否则在某些情况下会导致程序崩溃。
-    getEventLoop()->delegateToLoop(boost::bind(
-        &LinuxTcpConnection::afterPostRecvTask, shared_from_this()));
+    appendSendTask(buffer.size(), context, timeout);
 }
 
 //-----------------------------------------------------------------------------
-// 描述: 设置“是否监视可发送事件”
+// 描述: 提交一个发送文件的任务
 //-----------------------------------------------------------------------------
-void LinuxTcpConnection::setSendEnabled(bool enabled)
+void UringTcpConnection::postSendFileTask(HANDLE fileHandle, INT64 offset, INT64 length,
+    const Context& context, int timeout)
 {
-    ISE_ASSERT(eventLoop_ != NULL);
+    SendChunkList& chunks = getAppendChunks();
+    INT64 remainBytes = length;
+    while (remainBytes > 0)
+    {
+        SendChunk chunk;
+        chunk.fileHandle = fileHandle;
+        chunk.fileOffset = offset + (length - remainBytes);
+        chunk.bytes = (int)ise::min<INT64>(remainBytes, MAX_FILE_CHUNK_SIZE);
+        chunks.push_back(chunk);
+        remainBytes -= chunk.bytes;
+    }
 
-    enableSend_ = enabled;
-    getEventLoop()->updateConnection(this, enableSend_, enableRecv_);
+    appendSendTask(length, context, timeout);
 }
 
 //-----------------------------------------------------------------------------
-// 描述: 设置“是否监视可接收事件”
+// 描述: 登记发送任务
+// 备注:
+//   发送操作进行期间加入的数据在该操作完成时接着发送；否则登记到事件循环，
+//   在本轮循环的末尾提交发送操作，与下一轮的等待合并为一次 io_uring_enter()。
 //-----------------------------------------------------------------------------
-void LinuxTcpConnection::setRecvEnabled(bool enabled)
+void UringTcpConnection::appendSendTask(INT64 size, const Context& context, int timeout)
 {
-    ISE_ASSERT(eventLoop_ != NULL);
+    SendTask task;
+    task.bytes = size;
+    task.context = context;
+    task.timeout = timeout;
 
-    enableRecv_ = enabled;
-    getEventLoop()->updateConnection(this, enableSend_, enableRecv_);
+    sendTaskQueue_.push_back(task);
+    updateSendTimeout();
+
+    if (!isSending_ && !isSendScheduled_)
+    {
+        isSendScheduled_ = true;
+        getEventLoop()->addScheduledSend(this);
+    }
 }
 
 //-----------------------------------------------------------------------------
-// 描述: 当“可发送”事件到来时，尝试发送数据
+// 描述: 在本轮事件循环的末尾提交发送操作
+// 返回: 提交的 sendmsg 操作数
 //-----------------------------------------------------------------------------
-void LinuxTcpConnection::trySend()
+int UringTcpConnection::flushScheduledSend()
 {
-    int readableBytes = sendBuffer_.getReadableBytes();
-    if (readableBytes <= 0)
-    {
-        setSendEnabled(false);
-        return;
-    }
+    if (isErrorOccurred_ || isSending_) return 0;
 
-    const char *buffer = sendBuffer_.peek();
-    int bytesSent = sendBuffer((void*)buffer, readableBytes, false);
-    if (bytesSent < 0)
-    {
-        errorOccurred();
-        return;
-    }
+    int result = submitSend();
 
-    if (bytesSent > 0)
+    // 文件数据块可能已由 sendfile() 直接发出
+    if (!isErrorOccurred_)
+        invokeSendCompleteCallbacks();
+
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 从待发送数据链的头部开始提交发送操作
+// 返回: 提交的 sendmsg 操作数 (0 或 1)
+// 备注:
+//   1. 相邻的内存数据块以一个 sendmsg 操作聚集发送，最多 MAX_IOV_COUNT 块。
+//   2. io_uring 没有 sendfile 操作，文件数据块仍以非阻塞的 sendfile() 直接发送，
+//      内核发送缓冲区已满时提交 "等待可发送" 操作，完成后继续发送。
+//   3. sendChunks_ 发送完毕后，换入发送操作进行期间暂存的数据。
+//-----------------------------------------------------------------------------
+int UringTcpConnection::submitSend()
+{
+    while (!isSending_ && !isErrorOccurred_)
     {
-        sendBuffer_.retrieve(bytesSent);
-        bytesSent_ += bytesSent;
+        if (sendChunks_.empty())
+        {
+            if (pendingChunks_.empty()) break;
+            sendChunks_.swap(pendingChunks_);
+            sendBuffer_.swap(pendingBuffer_);
+        }
 
-        while (!sendTaskQueue_.empty())
+        SendChunk& firstChunk = sendChunks_.front();
+        if (firstChunk.isFile())
         {
-            SendTask& task = sendTaskQueue_.front();
-            if (bytesSent_ >= task.bytes)
+            off_t offset = (off_t)firstChunk.fileOffset;
+            int bytesSent = (int)::sendfile(getSocket().getHandle(), firstChunk.fileHandle,
+                &offset, firstChunk.bytes);
+
+            if (bytesSent > 0)
+            {
+                removeSendQueuedBytes(retrieveSentChunks(bytesSent));
+                bytesSent_ += bytesSent;
+                markActive();
+            }
+            else if (bytesSent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
             {
-                bytesSent_ -= task.bytes;
-                iseApp().iseBusiness().onTcpSendComplete(shared_from_this(), task.context);
-                sendTaskQueue_.pop_front();
+                getEventLoop()->getIoUringObject()->postPollSend(this);
+                isSending_ = true;
+                ++pendingOps_;
             }
+            else if (bytesSent < 0 && errno == EINTR)
+                continue;
             else
-                break;
+            {
+                // 出错，或文件长度不足 (例如文件已被截短)
+                errorOccurred();
+            }
+        }
+        else
+        {
+            // sendBuffer_ 中的数据块依次相邻，localBytes 为当前块在 sendBuffer_ 中的偏移
+            int vecCount = 0, localBytes = 0;
+            for (SendChunkList::iterator it = sendChunks_.begin();
+                it != sendChunks_.end() && !it->isFile() && vecCount < MAX_IOV_COUNT; ++it)
+            {
+                const SendChunk& chunk = *it;
+                if (chunk.buffer.empty())
+                {
+                    sendVec_[vecCount].iov_base = (void*)(sendBuffer_.peek() + localBytes);
+                    localBytes += chunk.bytes;
+                }
+                else
+                    sendVec_[vecCount].iov_base = (void*)(chunk.buffer.data() + chunk.offset);
+                sendVec_[vecCount].iov_len = chunk.bytes;
+                ++vecCount;
+            }
+
+            sendMsg_.msg_iovlen = vecCount;
+            getEventLoop()->getIoUringObject()->postSend(this, &sendMsg_);
+            isSending_ = true;
+            ++pendingOps_;
+            return 1;
         }
     }
+
+    return 0;
 }
 
 //-----------------------------------------------------------------------------
-// 描述: 当“可接收”事件到来时，尝试接收数据
+// 描述: 发送操作 (或等待可发送操作) 完成
 //-----------------------------------------------------------------------------
-void LinuxTcpConnection::tryRecv()
+void UringTcpConnection::onSendComplete(const IoUringObject::CompleteEvent& event)
 {
-    const int MAX_BUFFER_SIZE = iseApp().iseOptions().getTcpMaxRecvBufferSize();
-    if (recvTaskQueue_.empty() && recvBuffer_.getReadableBytes() >= MAX_BUFFER_SIZE)
+    isSending_ = false;
+
+    if (event.opType == IoUringObject::OT_SEND)
     {
-        setRecvEnabled(false);
+        if (event.result <= 0)
+        {
+            errorOccurred();
+            return;
+        }
+
+        removeSendQueuedBytes(retrieveSentChunks(event.result));
+        bytesSent_ += event.result;
+        markActive();
+    }
+    else if (event.result < 0)
+    {
+        errorOccurred();
         return;
     }
 
-    const int BUFFER_SIZE = 1024*16;
-    char dataBuf[BUFFER_SIZE];
+    submitSend();
+
+    if (!isErrorOccurred_)
+        invokeSendCompleteCallbacks();
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 提交多发接收操作 (已在接收或已出错时忽略)
+//-----------------------------------------------------------------------------
+void UringTcpConnection::startRecv()
+{
+    if (isRecving_ || isErrorOccurred_) return;
+
+    getEventLoop()->getIoUringObject()->postRecv(this);
+    isRecving_ = true;
+    isRecvCancelling_ = false;
+    ++pendingOps_;
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 没有接收需求时，接收缓存是否已达上限 (此时应暂停接收)
+//-----------------------------------------------------------------------------
+bool UringTcpConnection::isRecvBufferFull() const
+{
+    return !hasRecvDemand() &&
+        recvBuffer_.getReadableBytes() >= iseApp().iseOptions().getTcpMaxRecvBufferSize();
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 多发接收操作收到数据 (或已结束)
+// 备注:
+//   1. 接收缓存达到上限时取消多发接收，取消生效前收到的数据照常存入缓存。
+//   2. 操作结束后 (例如提供缓冲区暂时耗尽)，若仍需接收则重新提交。
+//-----------------------------------------------------------------------------
+void UringTcpConnection::onRecvComplete(const IoUringObject::CompleteEvent& event)
+{
+    if (!event.hasMore)
+        isRecving_ = false;
 
-    int bytesRecved = recvBuffer(dataBuf, BUFFER_SIZE, false);
-    if (bytesRecved < 0)
+    if (event.result > 0)
+    {
+        recvBuffer_.append(event.data, event.result);
+        markActive();
+        retrievePackets();
+    }
+    else if (event.result == 0 ||
+        (event.result != -ENOBUFS && event.result != -ECANCELED))
     {
+        // 对方关闭了连接，或发生了错误
         errorOccurred();
         return;
     }
 
-    if (bytesRecved > 0)
-        recvBuffer_.append(dataBuf, bytesRecved);
+    if (isErrorOccurred_) return;
 
-    while (!recvTaskQueue_.empty())
+    if (isRecvBufferFull())
     {
-        bool packetRecved = tryRetrievePacket();
-        if (!packetRecved)
-            break;
+        if (isRecving_ && !isRecvCancelling_)
+        {
+            getEventLoop()->getIoUringObject()->cancelRecv(this);
+            isRecvCancelling_ = true;
+        }
     }
+    else if (!isRecving_)
+        startRecv();
 }
 
 //-----------------------------------------------------------------------------
-// 描述: 尝试从缓存中取出一个完整数据包
+// 描述: 提交一个接收任务
 //-----------------------------------------------------------------------------
-bool LinuxTcpConnection::tryRetrievePacket()
+void UringTcpConnection::postRecvTask(const PacketSplitter& packetSplitter,
+    const Context& context, int timeout)
 {
-    if (recvTaskQueue_.empty()) return false;
+    RecvTask task;
+    task.packetSplitter = packetSplitter;
+    task.context = context;
+    task.timeout = timeout;
 
-    bool result = false;
-    RecvTask& task = recvTaskQueue_.front();
-    const char *buffer = recvBuffer_.peek();
-    int readableBytes = recvBuffer_.getReadableBytes();
+    recvTaskQueue_.push_back(task);
+    updateRecvTimeout();
 
-    if (readableBytes > 0)
-    {
-        int packetSize = 0;
-        task.packetSplitter(buffer, readableBytes, packetSize);
-        if (packetSize > 0)
-        {
-            iseApp().iseBusiness().onTcpRecvComplete(shared_from_this(),
-                (void*)buffer, packetSize, task.context);
-            recvTaskQueue_.pop_front();
-            recvBuffer_.retrieve(packetSize);
-            result = true;
-        }
-    }
+    startRecv();
 
-    return result;
+    // 缓存中可能已有数据，与 LinuxTcpConnection::postRecvTask() 同理须委托处理
+    getEventLoop()->delegateToLoop(boost::bind(
+        &LinuxTcpConnection::afterPostRecvTask, shared_from_this()));
 }
 
 //-----------------------------------------------------------------------------
-// 描述: 在 postRecvTask() 中调用此函数
+// 描述: 启用或停止连续接收模式
 //-----------------------------------------------------------------------------
-void LinuxTcpConnection::afterPostRecvTask(const TcpConnectionPtr& thisObj)
+void UringTcpConnection::postContinuousRecv(const PacketSplitter& packetSplitter,
+    bool batchMode, const Context& context)
 {
-    LinuxTcpConnection *thisPtr = static_cast<LinuxTcpConnection*>(thisObj.get());
-    if (!thisPtr->isErrorOccurred_)
-        thisPtr->tryRetrievePacket();
+    TcpConnection::postContinuousRecv(packetSplitter, batchMode, context);
+    if (!isContinuousRecv()) return;
+
+    startRecv();
+
+    getEventLoop()->delegateToLoop(boost::bind(
+        &LinuxTcpConnection::afterPostRecvTask, shared_from_this()));
 }
 
 ///////////////////////////////////////////////////////////////////////////////
-// class LinuxTcpEventLoop
+// class UringTcpEventLoop
 
-LinuxTcpEventLoop::LinuxTcpEventLoop()
+UringTcpEventLoop::UringTcpEventLoop() :
+    TcpEventLoop(IOB_IO_URING),
+    closingConnCount_(0)
 {
-    epollObject_->setNotifyEventCallback(boost::bind(&LinuxTcpEventLoop::onEpollNotifyEvent, this, _1, _2));
+    ioUringObject_->setCompleteEventCallback(boost::bind(&UringTcpEventLoop::onIoUringCompleteEvent, this, _1, _2));
 }
 
-LinuxTcpEventLoop::~LinuxTcpEventLoop()
+UringTcpEventLoop::~UringTcpEventLoop()
 {
     // nothing
 }
 
 //-----------------------------------------------------------------------------
-// 描述: 更新此 eventLoop 中的指定连接的设置
+// 描述: 注册监听套接字，由本事件循环以多发接受的方式直接接受新连接
+// 备注: 提交队列只能在事件循环线程中访问，故委托给事件循环执行。
+//-----------------------------------------------------------------------------
+void UringTcpEventLoop::addListener(SOCKET handle, const IoUringObject::AcceptEventCallback& callback)
+{
+    executeInLoop(boost::bind(&IoUringObject::addListener, ioUringObject_, handle, callback));
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 注销监听套接字
+//-----------------------------------------------------------------------------
+void UringTcpEventLoop::removeListener()
+{
+    executeInLoop(boost::bind(&IoUringObject::removeListener, ioUringObject_));
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 登记有待发数据的连接，在本轮循环的末尾提交发送操作
 //-----------------------------------------------------------------------------
-void LinuxTcpEventLoop::updateConnection(TcpConnection *connection, bool enableSend, bool enableRecv)
+void UringTcpEventLoop::addScheduledSend(UringTcpConnection *connection)
 {
-    epollObject_->updateConnection(connection, enableSend, enableRecv);
+    scheduledSendConns_.push_back(connection->shared_from_this());
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 为本轮循环中有待发数据的连接提交发送操作
+// 备注: 每个 sendmsg 操作均与下一轮的等待一同提交，省去了一次 writev 系统调用。
+//-----------------------------------------------------------------------------
+void UringTcpEventLoop::flushBatchedSends()
+{
+    if (scheduledSendConns_.empty()) return;
+
+    TcpConnectionPtrs connections;
+    connections.swap(scheduledSendConns_);
+
+    int syscallsSaved = 0;
+    for (size_t i = 0; i < connections.size(); ++i)
+    {
+        UringTcpConnection *connection = static_cast<UringTcpConnection*>(connections[i].get());
+        connection->isSendScheduled_ = false;
+        if (connection->getEventLoop() == this)
+            syscallsSaved += connection->flushScheduledSend();
+    }
+
+    sendFlushCount_.getAndAdd(connections.size());
+    sendSyscallsSaved_.getAndAdd(syscallsSaved);
+    TcpInspectInfo::instance().sendSyscallsSaved.getAndAdd(syscallsSaved);
 }
 
 //-----------------------------------------------------------------------------
 // 描述: 将新连接注册到事件循环中
+// 备注: io_uring 无须登记句柄，多发接收在 UringTcpConnection::eventLoopChanged() 中提交。
 //-----------------------------------------------------------------------------
-void LinuxTcpEventLoop::registerConnection(TcpConnection *connection)
+void UringTcpEventLoop::registerConnection(TcpConnection *connection)
 {
-    epollObject_->addConnection(connection, false, false);
+    // nothing
 }
 
 //-----------------------------------------------------------------------------
 // 描述: 从事件循环中注销连接
+// 备注:
+//   内核可能仍在引用连接的缓存 (例如进行中的发送操作)，因此在其全部操作结束之前，
+//   连接对象由 closingRef_ 维持，见 onIoUringCompleteEvent()。
 //-----------------------------------------------------------------------------
-void LinuxTcpEventLoop::unregisterConnection(TcpConnection *connection)
+void UringTcpEventLoop::unregisterConnection(TcpConnection *connection)
 {
-    epollObject_->removeConnection(connection);
+    UringTcpConnection *conn = static_cast<UringTcpConnection*>(connection);
+    if (conn->pendingOps_ > 0)
+    {
+        conn->closingRef_ = conn->shared_from_this();
+        ++closingConnCount_;
+        ioUringObject_->cancelAll(conn);
+    }
 }
 
 //-----------------------------------------------------------------------------
-// 描述: EPoll 事件回调
+// 描述: 提交 POLL_ADD 操作等待非阻塞连接完成
 //-----------------------------------------------------------------------------
-void LinuxTcpEventLoop::onEpollNotifyEvent(BaseTcpConnection *connection,
-    EpollObject::EVENT_TYPE eventType)
+void UringTcpEventLoop::watchConnect(BaseTcpConnection *connection)
 {
-    LinuxTcpConnection *conn = static_cast<LinuxTcpConnection*>(connection);
+    ioUringObject_->postPollConnect(connection);
+}
 
-    if (eventType == EpollObject::ET_ALLOW_SEND)
-        conn->trySend();
-    else if (eventType == EpollObject::ET_ALLOW_RECV)
-        conn->tryRecv();
-    else if (eventType == EpollObject::ET_ERROR)
-        conn->errorOccurred();
+//-----------------------------------------------------------------------------
+// 描述: 撤销连接等待
+// 备注: 取消操作是异步的，被取消的 POLL_ADD 仍会产生完成事件。
+//-----------------------------------------------------------------------------
+bool UringTcpEventLoop::unwatchConnect(BaseTcpConnection *connection)
+{
+    ioUringObject_->cancelPollConnect(connection);
+    return false;
+}
+
+//-----------------------------------------------------------------------------
+// 描述: io_uring 操作完成回调
+//-----------------------------------------------------------------------------
+void UringTcpEventLoop::onIoUringCompleteEvent(BaseTcpConnection *connection,
+    const IoUringObject::CompleteEvent& event)
+{
+    // 尚未加入事件循环的连接的 connect() 已完成
+    if (event.opType == IoUringObject::OT_POLL_CONNECT)
+    {
+        TcpConnector::onConnectEvent(connection);
+        return;
+    }
+
+    UringTcpConnection *conn = static_cast<UringTcpConnection*>(connection);
+
+    // 已注销的连接的最后一个操作结束，离开本函数时释放连接对象
+    TcpConnectionPtr closingRef;
+    if (!event.hasMore && --conn->pendingOps_ == 0 && conn->closingRef_)
+    {
+        closingRef.swap(conn->closingRef_);
+        --closingConnCount_;
+    }
+
+    // 已注销或已出错的连接只需等待其操作结束
+    if (conn->getEventLoop() != this || conn->isErrorOccurred_) return;
+
+    if (event.opType == IoUringObject::OT_RECV)
+        conn->onRecvComplete(event);
+    else
+        conn->onSendComplete(event);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 
-#endif  /* ifdef ISE_LINUX */
+#endif  /* ifdef ISE_IO_URING */
 
 ///////////////////////////////////////////////////////////////////////////////
 // class MainTcpServer
@@ -1567,6 +4490,10 @@ TcpEventLoopList& MainTcpServer::getTcpClientEventLoopList()
     {
         int eventLoopCount = iseApp().iseOptions().getTcpClientEventLoopCount();
         tcpClientEventLoopList_.reset(new TcpEventLoopList(eventLoopCount));
+        tcpClientEventLoopList_->setThreadName("ise-tcpcli");
+        tcpClientEventLoopList_->setPreciseTimers(iseApp().iseOptions().getPreciseTimers());
+        tcpClientEventLoopList_->setPlacementPolicy(LoopPlacementPolicy::create(
+            iseApp().iseOptions().getTcpClientLoopPlacement()));
         if (isActive_)
             tcpClientEventLoopList_->start();
     }
@@ -1592,7 +4519,7 @@ EventLoop* MainTcpServer::findEventLoop(THREAD_ID loopThreadId)
         }
     }
 
-    if (!result)
+    if (!result && tcpClientEventLoopList_)
         result = tcpClientEventLoopList_->findEventLoop(loopThreadId);
 
     return result;
@@ -1612,6 +4539,18 @@ void MainTcpServer::createTcpServerList()
         TcpServer *tcpServer = new TcpServer(iseApp().iseOptions().getTcpServerEventLoopCount(i));
         tcpServer->setContext(i);
         tcpServer->setLocalPort(static_cast<WORD>(iseApp().iseOptions().getTcpServerPort(i)));
+        tcpServer->setEdgeTriggered(iseApp().iseOptions().getTcpServerEdgeTriggered(i));
+        tcpServer->setSendBufferLimits(iseApp().iseOptions().getTcpServerSendBufferLimits(i));
+        tcpServer->setReusePort(iseApp().iseOptions().getTcpServerReusePort(i));
+
+        int spinMicroSecs = 0, socketMicroSecs = 0;
+        iseApp().iseOptions().getTcpServerBusyPoll(i, spinMicroSecs, socketMicroSecs);
+        tcpServer->getEventLoopList().setBusyPoll(spinMicroSecs, socketMicroSecs);
+        tcpServer->getEventLoopList().setThreadName(formatString("ise-tcp%d", i));
+        tcpServer->getEventLoopList().setCpuAffinity(iseApp().iseOptions().getTcpServerCpuAffinity(i));
+        tcpServer->getEventLoopList().setPreciseTimers(iseApp().iseOptions().getPreciseTimers());
+        tcpServer->getEventLoopList().setPlacementPolicy(LoopPlacementPolicy::create(
+            iseApp().iseOptions().getTcpServerLoopPlacement(i)));
 
         tcpServerList_[i] = tcpServer;
     }
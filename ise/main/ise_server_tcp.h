@@ -48,12 +48,12 @@
 //
 //   以下情况ISE会立即双向关闭 (shutdown(true, true)) 连接:
 //   1. 连接上有错误发生 (errorOccurred())；
-//   2. 发送或接收超时 (checkTimeout())；
+//   2. 发送、接收或空闲超时 (由 TcpEventLoop 的时间轮检测)；
 //   3. 程序退出时关闭现存连接 (clearConnections())。
 //
 // * 连接对象 (TcpConnection) 采用 boost::shared_ptr 管理，由以下几个角色持有:
 //   1. TcpEventLoop.
-//      由 TcpEventLoop::tcpConnMap_ 持有，TcpEventLoop::removeConnection() 时释放。
+//      由 TcpEventLoop::tcpConnTable_ 持有，TcpEventLoop::removeConnection() 时释放。
 //      当调用 TcpConnection::setEventLoop(NULL) 时，将引发 removeConnection()。
 //      程序正常退出 (kill 或 iseApp().setTerminated(true)) 时，将清理全部连接
 //      (TcpEventLoop::clearConnections())，从而使 TcpEventLoop 释放它持有的全部
@@ -99,6 +99,8 @@
 
 #ifdef ISE_LINUX
 #include <sys/epoll.h>
+#include <sys/uio.h>
+#include <sys/sendfile.h>
 #endif
 
 namespace ise
@@ -107,13 +109,21 @@ namespace ise
 ///////////////////////////////////////////////////////////////////////////////
 // 提前声明
 
+class SharedBuffer;
+class IoBufferPool;
 class IoBuffer;
+class TcpConnectionPool;
+class TcpConnectionTable;
 class TcpEventLoop;
 class TcpEventLoopList;
+class LoopPlacementPolicy;
 class TcpConnection;
 class TcpClient;
 class TcpServer;
 class TcpConnector;
+class TcpPeerPool;
+class OffloadPool;
+class OffloadPoolList;
 
 #ifdef ISE_WINDOWS
 class WinTcpConnection;
@@ -125,6 +135,11 @@ class LinuxTcpConnection;
 class LinuxTcpEventLoop;
 #endif
 
+#ifdef ISE_IO_URING
+class UringTcpConnection;
+class UringTcpEventLoop;
+#endif
+
 class MainTcpServer;
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -132,6 +147,35 @@ class MainTcpServer;
 
 typedef boost::shared_ptr<TcpConnection> TcpConnectionPtr;
 
+// 新连接在事件循环间的分派策略
+enum LOOP_PLACEMENT_POLICY
+{
+    LPP_ROUND_ROBIN,        // 轮流分派 (缺省)
+    LPP_LEAST_CONNECTIONS,  // 分派给连接数最少的事件循环
+    LPP_LEAST_BUSY,         // 分派给最近繁忙度最低的事件循环
+    LPP_PEER_HASH           // 按对端IP散列，同一IP的连接总是分派给同一事件循环
+};
+
+// 待发送数据超过上限时的处理策略
+enum SEND_BUFFER_OVERFLOW_POLICY
+{
+    SOP_DROP,               // 丢弃本次发送的数据 (不会回调 onTcpSendComplete)
+    SOP_DISCONNECT          // 断开连接
+};
+
+// 待发送数据的水位及上限 (字节数)
+struct SendBufferLimits
+{
+public:
+    INT64 highWatermark;    // 高水位，待发送数据达到此值时回调 onTcpSendBufferHigh (0 表示不启用)
+    INT64 lowWatermark;     // 低水位，越过高水位后回落到此值时回调 onTcpSendBufferDrained
+    INT64 hardCap;          // 上限，超过时按 overflowPolicy 处理 (0 表示不限制)
+    SEND_BUFFER_OVERFLOW_POLICY overflowPolicy;
+public:
+    SendBufferLimits() :
+        highWatermark(0), lowWatermark(0), hardCap(0), overflowPolicy(SOP_DROP) {}
+};
+
 // 分包器
 typedef boost::function<void (
     const char *data,   // 缓存中可用数据的首字节指针
@@ -139,6 +183,166 @@ typedef boost::function<void (
     int& retrieveBytes  // 返回分离出来的数据包大小，返回0表示现存数据中尚不足以分离出一个完整数据包
 )> PacketSplitter;
 
+// 连续接收模式下批量投递的数据包
+struct RecvPacket
+{
+    void *buffer;       // 数据包首字节指针 (指向接收缓存，仅在回调期间有效)
+    int size;           // 数据包字节数
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// 分包器模板
+//
+// 说明:
+// 1. 数据包未收全时，每次收到新数据都会以缓存中的全部可用数据再次调用分包器。
+//    以下分界符分包器记录已扫描过的字节数，下次从该处继续扫描，每个字节只扫描一次。
+// 2. 分包器对象在 TcpConnection::recv() 时被复制到接收任务中，因此每个接收任务都从
+//    初始状态开始。各分包器均为小对象，存入 PacketSplitter 时不会分配堆内存。
+
+// 在 [begin, end) 中查找第一个 '\r' 或 '\n'，找不到时返回 NULL
+const char* findLineDelimiter(const char *begin, const char *end);
+
+//-----------------------------------------------------------------------------
+// class DelimiterSplitter - 以单个字符 DELIMITER 为分界字符的分包器 (数据包含分界字符)
+
+template<char DELIMITER>
+class DelimiterSplitter
+{
+public:
+    DelimiterSplitter() : scannedBytes_(0) {}
+
+    void operator()(const char *data, int bytes, int& retrieveBytes)
+    {
+        if (scannedBytes_ > bytes) scannedBytes_ = 0;
+
+        const char *p = (const char*)::memchr(data + scannedBytes_, DELIMITER, bytes - scannedBytes_);
+        if (p != NULL)
+        {
+            retrieveBytes = (int)(p - data) + 1;
+            scannedBytes_ = 0;
+        }
+        else
+        {
+            retrieveBytes = 0;
+            scannedBytes_ = bytes;
+        }
+    }
+
+private:
+    int scannedBytes_;      // 已扫描过 (不含分界字符) 的字节数
+};
+
+//-----------------------------------------------------------------------------
+// class LineSplitter - 以 '\r'或'\n' 或其组合为分界字符的分包器 (数据包含分界字符)
+
+class LineSplitter
+{
+public:
+    LineSplitter() : scannedBytes_(0) {}
+
+    void operator()(const char *data, int bytes, int& retrieveBytes)
+    {
+        if (scannedBytes_ > bytes) scannedBytes_ = 0;
+
+        const char *p = findLineDelimiter(data + scannedBytes_, data + bytes);
+        if (p != NULL)
+        {
+            retrieveBytes = (int)(p - data) + 1;
+            if (retrieveBytes < bytes)
+            {
+                char next = *(p+1);
+                if ((next == '\r' || next == '\n') && next != *p)
+                    ++retrieveBytes;
+            }
+            scannedBytes_ = 0;
+        }
+        else
+        {
+            retrieveBytes = 0;
+            scannedBytes_ = bytes;
+        }
+    }
+
+private:
+    int scannedBytes_;      // 已扫描过 (不含分界字符) 的字节数
+};
+
+//-----------------------------------------------------------------------------
+// class FixedSizeSplitter - 数据包长度固定为 PACKET_SIZE 字节的分包器
+
+template<int PACKET_SIZE>
+class FixedSizeSplitter
+{
+public:
+    void operator()(const char *data, int bytes, int& retrieveBytes) const
+    {
+        retrieveBytes = (bytes >= PACKET_SIZE ? PACKET_SIZE : 0);
+    }
+};
+
+//-----------------------------------------------------------------------------
+// class LengthFieldSplitter - 以包头中的长度字段确定包长的分包器
+//
+// 参数:
+//   OFFSET - 长度字段在包中的偏移 (字节)
+//   WIDTH  - 长度字段的宽度 (1、2、4 或 8 字节)
+//   ORDER  - 长度字段的字节序
+//   ADJUST - 包长的修正值
+// 备注:
+//   包长 = OFFSET + WIDTH + 长度字段的值 + ADJUST。
+//   例如长度字段的值为整个包的长度时，ADJUST 应为 -(OFFSET + WIDTH)。
+//   算出的包长小于包头长度 (OFFSET + WIDTH) 时按包头长度处理。
+
+enum BYTE_ORDER_TYPE
+{
+    BO_BIG_ENDIAN,          // 大端 (网络字节序)
+    BO_LITTLE_ENDIAN        // 小端
+};
+
+template<int OFFSET, int WIDTH, BYTE_ORDER_TYPE ORDER = BO_BIG_ENDIAN, int ADJUST = 0>
+class LengthFieldSplitter
+{
+public:
+    enum { HEADER_SIZE = OFFSET + WIDTH };
+public:
+    LengthFieldSplitter() : packetSize_(0) {}
+
+    void operator()(const char *data, int bytes, int& retrieveBytes)
+    {
+        retrieveBytes = 0;
+
+        // 包头只解析一次
+        if (packetSize_ == 0)
+        {
+            if (bytes < HEADER_SIZE) return;
+            packetSize_ = calcPacketSize((const BYTE*)data + OFFSET);
+        }
+
+        if (bytes >= packetSize_)
+        {
+            retrieveBytes = packetSize_;
+            packetSize_ = 0;
+        }
+    }
+
+private:
+    static int calcPacketSize(const BYTE *field)
+    {
+        UINT64 value = 0;
+        for (int i = 0; i < WIDTH; ++i)
+        {
+            int index = (ORDER == BO_BIG_ENDIAN ? i : WIDTH - 1 - i);
+            value = (value << 8) | field[index];
+        }
+
+        INT64 size = (INT64)HEADER_SIZE + ADJUST + (INT64)ise::min<UINT64>(value, 0x7FFFFFFF);
+        return (int)ise::min<INT64>(ise::max<INT64>(size, HEADER_SIZE), 0x7FFFFFFF);
+    }
+
+private:
+    int packetSize_;        // 已解析出的包长 (0 表示尚未解析包头)
+};
+
 ///////////////////////////////////////////////////////////////////////////////
 // 预定义分包器
 
@@ -150,9 +354,9 @@ void anyPacketSplitter(const char *data, int bytes, int& retrieveBytes);
 // 每次接收一个字节的分包器
 const PacketSplitter BYTE_PACKET_SPLITTER = &ise::bytePacketSplitter;
 // 以 '\r'或'\n' 或其组合为分界字符的分包器
-const PacketSplitter LINE_PACKET_SPLITTER = &ise::linePacketSplitter;
+const PacketSplitter LINE_PACKET_SPLITTER = LineSplitter();
 // 以 '\0' 为分界字符的分包器
-const PacketSplitter NULL_TERMINATED_PACKET_SPLITTER = &ise::nullTerminatedPacketSplitter;
+const PacketSplitter NULL_TERMINATED_PACKET_SPLITTER = DelimiterSplitter<'\0'>();
 // 无论收到多少字节都立即获取的分包器
 const PacketSplitter ANY_PACKET_SPLITTER = &ise::anyPacketSplitter;
 
@@ -167,6 +371,159 @@ public:
     AtomicInt errorOccurredCount;    // TcpConnection::errorOccurred() 的调用次数
     AtomicInt addConnCount;          // TcpEventLoop::addConnection() 的调用次数
     AtomicInt removeConnCount;       // TcpEventLoop::removeConnection() 的调用次数
+    AtomicInt sendTimeoutCount;      // 发送任务超时的次数
+    AtomicInt recvTimeoutCount;      // 接收任务超时的次数
+    AtomicInt idleTimeoutCount;      // 连接空闲超时的次数
+    AtomicInt64 ioBufferInUseBytes;  // IoBuffer 当前占用的缓存块字节数
+    AtomicInt64 ioBufferPooledBytes; // 各事件循环的缓存池中空闲缓存块的字节数
+    AtomicInt64 sendSyscallsSaved;   // 合并发送 (send batching) 省去的系统调用次数
+    AtomicInt sendBufferHighCount;   // 待发送数据越过高水位的次数
+    AtomicInt sendBufferOverflowCount;  // 待发送数据超过上限而被丢弃或断开的次数
+    AtomicInt64 peerPoolAcquireCount;   // TcpPeerPool::acquire() 的调用次数
+    AtomicInt64 peerPoolHitCount;       // acquire() 时即有空闲连接可借出的次数
+    AtomicInt64 peerPoolWaitCount;      // acquire() 排队等待后借出连接的次数
+    AtomicInt64 peerPoolWaitMSecs;      // 排队等待的累计时长 (毫秒)
+    AtomicInt peerPoolWaitFailCount;    // 排队等待超时或因连接失败而落空的次数
+    AtomicInt peerPoolReconnectCount;   // 为补足断开或失效的连接而重新连接的次数
+    AtomicInt peerPoolConnectFailCount; // 连接池建立连接失败的次数
+    AtomicInt peerPoolIdleCloseCount;   // 空闲连接因超时或已被对端关闭而关闭的次数
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// class SharedBuffer - 引用计数的只读数据缓存
+//
+// 复制 SharedBuffer 对象只增加引用计数，而不复制数据。
+// 适用于将同一份数据发送给大量连接的场景 (见 TcpConnection::send(const SharedBuffer&))。
+// 注意: 数据一经提交发送，在发送完成前不得再修改。
+
+class SharedBuffer
+{
+public:
+    SharedBuffer() {}
+    SharedBuffer(const void *data, int size) : buffer_(new Buffer(data, size)) {}
+    explicit SharedBuffer(const string& str) : buffer_(new Buffer(str.c_str(), (int)str.length())) {}
+    explicit SharedBuffer(Buffer *buffer) : buffer_(buffer) {}  // 接管 buffer 的所有权，不复制数据
+
+    const char* data() const { return buffer_ ? buffer_->data() : NULL; }
+    int size() const { return buffer_ ? buffer_->getSize() : 0; }
+    bool empty() const { return size() <= 0; }
+
+private:
+    boost::shared_ptr<Buffer> buffer_;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// class IoBufferPool - IoBuffer 缓存块池 (非线程安全，每个事件循环一个)
+//
+// 缓存块的尺寸均为 2 的整数次幂 (最小 MIN_CHUNK_SIZE)。不超过 MAX_POOLED_CHUNK_SIZE
+// 的块在释放后按尺寸分级缓存，以便复用；每级缓存的总字节数不超过
+// MAX_POOLED_BYTES_PER_CLASS，超出部分及更大的块直接归还给堆。
+
+class IoBufferPool : boost::noncopyable
+{
+public:
+    enum { MIN_CHUNK_SHIFT = 10 };                            // 最小块 1KB
+    enum { MAX_POOLED_CHUNK_SHIFT = 18 };                     // 可缓存的最大块 256KB
+    enum { MIN_CHUNK_SIZE = 1 << MIN_CHUNK_SHIFT };
+    enum { MAX_POOLED_CHUNK_SIZE = 1 << MAX_POOLED_CHUNK_SHIFT };
+    enum { CLASS_COUNT = MAX_POOLED_CHUNK_SHIFT - MIN_CHUNK_SHIFT + 1 };
+    enum { MAX_POOLED_BYTES_PER_CLASS = 1024*1024*4 };
+
+public:
+    IoBufferPool();
+    ~IoBufferPool();
+
+    char* allocChunk(int chunkSize);
+    void freeChunk(char *chunk, int chunkSize);
+
+    // 本池中空闲缓存块的字节数 (可在任意线程中读取)
+    INT64 getPooledBytes() const { return pooledBytes_.get(); }
+
+    static int calcChunkSize(int minSize);
+    static char* allocHeapChunk(int chunkSize);
+    static void freeHeapChunk(char *chunk, int chunkSize);
+
+private:
+    static int getClassIndex(int chunkSize);
+
+private:
+    struct FreeChunk
+    {
+        FreeChunk *next;
+    };
+
+    FreeChunk *freeLists_[CLASS_COUNT];          // 各级空闲块链表
+    int classBytes_[CLASS_COUNT];                // 各级空闲块的总字节数
+    mutable AtomicInt64 pooledBytes_;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// class TcpConnectionPool - TcpConnection 对象的内存池 (每个接受连接的线程一个)
+//
+// 说明:
+// 1. 每个内存块依次存放块头、连接对象和 TcpConnectionPtr 的控制块，因此连接对象
+//    连同其 shared_ptr 只需一次分配。连接的引用全部释放后整块归还给池，由下一个
+//    新连接复用，对象状态由构造函数重新初始化。
+// 2. 只有所属线程 (监听线程或事件循环线程) 从池中分配；归还可在任意线程中进行，
+//    经无锁队列交回所属线程。
+// 3. 池以引用计数管理生命期: 所属者及每个未归还的块各持有一个引用。所属者释放池
+//    (release()) 之后，尚存的连接仍可安全地归还内存块。
+// 4. TcpConnection 重载了 operator new/delete，所有连接对象 (包括客户端连接) 都采用
+//    上述内存布局；不指定池时直接从堆分配。
+
+class TcpConnectionPool : boost::noncopyable
+{
+public:
+    enum { MAX_POOLED_COUNT = 2048 };    // 最多缓存的空闲块数
+    enum { CONTROL_BLOCK_SIZE = 64 };    // 为 shared_ptr 控制块预留的字节数
+
+public:
+    static TcpConnectionPool* create();
+    void release();
+
+    // 分配对象内存 (pool 为 NULL 时直接从堆分配)
+    static void* allocate(TcpConnectionPool *pool, size_t objectSize);
+    // 释放对象内存 (可在任意线程中调用)
+    static void deallocate(void *object);
+    // 以对象所在内存块中预留的空间存放控制块，创建 TcpConnectionPtr
+    static TcpConnectionPtr makeConnectionPtr(TcpConnection *connection);
+
+    // 空闲块数 (可在任意线程中读取)
+    int getPooledCount() const { return pooledCount_.get(); }
+
+private:
+    struct BlockHeader : public MpscQueue::Node
+    {
+        TcpConnectionPool *pool;     // 所属的池 (NULL 表示直接从堆分配)
+        size_t objectSize;           // 对象区的字节数 (控制块区紧随其后)
+        bool hasControlBlock;        // 控制块是否存放在本块中
+    };
+
+    enum { ALIGNMENT = 16 };
+
+    struct ConnectionDeleter;
+    template<typename T> class ControlBlockAllocator;
+
+private:
+    TcpConnectionPool();
+    ~TcpConnectionPool();
+
+    BlockHeader* allocBlock();
+    void freeBlock(BlockHeader *header);
+    void releaseRef();
+
+    static size_t alignSize(size_t size) { return (size + ALIGNMENT - 1) & ~(size_t)(ALIGNMENT - 1); }
+    static size_t getHeaderSize() { return alignSize(sizeof(BlockHeader)); }
+    static BlockHeader* getHeader(void *object) { return (BlockHeader*)((char*)object - getHeaderSize()); }
+    static void* getObject(BlockHeader *header) { return (char*)header + getHeaderSize(); }
+    static BlockHeader* allocHeapBlock(size_t objectSize);
+
+private:
+    size_t objectCapacity_;          // 池中每块的对象区字节数
+    MpscQueue::Node *freeList_;      // 空闲块链表 (仅所属线程访问)
+    MpscQueue returnedBlocks_;       // 其它线程归还的空闲块
+    mutable AtomicInt pooledCount_;  // 空闲块数 (freeList_ 与 returnedBlocks_ 之和)
+    AtomicInt refCount_;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -178,19 +535,25 @@ public:
 // +-----------------+------------------+------------------+
 // |                 |                  |                  |
 // 0     <=     readerIndex   <=   writerIndex    <=    size
+//
+// 缓存块在首次写入时才从缓存池 (IoBufferPool) 中获取，数据被全部读出后立即归还，
+// 因此空闲的缓存不占用任何存储空间。未指定缓存池时直接使用堆。
 
-class IoBuffer
+class IoBuffer : boost::noncopyable
 {
 public:
-    enum { INITIAL_SIZE = 1024 };
+    enum { INITIAL_SIZE = IoBufferPool::MIN_CHUNK_SIZE };
 
 public:
     IoBuffer();
     ~IoBuffer();
 
+    void setPool(IoBufferPool *pool) { pool_ = pool; }
+
     int getReadableBytes() const { return writerIndex_ - readerIndex_; }
-    int getWritableBytes() const { return (int)buffer_.size() - writerIndex_; }
+    int getWritableBytes() const { return size_ - writerIndex_; }
     int getUselessBytes() const { return readerIndex_; }
+    int getCapacity() const { return size_; }
 
     void append(const string& str);
     void append(const void *data, int bytes);
@@ -203,43 +566,197 @@ public:
     void swap(IoBuffer& rhs);
     const char* peek() const { return getBufferPtr() + readerIndex_; }
 
+#ifdef ISE_LINUX
+    int appendFromSocket(SOCKET handle);
+#endif
+
 private:
-    char* getBufferPtr() const { return (char*)&*buffer_.begin(); }
+    char* getBufferPtr() const { return buffer_; }
     char* getWriterPtr() const { return getBufferPtr() + writerIndex_; }
     void makeSpace(int moreBytes);
+    char* allocChunk(int chunkSize);
+    void releaseChunk();
 
 private:
-    std::vector<char> buffer_;
+    IoBufferPool *pool_;
+    char *buffer_;
+    int size_;
     int readerIndex_;
     int writerIndex_;
 };
 
+///////////////////////////////////////////////////////////////////////////////
+// class TcpConnectionTable - TCP连接表 (非线程安全)
+//
+// 以数组 (slab) 存放连接，空闲槽位串成链表以便复用，增删均为 O(1)。
+// 连接所在的槽位号记录在 TcpConnection::tableSlot_ 中。
+
+class TcpConnectionTable : boost::noncopyable
+{
+public:
+    TcpConnectionTable();
+
+    void add(const TcpConnectionPtr& connection);
+    void remove(TcpConnection *connection);
+    void clear();
+
+    int getCount() const { return count_; }
+    bool isEmpty() const { return count_ == 0; }
+
+    // 按槽位遍历 (空槽位返回空指针)
+    int getSlotCount() const { return (int)slots_.size(); }
+    const TcpConnectionPtr& getSlot(int slot) const { return slots_[slot].connection; }
+
+private:
+    struct Slot
+    {
+        TcpConnectionPtr connection;
+        int nextFree;                 // 下一个空闲槽位 (-1 表示没有)
+    };
+
+    std::vector<Slot> slots_;
+    int freeHead_;                    // 第一个空闲槽位 (-1 表示没有)
+    int count_;                       // 连接数
+};
+
 ///////////////////////////////////////////////////////////////////////////////
 // class TcpEventLoop - 事件循环类
 
 class TcpEventLoop : public OsEventLoop
 {
 public:
-    typedef std::map<string, TcpConnectionPtr> TcpConnectionMap;  // <connectionName, TcpConnectionPtr>
+    enum { TIMING_WHEEL_TICK = 100 };  // 时间轮精度 (毫秒)
 
 public:
-    TcpEventLoop();
+    explicit TcpEventLoop(IO_BACKEND_TYPE ioBackend = IOB_EPOLL);
     virtual ~TcpEventLoop();
 
     void addConnection(TcpConnection *connection);
     void removeConnection(TcpConnection *connection);
     void clearConnections();
 
+    TimingWheel& getTimingWheel() { return timingWheel_; }
+    IoBufferPool& getIoBufferPool() { return ioBufferPool_; }
+    TcpConnectionPool& getConnectionPool() { return *connectionPool_; }
+
+    // 设置此后加入的连接的 SO_BUSY_POLL 时长 (微秒，0 表示不设置)
+    void setSocketBusyPoll(int microSecs) { socketBusyPollMicroSecs_ = ise::max(microSecs, 0); }
+    int getSocketBusyPoll() const { return socketBusyPollMicroSecs_; }
+
+    // 以下负载计数可在任意线程中读取
+    int getConnectionCount() const { return connCount_.get(); }
+    int getPendingConnCount() const { return pendingConnCount_.get(); }
+    int getPlacedCount() const { return placedCount_.get(); }
+    // 以下合并发送的统计可在任意线程中读取
+    INT64 getIterationCount() const { return iterationCount_.get(); }
+    INT64 getSendFlushCount() const { return sendFlushCount_.get(); }
+    INT64 getSendSyscallsSaved() const { return sendSyscallsSaved_.get(); }
+
 protected:
     virtual void runLoop(Thread *thread);
+    virtual int calcLoopWaitTimeout();
     virtual void registerConnection(TcpConnection *connection) = 0;
     virtual void unregisterConnection(TcpConnection *connection) = 0;
+    // 在每轮循环中执行完被委托的仿函数后，发出本轮合并的发送数据
+    virtual void flushBatchedSends() {}
+    virtual bool hasBatchedSends() const { return false; }
+    // 是否尚有已注销连接的操作未结束 (此时不可退出循环)
+    virtual bool hasPendingIo() const { return false; }
+    // 等待尚未加入的连接上的非阻塞 connect() 完成 (一次性)，完成时先撤销等待，
+    // 再调用 TcpConnector::onConnectEvent()
+    virtual void watchConnect(BaseTcpConnection *connection) = 0;
+    // 撤销等待。返回 false 表示须异步撤销，此后仍会调用一次 TcpConnector::onConnectEvent()
+    virtual bool unwatchConnect(BaseTcpConnection *connection) = 0;
+
+private:
+    void addPlacedConnection(TcpConnection *connection);
 
 private:
-    void checkTimeout();
+    TcpConnectionTable tcpConnTable_;
+    TimingWheel timingWheel_;          // 用于连接的发送、接收及空闲超时
+    IoBufferPool ioBufferPool_;        // 本事件循环中各连接共用的缓存块池
+    TcpConnectionPool *connectionPool_;  // 本事件循环直接接受连接时使用的连接对象池
+    mutable AtomicInt connCount_;      // 已加入本事件循环的连接数
+    mutable AtomicInt pendingConnCount_;  // 已分派给本事件循环但尚未加入的连接数
+    mutable AtomicInt placedCount_;    // 被分派策略选中的累计次数
+    int socketBusyPollMicroSecs_;      // 连接的 SO_BUSY_POLL 时长 (微秒)
+    bool socketBusyPollFailed_;        // 是否已设置 SO_BUSY_POLL 失败过 (只记录一次日志)
+
+protected:
+    mutable AtomicInt64 iterationCount_;     // 已执行的循环轮数
+    mutable AtomicInt64 sendFlushCount_;     // 合并发送时实际写套接字的次数
+    mutable AtomicInt64 sendSyscallsSaved_;  // 合并发送省去的系统调用次数
+
+    friend class TcpEventLoopList;
+    friend class TcpConnector;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// class LoopPlacementPolicy - 新连接在事件循环间的分派策略 (接口)
+//
+// 用户可派生此类实现自己的策略，并通过 TcpEventLoopList::setPlacementPolicy()
+// 安装。selectLoop() 在 TcpEventLoopList 的锁内调用，实现无需考虑线程安全。
+
+class LoopPlacementPolicy : boost::noncopyable
+{
+public:
+    virtual ~LoopPlacementPolicy() {}
+
+    // 返回策略名称 (用于状态监视)
+    virtual string getName() const = 0;
+    // 为 connection 选择事件循环，返回其在 eventLoopList 中的序号
+    virtual int selectLoop(TcpEventLoopList& eventLoopList, BaseTcpConnection *connection) = 0;
+
+    static LoopPlacementPolicy* create(LOOP_PLACEMENT_POLICY policy);
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// class RoundRobinPlacement - 轮流分派
 
+class RoundRobinPlacement : public LoopPlacementPolicy
+{
+public:
+    RoundRobinPlacement() : nextIndex_(0) {}
+    virtual string getName() const { return "round_robin"; }
+    virtual int selectLoop(TcpEventLoopList& eventLoopList, BaseTcpConnection *connection);
 private:
-    TcpConnectionMap tcpConnMap_;
+    int nextIndex_;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// class LeastConnectionsPlacement - 分派给连接数 (含待加入的连接) 最少的事件循环
+
+class LeastConnectionsPlacement : public LoopPlacementPolicy
+{
+public:
+    virtual string getName() const { return "least_connections"; }
+    virtual int selectLoop(TcpEventLoopList& eventLoopList, BaseTcpConnection *connection);
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// class LeastBusyPlacement - 分派给最近繁忙度最低的事件循环，繁忙度相近时比较连接数
+//
+// 繁忙度每个统计周期 (EventLoop::LOAD_STAT_INTERVAL) 才更新一次，所以一个周期内
+// 的新连接会集中分派给同一事件循环。适用于连接长期存在、负载差异较大的场景。
+
+class LeastBusyPlacement : public LoopPlacementPolicy
+{
+public:
+    enum { BUSY_GRANULARITY = 50 };  // 繁忙度相差不足 5% 视为相同
+
+public:
+    virtual string getName() const { return "least_busy"; }
+    virtual int selectLoop(TcpEventLoopList& eventLoopList, BaseTcpConnection *connection);
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// class PeerHashPlacement - 按对端IP散列
+
+class PeerHashPlacement : public LoopPlacementPolicy
+{
+public:
+    virtual string getName() const { return "peer_hash"; }
+    virtual int selectLoop(TcpEventLoopList& eventLoopList, BaseTcpConnection *connection);
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -252,12 +769,28 @@ public:
     virtual ~TcpEventLoopList();
 
     bool registerToEventLoop(BaseTcpConnection *connection, int eventLoopIndex = -1);
+    int placeConnection(BaseTcpConnection *connection, int eventLoopIndex = -1);
+
+    void setPlacementPolicy(LoopPlacementPolicy *policy);
+    LoopPlacementPolicy& getPlacementPolicy() { return *placementPolicy_; }
 
     TcpEventLoop* getItem(int index) { return (TcpEventLoop*)EventLoopList::getItem(index); }
     TcpEventLoop* operator[] (int index) { return getItem(index); }
 
+    void setBusyPoll(int spinMicroSecs, int socketMicroSecs = 0);
+
+    static IO_BACKEND_TYPE getIoBackend();
+
 protected:
     virtual EventLoop* createEventLoop();
+
+private:
+    static IO_BACKEND_TYPE selectIoBackend();
+
+private:
+    boost::scoped_ptr<LoopPlacementPolicy> placementPolicy_;
+    int busyPollMicroSecs_;            // 各事件循环的忙轮询时长 (微秒)
+    int socketBusyPollMicroSecs_;      // 各连接的 SO_BUSY_POLL 时长 (微秒)
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -271,16 +804,16 @@ public:
     struct SendTask
     {
     public:
-        int bytes;
+        INT64 bytes;
         Context context;
         int timeout;
-        UINT startTicks;
+        bool isTimerStarted;    // 是否已开始超时计时 (任务成为队首时开始)
     public:
         SendTask()
         {
             bytes = 0;
             timeout = 0;
-            startTicks = 0;
+            isTimerStarted = false;
         }
     };
 
@@ -290,12 +823,12 @@ public:
         PacketSplitter packetSplitter;
         Context context;
         int timeout;
-        UINT startTicks;
+        bool isTimerStarted;    // 是否已开始超时计时 (任务成为队首时开始)
     public:
         RecvTask()
         {
             timeout = 0;
-            startTicks = 0;
+            isTimerStarted = false;
         }
     };
 
@@ -307,6 +840,11 @@ public:
     TcpConnection(TcpServer *tcpServer, SOCKET socketHandle);
     virtual ~TcpConnection();
 
+    static void* operator new(size_t size) { return TcpConnectionPool::allocate(NULL, size); }
+    static void* operator new(size_t size, TcpConnectionPool *pool) { return TcpConnectionPool::allocate(pool, size); }
+    static void operator delete(void *p) { TcpConnectionPool::deallocate(p); }
+    static void operator delete(void *p, TcpConnectionPool *pool) { TcpConnectionPool::deallocate(p); }
+
     void send(
         const void *buffer,
         size_t size,
@@ -314,14 +852,49 @@ public:
         int timeout = TIMEOUT_INFINITE
         );
 
+    void send(
+        const SharedBuffer& buffer,
+        const Context& context = EMPTY_CONTEXT,
+        int timeout = TIMEOUT_INFINITE
+        );
+
+    void sendFile(
+        HANDLE fileHandle,
+        INT64 offset,
+        INT64 length,
+        const Context& context = EMPTY_CONTEXT,
+        int timeout = TIMEOUT_INFINITE
+        );
+
     void recv(
         const PacketSplitter& packetSplitter = ANY_PACKET_SPLITTER,
         const Context& context = EMPTY_CONTEXT,
         int timeout = TIMEOUT_INFINITE
         );
 
+    // 启用连续接收模式 (线程安全)
+    void startContinuousRecv(
+        const PacketSplitter& packetSplitter,
+        bool batchMode = false,
+        const Context& context = EMPTY_CONTEXT
+        );
+    // 停止连续接收模式 (线程安全)
+    void stopContinuousRecv();
+    bool isContinuousRecv() const { return !continuousRecvSplitter_.empty(); }
+
+    // 设置待发送数据的水位及上限 (须在事件循环线程中调用，例如在 onTcpConnected 中)
+    void setSendBufferLimits(const SendBufferLimits& limits) { sendBufferLimits_ = limits; }
+    void setSendBufferWatermarks(INT64 highBytes, INT64 lowBytes);
+    void setSendBufferHardCap(INT64 bytes, SEND_BUFFER_OVERFLOW_POLICY policy);
+    const SendBufferLimits& getSendBufferLimits() const { return sendBufferLimits_; }
+    // 已提交但尚未写入套接字的字节数 (Linux 下不含 sendFile 的文件数据)
+    INT64 getSendQueuedBytes() const { return sendQueuedBytes_; }
+    bool isSendBufferHigh() const { return isSendBufferHigh_; }
+
+    bool isErrorOccurred() const { return isErrorOccurred_; }
     bool isFromClient() const { return (tcpServer_ == NULL);}
     bool isFromServer() const { return (tcpServer_ != NULL);}
+    UINT64 getConnectionId() const { return connectionId_; }
     const string& getConnectionName() const;
     int getServerIndex() const;
     int getServerPort() const;
@@ -331,12 +904,24 @@ protected:
     virtual void doDisconnect();
     virtual void eventLoopChanged() {}
     virtual void postSendTask(const void *buffer, int size, const Context& context, int timeout) = 0;
+    virtual void postSendTask(const SharedBuffer& buffer, const Context& context, int timeout);
+    virtual void postSendFileTask(HANDLE fileHandle, INT64 offset, INT64 length, const Context& context, int timeout);
     virtual void postRecvTask(const PacketSplitter& packetSplitter, const Context& context, int timeout) = 0;
+    virtual void postContinuousRecv(const PacketSplitter& packetSplitter, bool batchMode, const Context& context);
 
 protected:
     void errorOccurred();
-    void checkTimeout(UINT curTicks);
-    void postSendTask(const string& data, const Context& context, int timeout);
+
+    bool hasRecvDemand() const { return !recvTaskQueue_.empty() || isContinuousRecv(); }
+    int deliverContinuousPackets(const char *data, int bytes);
+
+    void updateSendTimeout();
+    void updateRecvTimeout();
+    void markActive() { lastActiveTicks_ = Clock::getTicks(); }
+
+    bool checkSendBufferCap(INT64 bytes);
+    void addSendQueuedBytes(INT64 bytes);
+    void removeSendQueuedBytes(INT64 bytes);
 
     void setEventLoop(TcpEventLoop *eventLoop);
     TcpEventLoop* getEventLoop() { return eventLoop_; }
@@ -344,18 +929,41 @@ protected:
 private:
     void init();
 
+    template<typename TaskQueue>
+    void updateTaskTimeout(TaskQueue& taskQueue, TimingWheel::Entry& entry);
+    void startTimeouts();
+    void stopTimeouts();
+    void onSendTimeout();
+    void onRecvTimeout();
+    void onIdleTimeout();
+
 protected:
     TcpServer *tcpServer_;                // 所属 TcpServer
     TcpEventLoop *eventLoop_;             // 所属 TcpEventLoop
-    mutable string connectionName_;       // 连接名称
+    UINT64 connectionId_;                 // 连接ID (进程内唯一)
+    int tableSlot_;                       // 在所属 TcpEventLoop 连接表中的槽位号
+    mutable string connectionName_;       // 连接名称 (首次访问时生成)
     IoBuffer sendBuffer_;                 // 数据发送缓存
     IoBuffer recvBuffer_;                 // 数据接收缓存
     SendTaskQueue sendTaskQueue_;         // 发送任务队列
     RecvTaskQueue recvTaskQueue_;         // 接收任务队列
     bool isErrorOccurred_;                // 连接上是否发生了错误
-
+    TimingWheel::Entry sendTimeoutEntry_; // 队首发送任务的超时定时项
+    TimingWheel::Entry recvTimeoutEntry_; // 队首接收任务的超时定时项
+    TimingWheel::Entry idleTimeoutEntry_; // 空闲超时定时项
+    UINT64 lastActiveTicks_;              // 最近一次收发数据的时间 (毫秒)
+    SendBufferLimits sendBufferLimits_;   // 待发送数据的水位及上限
+    INT64 sendQueuedBytes_;               // 已提交但尚未写入套接字的字节数
+    bool isSendBufferHigh_;               // 是否已越过高水位且尚未回落到低水位
+    PacketSplitter continuousRecvSplitter_;  // 连续接收模式的分包器 (为空表示未启用)
+    Context continuousRecvContext_;       // 连续接收模式的回调上下文
+    bool isRecvBatchMode_;                // 连续接收模式下是否以 onTcpRecvBatch 批量投递
+
+    friend class TcpConnectionTable;
     friend class TcpEventLoop;
     friend class TcpEventLoopList;
+    friend class TcpServer;
+    friend class OffloadPool;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -364,7 +972,7 @@ protected:
 class TcpClient : public BaseTcpClient
 {
 public:
-    TcpConnection& getConnection() { return *static_cast<TcpConnection*>(connection_); }
+    TcpConnection& getConnection() { return static_cast<TcpConnection&>(BaseTcpClient::getConnection()); }
 protected:
     virtual BaseTcpConnection* createConnection();
 private:
@@ -380,13 +988,23 @@ class TcpServer : public BaseTcpServer
 {
 public:
     explicit TcpServer(int eventLoopCount);
+    virtual ~TcpServer();
 
     int getConnectionCount() const { return connCount_.get(); }
+    TcpEventLoopList& getEventLoopList() { return eventLoopList_; }
+
+    void setEdgeTriggered(bool value) { edgeTriggered_ = value; }
+    bool isEdgeTriggered() const { return edgeTriggered_; }
+    // 设置本服务器新连接的待发送数据水位及上限的初始值
+    void setSendBufferLimits(const SendBufferLimits& limits) { sendBufferLimits_ = limits; }
+    const SendBufferLimits& getSendBufferLimits() const { return sendBufferLimits_; }
 
     virtual void open();
     virtual void close();
 
 protected:
+    virtual void startListenerThread();
+
     virtual BaseTcpConnection* createConnection(SOCKET socketHandle);
     virtual void acceptConnection(BaseTcpConnection *connection);
 
@@ -394,9 +1012,24 @@ private:
     void incConnCount() { connCount_.increment(); }
     void decConnCount() { connCount_.decrement(); }
 
+    TcpConnection* createConnection(SOCKET socketHandle, TcpConnectionPool *pool);
+    bool isLoopAccept() const;
+    void openLoopListeners();
+    void closeLoopListeners();
+    void acceptInLoop(TcpEventLoop *eventLoop, SOCKET listenHandle);
+    void addAcceptedConnection(TcpEventLoop *eventLoop, SOCKET acceptHandle);
+    void logAcceptError(int errorCode);
+
 private:
+    typedef std::vector<TcpSocket*> TcpSocketList;
+
     TcpEventLoopList eventLoopList_;
     mutable AtomicInt connCount_;
+    bool edgeTriggered_;
+    SendBufferLimits sendBufferLimits_;
+    TcpConnectionPool *listenerConnPool_;  // 监听线程接受连接时使用的连接对象池
+    TcpSocketList loopListenSockets_;  // 各事件循环自有的监听套接字 (0号事件循环使用 getSocket())
+    AtomicInt64 lastAcceptErrorTicks_;  // 最近一次记录 accept 错误日志的时刻 (用于限制日志频率)
 
     friend class TcpConnection;
     friend class MainTcpServer;
@@ -404,6 +1037,14 @@ private:
 
 ///////////////////////////////////////////////////////////////////////////////
 // class TcpConnector - TCP连接器类
+//
+// 说明:
+// 1. 非阻塞连接在调用者线程中发起，随后交给分派策略选定的客户端事件循环，由该
+//    事件循环等待连接完成 (EPoll 等待可写、io_uring 提交 POLL_ADD，IOCP 下定时检查)，
+//    不再需要单独的轮询线程。
+// 2. 完成回调在该事件循环线程中执行，连接成功时即已属于该事件循环。
+// 3. 连接超时由该事件循环的时间轮计时。
+// 4. 须在客户端事件循环停止之后销毁。
 
 class TcpConnector : boost::noncopyable
 {
@@ -412,31 +1053,24 @@ public:
         const InetAddress& peerAddr, const Context& context)> CompleteCallback;
 
 private:
-    typedef std::vector<SOCKET> FdList;
-
     struct TaskItem
     {
+        TcpConnector *owner;
+        UINT64 taskId;
         TcpClient tcpClient;
         InetAddress peerAddr;
         CompleteCallback completeCallback;
         ASYNC_CONNECT_STATE state;
         Context context;
+        int timeout;                     // 连接超时 (毫秒，TIMEOUT_INFINITE 表示不限)
+        TcpEventLoop *eventLoop;         // 负责等待连接完成的事件循环
+        TimingWheel::Entry timeoutEntry;
+        bool isWatching;                 // 事件循环是否正在等待连接完成
+        bool isTimedOut;                 // 是否已超时
+        bool isCancelled;                // 是否已被 clear() 取消 (受 mutex_ 保护)
     };
 
-    typedef ObjectList<TaskItem> TaskList;
-
-    class WorkerThread : public Thread
-    {
-    public:
-        WorkerThread(TcpConnector& owner) : owner_(owner) {}
-    protected:
-        virtual void execute() { owner_.work(*this); }
-        virtual void afterExecute() { owner_.thread_ = NULL; }
-    private:
-        TcpConnector& owner_;
-    };
-
-    friend class WorkerThread;
+    typedef std::map<UINT64, TaskItem*> TaskMap;
 
 public:
     TcpConnector();
@@ -444,27 +1078,460 @@ public:
 
     void connect(const InetAddress& peerAddr,
         const CompleteCallback& completeCallback,
-        const Context& context = EMPTY_CONTEXT);
+        const Context& context = EMPTY_CONTEXT,
+        int timeout = TIMEOUT_INFINITE);
     void clear();
 
+    // 进行中的连接数
+    int getPendingCount() const;
+
+private:
+    static void onConnectEvent(BaseTcpConnection *connection);
+    static ASYNC_CONNECT_STATE startConnect(TaskItem *task);
+
+    void startWatch(TaskItem *task);
+    void abortWatch(TaskItem *task);
+    void abortTask(UINT64 taskId);
+    void onConnectTimeout(TaskItem *task);
+    void completeTask(TaskItem *task);
+
+private:
+    TaskMap tasks_;                      // 进行中的连接任务 (taskId -> TaskItem)
+    UINT64 nextTaskId_;
+    mutable Mutex mutex_;
+
+    friend class WinTcpEventLoop;
+    friend class LinuxTcpEventLoop;
+    friend class UringTcpEventLoop;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// class TcpPeerPool - 按对端地址保持的出站TCP连接池
+//
+// 说明:
+// 1. 对每个对端地址保持 getConnsPerPeer() 个预先建立的连接。连接由 TcpConnector
+//    建立，按客户端事件循环的分派策略分布在各客户端事件循环中。
+// 2. acquire() 借出一个空闲连接；全部借出时排队等待，直至有连接归还或新建完成。
+//    用完后须以 release() 归还，不可再用的连接 (如应答未收完) 以 reusable = false 归还。
+// 3. 后台每隔 MAINTAIN_INTERVAL 毫秒 (在客户端事件循环中) 维护一次: 丢弃已出错或
+//    已被对端关闭的空闲连接，关闭空闲超过 getMaxIdleTime() 的连接，补足连接数，
+//    并使等待超时的请求失败。连接均启用 SO_KEEPALIVE，以便发现失联的对端。
+// 4. AcquireCallback 可能在调用者线程、归还连接的线程、客户端事件循环线程或
+//    定时器线程中执行，回调时不持有连接池的锁。
+// 5. 借出的连接与其他客户端连接一样，收发结果经由 IseBusiness 回调。
+
+class TcpPeerPool : boost::noncopyable
+{
+public:
+    enum { DEF_CONNS_PER_PEER = 4 };             // 缺省的每个对端的连接数
+    enum { DEF_MAX_IDLE_TIME = 1000*60 };        // 缺省的最大空闲时间 (毫秒)
+    enum { DEF_CONNECT_TIMEOUT = 1000*5 };       // 缺省的连接超时 (毫秒)
+    enum { MAINTAIN_INTERVAL = 100 };            // 后台维护的间隔 (毫秒)
+    enum { RECONNECT_DELAY = 1000 };             // 连接失败后再次连接的间隔 (毫秒)
+
+    // 借出连接的回调 (失败或等待超时时 connection 为空)
+    typedef boost::function<void (const TcpConnectionPtr& connection,
+        const InetAddress& peerAddr)> AcquireCallback;
+
+private:
+    struct IdleConn
+    {
+        TcpConnectionPtr connection;
+        UINT64 idleTicks;                // 开始空闲的时间
+    };
+
+    struct Waiter
+    {
+        AcquireCallback callback;
+        UINT64 startTicks;               // 开始等待的时间
+        int timeout;                     // 等待超时 (毫秒，TIMEOUT_INFINITE 表示不限)
+    };
+
+    typedef std::deque<IdleConn> IdleConnList;
+    typedef std::deque<Waiter> WaiterList;
+
+    struct Peer
+    {
+        UINT64 peerId;                   // 区别先后添加的同一地址 (随连接请求传递)
+        InetAddress addr;
+        IdleConnList idleConns;          // 空闲连接 (队尾为最近归还的)
+        WaiterList waiters;              // 等待借出连接的请求
+        int borrowedCount;               // 已借出的连接数
+        int connectingCount;             // 正在建立的连接数
+        UINT64 retryTicks;               // 连接失败后，在此时间之前不再连接
+        bool isWarmedUp;                 // 是否已发起过首批连接
+    };
+
+    typedef std::map<UINT64, Peer*> PeerMap;
+
+    // 在锁外执行的回调
+    struct PendingCall
+    {
+        AcquireCallback callback;
+        TcpConnectionPtr connection;
+        InetAddress peerAddr;
+    };
+
+    // 在锁外发起的连接
+    struct PendingConnect
+    {
+        UINT64 peerId;
+        InetAddress peerAddr;
+        int count;
+    };
+
+    typedef std::vector<PendingCall> PendingCalls;
+    typedef std::vector<PendingConnect> PendingConnects;
+    typedef std::vector<TcpConnectionPtr> TcpConnectionPtrs;
+
+    // 一次操作中需在锁外完成的事项
+    struct Deferred
+    {
+        PendingCalls calls;
+        PendingConnects connects;
+        TcpConnectionPtrs closingConns;
+    };
+
+    // 连接器和定时器经此对象回调连接池，连接池析构后不再回调
+    struct LifeGuard
+    {
+        Mutex mutex;
+        TcpPeerPool *pool;
+    };
+
+    typedef boost::shared_ptr<LifeGuard> LifeGuardPtr;
+
+public:
+    TcpPeerPool();
+    ~TcpPeerPool();
+
+    // 以下设置对此后的维护生效
+    void setConnsPerPeer(int value) { connsPerPeer_ = ise::max(value, 1); }
+    void setMaxIdleTime(int msecs) { maxIdleTime_ = ise::max(msecs, 0); }
+    void setConnectTimeout(int msecs) { connectTimeout_ = msecs; }
+
+    int getConnsPerPeer() const { return connsPerPeer_; }
+    int getMaxIdleTime() const { return maxIdleTime_; }
+    int getConnectTimeout() const { return connectTimeout_; }
+
+    void addPeer(const InetAddress& peerAddr);
+    void removePeer(const InetAddress& peerAddr);
+
+    void acquire(const InetAddress& peerAddr, const AcquireCallback& callback,
+        int timeout = TIMEOUT_INFINITE);
+    void release(const TcpConnectionPtr& connection, bool reusable = true);
+
+    int getPeerCount() const;
+    int getIdleCount() const;
+    int getBorrowedCount() const;
+
+private:
+    static UINT64 getPeerKey(const InetAddress& peerAddr);
+    static bool isAlive(TcpConnection& connection);
+    static void onConnectComplete(const LifeGuardPtr& guard, bool success,
+        TcpConnection *connection, const InetAddress& peerAddr, const Context& context);
+    static void onMaintainTimer(const LifeGuardPtr& guard);
+
+    Peer* findPeer(const InetAddress& peerAddr);
+    Peer* getPeer(const InetAddress& peerAddr);
+    void deletePeer(Peer *peer, Deferred& deferred);
+    void lend(Peer *peer, const TcpConnectionPtr& connection, Deferred& deferred);
+    void failWaiters(Peer *peer, Deferred& deferred);
+    void replenish(Peer *peer, Deferred& deferred);
+    void maintainPeer(Peer *peer, Deferred& deferred);
+
+    void connectComplete(bool success, TcpConnection *connection, UINT64 peerId,
+        const InetAddress& peerAddr);
+    void maintain();
+    void startMaintainTimer();
+    void finish(Deferred& deferred);
+
+private:
+    PeerMap peers_;
+    int connsPerPeer_;                   // 每个对端的连接数
+    int maxIdleTime_;                    // 连接的最大空闲时间 (毫秒，0 表示不限)
+    int connectTimeout_;                 // 连接超时 (毫秒)
+    UINT64 nextPeerId_;
+    LifeGuardPtr lifeGuard_;
+    EventLoop *maintainLoop_;            // 执行后台维护的事件循环 (NULL 表示尚未启动)
+    TimerId maintainTimerId_;            // 后台维护定时器
+    mutable Mutex mutex_;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+// 阻塞任务的卸载 (Offload)
+
+// 卸载任务的执行状态
+struct OffloadStatus
+{
+public:
+    bool isOk;                  // 任务是否正常返回 (未抛出异常)
+    string errorMsg;            // 任务抛出异常时的异常信息
+    INT64 queueWaitMicroSecs;   // 任务在线程池中排队等待的时长 (微秒)
+    INT64 execMicroSecs;        // 任务的执行时长 (微秒)
+public:
+    OffloadStatus() : isOk(false), queueWaitMicroSecs(0), execMicroSecs(0) {}
+};
+
+// 卸载任务的执行结果 (R 为任务的返回值类型)
+template<typename R>
+struct OffloadResult : public OffloadStatus
+{
+public:
+    R value;                    // 任务的返回值 (任务抛出异常时为缺省值)
+public:
+    OffloadResult() : value() {}
+};
+
+template<>
+struct OffloadResult<void> : public OffloadStatus
+{
+};
+
+// 执行任务并保存返回值 (对 void 特化)
+template<typename R>
+struct OffloadInvoker
+{
+    static void invoke(const boost::function<R ()>& work, OffloadResult<R>& result)
+        { result.value = work(); }
+};
+
+template<>
+struct OffloadInvoker<void>
+{
+    static void invoke(const boost::function<void ()>& work, OffloadResult<void>& result)
+        { work(); }
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// class OffloadPool - 阻塞任务卸载池 (在线程池中执行阻塞操作，在发起的事件循环中处理结果)
+//
+// 说明:
+// 1. 事件循环线程 (如 IseBusiness::onTcpRecvComplete() 中) 不可执行阻塞操作 (数据库、
+//    磁盘等)。submit() 将阻塞操作 (work) 交给本池的线程执行，完成后把结果委托给发起的
+//    事件循环，在该事件循环线程中调用后续处理 (continuation)。
+// 2. 以 TcpConnection 提交的任务在该连接所属的事件循环中继续，连接断开即取消任务:
+//    尚未开始执行的不再执行，已执行完的不再调用 continuation。以 EventLoop 提交时可
+//    自行指定取消条件 (CancelCheck，须线程安全)。被取消的任务不调用 continuation。
+// 3. 池内的任务数 (排队及执行中的) 不超过 getMaxInFlight()，达到上限或池未启动时
+//    submit() 返回 false，由调用者决定如何应对 (如答复 "服务繁忙")。
+// 4. work 抛出的 Exception 或 std::exception 被捕获，以 result.isOk == false 交给
+//    continuation。continuation 抛出的异常由事件循环处理。
+// 5. 统计数据可在任意线程中读取，inspector 的 /tcp/offload 页面列出各池的统计。
+// 6. 由 IseOptions::addOffloadPool() 配置的池随服务器启动和停止，以
+//    iseApp().offloadPool(name) 取得。停止时等待执行中的任务返回，尚未执行的任务
+//    留待再次启动时执行，池销毁时被丢弃 (不调用 continuation)。
+//
+// 示例:
+//   bool ok = iseApp().offloadPool("db").submit<string>(connection,
+//       boost::bind(&AppBusiness::queryUser, this, userId),
+//       boost::bind(&AppBusiness::onUserQueried, this, connection, _1));
+//
+//   void AppBusiness::onUserQueried(const TcpConnectionPtr& connection, OffloadResult<string>& result)
+//   {
+//       if (result.isOk) connection->send(result.value.c_str(), result.value.size());
+//   }
+
+class OffloadPool : boost::noncopyable
+{
+public:
+    // 取消条件 (返回 true 表示任务已取消)
+    typedef boost::function<bool ()> CancelCheck;
+
 private:
+    // 统计数据 (由池及其未完成的任务共同持有，池销毁后尚在途的任务仍可安全地更新)
+    struct Stat
+    {
+        AtomicInt inFlightCount;         // 排队及执行中的任务数
+        AtomicInt64 submitCount;         // 被接受的任务数
+        AtomicInt64 rejectCount;         // 因达到上限或池未启动而被拒绝的任务数
+        AtomicInt64 completeCount;       // 正常返回并已调用 continuation 的任务数
+        AtomicInt64 failCount;           // 抛出异常并已调用 continuation 的任务数
+        AtomicInt64 cancelCount;         // 被取消的任务数
+        AtomicInt64 startCount;          // 已出队的任务数 (含出队后即被取消的)
+        AtomicInt64 execCount;           // 已执行的任务数
+        AtomicInt64 queueWaitMicroSecs;  // 出队任务的累计排队等待时长 (微秒)
+        AtomicInt64 execMicroSecs;       // 累计执行时长 (微秒)
+    };
+
+    typedef boost::shared_ptr<Stat> StatPtr;
+
+    template<typename R>
+    struct Job
+    {
+        boost::function<R ()> work;
+        boost::function<void (OffloadResult<R>&)> continuation;
+        CancelCheck cancelCheck;
+        EventLoop *eventLoop;            // 发起任务的事件循环
+        StatPtr stat;
+        UINT64 submitMicroTicks;         // 提交时间 (微秒)
+        OffloadResult<R> result;
+    };
+
+public:
+    OffloadPool(const string& name, int threadCount, int maxInFlight = 0);
+    ~OffloadPool();
+
     void start();
     void stop();
-    void work(WorkerThread& thread);
 
-    void tryConnect();
-    void getPendingFdsFromTaskList(int& fromIndex, FdList& fds);
-    void checkAsyncConnectState(const FdList& fds, FdList& connectedFds, FdList& failedFds);
-    TaskItem* findTask(SOCKET fd);
-    void invokeCompleteCallback();
+    template<typename R>
+    bool submit(EventLoop *eventLoop,
+        const boost::function<R ()>& work,
+        const boost::function<void (OffloadResult<R>&)>& continuation,
+        const CancelCheck& cancelCheck = CancelCheck());
+
+    template<typename R>
+    bool submit(const TcpConnectionPtr& connection,
+        const boost::function<R ()>& work,
+        const boost::function<void (OffloadResult<R>&)>& continuation);
+
+    const string& getName() const { return name_; }
+    int getThreadCount() const { return threadCount_; }
+    int getMaxInFlight() const { return maxInFlight_; }  // 0 表示不限
+    bool isRunning() const { return threadPool_.isRunning(); }
+
+    int getInFlightCount() const { return stat_->inFlightCount.get(); }
+    INT64 getSubmitCount() const { return stat_->submitCount.get(); }
+    INT64 getRejectCount() const { return stat_->rejectCount.get(); }
+    INT64 getCompleteCount() const { return stat_->completeCount.get(); }
+    INT64 getFailCount() const { return stat_->failCount.get(); }
+    INT64 getCancelCount() const { return stat_->cancelCount.get(); }
+    INT64 getStartCount() const { return stat_->startCount.get(); }
+    INT64 getExecCount() const { return stat_->execCount.get(); }
+    INT64 getQueueWaitMicroSecs() const { return stat_->queueWaitMicroSecs.get(); }
+    INT64 getExecMicroSecs() const { return stat_->execMicroSecs.get(); }
 
 private:
-    TaskList taskList_;
-    Mutex mutex_;
-    WorkerThread *thread_;
+    bool acquireSlot();
+    static bool isConnectionClosed(const boost::weak_ptr<TcpConnection>& connection);
+    static bool isCanceled(const CancelCheck& cancelCheck, Stat& stat);
+    static void runWork(const boost::function<void ()>& invoker, OffloadStatus& status, Stat& stat);
+
+    template<typename R>
+    static void runJob(const boost::shared_ptr<Job<R> >& job, Thread& thread);
+    template<typename R>
+    static void resumeJob(const boost::shared_ptr<Job<R> >& job);
+
+private:
+    string name_;
+    int threadCount_;
+    int maxInFlight_;
+    ThreadPool threadPool_;
+    StatPtr stat_;
 };
 
+//-----------------------------------------------------------------------------
+// 描述: 提交一个阻塞任务
+// 参数:
+//   eventLoop    - 执行 continuation 的事件循环 (通常为当前所在的事件循环)
+//   work         - 在线程池中执行的阻塞操作
+//   continuation - 在 eventLoop 中以执行结果调用的后续处理
+//   cancelCheck  - 取消条件，在执行 work 前 (线程池线程中) 及调用 continuation 前
+//                  (事件循环线程中) 各检查一次，为空表示不取消
+// 返回:
+//   false - 池内任务数已达上限或池未启动，任务未被接受
+// 备注: 线程安全
+//-----------------------------------------------------------------------------
+template<typename R>
+bool OffloadPool::submit(EventLoop *eventLoop,
+    const boost::function<R ()>& work,
+    const boost::function<void (OffloadResult<R>&)>& continuation,
+    const CancelCheck& cancelCheck)
+{
+    if (!eventLoop)
+        iseThrowException(SEM_EVENT_LOOP_NOT_SPECIFIED);
+
+    if (!acquireSlot()) return false;
+
+    boost::shared_ptr<Job<R> > job(new Job<R>());
+    job->work = work;
+    job->continuation = continuation;
+    job->cancelCheck = cancelCheck;
+    job->eventLoop = eventLoop;
+    job->stat = stat_;
+    job->submitMicroTicks = getCurMicroTicks();
+
+    threadPool_.addTask(boost::bind(&OffloadPool::runJob<R>, job, _1));
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 为连接提交一个阻塞任务，continuation 在连接所属的事件循环中调用
+// 备注: 须在连接所属的事件循环线程中调用 (如 IseBusiness 的各回调中)。连接断开时任务被取消。
+//-----------------------------------------------------------------------------
+template<typename R>
+bool OffloadPool::submit(const TcpConnectionPtr& connection,
+    const boost::function<R ()>& work,
+    const boost::function<void (OffloadResult<R>&)>& continuation)
+{
+    return submit<R>(connection->getEventLoop(), work, continuation,
+        boost::bind(&OffloadPool::isConnectionClosed, boost::weak_ptr<TcpConnection>(connection)));
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 在线程池线程中执行任务，并将结果委托给发起的事件循环
+//-----------------------------------------------------------------------------
+template<typename R>
+void OffloadPool::runJob(const boost::shared_ptr<Job<R> >& job, Thread& thread)
+{
+    Job<R>& j = *job;
+
+    j.result.queueWaitMicroSecs = (INT64)(getCurMicroTicks() - j.submitMicroTicks);
+    j.stat->queueWaitMicroSecs.getAndAdd(j.result.queueWaitMicroSecs);
+    j.stat->startCount.increment();
+
+    if (!isCanceled(j.cancelCheck, *j.stat))
+    {
+        runWork(boost::bind(&OffloadInvoker<R>::invoke, boost::cref(j.work), boost::ref(j.result)),
+            j.result, *j.stat);
+        j.stat->inFlightCount.decrement();
+        j.eventLoop->delegateToLoop(boost::bind(&OffloadPool::resumeJob<R>, job));
+    }
+    else
+        j.stat->inFlightCount.decrement();
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 在发起的事件循环线程中以执行结果调用 continuation
+//-----------------------------------------------------------------------------
+template<typename R>
+void OffloadPool::resumeJob(const boost::shared_ptr<Job<R> >& job)
+{
+    Job<R>& j = *job;
+
+    if (isCanceled(j.cancelCheck, *j.stat)) return;
+
+    if (j.result.isOk)
+        j.stat->completeCount.increment();
+    else
+        j.stat->failCount.increment();
+
+    if (j.continuation)
+        j.continuation(j.result);
+}
+
 ///////////////////////////////////////////////////////////////////////////////
+// class OffloadPoolList - 由 IseOptions 配置的卸载池列表
+
+class OffloadPoolList : boost::noncopyable
+{
+public:
+    OffloadPoolList();
+    ~OffloadPoolList();
+
+    void start();
+    void stop();
+
+    int getCount() const { return (int)items_.size(); }
+    OffloadPool& getItem(int index) { return *items_[index]; }
+    OffloadPool* find(const string& name);
+
+private:
+    std::vector<OffloadPool*> items_;
+};
+
 
 #ifdef ISE_WINDOWS
 
@@ -481,6 +1548,7 @@ protected:
     virtual void eventLoopChanged();
     virtual void postSendTask(const void *buffer, int size, const Context& context, int timeout);
     virtual void postRecvTask(const PacketSplitter& packetSplitter, const Context& context, int timeout);
+    virtual void postContinuousRecv(const PacketSplitter& packetSplitter, bool batchMode, const Context& context);
 
 private:
     void init();
@@ -497,7 +1565,7 @@ private:
 private:
     bool isSending_;       // 是否已向IOCP提交发送任务但尚未收到回调通知
     bool isRecving_;       // 是否已向IOCP提交接收任务但尚未收到回调通知
-    int bytesSent_;        // 自从上次发送任务完成回调以来共发送了多少字节
+    INT64 bytesSent_;      // 自从上次发送任务完成回调以来共发送了多少字节
     int bytesRecved_;      // 自从上次接收任务完成回调以来共接收了多少字节
 };
 
@@ -507,11 +1575,26 @@ private:
 class WinTcpEventLoop : public TcpEventLoop
 {
 public:
+    enum { CONNECT_CHECK_INTERVAL = 10 };  // 检查非阻塞连接是否完成的间隔 (毫秒)
+
+public:
+    WinTcpEventLoop();
+
     IocpObject* getIocpObject() { return iocpObject_; }
 
 protected:
     virtual void registerConnection(TcpConnection *connection);
     virtual void unregisterConnection(TcpConnection *connection);
+    virtual void watchConnect(BaseTcpConnection *connection);
+    virtual bool unwatchConnect(BaseTcpConnection *connection);
+
+private:
+    void checkConnectWatches();
+
+private:
+    typedef std::set<BaseTcpConnection*> ConnectionSet;
+    ConnectionSet connectWatches_;         // 正在等待连接完成的连接
+    TimerId connectCheckTimerId_;          // 定时检查 connectWatches_ 的定时器 (0 表示无)
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -528,6 +1611,26 @@ protected:
 
 class LinuxTcpConnection : public TcpConnection
 {
+public:
+    // 待发送数据块
+    struct SendChunk
+    {
+    public:
+        SharedBuffer buffer;         // 为空表示数据位于 sendBuffer_ 中 (复制进来的数据)
+        int offset;                  // 未发送数据在 buffer 中的起始位置
+        int bytes;                   // 未发送的字节数
+        HANDLE fileHandle;           // 不为 INVALID_HANDLE_VALUE 表示数据位于文件中 (sendFile)
+        INT64 fileOffset;            // 未发送数据在文件中的起始位置
+    public:
+        SendChunk() : offset(0), bytes(0), fileHandle(INVALID_HANDLE_VALUE), fileOffset(0) {}
+        bool isFile() const { return fileHandle != INVALID_HANDLE_VALUE; }
+    };
+
+    // 每个文件数据块的最大字节数 (大文件拆分为多个数据块)
+    enum { MAX_FILE_CHUNK_SIZE = 1024*1024*256 };
+
+    typedef std::deque<SendChunk> SendChunkList;
+
 public:
     LinuxTcpConnection();
     LinuxTcpConnection(TcpServer *tcpServer, SOCKET socketHandle);
@@ -535,7 +1638,19 @@ public:
 protected:
     virtual void eventLoopChanged();
     virtual void postSendTask(const void *buffer, int size, const Context& context, int timeout);
+    virtual void postSendTask(const SharedBuffer& buffer, const Context& context, int timeout);
+    virtual void postSendFileTask(HANDLE fileHandle, INT64 offset, INT64 length, const Context& context, int timeout);
     virtual void postRecvTask(const PacketSplitter& packetSplitter, const Context& context, int timeout);
+    virtual void postContinuousRecv(const PacketSplitter& packetSplitter, bool batchMode, const Context& context);
+
+protected:
+    // 以下与 UringTcpConnection 共用
+    INT64 retrieveSentChunks(INT64 bytes);
+    void invokeSendCompleteCallbacks();
+
+    bool tryRetrievePacket();
+    void retrievePackets();
+    static void afterPostRecvTask(const TcpConnectionPtr& thisObj);
 
 private:
     void init();
@@ -547,14 +1662,22 @@ private:
 
     void trySend();
     void tryRecv();
+    void afterAppendSendData(INT64 size, const Context& context, int timeout);
+    INT64 doSend();
+    int flushBatchedSends();
 
-    bool tryRetrievePacket();
-    static void afterPostRecvTask(const TcpConnectionPtr& thisObj);
+    static void afterPostSendTask(const TcpConnectionPtr& thisObj);
+
+protected:
+    SendChunkList sendChunks_;       // 待发送数据链 (按发送顺序)
+    INT64 bytesSent_;                // 自从上次发送任务完成回调以来共发送了多少字节
 
 private:
-    int bytesSent_;                  // 自从上次发送任务完成回调以来共发送了多少字节
     bool enableSend_;                // 是否监视可发送事件
     bool enableRecv_;                // 是否监视可接收事件
+    bool edgeTriggered_;             // 是否采用边沿触发 (EPOLLET) 模式
+    bool sendBatching_;              // 是否合并一轮事件循环内的多次发送
+    int batchedSendCount_;           // 本轮事件循环中已合并的发送次数
 
     friend class LinuxTcpEventLoop;
 };
@@ -568,20 +1691,134 @@ public:
     LinuxTcpEventLoop();
     virtual ~LinuxTcpEventLoop();
 
-    void updateConnection(TcpConnection *connection, bool enableSend, bool enableRecv);
+    void updateConnection(LinuxTcpConnection *connection, bool enableSend, bool enableRecv);
+
+    void addListener(SOCKET handle, const EpollObject::AcceptEventCallback& callback);
+    void removeListener();
+    void suspendListener();
+
+    void addBatchedSend(LinuxTcpConnection *connection);
 
 protected:
     virtual void registerConnection(TcpConnection *connection);
     virtual void unregisterConnection(TcpConnection *connection);
+    virtual void flushBatchedSends();
+    virtual bool hasBatchedSends() const { return !batchedSendConns_.empty(); }
+    virtual void watchConnect(BaseTcpConnection *connection);
+    virtual bool unwatchConnect(BaseTcpConnection *connection);
 
 private:
     void onEpollNotifyEvent(BaseTcpConnection *connection, EpollObject::EVENT_TYPE eventType);
+
+private:
+    typedef std::vector<TcpConnectionPtr> TcpConnectionPtrs;
+    TcpConnectionPtrs batchedSendConns_;    // 本轮循环中有待发数据的连接 (合并发送模式)
 };
 
 ///////////////////////////////////////////////////////////////////////////////
 
 #endif  /* ifdef ISE_LINUX */
 
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+#ifdef ISE_IO_URING
+
+///////////////////////////////////////////////////////////////////////////////
+// class UringTcpConnection - 基于 io_uring 的TCP连接
+//
+// 说明:
+// 1. 与 WinTcpConnection 相同，收发均以 "提交操作、等待完成" 的方式进行:
+//    接收为一个持续有效的多发接收操作，发送为 sendmsg 聚集发送操作。
+// 2. 发送操作进行期间，其引用的数据不可移动，此间提交的数据暂存于 pendingChunks_
+//    和 pendingBuffer_ 中，待 sendChunks_ 发送完毕后再换入。
+// 3. 待发送数据链、数据包的分离等与 LinuxTcpConnection 共用。
+
+class UringTcpConnection : public LinuxTcpConnection
+{
+public:
+    enum { MAX_IOV_COUNT = 64 };     // 每个发送操作最多聚集的数据块数
+
+public:
+    UringTcpConnection();
+    UringTcpConnection(TcpServer *tcpServer, SOCKET socketHandle);
+
+protected:
+    virtual void eventLoopChanged();
+    virtual void postSendTask(const void *buffer, int size, const Context& context, int timeout);
+    virtual void postSendTask(const SharedBuffer& buffer, const Context& context, int timeout);
+    virtual void postSendFileTask(HANDLE fileHandle, INT64 offset, INT64 length, const Context& context, int timeout);
+    virtual void postRecvTask(const PacketSplitter& packetSplitter, const Context& context, int timeout);
+    virtual void postContinuousRecv(const PacketSplitter& packetSplitter, bool batchMode, const Context& context);
+
+private:
+    void init();
+
+    UringTcpEventLoop* getEventLoop() { return (UringTcpEventLoop*)eventLoop_; }
+    SendChunkList& getAppendChunks() { return isSending_ ? pendingChunks_ : sendChunks_; }
+
+    void appendSendTask(INT64 size, const Context& context, int timeout);
+    int flushScheduledSend();
+    int submitSend();
+    void startRecv();
+    bool isRecvBufferFull() const;
+
+    void onSendComplete(const IoUringObject::CompleteEvent& event);
+    void onRecvComplete(const IoUringObject::CompleteEvent& event);
+
+private:
+    SendChunkList pendingChunks_;    // 发送操作进行期间提交的数据块
+    IoBuffer pendingBuffer_;         // pendingChunks_ 中复制进来的数据
+    struct msghdr sendMsg_;          // 进行中的发送操作的消息头
+    struct iovec sendVec_[MAX_IOV_COUNT];
+    bool isSending_;                 // 是否有进行中的发送操作 (sendmsg 或等待可发送)
+    bool isSendScheduled_;           // 是否已登记到本轮循环的末尾提交发送
+    bool isRecving_;                 // 多发接收操作是否仍然有效
+    bool isRecvCancelling_;          // 是否已请求取消多发接收 (接收缓存已满)
+    int pendingOps_;                 // 进行中的操作数
+    TcpConnectionPtr closingRef_;    // 注销时仍有进行中的操作，则持有自身直至操作全部结束
+
+    friend class UringTcpEventLoop;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// class UringTcpEventLoop
+
+class UringTcpEventLoop : public TcpEventLoop
+{
+public:
+    UringTcpEventLoop();
+    virtual ~UringTcpEventLoop();
+
+    IoUringObject* getIoUringObject() { return ioUringObject_; }
+
+    void addListener(SOCKET handle, const IoUringObject::AcceptEventCallback& callback);
+    void removeListener();
+
+    void addScheduledSend(UringTcpConnection *connection);
+
+protected:
+    virtual void registerConnection(TcpConnection *connection);
+    virtual void unregisterConnection(TcpConnection *connection);
+    virtual void flushBatchedSends();
+    virtual bool hasBatchedSends() const { return !scheduledSendConns_.empty(); }
+    virtual bool hasPendingIo() const { return closingConnCount_ > 0; }
+    virtual void watchConnect(BaseTcpConnection *connection);
+    virtual bool unwatchConnect(BaseTcpConnection *connection);
+
+private:
+    void onIoUringCompleteEvent(BaseTcpConnection *connection, const IoUringObject::CompleteEvent& event);
+
+private:
+    typedef std::vector<TcpConnectionPtr> TcpConnectionPtrs;
+    TcpConnectionPtrs scheduledSendConns_;  // 本轮循环中有待发数据的连接
+    int closingConnCount_;                  // 已注销但仍有进行中操作的连接数
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+#endif  /* ifdef ISE_IO_URING */
+
 ///////////////////////////////////////////////////////////////////////////////
 // class MainTcpServer - TCP主服务器类
 
@@ -595,7 +1832,9 @@ public:
     void close();
 
     TcpServer& getTcpServer(int index);
+    int getTcpServerCount() const { return (int)tcpServerList_.size(); }
     TcpEventLoopList& getTcpClientEventLoopList();
+    bool isTcpClientEventLoopListCreated() const { return tcpClientEventLoopList_.get() != NULL; }
     EventLoop* findEventLoop(THREAD_ID loopThreadId);
 
 private:
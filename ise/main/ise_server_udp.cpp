@@ -396,6 +396,8 @@ void UdpWorkerThreadPool::createThreads(int count)
     {
         UdpWorkerThread *thread;
         thread = new UdpWorkerThread(this);
+        thread->setName(formatString("ise-udp%d-wk", ownGroup_->getGroupIndex()));
+        thread->setCpuAffinity(iseApp().iseOptions().getUdpGroupCpuAffinity(ownGroup_->getGroupIndex()));
         thread->run();
     }
 }
@@ -500,6 +500,21 @@ void Socket::setBlockMode(bool value)
     isBlockMode_ = value;
 }
 
+//-----------------------------------------------------------------------------
+// 描述: 设置 SO_REUSEPORT 选项 (须在 bind 之前设置)
+// 备注:
+//   多个设置了此选项的套接字可绑定同一端口，由内核在它们之间分配新连接。
+//   不支持此选项的平台下本函数不做任何事。
+//-----------------------------------------------------------------------------
+void Socket::setReusePort(bool value)
+{
+#ifdef SO_REUSEPORT
+    int optVal = (value ? 1 : 0);
+    if (setsockopt(handle_, SOL_SOCKET, SO_REUSEPORT, (char*)&optVal, sizeof(optVal)) < 0)
+        iseThrowSocketLastError();
+#endif
+}
+
 //-----------------------------------------------------------------------------
 
 void Socket::setHandle(SOCKET value)
@@ -890,6 +905,20 @@ void BaseTcpConnection::setKeepAlive(bool value)
         (char*)&optVal, sizeof(optVal));
 }
 
+//-----------------------------------------------------------------------------
+// 描述: 设置 SO_BUSY_POLL (微秒)，接收队列为空时内核在驱动层忙等新数据 (仅Linux)
+// 返回: 是否设置成功
+//-----------------------------------------------------------------------------
+bool BaseTcpConnection::setBusyPoll(int microSecs)
+{
+#ifdef SO_BUSY_POLL
+    return (::setsockopt(getSocket().getHandle(), SOL_SOCKET, SO_BUSY_POLL,
+        (char*)&microSecs, sizeof(microSecs)) == 0);
+#else
+    return false;
+#endif
+}
+
 //-----------------------------------------------------------------------------
 // 描述: 取得此连接的本地地址
 //-----------------------------------------------------------------------------
@@ -1417,6 +1446,7 @@ TcpSocket& BaseTcpClient::getSocket()
 
 BaseTcpServer::BaseTcpServer() :
     localPort_(0),
+    reusePort_(false),
     listenerThread_(NULL)
 {
     // nothing
@@ -1438,10 +1468,7 @@ void BaseTcpServer::open()
     {
         if (!isActive())
         {
-            socket_.open();
-            socket_.bind(localPort_);
-            if (listen(socket_.getHandle(), LISTEN_QUEUE_SIZE) < 0)
-                iseThrowSocketLastError();
+            openListenSocket(socket_);
             startListenerThread();
         }
     }
@@ -1488,6 +1515,35 @@ void BaseTcpServer::setLocalPort(WORD value)
     }
 }
 
+//-----------------------------------------------------------------------------
+// 描述: 设置监听套接字是否启用 SO_REUSEPORT (须在开启服务器之前设置)
+//-----------------------------------------------------------------------------
+void BaseTcpServer::setReusePort(bool value)
+{
+    if (value != reusePort_)
+    {
+        if (isActive()) close();
+        reusePort_ = value;
+    }
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 打开监听套接字并开始监听 localPort_
+//-----------------------------------------------------------------------------
+void BaseTcpServer::openListenSocket(TcpSocket& socket)
+{
+    socket.open();
+    if (reusePort_)
+    {
+        // 启用 SO_REUSEPORT 时由事件循环以非阻塞方式接受连接
+        socket.setReusePort(true);
+        socket.setBlockMode(false);
+    }
+    socket.bind(localPort_);
+    if (listen(socket.getHandle(), LISTEN_QUEUE_SIZE) < 0)
+        iseThrowSocketLastError();
+}
+
 //-----------------------------------------------------------------------------
 // 描述: 设置“创建新连接”的回调
 //-----------------------------------------------------------------------------
@@ -1512,6 +1568,7 @@ void BaseTcpServer::startListenerThread()
     if (!listenerThread_)
     {
         listenerThread_ = new TcpListenerThread(this);
+        listenerThread_->setName(formatString("ise-lsn-%d", localPort_));
         listenerThread_->run();
     }
 }
@@ -1664,6 +1721,7 @@ void UdpListenerThreadPool::startThreads()
     {
         UdpListenerThread *thread;
         thread = new UdpListenerThread(this, i);
+        thread->setName(formatString("ise-udplsn-%d", i));
         thread->run();
     }
 }
@@ -344,6 +344,7 @@ public:
     InetAddress getPeerAddr() const;
     bool isBlockMode() const { return isBlockMode_; }
     void setBlockMode(bool value);
+    void setReusePort(bool value);
     void setHandle(SOCKET value);
 
 protected:
@@ -471,6 +472,7 @@ public:
 
     void setNoDelay(bool value);
     void setKeepAlive(bool value);
+    bool setBusyPoll(int microSecs);
 
     TcpSocket& getSocket() { return socket_; }
     const TcpSocket& getSocket() const { return socket_; }
@@ -496,6 +498,8 @@ private:
     bool isDisconnected_;
     mutable InetAddress localAddr_;
     mutable InetAddress peerAddr_;
+
+    friend class TcpConnector;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -558,12 +562,17 @@ public:
     WORD getLocalPort() const { return localPort_; }
     void setLocalPort(WORD value);
 
+    bool isReusePort() const { return reusePort_; }
+    void setReusePort(bool value);
+
     const TcpSocket& getSocket() const { return socket_; }
 
     void setCreateConnCallback(const TcpSvrCreateConnCallback& callback);
     void setAcceptConnCallback(const TcpSvrAcceptConnCallback& callback);
 
 protected:
+    void openListenSocket(TcpSocket& socket);
+
     virtual void startListenerThread();
     virtual void stopListenerThread();
 
@@ -573,6 +582,7 @@ protected:
 private:
     TcpSocket socket_;
     WORD localPort_;
+    bool reusePort_;
     TcpListenerThread *listenerThread_;
     TcpSvrCreateConnCallback onCreateConn_;
     TcpSvrAcceptConnCallback onAcceptConn_;
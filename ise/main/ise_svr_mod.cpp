@@ -38,6 +38,16 @@ void IseServerModule::broadcastMessage(BaseSvrModMessage& message)
     (static_cast<IseSvrModBusiness*>(&iseApp().iseBusiness()))->broadcastMessage(message);
 }
 
+//-----------------------------------------------------------------------------
+// 描述: TCP连接在连续接收模式下收到了一批数据包
+//-----------------------------------------------------------------------------
+void IseServerModule::onTcpRecvBatch(const TcpConnectionPtr& connection,
+    const RecvPacket *packets, int count, const Context& context)
+{
+    for (int i = 0; i < count; ++i)
+        onTcpRecvComplete(connection, packets[i].buffer, packets[i].size, context);
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 // classs IseServerModuleMgr
 
@@ -180,6 +190,20 @@ void IseSvrModBusiness::onTcpRecvComplete(const TcpConnectionPtr& connection, vo
     }
 }
 
+//-----------------------------------------------------------------------------
+// 描述: TCP连接在连续接收模式下收到了一批数据包
+//-----------------------------------------------------------------------------
+void IseSvrModBusiness::onTcpRecvBatch(const TcpConnectionPtr& connection,
+    const RecvPacket *packets, int count, const Context& context)
+{
+    TcpServerIndexMap::iterator iter = tcpServerIndexMap_.find(connection->getServerIndex());
+    if (iter != tcpServerIndexMap_.end())
+    {
+        int modIndex = iter->second;
+        serverModuleMgr_.getItem(modIndex).onTcpRecvBatch(connection, packets, count, context);
+    }
+}
+
 //-----------------------------------------------------------------------------
 // 描述: TCP连接上的一个发送任务已完成
 //-----------------------------------------------------------------------------
@@ -193,6 +217,32 @@ void IseSvrModBusiness::onTcpSendComplete(const TcpConnectionPtr& connection, co
     }
 }
 
+//-----------------------------------------------------------------------------
+// 描述: TCP连接的待发送数据达到了高水位
+//-----------------------------------------------------------------------------
+void IseSvrModBusiness::onTcpSendBufferHigh(const TcpConnectionPtr& connection, INT64 queuedBytes)
+{
+    TcpServerIndexMap::iterator iter = tcpServerIndexMap_.find(connection->getServerIndex());
+    if (iter != tcpServerIndexMap_.end())
+    {
+        int modIndex = iter->second;
+        serverModuleMgr_.getItem(modIndex).onTcpSendBufferHigh(connection, queuedBytes);
+    }
+}
+
+//-----------------------------------------------------------------------------
+// 描述: TCP连接的待发送数据从高水位回落到了低水位
+//-----------------------------------------------------------------------------
+void IseSvrModBusiness::onTcpSendBufferDrained(const TcpConnectionPtr& connection)
+{
+    TcpServerIndexMap::iterator iter = tcpServerIndexMap_.find(connection->getServerIndex());
+    if (iter != tcpServerIndexMap_.end())
+    {
+        int modIndex = iter->second;
+        serverModuleMgr_.getItem(modIndex).onTcpSendBufferDrained(connection);
+    }
+}
+
 //-----------------------------------------------------------------------------
 // 描述: 辅助服务线程执行(assistorIndex: 0-based)
 //-----------------------------------------------------------------------------
@@ -384,6 +434,13 @@ void IseSvrModBusiness::updateIseOptions()
             serverModule.getTcpServerOptions(serverIndex, svrOpt);
             options.setTcpServerPort(globalServerIndex, svrOpt.serverPort);
             options.setTcpServerEventLoopCount(globalServerIndex, svrOpt.eventLoopCount);
+            options.setTcpServerEdgeTriggered(globalServerIndex, svrOpt.edgeTriggered);
+            options.setTcpServerReusePort(globalServerIndex, svrOpt.reusePort);
+            options.setTcpServerLoopPlacement(globalServerIndex, svrOpt.loopPlacement);
+            options.setTcpServerSendBufferWatermarks(globalServerIndex,
+                svrOpt.sendBufferLimits.highWatermark, svrOpt.sendBufferLimits.lowWatermark);
+            options.setTcpServerSendBufferHardCap(globalServerIndex,
+                svrOpt.sendBufferLimits.hardCap, svrOpt.sendBufferLimits.overflowPolicy);
             globalServerIndex++;
         }
     }
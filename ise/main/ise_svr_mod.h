@@ -84,8 +84,15 @@ public:
     // TCP连接上的一个接收任务已完成
     virtual void onTcpRecvComplete(const TcpConnectionPtr& connection, void *packetBuffer,
         int packetSize, const Context& context) {}
+    // TCP连接在连续接收模式下收到了一批数据包 (缺省逐个转给 onTcpRecvComplete)
+    virtual void onTcpRecvBatch(const TcpConnectionPtr& connection, const RecvPacket *packets,
+        int count, const Context& context);
     // TCP连接上的一个发送任务已完成
     virtual void onTcpSendComplete(const TcpConnectionPtr& connection, const Context& context) {}
+    // TCP连接的待发送数据达到了高水位
+    virtual void onTcpSendBufferHigh(const TcpConnectionPtr& connection, INT64 queuedBytes) {}
+    // TCP连接的待发送数据从高水位回落到了低水位
+    virtual void onTcpSendBufferDrained(const TcpConnectionPtr& connection) {}
 
     // 返回此模块所需辅助服务线程的数量
     virtual int getAssistorThreadCount() { return 0; }
@@ -148,7 +155,11 @@ public:
     virtual void onTcpDisconnected(const TcpConnectionPtr& connection);
     virtual void onTcpRecvComplete(const TcpConnectionPtr& connection, void *packetBuffer,
         int packetSize, const Context& context);
+    virtual void onTcpRecvBatch(const TcpConnectionPtr& connection, const RecvPacket *packets,
+        int count, const Context& context);
     virtual void onTcpSendComplete(const TcpConnectionPtr& connection, const Context& context);
+    virtual void onTcpSendBufferHigh(const TcpConnectionPtr& connection, INT64 queuedBytes);
+    virtual void onTcpSendBufferDrained(const TcpConnectionPtr& connection);
 
     virtual void assistorThreadExecute(AssistorThread& assistorThread, int assistorIndex);
     virtual void daemonThreadExecute(Thread& thread, int secondCount);
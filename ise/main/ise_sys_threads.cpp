@@ -78,6 +78,7 @@ void SysThreadMgr::initialize()
     Thread *thread;
 
     thread = new SysDaemonThread(*this);
+    thread->setName("ise-daemon");
     threadList_.add(thread);
     thread->run();
 }
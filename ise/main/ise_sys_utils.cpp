@@ -1292,6 +1292,7 @@ void sleepSeconds(double seconds, bool allowInterrupt)
 
 //-----------------------------------------------------------------------------
 // 描述: 取得当前 Ticks，单位:毫秒
+// 备注: 取自单调时钟，不受系统时间调整的影响，只可用于计算时间间隔。
 //-----------------------------------------------------------------------------
 UINT64 getCurTicks()
 {
@@ -1299,9 +1300,9 @@ UINT64 getCurTicks()
     return static_cast<UINT64>(GetTickCount());
 #endif
 #ifdef ISE_LINUX
-    timeval tv;
-    gettimeofday(&tv, NULL);
-    return static_cast<UINT64>(static_cast<UINT64>(tv.tv_sec) * 1000 + tv.tv_usec / 1000);
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<UINT64>(static_cast<UINT64>(ts.tv_sec) * 1000 + ts.tv_nsec / 1000000);
 #endif
 }
 
@@ -1316,6 +1317,117 @@ UINT64 getTickDiff(UINT64 oldTicks, UINT64 newTicks)
         return (UINT64(-1) - oldTicks + newTicks);
 }
 
+//-----------------------------------------------------------------------------
+// 描述: 取得单调时钟的当前值 (微秒)，用于测量短时间间隔
+//-----------------------------------------------------------------------------
+UINT64 getCurMicroTicks()
+{
+#ifdef ISE_WINDOWS
+    LARGE_INTEGER freq, counter;
+    ::QueryPerformanceFrequency(&freq);
+    ::QueryPerformanceCounter(&counter);
+    return static_cast<UINT64>(counter.QuadPart / freq.QuadPart * 1000000 +
+        counter.QuadPart % freq.QuadPart * 1000000 / freq.QuadPart);
+#endif
+#ifdef ISE_LINUX
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<UINT64>(static_cast<UINT64>(ts.tv_sec) * 1000000 + ts.tv_nsec / 1000);
+#endif
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 解析CPU列表字符串 (如 "0-3,8,10-11")，结果按升序排列且不含重复项
+// 返回: 格式不正确时返回 false
+//-----------------------------------------------------------------------------
+bool parseCpuList(const string& str, IntegerArray& cpus)
+{
+    const int MAX_CPU_NUMBER = 4095;
+
+    StrList strList;
+    IntegerSet cpuSet;
+
+    splitString(str, ',', strList, true);
+    for (int i = 0; i < strList.getCount(); ++i)
+    {
+        string item = strList[i];
+        if (item.empty()) continue;
+
+        bool isRange = (item.find('-') != string::npos);
+        string first = trimString(fetchStr(item, '-'));
+        string last = (isRange ? trimString(item) : first);
+        if (!isIntStr(first) || !isIntStr(last)) return false;
+
+        int from = strToInt(first), to = strToInt(last);
+        if (from < 0 || to < from || to > MAX_CPU_NUMBER) return false;
+
+        for (int cpu = from; cpu <= to; ++cpu)
+            cpuSet.insert(cpu);
+    }
+
+    cpus.assign(cpuSet.begin(), cpuSet.end());
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 将CPU列表转换为字符串 (连续的编号合并为区间，如 "0-3,8")
+//-----------------------------------------------------------------------------
+string cpuListToStr(const IntegerArray& cpus)
+{
+    string result;
+    size_t i = 0;
+
+    while (i < cpus.size())
+    {
+        size_t j = i;
+        while (j + 1 < cpus.size() && cpus[j + 1] == cpus[j] + 1)
+            ++j;
+
+        if (!result.empty()) result += ",";
+        if (j > i)
+            result += formatString("%d-%d", cpus[i], cpus[j]);
+        else
+            result += intToStr(cpus[i]);
+
+        i = j + 1;
+    }
+
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 令当前线程此后分配的内存优先位于其运行CPU所在的NUMA节点
+// 备注:
+//   Linux 的缺省策略已是首次访问时在本地节点分配；此函数用于进程被设置了其它策略
+//   (如 numactl --interleave) 时，恢复绑定了CPU的线程的本地分配。非NUMA系统上无影响。
+//-----------------------------------------------------------------------------
+bool setLocalMemoryPolicy()
+{
+#ifdef ISE_WINDOWS
+    return true;
+#endif
+#ifdef ISE_LINUX
+    const int MPOL_LOCAL_POLICY = 4;   // MPOL_LOCAL (linux/mempolicy.h)
+    return (syscall(SYS_set_mempolicy, MPOL_LOCAL_POLICY, NULL, 0) == 0);
+#endif
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 设置当前线程的定时器松弛量 (纳秒)
+// 备注:
+//   Linux 允许内核将线程的定时等待 (epoll_wait、timerfd 等) 推迟至多该时长以合并唤醒，
+//   缺省为 50 微秒。设为 1 可使定时器尽量准时到期。Windows 下不支持，返回 false。
+//-----------------------------------------------------------------------------
+bool setThreadTimerSlack(UINT64 nanoSecs)
+{
+#ifdef ISE_WINDOWS
+    return false;
+#endif
+#ifdef ISE_LINUX
+    return (::prctl(PR_SET_TIMERSLACK, (unsigned long)ise::max(nanoSecs, (UINT64)1), 0, 0, 0) == 0);
+#endif
+}
+
 //-----------------------------------------------------------------------------
 // 描述: 随机化 "随机数种子"
 //-----------------------------------------------------------------------------
@@ -58,6 +58,7 @@
 #include <sys/time.h>
 #include <sys/types.h>
 #include <sys/syscall.h>
+#include <sys/prctl.h>
 #include <sys/stat.h>
 #include <iostream>
 #include <string>
@@ -159,6 +160,11 @@ string sysErrorMessage(int errorCode);
 void sleepSeconds(double seconds, bool allowInterrupt = true);
 UINT64 getCurTicks();
 UINT64 getTickDiff(UINT64 oldTicks, UINT64 newTicks);
+UINT64 getCurMicroTicks();
+bool parseCpuList(const string& str, IntegerArray& cpus);
+string cpuListToStr(const IntegerArray& cpus);
+bool setLocalMemoryPolicy();
+bool setThreadTimerSlack(UINT64 nanoSecs);
 
 //-----------------------------------------------------------------------------
 //-- 其它函数:
@@ -257,6 +257,9 @@ void WinThreadImpl::run()
     // 设置线程优先级
     if (priority_ != THREAD_PRI_NORMAL)
         setPriority(priority_);
+    // 设置CPU亲和性
+    if (!cpuAffinity_.empty())
+        applyCpuAffinity();
 
     ::ResumeThread(handle_);
 }
@@ -329,6 +332,24 @@ void WinThreadImpl::setPriority(int value)
         SetThreadPriority(handle_, priorities[value]);
 }
 
+//-----------------------------------------------------------------------------
+// 描述: 设置线程名称 (Windows下仅作记录)
+//-----------------------------------------------------------------------------
+void WinThreadImpl::setName(const string& value)
+{
+    name_ = value;
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 设置线程的CPU亲和性
+//-----------------------------------------------------------------------------
+void WinThreadImpl::setCpuAffinity(const IntegerArray& value)
+{
+    cpuAffinity_ = value;
+    if (threadId_ != 0)
+        applyCpuAffinity();
+}
+
 //-----------------------------------------------------------------------------
 // 描述: 线程错误处理
 //-----------------------------------------------------------------------------
@@ -342,6 +363,31 @@ void WinThreadImpl::checkThreadError(bool success)
     }
 }
 
+//-----------------------------------------------------------------------------
+// 描述: 将 cpuAffinity_ 应用到线程上 (为空表示可在全部CPU上运行)
+//-----------------------------------------------------------------------------
+void WinThreadImpl::applyCpuAffinity()
+{
+    DWORD_PTR mask = 0;
+    for (size_t i = 0; i < cpuAffinity_.size(); ++i)
+    {
+        if (cpuAffinity_[i] >= 0 && cpuAffinity_[i] < (int)(sizeof(DWORD_PTR) * 8))
+            mask |= ((DWORD_PTR)1 << cpuAffinity_[i]);
+    }
+
+    if (mask == 0)
+    {
+        DWORD_PTR systemMask = 0;
+        ::GetProcessAffinityMask(::GetCurrentProcess(), &mask, &systemMask);
+    }
+
+    if (::SetThreadAffinityMask(handle_, mask) == 0)
+    {
+        logger().writeFmt(SEM_THREAD_AFFINITY_ERROR, name_.c_str(),
+            cpuListToStr(cpuAffinity_).c_str(), ::GetLastError());
+    }
+}
+
 #endif
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -478,6 +524,11 @@ void LinuxThreadImpl::run()
     // 设置线程优先级
     if (priority_ != THREAD_PRI_DEFAULT)
         setPriority(priority_);
+    // 设置线程名称及CPU亲和性 (须在线程函数开始运行前完成，线程此后分配的内存即位于所绑定CPU的本地节点)
+    if (!name_.empty())
+        applyName();
+    if (!cpuAffinity_.empty())
+        applyCpuAffinity();
 
     // 线程对象已准备就绪，线程函数可以开始运行
     execSem_->increase();
@@ -583,6 +634,26 @@ void LinuxThreadImpl::setPriority(int value)
     }
 }
 
+//-----------------------------------------------------------------------------
+// 描述: 设置线程名称 (超出15个字符的部分被截去)
+//-----------------------------------------------------------------------------
+void LinuxThreadImpl::setName(const string& value)
+{
+    name_ = value;
+    if (pthreadId_ != 0)
+        applyName();
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 设置线程的CPU亲和性
+//-----------------------------------------------------------------------------
+void LinuxThreadImpl::setCpuAffinity(const IntegerArray& value)
+{
+    cpuAffinity_ = value;
+    if (pthreadId_ != 0)
+        applyCpuAffinity();
+}
+
 //-----------------------------------------------------------------------------
 // 描述: 线程错误处理
 //-----------------------------------------------------------------------------
@@ -596,6 +667,43 @@ void LinuxThreadImpl::checkThreadError(int errorCode)
     }
 }
 
+//-----------------------------------------------------------------------------
+// 描述: 将 name_ 应用到线程上
+//-----------------------------------------------------------------------------
+void LinuxThreadImpl::applyName()
+{
+    const size_t MAX_NAME_LEN = 15;   // 不含结尾的 '\0'
+    pthread_setname_np(pthreadId_, name_.substr(0, MAX_NAME_LEN).c_str());
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 将 cpuAffinity_ 应用到线程上 (为空表示可在全部CPU上运行)
+//-----------------------------------------------------------------------------
+void LinuxThreadImpl::applyCpuAffinity()
+{
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+
+    for (size_t i = 0; i < cpuAffinity_.size(); ++i)
+    {
+        if (cpuAffinity_[i] >= 0 && cpuAffinity_[i] < CPU_SETSIZE)
+            CPU_SET(cpuAffinity_[i], &cpuSet);
+    }
+
+    if (CPU_COUNT(&cpuSet) == 0)
+    {
+        for (int i = 0; i < CPU_SETSIZE; ++i)
+            CPU_SET(i, &cpuSet);
+    }
+
+    int errorCode = pthread_setaffinity_np(pthreadId_, sizeof(cpuSet), &cpuSet);
+    if (errorCode != 0)
+    {
+        logger().writeFmt(SEM_THREAD_AFFINITY_ERROR, name_.c_str(),
+            cpuListToStr(cpuAffinity_).c_str(), errorCode);
+    }
+}
+
 #endif
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -719,6 +827,28 @@ void ThreadList::waitForAllThreads(int maxWaitSecs, int *killedCount)
 ///////////////////////////////////////////////////////////////////////////////
 // class ThreadPool
 
+// 当前线程所属的工作线程 (ThreadPool::Worker*)，非工作线程为 NULL
+static ISE_THREAD_LOCAL void *t_currentWorker = NULL;
+
+//-----------------------------------------------------------------------------
+// 描述: 自旋等待时让出CPU流水线 (超线程时让给同核的另一个线程)
+//-----------------------------------------------------------------------------
+static inline void cpuRelax()
+{
+#ifdef ISE_WINDOWS
+    YieldProcessor();
+#endif
+#ifdef ISE_LINUX
+#if defined(__i386__) || defined(__x86_64__)
+    __asm__ __volatile__("pause" ::: "memory");
+#else
+    __sync_synchronize();
+#endif
+#endif
+}
+
+//-----------------------------------------------------------------------------
+
 ThreadPool::ThreadPool() :
     condition_(mutex_),
     isRunning_(false),
@@ -730,6 +860,17 @@ ThreadPool::ThreadPool() :
 ThreadPool::~ThreadPool()
 {
     stop();
+
+    for (int i = 0; i < INJECT_SHARD_COUNT; ++i)
+    {
+        MpscQueue::Node *node = injectShards_[i].queue.popAll();
+        while (node != NULL)
+        {
+            MpscQueue::Node *next = node->next;
+            delete static_cast<TaskNode*>(node);
+            node = next;
+        }
+    }
 }
 
 //-----------------------------------------------------------------------------
@@ -741,88 +882,318 @@ void ThreadPool::start(int threadCount)
 
     AutoLocker locker(mutex_);
 
+    for (int i = 0; i < threadCount; ++i)
+    {
+        Worker *worker = new Worker();
+        worker->pool = this;
+        worker->index = i;
+        worker->randSeed = (UINT)i * 2654435761U + 1;
+        workers_.push_back(worker);
+    }
+
     isRunning_ = true;
     for (int i = 0; i < threadCount; ++i)
-        threadList_.add(Thread::create(boost::bind(&ThreadPool::threadProc, this, _1)));
+    {
+        WorkerThread *thread = new WorkerThread(this, workers_[i]);
+        thread->run();
+    }
 }
 
 //-----------------------------------------------------------------------------
-
+// 描述: 停止线程池
+// 备注: 尚未执行的任务保留在注入队列中，再次 start() 后继续执行。
+//-----------------------------------------------------------------------------
 void ThreadPool::stop(int maxWaitSecs)
 {
-    AutoLocker locker(mutex_);
-
-    if (isRunning_)
     {
+        AutoLocker locker(mutex_);
+        if (!isRunning_) return;
         isRunning_ = false;
         condition_.notifyAll();
-
-        threadList_.terminateAllThreads();
-        threadList_.waitForAllThreads(maxWaitSecs);
     }
+
+    // 不可持锁等待，休眠中的工作线程被唤醒后须先取得锁才能退出
+    threadList_.terminateAllThreads();
+    threadList_.waitForAllThreads(maxWaitSecs);
+
+    clearWorkers();
 }
 
 //-----------------------------------------------------------------------------
-
+// 描述: 添加任务 (线程安全)
+// 备注: 在本线程池的工作线程中调用时，任务压入该线程自己的队列。
+//-----------------------------------------------------------------------------
 void ThreadPool::addTask(const Task& task)
 {
-    AutoLocker locker(mutex_);
-    tasks_.push_back(task);
-    condition_.notify();
+    TaskNode *node = new TaskNode(task);
+
+    Worker *worker = static_cast<Worker*>(t_currentWorker);
+    if (worker != NULL && worker->pool == this)
+    {
+        worker->deque.push(node);
+        if (parkedCount_.get() > 0)
+            wakeWorkers(1);
+    }
+    else
+        injectTasks(node, node, 1);
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 一次添加一批任务 (线程安全)
+// 备注: 整批任务只需一次原子操作放入注入队列，按需唤醒休眠的工作线程。
+//-----------------------------------------------------------------------------
+void ThreadPool::addTasks(const TaskList& tasks)
+{
+    if (tasks.empty()) return;
+
+    // 链表以 next 相连，从最后一个任务 (最后压入者) 指向第一个任务
+    TaskNode *oldest = new TaskNode(tasks[0]);
+    TaskNode *newest = oldest;
+    for (size_t i = 1; i < tasks.size(); ++i)
+    {
+        TaskNode *node = new TaskNode(tasks[i]);
+        node->next = newest;
+        newest = node;
+    }
+
+    injectTasks(newest, oldest, (int)tasks.size());
 }
 
 //-----------------------------------------------------------------------------
 
 void ThreadPool::setTaskRepeat(bool repeat)
 {
-    AutoLocker locker(mutex_);
     repeat_ = repeat;
 }
 
 //-----------------------------------------------------------------------------
+// 描述: 将一串任务放入注入队列 (按当前线程选择分片)，并唤醒所需的休眠线程
+//-----------------------------------------------------------------------------
+void ThreadPool::injectTasks(TaskNode *newest, TaskNode *oldest, int count)
+{
+    int shard = (int)((UINT)getCurThreadId() % INJECT_SHARD_COUNT);
+    injectShards_[shard].queue.pushChain(newest, oldest);
 
-bool ThreadPool::takeTask(Task& task)
+    // 压入 (原子操作，兼作内存屏障) 之后再读休眠线程数，与 parkWorker() 中的顺序相对
+    int parkedCount = parkedCount_.get();
+    if (parkedCount > 0)
+        wakeWorkers(ise::min(count, parkedCount));
+}
+
+//-----------------------------------------------------------------------------
+
+void ThreadPool::wakeWorkers(int count)
 {
     AutoLocker locker(mutex_);
 
-    while (tasks_.empty() && isRunning_)
-        condition_.wait();
+    if (count >= (int)workers_.size())
+        condition_.notifyAll();
+    else
+    {
+        for (int i = 0; i < count; ++i)
+            condition_.notify();
+    }
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 为工作线程查找一个任务 (找不到返回 NULL)
+//-----------------------------------------------------------------------------
+ThreadPool::TaskNode* ThreadPool::findTask(Worker& worker)
+{
+    TaskNode *node = static_cast<TaskNode*>(worker.deque.pop());
+    if (node == NULL)
+        node = takeInjectedTasks(worker);
+    if (node == NULL)
+        node = stealTask(worker);
+    return node;
+}
 
-    if (!tasks_.empty())
+//-----------------------------------------------------------------------------
+// 描述: 从注入队列中整批取走任务
+// 返回: 最早的一个任务，其余的放入工作线程自己的队列 (供其它线程窃取)
+//-----------------------------------------------------------------------------
+ThreadPool::TaskNode* ThreadPool::takeInjectedTasks(Worker& worker)
+{
+    for (int i = 0; i < INJECT_SHARD_COUNT; ++i)
     {
-        task = tasks_.front();
-        tasks_.pop_front();
-        if (repeat_)
+        MpscQueue& queue = injectShards_[(worker.index + i) % INJECT_SHARD_COUNT].queue;
+        if (queue.isEmpty()) continue;
+
+        MpscQueue::Node *first = queue.popAll();
+        if (first == NULL) continue;
+
+        // 其余任务逆序压入，使自己按添加的先后顺序从底部弹出
+        MpscQueue::Node *reversed = NULL;
+        int count = 0;
+        for (MpscQueue::Node *node = first->next; node != NULL; ++count)
         {
-            tasks_.push_back(task);
-            condition_.notify();
+            MpscQueue::Node *next = node->next;
+            node->next = reversed;
+            reversed = node;
+            node = next;
         }
+        for (MpscQueue::Node *node = reversed; node != NULL; node = node->next)
+            worker.deque.push(node);
+
+        if (count > 0 && parkedCount_.get() > 0)
+            wakeWorkers(1);
 
-        return true;
+        first->next = NULL;
+        return static_cast<TaskNode*>(first);
     }
-    else
-        return false;
+
+    return NULL;
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 从其它工作线程的队列中窃取一个任务 (从随机位置开始依次尝试)
+//-----------------------------------------------------------------------------
+ThreadPool::TaskNode* ThreadPool::stealTask(Worker& worker)
+{
+    int count = (int)workers_.size();
+    if (count <= 1) return NULL;
+
+    worker.randSeed = worker.randSeed * 1103515245 + 12345;
+    int start = (int)((worker.randSeed >> 16) % (UINT)count);
+
+    for (int i = 0; i < count; ++i)
+    {
+        Worker *victim = workers_[(start + i) % count];
+        if (victim == &worker) continue;
+
+        TaskNode *node = static_cast<TaskNode*>(victim->deque.steal());
+        if (node != NULL)
+        {
+            stealCount_.increment();
+            return node;
+        }
+    }
+
+    return NULL;
+}
+
+//-----------------------------------------------------------------------------
+
+bool ThreadPool::hasPendingTasks()
+{
+    for (int i = 0; i < INJECT_SHARD_COUNT; ++i)
+        if (!injectShards_[i].queue.isEmpty()) return true;
+
+    for (size_t i = 0; i < workers_.size(); ++i)
+        if (!workers_[i]->deque.isEmpty()) return true;
+
+    return false;
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 工作线程休眠，直至有新任务或线程池停止
+// 备注:
+//   先增加休眠线程数再检查是否有任务，而添加任务者先放入任务再读休眠线程数，
+//   两者中至少有一方能看到对方，因此不会丢失唤醒。
+//-----------------------------------------------------------------------------
+void ThreadPool::parkWorker(Thread& thread)
+{
+    AutoLocker locker(mutex_);
+
+    parkedCount_.increment();
+    if (isRunning_ && !thread.isTerminated() && !hasPendingTasks())
+    {
+        parkCount_.increment();
+        condition_.wait();
+    }
+    parkedCount_.decrement();
 }
 
 //-----------------------------------------------------------------------------
 
-void ThreadPool::threadProc(Thread& thread)
+void ThreadPool::runTask(Thread& thread, TaskNode *node)
 {
-    AutoFinalizer autoFinalizer(boost::bind(&ThreadList::remove, &threadList_, &thread));
+    boost::scoped_ptr<TaskNode> holder(node);
 
+    if (repeat_)
+    {
+        TaskNode *copy = new TaskNode(node->task);
+        injectTasks(copy, copy, 1);
+    }
+
+    node->task(thread);
+}
+
+//-----------------------------------------------------------------------------
+
+void ThreadPool::threadProc(Thread& thread, Worker *worker)
+{
+    t_currentWorker = worker;
+
+    int idleCount = 0;
     while (!thread.isTerminated())
     {
         try
         {
-            Task task;
-            if (takeTask(task))
-                task(thread);
+            TaskNode *node = findTask(*worker);
+            if (node != NULL)
+            {
+                idleCount = 0;
+                runTask(thread, node);
+            }
+            else if (++idleCount < IDLE_SPIN_COUNT)
+                cpuRelax();
+            else
+            {
+                idleCount = 0;
+                parkWorker(thread);
+            }
         }
         catch (Exception& e)
         {
             logger().writeException(e);
         }
     }
+
+    t_currentWorker = NULL;
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 释放各工作线程的数据，未执行的任务移回注入队列
+//-----------------------------------------------------------------------------
+void ThreadPool::clearWorkers()
+{
+    for (size_t i = 0; i < workers_.size(); ++i)
+    {
+        Worker *worker = workers_[i];
+        void *item;
+        while ((item = worker->deque.steal()) != NULL)
+        {
+            TaskNode *node = static_cast<TaskNode*>(item);
+            injectShards_[0].queue.pushChain(node, node);
+        }
+        delete worker;
+    }
+
+    workers_.clear();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// class ThreadPool::WorkerThread
+
+ThreadPool::WorkerThread::WorkerThread(ThreadPool *pool, Worker *worker) :
+    pool_(pool),
+    worker_(worker)
+{
+    setAutoDelete(true);
+    pool_->threadList_.add(this);
+}
+
+ThreadPool::WorkerThread::~WorkerThread()
+{
+    pool_->threadList_.remove(this);
+}
+
+//-----------------------------------------------------------------------------
+
+void ThreadPool::WorkerThread::execute()
+{
+    pool_->threadProc(*this, worker_);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -56,6 +56,7 @@ namespace ise
 
     1. Windows线程拥有Handle和ThreadId，而Linux线程只有ThreadId。
     2. Windows线程只有ThreadPriority，而Linux线程有ThreadPolicy和ThreadPriority。
+    3. 线程名称只在Linux下生效 (pthread_setname_np，最多15个字符)，Windows下仅作记录。
 
 */
 ///////////////////////////////////////////////////////////////////////////////
@@ -125,12 +126,16 @@ public:
     int getReturnValue() const { return returnValue_; }
     bool isAutoDelete() const { return isAutoDelete_; }
     int getTermElapsedSecs() const;
+    const string& getName() const { return name_; }
+    const IntegerArray& getCpuAffinity() const { return cpuAffinity_; }
     // 属性 (setter)
     void setThreadId(THREAD_ID value) { threadId_ = value; }
     void setExecuting(bool value) { isExecuting_ = value; }
     void setTerminated(bool value);
     void setReturnValue(int value) { returnValue_ = value; }
     void setAutoDelete(bool value) { isAutoDelete_ = value; }
+    void setName(const string& value) { name_ = value; }
+    void setCpuAffinity(const IntegerArray& value) { cpuAffinity_ = value; }
 
 protected:
     void execute();
@@ -150,6 +155,8 @@ protected:
     bool terminated_;             // 是否应退出的标志
     bool isSleepInterrupted_;     // 睡眠是否被中断
     int returnValue_;             // 线程返回值 (可在 execute 函数中修改此值，函数 waitFor 返回此值)
+    string name_;                 // 线程名称 (为空表示不设置)
+    IntegerArray cpuAffinity_;    // 线程可运行的CPU编号 (为空表示不限制)
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -172,9 +179,12 @@ public:
 
     int getPriority() const { return priority_; }
     void setPriority(int value);
+    void setName(const string& value);
+    void setCpuAffinity(const IntegerArray& value);
 
 private:
     void checkThreadError(bool success);
+    void applyCpuAffinity();
 
 protected:
     HANDLE handle_;               // 线程句柄
@@ -205,9 +215,13 @@ public:
     int getPriority() const { return priority_; }
     void setPolicy(int value);
     void setPriority(int value);
+    void setName(const string& value);
+    void setCpuAffinity(const IntegerArray& value);
 
 private:
     void checkThreadError(int errorCode);
+    void applyName();
+    void applyCpuAffinity();
 
 protected:
     pthread_t pthreadId_;         // POSIX线程ID
@@ -261,6 +275,8 @@ public:
     int getReturnValue() const { return threadImpl_.getReturnValue(); }
     bool isAutoDelete() const { return threadImpl_.isAutoDelete(); }
     int getTermElapsedSecs() const { return threadImpl_.getTermElapsedSecs(); }
+    const string& getName() const { return threadImpl_.getName(); }
+    const IntegerArray& getCpuAffinity() const { return threadImpl_.getCpuAffinity(); }
 #ifdef ISE_WINDOWS
     int getPriority() const { return threadImpl_.getPriority(); }
 #endif
@@ -272,6 +288,10 @@ public:
     void setTerminated(bool value) { threadImpl_.setTerminated(value); }
     void setReturnValue(int value) { threadImpl_.setReturnValue(value); }
     void setAutoDelete(bool value) { threadImpl_.setAutoDelete(value); }
+    // 设置线程名称 (可在 run() 之前或之后调用)
+    void setName(const string& value) { threadImpl_.setName(value); }
+    // 将线程绑定到指定的CPU上运行 (CPU编号 0-based，为空表示不限制)
+    void setCpuAffinity(const IntegerArray& value) { threadImpl_.setCpuAffinity(value); }
 #ifdef ISE_WINDOWS
     void setPriority(int value) { threadImpl_.setPriority(value); }
 #endif
@@ -340,12 +360,24 @@ protected:
 };
 
 ///////////////////////////////////////////////////////////////////////////////
-// class ThreadPool - 线程池
+// class ThreadPool - 线程池 (工作窃取)
+//
+// 说明:
+// 1. 每个工作线程拥有一个工作窃取队列 (WorkStealingDeque)。工作线程自身 (即在任务中)
+//    添加的任务压入自己的队列，无需加锁；其它线程添加的任务按线程分片放入注入队列
+//    (INJECT_SHARD_COUNT 个无锁队列)，由空闲的工作线程整批取走。
+// 2. 工作线程依次从自己的队列、注入队列中取任务，都没有时从其它工作线程的队列中窃取。
+// 3. 找不到任务的工作线程先自旋 (IDLE_SPIN_COUNT 轮)，仍无任务时才休眠；添加任务时
+//    只唤醒所需数量的休眠线程，避免惊群。
+// 4. addTasks() 一次性添加一批任务，只需一次原子操作和至多一次唤醒系统调用。
+// 5. setTaskRepeat(true) 时，每个任务被取出后立即重新放入注入队列，因而被反复执行
+//    (可能同时在多个线程中执行)，直到线程池停止。
 
 class ThreadPool : boost::noncopyable
 {
 public:
     typedef boost::function<void (Thread& thread)> Task;
+    typedef std::vector<Task> TaskList;
 
 public:
     ThreadPool();
@@ -355,21 +387,78 @@ public:
     void stop(int maxWaitSecs = TIMEOUT_INFINITE);
 
     void addTask(const Task& task);
+    void addTasks(const TaskList& tasks);
     void setTaskRepeat(bool repeat);
 
     bool isRunning() const { return isRunning_; }
+    int getThreadCount() const { return (int)workers_.size(); }
+    INT64 getStealCount() { return stealCount_.get(); }
+    INT64 getParkCount() { return parkCount_.get(); }
 
 private:
-    bool takeTask(Task& task);
-    void threadProc(Thread& thread);
+    enum { INJECT_SHARD_COUNT = 16 };    // 注入队列的分片数
+    enum { IDLE_SPIN_COUNT = 64 };       // 休眠前查找任务的轮数
+
+    struct TaskNode : public MpscQueue::Node
+    {
+        Task task;
+        explicit TaskNode(const Task& t) : task(t) {}
+    };
+
+    struct Worker
+    {
+        ThreadPool *pool;
+        int index;
+        UINT randSeed;                   // 选择窃取对象用的随机数种子
+        WorkStealingDeque deque;
+    };
+
+    struct InjectShard
+    {
+        MpscQueue queue;
+        char padding[CACHE_LINE_SIZE - sizeof(MpscQueue)];
+    };
+
+    // 工作线程 (析构时从线程列表中移除，因而尚未开始执行即被终止的线程也不会遗留在列表中)
+    class WorkerThread : public Thread
+    {
+    public:
+        WorkerThread(ThreadPool *pool, Worker *worker);
+        virtual ~WorkerThread();
+    protected:
+        virtual void execute();
+    private:
+        ThreadPool *pool_;
+        Worker *worker_;
+    };
 
 private:
+    void injectTasks(TaskNode *newest, TaskNode *oldest, int count);
+    void wakeWorkers(int count);
+    TaskNode* findTask(Worker& worker);
+    TaskNode* takeInjectedTasks(Worker& worker);
+    TaskNode* stealTask(Worker& worker);
+    bool hasPendingTasks();
+    void parkWorker(Thread& thread);
+    void runTask(Thread& thread, TaskNode *node);
+    void threadProc(Thread& thread, Worker *worker);
+    void clearWorkers();
+
+private:
+    typedef std::vector<Worker*> Workers;
+
     Condition::Mutex mutex_;
     Condition condition_;
-    std::deque<Task> tasks_;
+    InjectShard injectShards_[INJECT_SHARD_COUNT];
+    Workers workers_;
     ThreadList threadList_;
-    bool isRunning_;
-    bool repeat_;
+    AtomicInt parkedCount_;      // 正在休眠的工作线程数
+    AtomicInt64 stealCount_;     // 窃取成功的次数
+    AtomicInt64 parkCount_;      // 工作线程进入休眠的次数
+    volatile bool isRunning_;
+    volatile bool repeat_;
+
+    friend class WorkerThread;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
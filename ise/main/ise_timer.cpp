@@ -38,16 +38,21 @@ namespace ise
 ///////////////////////////////////////////////////////////////////////////////
 // class Timer
 
-SeqNumberAlloc Timer::s_timerIdAlloc(1);
-
-Timer::Timer(Timestamp expiration, INT64 interval, const TimerCallback& callback) :
-    expiration_(expiration),
-    interval_(interval),
-    repeat_(interval > 0.0),
-    timerId_(s_timerIdAlloc.allocId()),
-    callback_(callback)
+Timer::Timer() :
+    owner_(NULL),
+    expireTicks_(0),
+    interval_(0),
+    slack_(0),
+    timerId_(0),
+    remoteId_(0),
+    index_(0),
+    serial_(0),
+    nextFree_(NULL),
+    isRunning_(false),
+    isCanceled_(false),
+    isDeferred_(false)
 {
-    // nothing
+    entry_.setCallback(boost::bind(&TimerQueue::onTimerExpired, this));
 }
 
 //-----------------------------------------------------------------------------
@@ -68,20 +73,39 @@ void Timer::invokeCallback()
 }
 
 //-----------------------------------------------------------------------------
-
-void Timer::restart(Timestamp now)
+// 备注:
+//   指定了 slack 的定时器以上次的 (未推迟的) 到期时间为起点，使推迟不致累积。
+//   下次到期时刻直接以单调时钟计算，不再经墙上时间换算，以免每个周期累积取整误差。
+//-----------------------------------------------------------------------------
+void Timer::restart(Timestamp now, UINT64 nowTicks)
 {
-    if (repeat_)
-        expiration_ = now + interval_;
-    else
+    if (!repeat())
         expiration_ = Timestamp(0);
+    else if (slack_ > 0 && expireTicks_ + interval_ > nowTicks)
+    {
+        expiration_ += interval_;
+        expireTicks_ += interval_;
+    }
+    else
+    {
+        expiration_ = now + interval_;
+        expireTicks_ = nowTicks + interval_;
+    }
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 // class TimerQueue
 
+// 由其它线程添加的定时器的 TimerId 带有此标志，以区别于由池序号组成的 TimerId
+static const TimerId REMOTE_TIMER_ID_FLAG = (TimerId)1 << 62;
+
+AtomicInt64 TimerQueue::s_remoteIdAlloc;
+
 TimerQueue::TimerQueue() :
-    callingExpiredTimers_(false)
+    wheel_(1),
+    freeList_(NULL),
+    nowTicks_(0),
+    count_(0)
 {
     // nothing
 }
@@ -92,97 +116,498 @@ TimerQueue::~TimerQueue()
 }
 
 //-----------------------------------------------------------------------------
+// 描述: 添加定时器，返回 TimerId
+//-----------------------------------------------------------------------------
+TimerId TimerQueue::addTimer(Timestamp expiration, INT64 interval, const TimerCallback& callback,
+    INT64 slack)
+{
+    Timer *timer = allocTimer();
+    timer->expiration_ = expiration;
+    timer->interval_ = interval;
+    timer->slack_ = ise::max(slack, (INT64)0);
+    timer->callback_ = callback;
+
+    scheduleTimer(timer);
+    return timer->timerId_;
+}
 
-void TimerQueue::addTimer(Timer *timer)
+//-----------------------------------------------------------------------------
+// 描述: 添加由其它线程请求的定时器 (remoteId 由 allocRemoteTimerId() 分配)
+//-----------------------------------------------------------------------------
+void TimerQueue::addRemoteTimer(TimerId remoteId, Timestamp expiration, INT64 interval,
+    const TimerCallback& callback, INT64 slack)
 {
-    bool success = timerList_.insert(TimerItem(timer->expiration(), timer)).second;
-    ISE_ASSERT(success);
-    (void)success;
+    Timer *timer = findTimer(addTimer(expiration, interval, callback, slack));
+    timer->remoteId_ = remoteId;
+    remoteTimers_[remoteId] = timer;
+}
 
-    success = timerIdMap_.insert(std::make_pair(timer->timerId(), timer)).second;
-    ISE_ASSERT(success);
+//-----------------------------------------------------------------------------
+// 描述: 取消定时器
+// 备注: 可在定时器的回调中取消定时器自身。
+//-----------------------------------------------------------------------------
+void TimerQueue::cancelTimer(TimerId timerId)
+{
+    Timer *timer = findTimer(timerId);
+    if (!timer) return;
 
-    ISE_ASSERT(timerList_.size() == timerIdMap_.size());
+    if (timer->isRunning_)
+        timer->isCanceled_ = true;
+    else
+    {
+        timer->entry_.cancel();
+        freeTimer(timer);
+    }
 }
 
 //-----------------------------------------------------------------------------
+// 描述: 取得最近一个定时器的到期时间 (无定时器时返回 false)
+//-----------------------------------------------------------------------------
+bool TimerQueue::getNearestExpiration(Timestamp& expiration)
+{
+    int timeout = wheel_.calcWaitTimeout(Clock::getTicks());
+    bool result = (timeout != TIMEOUT_INFINITE);
+    if (result)
+        expiration = Clock::now() + timeout;
+    return result;
+}
 
-void TimerQueue::cancelTimer(TimerId timerId)
+//-----------------------------------------------------------------------------
+// 描述: 执行全部到期定时器的回调
+//-----------------------------------------------------------------------------
+void TimerQueue::processExpiredTimers(Timestamp now)
+{
+    now_ = now;
+    nowTicks_ = Clock::getTicks();
+    wheel_.advance(nowTicks_);
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 无锁地分配一个供其它线程使用的 TimerId
+//-----------------------------------------------------------------------------
+TimerId TimerQueue::allocRemoteTimerId()
+{
+    return REMOTE_TIMER_ID_FLAG | (s_remoteIdAlloc.increment() & (REMOTE_TIMER_ID_FLAG - 1));
+}
+
+//-----------------------------------------------------------------------------
+
+void TimerQueue::onTimerExpired(Timer *timer)
+{
+    timer->owner_->expireTimer(timer);
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 从定时器池中分配一个 Timer，池空时按块扩充
+//-----------------------------------------------------------------------------
+Timer* TimerQueue::allocTimer()
 {
-    TimerIdMap::iterator iter = timerIdMap_.find(timerId);
-    if (iter != timerIdMap_.end())
+    if (!freeList_)
     {
-        Timer *timer = iter->second;
-        timerList_.erase(TimerItem(timer->expiration(), timer));
-        timerIdMap_.erase(iter);
+        Timer *chunk = new Timer[CHUNK_SIZE];
+        UINT baseIndex = (UINT)(chunks_.size() * CHUNK_SIZE);
+        chunks_.push_back(chunk);
+
+        for (int i = CHUNK_SIZE - 1; i >= 0; --i)
+        {
+            Timer& timer = chunk[i];
+            timer.owner_ = this;
+            timer.index_ = baseIndex + i;
+            timer.nextFree_ = freeList_;
+            freeList_ = &timer;
+        }
+    }
+
+    Timer *timer = freeList_;
+    freeList_ = timer->nextFree_;
 
-        delete timer;
+    timer->serial_ = (timer->serial_ + 1) & SERIAL_MASK;
+    if (timer->serial_ == 0) timer->serial_ = 1;
+    timer->timerId_ = ((TimerId)timer->serial_ << 32) | timer->index_;
+    timer->nextFree_ = NULL;
+    timer->isRunning_ = false;
+    timer->isCanceled_ = false;
+    ++count_;
 
-        ISE_ASSERT(timerList_.size() == timerIdMap_.size());
+    return timer;
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 将 Timer 归还定时器池
+//-----------------------------------------------------------------------------
+void TimerQueue::freeTimer(Timer *timer)
+{
+    if (timer->remoteId_)
+    {
+        remoteTimers_.erase(timer->remoteId_);
+        timer->remoteId_ = 0;
     }
-    else if (callingExpiredTimers_)
+
+    timer->timerId_ = 0;
+    timer->callback_ = TimerCallback();  // 尽早释放回调所绑定的对象
+    timer->nextFree_ = freeList_;
+    freeList_ = timer;
+    --count_;
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 根据 TimerId 查找有效的定时器 (找不到返回 NULL)
+//-----------------------------------------------------------------------------
+Timer* TimerQueue::findTimer(TimerId timerId)
+{
+    if (timerId & REMOTE_TIMER_ID_FLAG)
     {
-        cancelingTimers_.insert(timerId);
+        RemoteTimerMap::iterator iter = remoteTimers_.find(timerId);
+        return (iter != remoteTimers_.end() ? iter->second : NULL);
     }
+
+    UINT index = (UINT)(timerId & 0xFFFFFFFF);
+    if (timerId <= 0 || index >= chunks_.size() * CHUNK_SIZE)
+        return NULL;
+
+    Timer *timer = &chunks_[index / CHUNK_SIZE][index % CHUNK_SIZE];
+    return (timer->timerId_ == timerId ? timer : NULL);
 }
 
 //-----------------------------------------------------------------------------
+// 描述: 按定时器的到期时间将其放入时间轮
+//-----------------------------------------------------------------------------
+void TimerQueue::scheduleTimer(Timer *timer)
+{
+    timer->expireTicks_ = Clock::toTicks(timer->expiration_);
+    scheduleTimerTicks(timer);
+}
 
-bool TimerQueue::getNearestExpiration(Timestamp& expiration)
+//-----------------------------------------------------------------------------
+// 描述: 按定时器已换算好的到期时刻 (expireTicks_) 将其放入时间轮
+//-----------------------------------------------------------------------------
+void TimerQueue::scheduleTimerTicks(Timer *timer)
 {
-    bool result = !timerList_.empty();
-    if (result)
-        expiration = timerList_.begin()->first;
-    return result;
+    UINT64 curTicks = Clock::getTicks();
+    UINT64 expireTicks = ise::max(timer->expireTicks_, curTicks);
+
+    timer->isDeferred_ = (expireTicks - curTicks > wheel_.getMaxDelay());
+    if (timer->isDeferred_)
+        expireTicks = curTicks + wheel_.getMaxDelay();
+
+    if (timer->slack_ > 0 && !timer->isDeferred_)
+        expireTicks = applySlack(expireTicks, (UINT64)timer->slack_);
+
+    wheel_.scheduleAt(timer->entry_, expireTicks);
 }
 
 //-----------------------------------------------------------------------------
+// 描述: 在 [expireTicks, expireTicks + slack] 内取低位连续为0最多的时刻
+// 备注: 区间有重叠的定时器大多取到同一时刻，从而在同一个 tick 中到期。
+//-----------------------------------------------------------------------------
+UINT64 TimerQueue::applySlack(UINT64 expireTicks, UINT64 slack)
+{
+    UINT64 limit = expireTicks + slack;
+    UINT64 diffBits = expireTicks ^ limit;
+    if (diffBits == 0) return expireTicks;
 
-void TimerQueue::processExpiredTimers(Timestamp now)
+    UINT64 highBit = 1;
+    while (diffBits >>= 1)
+        highBit <<= 1;
+
+    return limit & ~(highBit - 1);
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 定时器到期
+//-----------------------------------------------------------------------------
+void TimerQueue::expireTimer(Timer *timer)
 {
-    std::vector<Timer*> expiredTimers;
-    TimerItem timerItem(now, reinterpret_cast<Timer*>(std::numeric_limits<uintptr_t>::max()));
+    if (timer->isDeferred_)
+    {
+        scheduleTimerTicks(timer);
+        return;
+    }
 
-    TimerList::iterator bound = timerList_.upper_bound(timerItem);
-    for (TimerList::iterator iter = timerList_.begin(); iter != bound;)
+    timer->isRunning_ = true;
+    timer->invokeCallback();
+    timer->isRunning_ = false;
+
+    if (timer->repeat() && !timer->isCanceled_)
     {
-        Timer *timer = iter->second;
-        expiredTimers.push_back(timer);
+        timer->restart(now_, nowTicks_);
+        scheduleTimerTicks(timer);
+    }
+    else
+        freeTimer(timer);
+}
+
+//-----------------------------------------------------------------------------
 
-        timerList_.erase(iter++);
-        timerIdMap_.erase(timer->timerId());
+void TimerQueue::clearTimers()
+{
+    for (size_t i = 0; i < chunks_.size(); ++i)
+        delete[] chunks_[i];
+    chunks_.clear();
+    remoteTimers_.clear();
+    freeList_ = NULL;
+    count_ = 0;
+}
 
-        ISE_ASSERT(timerList_.size() == timerIdMap_.size());
+///////////////////////////////////////////////////////////////////////////////
+// class TimingWheel
+
+TimingWheel::TimingWheel(UINT tickMSecs) :
+    tickMSecs_(ise::max(tickMSecs, (UINT)1)),
+    currentTick_(Clock::getTicks() / tickMSecs_),
+    count_(0)
+{
+    for (int i = 0; i < SLOT_COUNT; ++i)
+        slots_[i].prev = slots_[i].next = &slots_[i];
+}
+
+TimingWheel::~TimingWheel()
+{
+    for (int i = 0; i < SLOT_COUNT; ++i)
+    {
+        Link& slot = slots_[i];
+        while (slot.next != &slot)
+            cancel(static_cast<Entry&>(*slot.next));
     }
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 调度定时项，delayMSecs 毫秒后到期 (若已调度则重新调度)
+// 备注:
+//   1. 以当前时间 (而非 currentTick_，它可能因事件循环等待而滞后) 为起点计算。
+//   2. 定时项不会提前到期，但最多可能推迟一个 tick。
+//-----------------------------------------------------------------------------
+void TimingWheel::schedule(Entry& entry, UINT64 delayMSecs)
+{
+    UINT64 ticks = (delayMSecs + tickMSecs_ - 1) / tickMSecs_ + 1;
+    scheduleAt(entry, (Clock::getTicks() / tickMSecs_ + ticks) * tickMSecs_);
+}
 
-    for (size_t i = 0; i < expiredTimers.size(); i++)
+//-----------------------------------------------------------------------------
+// 描述: 调度定时项，在 Clock::getTicks() 达到 expireTicks 时到期 (若已调度则重新调度)
+// 备注: 已过期的定时项在下一个 tick 到期，超出最大定时时长者按最大时长处理。
+//-----------------------------------------------------------------------------
+void TimingWheel::scheduleAt(Entry& entry, UINT64 expireTicks)
+{
+    if (entry.wheel_)
+        cancel(entry);
+
+    if (count_ == 0)
+        currentTick_ = ise::max(Clock::getTicks() / tickMSecs_, currentTick_);
+
+    UINT64 expireTick = (expireTicks + tickMSecs_ - 1) / tickMSecs_;
+    expireTick = ise::max(expireTick, currentTick_ + 1);
+    expireTick = ise::min(expireTick, currentTick_ + (UINT64)(MAX_TICKS - 1));
+
+    entry.expireTick_ = expireTick;
+    entry.wheel_ = this;
+    addEntry(entry);
+    ++count_;
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 取消定时项
+//-----------------------------------------------------------------------------
+void TimingWheel::cancel(Entry& entry)
+{
+    if (entry.wheel_ != this) return;
+
+    unlink(entry);
+    entry.wheel_ = NULL;
+    --count_;
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 推进时间轮至 curTicks (毫秒)，并执行到期定时项的回调
+//-----------------------------------------------------------------------------
+void TimingWheel::advance(UINT64 curTicks)
+{
+    UINT64 targetTick = curTicks / tickMSecs_;
+
+    if (count_ == 0)
     {
-        Timer *timer = expiredTimers[i];
+        if (targetTick > currentTick_)
+            currentTick_ = targetTick;
+        return;
+    }
 
-        cancelingTimers_.clear();
-        callingExpiredTimers_ = true;
-        timer->invokeCallback();
-        callingExpiredTimers_ = false;
+    while (currentTick_ < targetTick)
+    {
+        // 长时间未推进时，跳过没有定时项的 tick
+        if (targetTick - currentTick_ > LEVEL0_SIZE)
+            currentTick_ = ise::min(findNextTick(), targetTick) - 1;
 
-        if (timer->repeat() &&
-            cancelingTimers_.find(timer->timerId()) == cancelingTimers_.end())
+        ++currentTick_;
+
+        // 第0层转完一圈时，将上层对应槽中的定时项下移
+        if ((currentTick_ & (LEVEL0_SIZE - 1)) == 0)
+        {
+            for (int level = 1; level < LEVEL_COUNT; ++level)
+            {
+                cascade(level);
+                int shift = LEVEL0_BITS + LEVELN_BITS * (level - 1);
+                if (((currentTick_ >> shift) & (LEVELN_SIZE - 1)) != 0)
+                    break;
+            }
+        }
+
+        expireSlot(getSlot(0, currentTick_));
+
+        if (count_ == 0)
         {
-            timer->restart(now);
-            addTimer(timer);
+            currentTick_ = ise::max(currentTick_, targetTick);
+            break;
         }
-        else
-            delete timer;
     }
 }
 
 //-----------------------------------------------------------------------------
+// 描述: 计算事件循环的最长等待时间 (毫秒)，无定时项时返回 TIMEOUT_INFINITE
+//-----------------------------------------------------------------------------
+int TimingWheel::calcWaitTimeout(UINT64 curTicks) const
+{
+    if (count_ == 0) return TIMEOUT_INFINITE;
 
-void TimerQueue::clearTimers()
+    UINT64 expireTicks = findNextTick() * tickMSecs_;
+    UINT64 timeout = (expireTicks <= curTicks) ? 0 : (expireTicks - curTicks);
+    return (int)ise::min(timeout, (UINT64)INT_MAX);
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 返回 currentTick_ 之后最近一个需要处理 (有定时项到期或需逐层下移) 的 tick
+// 备注: 上层槽中的定时项最早在该槽下移时到期，故以下移的时刻为准。
+//-----------------------------------------------------------------------------
+UINT64 TimingWheel::findNextTick() const
+{
+    UINT64 result = currentTick_ + MAX_TICKS;
+
+    for (UINT64 tick = currentTick_ + 1; tick < currentTick_ + LEVEL0_SIZE; ++tick)
+    {
+        const Link& slot = slots_[getSlotIndex(0, tick)];
+        if (slot.next != &slot)
+        {
+            result = tick;
+            break;
+        }
+    }
+
+    for (int level = 1; level < LEVEL_COUNT; ++level)
+    {
+        int shift = LEVEL0_BITS + LEVELN_BITS * (level - 1);
+        for (UINT64 i = 1; i <= LEVELN_SIZE; ++i)
+        {
+            UINT64 tick = ((currentTick_ >> shift) + i) << shift;
+            if (tick >= result) break;
+
+            const Link& slot = slots_[getSlotIndex(level, tick)];
+            if (slot.next != &slot)
+            {
+                result = tick;
+                break;
+            }
+        }
+    }
+
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+
+int TimingWheel::getSlotIndex(int level, UINT64 tick)
+{
+    if (level == 0)
+        return (int)(tick & (LEVEL0_SIZE - 1));
+
+    int shift = LEVEL0_BITS + LEVELN_BITS * (level - 1);
+    return LEVEL0_SIZE + LEVELN_SIZE * (level - 1) + (int)((tick >> shift) & (LEVELN_SIZE - 1));
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 根据到期时间将定时项放入合适的层
+//-----------------------------------------------------------------------------
+void TimingWheel::addEntry(Entry& entry)
+{
+    UINT64 diff = (entry.expireTick_ > currentTick_ ? entry.expireTick_ - currentTick_ : 0);
+    if (diff == 0)
+        entry.expireTick_ = currentTick_;
+
+    int level = 0;
+    UINT64 range = LEVEL0_SIZE;
+    while (diff >= range && level < LEVEL_COUNT - 1)
+    {
+        ++level;
+        range <<= LEVELN_BITS;
+    }
+
+    linkTail(getSlot(level, entry.expireTick_), entry);
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 将第 level 层当前槽中的定时项重新放入下层
+//-----------------------------------------------------------------------------
+void TimingWheel::cascade(int level)
+{
+    Link& slot = getSlot(level, currentTick_);
+    if (slot.next == &slot) return;
+
+    // 先将整个槽摘下，再逐个重新放入
+    Link list;
+    list.next = slot.next;
+    list.prev = slot.prev;
+    list.next->prev = &list;
+    list.prev->next = &list;
+    slot.prev = slot.next = &slot;
+
+    while (list.next != &list)
+    {
+        Entry& entry = static_cast<Entry&>(*list.next);
+        unlink(entry);
+        addEntry(entry);
+    }
+}
+
+//-----------------------------------------------------------------------------
+// 描述: 执行槽中全部定时项的回调
+// 备注: 回调中可以调度或取消任何定时项 (包括同一槽中尚未执行的定时项)。
+//-----------------------------------------------------------------------------
+void TimingWheel::expireSlot(Link& slot)
+{
+    while (slot.next != &slot)
+    {
+        Entry& entry = static_cast<Entry&>(*slot.next);
+        cancel(entry);
+
+        try
+        {
+            // 回调中可能销毁 entry，故先复制回调
+            Entry::Callback callback = entry.callback_;
+            if (callback)
+                callback();
+        }
+        catch (Exception& e)
+        {
+            logger().writeException(e);
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+void TimingWheel::unlink(Link& link)
+{
+    link.prev->next = link.next;
+    link.next->prev = link.prev;
+    link.prev = link.next = NULL;
+}
+
+//-----------------------------------------------------------------------------
+
+void TimingWheel::linkTail(Link& head, Link& link)
 {
-    for (TimerList::iterator iter = timerList_.begin(); iter != timerList_.end(); ++iter)
-        delete iter->second;
-    timerList_.clear();
-    timerIdMap_.clear();
+    link.prev = head.prev;
+    link.next = &head;
+    head.prev->next = &link;
+    head.prev = &link;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -206,25 +631,25 @@ TimerManager::~TimerManager()
 //-----------------------------------------------------------------------------
 // 描述: 添加定时器 (指定时间执行)
 //-----------------------------------------------------------------------------
-TimerId TimerManager::executeAt(Timestamp time, const TimerCallback& callback)
+TimerId TimerManager::executeAt(Timestamp time, const TimerCallback& callback, INT64 slack)
 {
-    return getTimerEventLoop().executeAt(time, callback);
+    return getTimerEventLoop().executeAt(time, callback, slack);
 }
 
 //-----------------------------------------------------------------------------
 // 描述: 添加定时器 (在 delay 毫秒后执行)
 //-----------------------------------------------------------------------------
-TimerId TimerManager::executeAfter(INT64 delay, const TimerCallback& callback)
+TimerId TimerManager::executeAfter(INT64 delay, const TimerCallback& callback, INT64 slack)
 {
-    return getTimerEventLoop().executeAfter(delay, callback);
+    return getTimerEventLoop().executeAfter(delay, callback, slack);
 }
 
 //-----------------------------------------------------------------------------
 // 描述: 添加定时器 (每 interval 毫秒循环执行)
 //-----------------------------------------------------------------------------
-TimerId TimerManager::executeEvery(INT64 interval, const TimerCallback& callback)
+TimerId TimerManager::executeEvery(INT64 interval, const TimerCallback& callback, INT64 slack)
 {
-    return getTimerEventLoop().executeEvery(interval, callback);
+    return getTimerEventLoop().executeEvery(interval, callback, slack);
 }
 
 //-----------------------------------------------------------------------------
@@ -250,6 +675,8 @@ EventLoop& TimerManager::getTimerEventLoop()
         if (eventLoopList_ == NULL)
         {
             eventLoopList_ = new EventLoopList(1);
+            eventLoopList_->setThreadName("ise-timer");
+            eventLoopList_->setPreciseTimers(iseApp().iseOptions().getPreciseTimers());
             eventLoopList_->start();
         }
         result = eventLoopList_->getItem(0);
@@ -39,35 +39,144 @@ namespace ise
 
 class EventLoop;
 class EventLoopList;
+class TimerQueue;
 
 ///////////////////////////////////////////////////////////////////////////////
-// class Timer
+// class TimingWheel - 分层时间轮 (非线程安全)
+//
+// 说明:
+// 1. 以 tickMSecs 为精度，共4层: 第0层 256 个槽，其余各层 64 个槽，最大定时时长为
+//    2^26 个 tick，超出者按最大时长处理。
+// 2. 定时项 (Entry) 为侵入式双向链表节点，调度与取消均为 O(1)，推进时间轮的开销
+//    只与到期的定时项数量 (及少量的逐层下移) 有关，而与定时项总数无关。长时间未推进
+//    时，直接跳过没有定时项的 tick。
+// 3. Entry 由使用者持有，析构时自动取消。
+
+class TimingWheel : boost::noncopyable
+{
+public:
+    // 双向循环链表节点
+    struct Link
+    {
+        Link *prev;
+        Link *next;
+    };
+
+    class Entry : public Link, boost::noncopyable
+    {
+    public:
+        typedef boost::function<void ()> Callback;
+    public:
+        Entry() : wheel_(NULL), expireTick_(0) { prev = next = NULL; }
+        ~Entry() { cancel(); }
+
+        void setCallback(const Callback& callback) { callback_ = callback; }
+        bool isScheduled() const { return wheel_ != NULL; }
+        void cancel() { if (wheel_) wheel_->cancel(*this); }
+    private:
+        TimingWheel *wheel_;
+        UINT64 expireTick_;
+        Callback callback_;
+
+        friend class TimingWheel;
+    };
+
+public:
+    explicit TimingWheel(UINT tickMSecs);
+    ~TimingWheel();
+
+    void schedule(Entry& entry, UINT64 delayMSecs);
+    void scheduleAt(Entry& entry, UINT64 expireTicks);
+    void cancel(Entry& entry);
+    void advance(UINT64 curTicks);
+    int calcWaitTimeout(UINT64 curTicks) const;
+    UINT64 findNextTick() const;
+
+    UINT getTickMSecs() const { return tickMSecs_; }
+    UINT64 getCurrentTick() const { return currentTick_; }
+    int getCount() const { return count_; }
+    UINT64 getMaxDelay() const { return (UINT64)(MAX_TICKS / 2) * tickMSecs_; }
+
+private:
+    enum
+    {
+        LEVEL_COUNT  = 4,
+        LEVEL0_BITS  = 8,
+        LEVELN_BITS  = 6,
+        LEVEL0_SIZE  = 1 << LEVEL0_BITS,
+        LEVELN_SIZE  = 1 << LEVELN_BITS,
+        MAX_TICKS    = 1 << (LEVEL0_BITS + LEVELN_BITS * (LEVEL_COUNT - 1)),
+        SLOT_COUNT   = LEVEL0_SIZE + LEVELN_SIZE * (LEVEL_COUNT - 1),
+    };
+
+    static int getSlotIndex(int level, UINT64 tick);
+    Link& getSlot(int level, UINT64 tick) { return slots_[getSlotIndex(level, tick)]; }
+    void addEntry(Entry& entry);
+    void cascade(int level);
+    void expireSlot(Link& slot);
+    static void unlink(Link& link);
+    static void linkTail(Link& head, Link& link);
+
+private:
+    const UINT tickMSecs_;
+    UINT64 currentTick_;           // 已处理到的 tick
+    int count_;                    // 已调度的定时项数
+    Link slots_[SLOT_COUNT];       // 各层的槽 (循环链表头结点)
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// class Timer - 定时器
+//
+// 说明:
+// 1. Timer 对象由 TimerQueue 的定时器池分配和回收，使用者不直接创建。
+// 2. TimerId 由定时器在池中的序号及其复用序号组成，据此可 O(1) 地找到定时器，
+//    定时器被回收后，旧的 TimerId 自动失效。
 
 class Timer : boost::noncopyable
 {
 public:
-    Timer(Timestamp expiration, INT64 interval, const TimerCallback& callback);
-
     Timestamp expiration() const { return expiration_; }
     INT64 interval() const { return interval_; }
-    bool repeat() const { return repeat_; }
+    INT64 slack() const { return slack_; }
+    bool repeat() const { return interval_ > 0; }
     TimerId timerId() const { return timerId_; }
-    void invokeCallback();
 
-    void restart(Timestamp now);
+private:
+    Timer();
+
+    void invokeCallback();
+    void restart(Timestamp now, UINT64 nowTicks);
 
 private:
+    TimerQueue *owner_;
+    TimingWheel::Entry entry_;
     Timestamp expiration_;
-    const INT64 interval_;  // millisecond
-    const bool repeat_;
-    TimerId timerId_;
-    const TimerCallback callback_;
-
-    static SeqNumberAlloc s_timerIdAlloc;
+    UINT64 expireTicks_;     // 换算成单调时钟的 (未推迟的) 到期时刻
+    INT64 interval_;         // millisecond
+    INT64 slack_;            // 允许推迟到期的毫秒数
+    TimerId timerId_;        // 为 0 表示空闲
+    TimerId remoteId_;       // 由其它线程添加时返回给调用者的 TimerId (否则为 0)
+    TimerCallback callback_;
+    UINT index_;             // 在定时器池中的序号
+    UINT serial_;            // 复用序号
+    Timer *nextFree_;
+    bool isRunning_;         // 是否正在执行回调
+    bool isCanceled_;        // 是否在执行回调期间被取消
+    bool isDeferred_;        // 是否超出时间轮的范围 (到期时需重新调度)
+
+    friend class TimerQueue;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
-// class TimerQueue
+// class TimerQueue - 定时器队列 (非线程安全，只在所属事件循环线程中使用)
+//
+// 说明:
+// 1. 定时器按 1 毫秒精度存放在分层时间轮 (TimingWheel) 中，添加、取消、到期均为 O(1)。
+// 2. Timer 对象按块分配并放入空闲链表中复用，添加定时器时不再分配内存。
+// 3. 指定了 slack 的定时器，其到期时刻在 [expiration, expiration + slack] 内按二进制
+//    取整，使到期时刻相近的定时器落在同一时刻，由一次唤醒处理。
+// 4. 其它线程添加定时器时，先由 allocRemoteTimerId() 无锁地分配 TimerId，
+//    再由事件循环线程调用 addRemoteTimer()，此类 TimerId 需查表才能找到定时器。
 
 class TimerQueue : boost::noncopyable
 {
@@ -75,24 +184,48 @@ public:
     TimerQueue();
     ~TimerQueue();
 
-    void addTimer(Timer *timer);
+    TimerId addTimer(Timestamp expiration, INT64 interval, const TimerCallback& callback,
+        INT64 slack = 0);
+    void addRemoteTimer(TimerId remoteId, Timestamp expiration, INT64 interval,
+        const TimerCallback& callback, INT64 slack);
     void cancelTimer(TimerId timerId);
     bool getNearestExpiration(Timestamp& expiration);
     void processExpiredTimers(Timestamp now);
 
+    int getCount() const { return count_; }
+
+    static TimerId allocRemoteTimerId();
+
 private:
+    enum { CHUNK_SIZE = 256 };              // 定时器池每次分配的 Timer 个数
+    enum { SERIAL_MASK = 0x3FFFFFFF };      // 复用序号的取值范围
+
+    static void onTimerExpired(Timer *timer);
+
+    Timer* allocTimer();
+    void freeTimer(Timer *timer);
+    Timer* findTimer(TimerId timerId);
+    void scheduleTimer(Timer *timer);
+    void scheduleTimerTicks(Timer *timer);
+    static UINT64 applySlack(UINT64 expireTicks, UINT64 slack);
+    void expireTimer(Timer *timer);
     void clearTimers();
 
 private:
-    typedef std::pair<Timestamp, Timer*> TimerItem;
-    typedef std::set<TimerItem> TimerList;
-    typedef std::map<TimerId, Timer*> TimerIdMap;
-    typedef std::set<TimerId> TimerIds;
-
-    TimerList timerList_;
-    TimerIdMap timerIdMap_;
-    bool callingExpiredTimers_;
-    TimerIds cancelingTimers_;
+    typedef std::vector<Timer*> TimerChunks;
+    typedef std::map<TimerId, Timer*> RemoteTimerMap;
+
+    TimingWheel wheel_;
+    TimerChunks chunks_;           // 定时器池 (每项为 CHUNK_SIZE 个 Timer 的数组)
+    Timer *freeList_;              // 空闲 Timer 链表
+    RemoteTimerMap remoteTimers_;  // 由其它线程添加的定时器 (remoteId -> Timer)
+    Timestamp now_;                // 本次处理到期定时器的时间
+    UINT64 nowTicks_;              // 本次处理到期定时器的单调时钟 Ticks
+    int count_;                    // 有效的定时器数
+
+    static AtomicInt64 s_remoteIdAlloc;
+
+    friend class Timer;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -104,9 +237,9 @@ public:
     TimerManager();
     ~TimerManager();
 public:
-    TimerId executeAt(Timestamp time, const TimerCallback& callback);
-    TimerId executeAfter(INT64 delay, const TimerCallback& callback);
-    TimerId executeEvery(INT64 interval, const TimerCallback& callback);
+    TimerId executeAt(Timestamp time, const TimerCallback& callback, INT64 slack = 0);
+    TimerId executeAfter(INT64 delay, const TimerCallback& callback, INT64 slack = 0);
+    TimerId executeEvery(INT64 interval, const TimerCallback& callback, INT64 slack = 0);
     void cancelTimer(TimerId timerId);
 private:
     EventLoop& getTimerEventLoop();